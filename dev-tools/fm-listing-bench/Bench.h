@@ -0,0 +1,144 @@
+//===========================================
+//  Lumina-DE source code
+//  Copyright (c) 2016, Ken Moore
+//  Available under the 3-clause BSD license
+//  See the LICENSE file for full details
+//===========================================
+//  Times the stages of a lumina-fm directory load:
+//   listing (scan + batches into the model), first paint of a view showing the model,
+//   sorting, and loading the data of every item
+//  Each stage also reports the peak memory use (RSS) of the process so far
+//===========================================
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTreeView>
+#include <QEvent>
+#include <QTimer>
+#include <QDebug>
+
+#include <sys/resource.h>
+
+#include "Browser.h"
+#include "BrowserModel.h"
+
+class ListBench : public QObject{
+	Q_OBJECT
+private:
+	Browser *browser;
+	BrowserModel *model;
+	QString dir;
+	QTreeView *view;
+	QElapsedTimer timer, sinceload;
+	int loaded, changes;
+	bool listed, painted;
+
+	static long peakRSS(){
+	  //KB on Linux and the BSDs
+	  struct rusage use;
+	  if(getrusage(RUSAGE_SELF, &use)!=0){ return -1; }
+	  return use.ru_maxrss;
+	}
+
+	void report(QString stage, qint64 ms = -1){
+	  if(ms<0){ ms = timer.elapsed(); }
+	  qDebug() << QString("%1: %2 ms").arg(stage, -22).arg(ms) << "(" << model->rowCount() << "items, peak RSS" << peakRSS()/1024 << "MB )";
+	}
+
+	void quit(){
+	  QCoreApplication::exit(0);
+	}
+
+protected:
+	bool eventFilter(QObject *obj, QEvent *ev){
+	  if(!painted && obj==view->viewport() && ev->type()==QEvent::Paint && model->rowCount()>0){
+	    //Report once the event loop is back (after the items were painted)
+	    painted = true;
+	    QTimer::singleShot(0, this, SLOT(firstPaint()) );
+	  }
+	  return false;
+	}
+
+private slots:
+	void firstPaint(){
+	  report("First paint (since load)", sinceload.elapsed());
+	}
+
+	void itemsLoading(int total){
+	  if(total<1){ qDebug() << "Empty directory:" << dir; quit(); }
+	}
+
+	void listingFinished(){
+	  if(listed){
+	    //Change events after the files were added (directory watcher)
+	    report("Changes applied");
+	    quit();
+	    return;
+	  }
+	  listed = true;
+	  report("Listed");
+	  timer.start();
+	  model->sort(0, Qt::AscendingOrder);
+	  report("Sorted (name)");
+	  timer.start();
+	  model->sort(0, Qt::DescendingOrder);
+	  report("Sorted (name reverse)");
+	  //Now load the data of every item (as if it were all on the screen)
+	  timer.start();
+	  for(int i=0; i<model->rowCount(); i++){ browser->requestItem( model->itemPath(i) ); }
+	}
+
+	void itemDataAvailable(QIcon ico, LFileInfo info){
+	  model->updateItem(ico, info);
+	  loaded++;
+	  if(loaded != model->rowCount()){ return; }
+	  report("Item data loaded");
+	  timer.start();
+	  model->sort(2, Qt::AscendingOrder);
+	  report("Sorted (type)");
+	  timer.start();
+	  model->sort(1, Qt::AscendingOrder);
+	  report("Sorted (size)");
+	  //Add a few files to time the change handling too (includes the 500 ms the backend waits for more changes)
+	  timer.start();
+	  for(int i=0; i<changes; i++){
+	    QFile file(dir+"/bench-change-"+QString::number(i));
+	    if(file.open(QIODevice::WriteOnly)){ file.close(); }
+	  }
+	  if(changes<1){ quit(); }
+	}
+
+public:
+	ListBench(QString path, int newfiles) : QObject(){
+	  dir = path;
+	  changes = newfiles;
+	  loaded = 0;
+	  listed = painted = false;
+	  browser = new Browser(this);
+	  model = new BrowserModel(this);
+	  //Show the items like lumina-fm does so the first paint can be timed
+	  view = new QTreeView();
+	  view->setModel(model);
+	  view->resize(800, 600);
+	  view->viewport()->installEventFilter(this);
+	  view->show();
+	  connect(browser, SIGNAL(itemsLoading(int)), this, SLOT(itemsLoading(int)) );
+	  connect(browser, SIGNAL(itemsListed(QStringList, bool)), this, SLOT(itemsListed(QStringList, bool)) );
+	  connect(browser, SIGNAL(listingFinished()), this, SLOT(listingFinished()) );
+	  connect(browser, SIGNAL(itemDataAvailable(QIcon, LFileInfo)), this, SLOT(itemDataAvailable(QIcon, LFileInfo)) );
+	}
+	~ListBench(){
+	  delete view;
+	}
+
+	void start(){
+	  timer.start();
+	  sinceload.start();
+	  browser->loadDirectory(dir);
+	}
+
+public slots:
+	void itemsListed(QStringList paths, bool dirs){
+	  model->addItems(paths, dirs);
+	}
+};
@@ -0,0 +1,23 @@
+# Benchmark for the lumina-fm directory listing (backend scan, model, first paint, sorting, item loading, peak RSS)
+# Usage: fm-listing-bench <directory | number of files to generate (10k, 100k, 1M, ...) | presets>
+
+QT += core gui widgets concurrent
+
+TEMPLATE = app
+TARGET = fm-listing-bench
+target.path = $${PWD}
+
+FM = ../../src-qt5/desktop-utils/lumina-fm
+
+#Same libLumina classes as lumina-fm uses for the listing
+include(../../src-qt5/core/libLumina/LuminaXDG.pri)
+
+INCLUDEPATH += $${FM}
+
+SOURCES = main.cpp \
+		$${FM}/Browser.cpp \
+		$${FM}/BrowserModel.cpp
+
+HEADERS = Bench.h \
+		$${FM}/Browser.h \
+		$${FM}/BrowserModel.h
@@ -0,0 +1,61 @@
+#include <QApplication>
+#include <QTemporaryDir>
+#include <QFile>
+#include <QDebug>
+
+#include "Bench.h"
+
+//Number of items to generate: "5000", "10k", "100k", "1M" (-1 if the argument is a directory)
+static int itemCount(QString arg){
+  int mult = 1;
+  if(arg.endsWith("k", Qt::CaseInsensitive)){ mult = 1000; arg.chop(1); }
+  else if(arg.endsWith("M")){ mult = 1000000; arg.chop(1); }
+  bool isnum = false;
+  int num = arg.toInt(&isnum);
+  if(!isnum || num<1){ return -1; }
+  return num*mult;
+}
+
+//Generate a directory with mixed names ("File10", "file9", "a.txt", ...) and some sub-dirs
+static void generateItems(QString dir, int num){
+  QStringList exts; exts << "txt" << "png" << "desktop" << "mp3" << "";
+  for(int i=0; i<num; i++){
+    if(i%50==0){ QDir(dir).mkdir("Dir"+QString::number(i)); continue; }
+    QString name = QString( (i%2==0) ? "File" : "file")+QString::number(i);
+    if(!exts[i%exts.length()].isEmpty()){ name.append("."+exts[i%exts.length()]); }
+    QFile file(dir+"/"+name);
+    if(file.open(QIODevice::WriteOnly)){ file.write( QByteArray(i%256, 'x') ); file.close(); }
+  }
+}
+
+int  main(int argc, char *argv[]) {
+
+   QApplication a(argc, argv);
+   if(argc<2){
+     qDebug() << "Usage: fm-listing-bench <directory | number of files to generate (10k, 100k, 1M, ...) | presets>";
+     qDebug() << "  presets: run 10k, 100k and 1M generated files one after the other";
+     return 1;
+   }
+   QStringList runs;
+   if(QString(argv[1])=="presets"){ runs << "10k" << "100k" << "1M"; }
+   else{ runs << QString(argv[1]); }
+   int ret = 0;
+   for(int r=0; r<runs.length() && ret==0; r++){
+     QString dir = runs[r];
+     QTemporaryDir tmpdir;
+     int changes = 0;
+     int num = itemCount(runs[r]);
+     if(num>0){
+       if(!tmpdir.isValid()){ qDebug() << "Could not create a temporary directory"; return 1; }
+       dir = tmpdir.path();
+       generateItems(dir, num);
+       changes = qMax(1, num/100); //files added after the initial load
+       qDebug() << "Generated" << num << "items in:" << dir;
+     }
+     //Note: the peak RSS is for the whole process - the presets run smallest first
+     ListBench bench(dir, changes);
+     bench.start();
+     ret = a.exec();
+   }
+   return ret;
+}
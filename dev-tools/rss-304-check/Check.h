@@ -0,0 +1,166 @@
+//===========================================
+//  Lumina-DE source code
+//  Copyright (c) 2016, Ken Moore
+//  Available under the 3-clause BSD license
+//  See the LICENSE file for full details
+//===========================================
+//  Runs the desktop RSS reader against a local HTTP server which serves a feed
+//   with ETag/Last-Modified/Cache-Control headers and answers conditional requests with 304
+//  Steps: initial download, 304 on a re-sync, load from the disk cache on "restart"
+//   (no request at all), and a full download once the feed changes
+//===========================================
+#include <QCoreApplication>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QHash>
+#include <QDebug>
+
+#include "RSSObjects.h"
+
+#define CHECK_POLL 100 //ms between checks of the reader state
+#define CHECK_TIMEOUT 10000 //ms before a step fails
+
+class RSSCheck : public QObject{
+	Q_OBJECT
+private:
+	QTcpServer *server;
+	QHash<QTcpSocket*, QByteArray> requests; //partial requests
+	RSSReader *reader;
+	QTimer *poll;
+	QString url;
+	int version, step, waited, failures;
+	//Server statistics
+	int full, notmodified;
+	QByteArray lastETag, lastSince; //conditional headers of the last request
+
+	QByteArray etag(){ return "\"feed-v"+QByteArray::number(version)+"\""; }
+	QByteArray lastModified(){ return (version==1) ? "Mon, 04 Jan 2016 10:00:00 GMT" : "Tue, 05 Jan 2016 10:00:00 GMT"; }
+
+	QByteArray feed(){
+	  QByteArray num = QByteArray::number(version);
+	  QByteArray date = (version==1) ? "Mon, 04 Jan 2016 10:00:00 +0000" : "Tue, 05 Jan 2016 10:00:00 +0000";
+	  return "<?xml version=\"1.0\"?>\n<rss version=\"2.0\"><channel>"
+		"<title>Feed v"+num+"</title><link>http://localhost/</link><description>RSS check feed</description>"
+		"<lastBuildDate>"+date+"</lastBuildDate><ttl>60</ttl>"
+		"<item><title>Item v"+num+"</title><link>http://localhost/"+num+"</link><description>Test item</description></item>"
+		"</channel></rss>\n";
+	}
+
+	QString title(){
+	  if(reader==0){ return ""; }
+	  return reader->dataForID(url).title;
+	}
+
+	void result(QString name, bool ok, QString info){
+	  qDebug() << (ok ? "PASS:" : "FAIL:") << name << info;
+	  if(!ok){ failures++; }
+	}
+
+	void nextStep(){
+	  step++;
+	  waited = 0;
+	  if(step==1){
+	    reader = new RSSReader(this, "rsscheck/");
+	    reader->addUrls(QStringList() << url);
+	  }else if(step==2){
+	    reader->syncNow(); //still fresh - should be a conditional request
+	  }else if(step==3){
+	    //New session: the feed should come from the disk cache without a request
+	    delete reader;
+	    reader = new RSSReader(this, "rsscheck/");
+	    reader->addUrls(QStringList() << url);
+	  }else if(step==4){
+	    version = 2;
+	    reader->syncNow();
+	  }else{
+	    poll->stop();
+	    qDebug() << (failures==0 ? "All checks passed" : "Checks failed:") << failures;
+	    QCoreApplication::exit(failures==0 ? 0 : 1);
+	  }
+	}
+
+private slots:
+	void newConnection(){
+	  while(server->hasPendingConnections()){
+	    QTcpSocket *sock = server->nextPendingConnection();
+	    connect(sock, SIGNAL(readyRead()), this, SLOT(readRequest()) );
+	    connect(sock, SIGNAL(disconnected()), sock, SLOT(deleteLater()) );
+	    requests.insert(sock, QByteArray());
+	  }
+	}
+
+	void readRequest(){
+	  QTcpSocket *sock = static_cast<QTcpSocket*>(sender());
+	  requests[sock].append(sock->readAll());
+	  if(!requests[sock].contains("\r\n\r\n")){ return; } //headers not complete yet
+	  QList<QByteArray> lines = requests.take(sock).split('\n');
+	  lastETag.clear(); lastSince.clear();
+	  for(int i=1; i<lines.length(); i++){
+	    QByteArray name = lines[i].left(lines[i].indexOf(':')).trimmed().toLower();
+	    QByteArray val = lines[i].mid(lines[i].indexOf(':')+1).trimmed();
+	    if(name=="if-none-match"){ lastETag = val; }
+	    else if(name=="if-modified-since"){ lastSince = val; }
+	  }
+	  //If-None-Match wins over If-Modified-Since when both are given
+	  bool same = lastETag.isEmpty() ? (lastSince==lastModified()) : (lastETag==etag());
+	  QByteArray reply, body;
+	  if(same){
+	    reply = "HTTP/1.1 304 Not Modified\r\n";
+	    notmodified++;
+	  }else{
+	    body = feed();
+	    reply = "HTTP/1.1 200 OK\r\nContent-Type: application/rss+xml\r\nContent-Length: "+QByteArray::number(body.size())+"\r\n";
+	    full++;
+	  }
+	  reply += "ETag: "+etag()+"\r\nLast-Modified: "+lastModified()+"\r\nCache-Control: max-age=60\r\nConnection: close\r\n\r\n";
+	  sock->write(reply+body);
+	  sock->disconnectFromHost();
+	}
+
+	void checkStep(){
+	  waited += CHECK_POLL;
+	  bool timeout = (waited>=CHECK_TIMEOUT);
+	  QString stats = QString("(server: %1 full, %2 not modified)").arg(QString::number(full), QString::number(notmodified));
+	  if(step==1){
+	    if(title()!="Feed v1" && !timeout){ return; }
+	    result("Initial download", title()=="Feed v1" && full==1 && notmodified==0, stats);
+	  }else if(step==2){
+	    if(full+notmodified<2 && !timeout){ return; }
+	    if(waited<5*CHECK_POLL){ return; } //give the reader time to handle the reply
+	    result("Conditional request sent", lastETag==etag() && lastSince==lastModified(), "If-None-Match: "+lastETag+" If-Modified-Since: "+lastSince);
+	    result("304 reply kept the feed", title()=="Feed v1" && full==1 && notmodified==1, stats);
+	  }else if(step==3){
+	    if(title()!="Feed v1" && !timeout){ return; }
+	    if(waited<5*CHECK_POLL){ return; } //make sure no request follows the cached copy
+	    result("Loaded from the disk cache", title()=="Feed v1" && full+notmodified==2, stats);
+	  }else if(step==4){
+	    if(title()!="Feed v2" && !timeout){ return; }
+	    result("Changed feed downloaded", title()=="Feed v2" && full==2, stats);
+	  }
+	  nextStep();
+	}
+
+public:
+	RSSCheck() : QObject(){
+	  reader = 0;
+	  version = 1;
+	  step = waited = failures = 0;
+	  full = notmodified = 0;
+	  server = new QTcpServer(this);
+	  connect(server, SIGNAL(newConnection()), this, SLOT(newConnection()) );
+	  poll = new QTimer(this);
+	    poll->setInterval(CHECK_POLL);
+	  connect(poll, SIGNAL(timeout()), this, SLOT(checkStep()) );
+	}
+	~RSSCheck(){}
+
+	bool start(){
+	  if(!server->listen(QHostAddress::LocalHost)){ qDebug() << "Could not start the HTTP server:" << server->errorString(); return false; }
+	  url = "http://127.0.0.1:"+QString::number(server->serverPort())+"/feed.xml";
+	  qDebug() << "Serving the test feed at:" << url;
+	  nextStep();
+	  poll->start();
+	  return true;
+	}
+};
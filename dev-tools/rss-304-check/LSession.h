@@ -0,0 +1,36 @@
+//===========================================
+//  Lumina-DE source code
+//  Copyright (c) 2016, Ken Moore
+//  Available under the 3-clause BSD license
+//  See the LICENSE file for full details
+//===========================================
+//  Stand-in for the desktop session: just the plugin settings the RSS reader uses
+//  (defaults only - nothing is ever written)
+//===========================================
+#ifndef _LUMINA_DEVTOOLS_RSS_CHECK_SESSION_H
+#define _LUMINA_DEVTOOLS_RSS_CHECK_SESSION_H
+
+#include <QCoreApplication>
+#include <QSettings>
+#include <QDir>
+#include <QImage>
+#include <QPixmap>
+#include <QDebug>
+
+class LSession{
+public:
+	static LSession* handle(){
+	  static LSession *session = 0;
+	  if(session==0){ session = new LSession(); }
+	  return session;
+	}
+	QSettings* DesktopPluginSettings(){ return settings; }
+
+private:
+	QSettings *settings;
+	LSession(){
+	  settings = new QSettings(QDir::tempPath()+"/rss-304-check-"+QString::number(QCoreApplication::applicationPid())+".conf", QSettings::IniFormat);
+	}
+};
+
+#endif
@@ -0,0 +1,18 @@
+#include <QApplication>
+#include <QTemporaryDir>
+#include <QDebug>
+
+#include "Check.h"
+
+#include <stdlib.h>
+
+int  main(int argc, char *argv[]) {
+   //Use an empty cache directory (the user cache is never touched)
+   QTemporaryDir tmpdir;
+   if(!tmpdir.isValid()){ qDebug() << "Could not create a temporary directory"; return 1; }
+   setenv("XDG_CACHE_HOME", tmpdir.path().toLocal8Bit().constData(), 1);
+   QApplication a(argc, argv);
+   RSSCheck check;
+   if(!check.start()){ return 1; }
+   return  a.exec();
+}
@@ -0,0 +1,23 @@
+# Check of the RSS reader conditional requests against a local HTTP server (ETag/Last-Modified, 304 replies, disk cache)
+# Usage: rss-304-check
+
+QT += core gui widgets network concurrent
+
+TEMPLATE = app
+TARGET = rss-304-check
+target.path = $${PWD}
+
+RSS = ../../src-qt5/core/lumina-desktop/desktop-plugins/rssreader
+
+#LTimerService (used by the reader for the sync checks)
+include(../../src-qt5/core/libLumina/LUtils.pri)
+
+#Note: This directory comes first so the stand-in LSession.h gets used
+INCLUDEPATH = $${PWD} $${RSS} ../../src-qt5/core/libLumina $${INCLUDEPATH}
+
+SOURCES = main.cpp \
+		$${RSS}/RSSObjects.cpp
+
+HEADERS = Check.h \
+		LSession.h \
+		$${RSS}/RSSObjects.h
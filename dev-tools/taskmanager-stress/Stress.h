@@ -0,0 +1,116 @@
+//===========================================
+//  Lumina-DE source code
+//  Copyright (c) 2016, Ken Moore
+//  Available under the 3-clause BSD license
+//  See the LICENSE file for full details
+//===========================================
+//  Opens a number of windows and keeps changing their titles at a fixed rate,
+//   then reports how much CPU time lumina-desktop spent on the updates
+//   (the CPU time of an idle period of the same length is subtracted)
+//===========================================
+#include <QApplication>
+#include <QWidget>
+#include <QTimer>
+#include <QFile>
+#include <QProcess>
+#include <QDebug>
+
+#include <unistd.h>
+
+#define STRESS_TICK 10 //ms between batches of title changes
+
+class TitleStress : public QObject{
+	Q_OBJECT
+private:
+	QList<QWidget*> windows;
+	QTimer *timer;
+	QString pid;
+	int rate, seconds, stage, next, sent, ticks;
+	double cpu, idle;
+
+	//CPU time (user+system) used by the desktop process so far
+	double cpuSeconds(){
+	  QFile file("/proc/"+pid+"/stat");
+	  if(file.open(QIODevice::ReadOnly)){
+	    //Linux: utime and stime are the 12th and 13th fields after the command name
+	    QStringList info = QString(file.readAll()).section(")",-1).split(" ", QString::SkipEmptyParts);
+	    file.close();
+	    if(info.length()>12){ return (info[11].toDouble()+info[12].toDouble()) / sysconf(_SC_CLK_TCK); }
+	  }
+	  //Other systems: [[dd-]hh:]mm:ss.cc from ps
+	  QProcess proc;
+	  proc.start("ps", QStringList() << "-o" << "time=" << "-p" << pid);
+	  proc.waitForFinished();
+	  QString time = QString(proc.readAllStandardOutput()).trimmed();
+	  double secs = 0;
+	  if(time.contains("-")){ secs = time.section("-",0,0).toDouble()*86400; time = time.section("-",1,-1); }
+	  QStringList parts = time.split(":");
+	  for(int i=0; i<parts.length(); i++){ secs = (secs*60) + parts[i].toDouble(); }
+	  return secs;
+	}
+
+	void quit(int ret){
+	  for(int i=0; i<windows.length(); i++){ windows[i]->deleteLater(); }
+	  QCoreApplication::exit(ret);
+	}
+
+private slots:
+	void nextStage(){
+	  stage++;
+	  if(stage==1){
+	    //Windows are open and listed: measure an idle period first
+	    cpu = cpuSeconds();
+	    QTimer::singleShot(seconds*1000, this, SLOT(nextStage()) );
+	  }else if(stage==2){
+	    idle = cpuSeconds() - cpu;
+	    qDebug() << "Idle desktop CPU time (ms):" << (int) (idle*1000);
+	    cpu = cpuSeconds();
+	    timer->start();
+	    QTimer::singleShot(seconds*1000, this, SLOT(nextStage()) );
+	  }else{
+	    timer->stop();
+	    QTimer::singleShot(1000, this, SLOT(finished()) ); //let the desktop catch up with the last changes
+	  }
+	}
+
+	void changeTitles(){
+	  ticks++;
+	  //Keep the overall rate exact (the number per tick does not need to be a whole number)
+	  int total = (qint64) rate * ticks * STRESS_TICK / 1000;
+	  for( ; sent<total; sent++){
+	    windows[next]->setWindowTitle( QString("Stress %1 - %2").arg(QString::number(next), QString::number(sent)) );
+	    next = (next+1) % windows.length();
+	  }
+	}
+
+	void finished(){
+	  double used = cpuSeconds() - cpu - (idle*(seconds+1)/seconds); //one extra second was waited
+	  qDebug() << "Title changes sent:" << sent << "in" << seconds << "seconds";
+	  qDebug() << "Desktop CPU time for the updates (ms):" << (int) (used*1000);
+	  if(sent>0){ qDebug() << "Cost per title change (us):" << (int) (used*1000000/sent); }
+	  quit(0);
+	}
+
+public:
+	TitleStress(int num, int persec, int secs, QString desktop) : QObject(){
+	  rate = persec; seconds = secs; pid = desktop;
+	  stage = next = sent = ticks = 0;
+	  cpu = idle = 0;
+	  timer = new QTimer(this);
+	    timer->setInterval(STRESS_TICK);
+	  connect(timer, SIGNAL(timeout()), this, SLOT(changeTitles()) );
+	  for(int i=0; i<num; i++){
+	    QWidget *win = new QWidget();
+	      win->setWindowTitle( QString("Stress %1").arg(QString::number(i)) );
+	      win->resize(200,100);
+	    windows << win;
+	  }
+	}
+	~TitleStress(){}
+
+	void start(){
+	  for(int i=0; i<windows.length(); i++){ windows[i]->show(); }
+	  qDebug() << "Opened" << windows.length() << "windows - measuring lumina-desktop PID" << pid;
+	  QTimer::singleShot(3000, this, SLOT(nextStage()) ); //give the task manager time to list them all
+	}
+};
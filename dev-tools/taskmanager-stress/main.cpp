@@ -0,0 +1,28 @@
+#include <QApplication>
+#include <QProcess>
+#include <QDebug>
+
+#include "Stress.h"
+
+int  main(int argc, char *argv[]) {
+
+   QApplication a(argc, argv);
+   int windows = (argc>1) ? QString(argv[1]).toInt() : 20;
+   int rate = (argc>2) ? QString(argv[2]).toInt() : 500;
+   int seconds = (argc>3) ? QString(argv[3]).toInt() : 10;
+   QString pid = (argc>4) ? QString(argv[4]) : "";
+   if(windows<1 || rate<1 || seconds<1){
+     qDebug() << "Usage: taskmanager-stress [windows] [title changes per second] [seconds] [desktop PID]";
+     return 1;
+   }
+   if(pid.isEmpty()){
+     QProcess proc;
+     proc.start("pgrep", QStringList() << "-x" << "lumina-desktop");
+     proc.waitForFinished();
+     pid = QString(proc.readAllStandardOutput()).section("\n",0,0).trimmed();
+   }
+   if(pid.isEmpty()){ qDebug() << "Could not find a running lumina-desktop process"; return 1; }
+   TitleStress stress(windows, rate, seconds, pid);
+   stress.start();
+   return  a.exec();
+}
@@ -0,0 +1,13 @@
+# Stress test for the lumina-desktop task manager (window title changes)
+# Usage: taskmanager-stress [windows] [title changes per second] [seconds] [desktop PID]
+# Note: Run it within a Lumina session with a task manager panel plugin
+
+QT += core gui widgets
+
+TEMPLATE = app
+TARGET = taskmanager-stress
+target.path = $${PWD}
+
+SOURCES = main.cpp
+
+HEADERS = Stress.h
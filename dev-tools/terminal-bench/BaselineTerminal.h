@@ -0,0 +1,37 @@
+//===========================================
+//  Lumina-DE source code
+//  Copyright (c) 2015, Ken Moore
+//  Available under the 3-clause BSD license
+//  See the LICENSE file for full details
+//===========================================
+//  The old (QTextEdit-based) lumina-terminal output handling - used as the baseline
+//===========================================
+#ifndef _LUMINA_TERMINAL_BENCH_BASELINE_H
+#define _LUMINA_TERMINAL_BENCH_BASELINE_H
+
+#include <QTextEdit>
+#include <QTextCursor>
+#include <QTextCharFormat>
+
+class BaselineTerminal : public QTextEdit{
+public:
+	BaselineTerminal(QWidget *parent = 0);
+	~BaselineTerminal();
+
+	void applyData(QByteArray data); //overall data parsing (one TTY read)
+
+private:
+	QTextCharFormat DEFFMT, CFMT; //default/current text format
+	QTextCursor selCursor, lastCursor;
+
+	//Incoming Data parsing
+	void InsertText(QString);
+	void applyANSI(QByteArray code); //individual code application
+	void applyANSIColor(int code); //Add the designated color code to the  CFMT structure
+
+	//Special incoming data flags
+	int startrow, endrow; //indexes for the first/last row ("\x1b[A;Br" CC)
+	bool altkeypad;
+};
+
+#endif
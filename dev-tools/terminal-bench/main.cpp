@@ -0,0 +1,110 @@
+//===========================================
+//  Lumina-DE source code
+//  Copyright (c) 2016, Ken Moore
+//  Available under the 3-clause BSD license
+//  See the LICENSE file for full details
+//===========================================
+//  Feeds terminal output through the lumina-terminal screen model in chunks of
+//   different sizes (64 bytes was the old TTY read size) and reports the MB/s
+//  The same data is also fed through a copy of the old QTextEdit-based widget
+//   (BaselineTerminal) so both numbers can be compared directly
+//  The generated output mixes plain text, colors (SGR), cursor movement,
+//   erase codes, line drawing and wide (CJK) characters, like a build log or "ls --color"
+//===========================================
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QBitArray>
+#include <QTextDocument>
+#include <QDebug>
+
+#include "TerminalScreen.h"
+#include "BaselineTerminal.h"
+
+//The old widget prints a debug line for every code it does not know - do not time the console output
+static void dropMessages(QtMsgType, const QMessageLogContext&, const QString&){}
+
+static QByteArray generateOutput(int mb){
+  QByteArray out;
+  out.reserve(mb*1024*1024 + 1024);
+  QByteArray cjk("\xe6\x96\x87\xe4\xbb\xb6 \xe7\x9b\xae\xe5\xbd\x95"); //wide characters (UTF-8)
+  for(int i=0; out.size() < mb*1024*1024; i++){
+    QByteArray num = QByteArray::number(i);
+    switch(i%8){
+      case 0: //Compiler line
+        out += "g++ -c -pipe -O2 -Wall -W -fPIC -DQT_CORE_LIB -I. -o obj/file"+num+".o src/file"+num+".cpp\r\n";
+        break;
+      case 1: //Colored warning
+        out += "\x1b[01m\x1b[Ksrc/file"+num+".cpp:12:5:\x1b[m\x1b[K \x1b[01;35m\x1b[Kwarning: \x1b[m\x1b[Kunused variable\r\n";
+        break;
+      case 2: //"ls --color" style listing
+        out += "\x1b[0m\x1b[01;34mdir"+num+"\x1b[0m  \x1b[01;32mrun"+num+".sh\x1b[0m  file"+num+".txt  \x1b[38;5;208mimage.png\x1b[0m\r\n";
+        break;
+      case 3: //Progress bar redrawn in place
+        out += "\r\x1b[K["+QByteArray(i%40, '#')+QByteArray(40-(i%40), ' ')+"] "+num+"%";
+        out += "\x1b[1A\x1b[2C\x1b[1B\r\n";
+        break;
+      case 4: //Wide characters
+        out += cjk+" "+num+" "+cjk+"\r\n";
+        break;
+      case 5: //Line drawing and direct colors
+        out += "\x1b(0lqqqqqqqqk\x1b(B \x1b[38;2;255;128;0mtruecolor\x1b[0m \x1b[48;5;22m"+num+"\x1b[49m\r\n";
+        break;
+      case 6: //Tabs and an erase
+        out += "col1\tcol2\tcol3\t"+num+"\x1b[0K\r\n";
+        break;
+      default: //Plain text
+        out += "The quick brown fox jumps over the lazy dog "+num+"\r\n";
+    }
+  }
+  return out;
+}
+
+int  main(int argc, char *argv[]) {
+
+   QApplication a(argc, argv); //the baseline needs a widget (QT_QPA_PLATFORM=offscreen works without a display)
+   QByteArray data;
+   QString arg = (argc>1) ? QString(argv[1]) : "5";
+   bool isnum = false;
+   int mb = arg.toInt(&isnum);
+   if(isnum && mb>0){
+     data = generateOutput(mb);
+   }else{
+     QFile file(arg);
+     if(!file.open(QIODevice::ReadOnly)){
+       qDebug() << "Usage: terminal-bench [MB of generated output | file with captured output]";
+       return 1;
+     }
+     data = file.readAll();
+     file.close();
+   }
+   qDebug() << "Output size:" << data.size() << "bytes";
+
+   QList<int> chunks; chunks << 64 << 4096 << 65536 << 1048576;
+   QElapsedTimer timer;
+   for(int c=0; c<chunks.length(); c++){
+     TerminalScreen screen(80, 24, 10000);
+     int rows = 0;
+     timer.start();
+     for(int i=0; i<data.size(); i+=chunks[c]){
+       screen.parse( QByteArray::fromRawData(data.constData()+i, qMin(chunks[c], data.size()-i)) );
+       rows += screen.takeDirty().count(true); //what the widget would repaint after each read
+     }
+     qint64 ms = qMax((qint64) 1, timer.elapsed());
+     qDebug() << QString("Chunks of %1 bytes: %2 MB/s").arg(chunks[c], 8).arg( (data.size()/1048576.0)/(ms/1000.0), 0, 'f', 1)
+	<< "(" << ms << "ms," << rows << "dirty rows," << screen.historyCount() << "history lines )";
+     //Same data through the old QTextEdit widget
+     BaselineTerminal old;
+     old.resize(old.fontMetrics().width("W")*80, old.fontMetrics().height()*24);
+     QtMessageHandler handler = qInstallMessageHandler(dropMessages);
+     timer.start();
+     for(int i=0; i<data.size(); i+=chunks[c]){
+       old.applyData( QByteArray::fromRawData(data.constData()+i, qMin(chunks[c], data.size()-i)) );
+     }
+     qint64 oldms = qMax((qint64) 1, timer.elapsed());
+     qInstallMessageHandler(handler);
+     qDebug() << QString("      baseline (QTextEdit): %1 MB/s").arg( (data.size()/1048576.0)/(oldms/1000.0), 0, 'f', 1)
+	<< "(" << oldms << "ms," << old.document()->blockCount() << "lines," << QString::number(oldms/(double) ms, 'f', 1)+"x the time )";
+   }
+   return 0;
+}
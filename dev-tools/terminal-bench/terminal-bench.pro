@@ -0,0 +1,20 @@
+# Throughput benchmark for the lumina-terminal screen model (VT parser + cell grid)
+#  compared against the old QTextEdit-based output handling (BaselineTerminal)
+# Usage: terminal-bench [MB of generated output | file with captured output]
+
+QT += core gui widgets
+
+TEMPLATE = app
+TARGET = terminal-bench
+target.path = $${PWD}
+
+TERM = ../../src-qt5/desktop-utils/lumina-terminal
+
+INCLUDEPATH += $${TERM}
+
+SOURCES = main.cpp \
+		BaselineTerminal.cpp \
+		$${TERM}/TerminalScreen.cpp
+
+HEADERS = BaselineTerminal.h \
+		$${TERM}/TerminalScreen.h
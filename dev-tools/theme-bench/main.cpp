@@ -0,0 +1,83 @@
+//===========================================
+//  Lumina-DE source code
+//  Copyright (c) 2016, Ken Moore
+//  Available under the 3-clause BSD license
+//  See the LICENSE file for full details
+//===========================================
+//  Times the theme startup work done by every Lumina process:
+//   assembling the stylesheet from scratch, loading it from the disk cache,
+//   applying it, and constructing the theme engine
+//  Note: A temporary cache directory is used (the user cache is never touched)
+//===========================================
+#include <QApplication>
+#include <QTemporaryDir>
+#include <QElapsedTimer>
+#include <QDir>
+#include <QDebug>
+
+#include <LuminaThemes.h>
+
+#include <stdlib.h>
+
+static void report(QString stage, qint64 nsecs, int count){
+  qDebug() << QString("%1: %2 us per call").arg(stage, -22).arg( (nsecs/count)/1000.0, 0, 'f', 1) << "(" << count << "calls )";
+}
+
+int  main(int argc, char *argv[]) {
+   QTemporaryDir tmpdir;
+   if(!tmpdir.isValid()){ qDebug() << "Could not create a temporary directory"; return 1; }
+   setenv("XDG_CACHE_HOME", tmpdir.path().toLocal8Bit().constData(), 1); //before anything reads it
+   QApplication a(argc, argv);
+   int count = 20;
+   if(argc>1){ count = QString(argv[1]).toInt(); }
+   if(count<1){ qDebug() << "Usage: theme-bench [iterations]"; return 1; }
+
+   QStringList current = LTHEME::currentSettings(); //[theme path, colorspath, iconsname, font, fontsize]
+   qDebug() << "Theme:" << current[0];
+   qDebug() << "Colors:" << current[1];
+   QElapsedTimer timer;
+   QString style;
+
+   //Cold: nothing cached (every run re-reads the theme, colors and inherited themes)
+   qint64 total = 0;
+   for(int i=0; i<count; i++){
+     QDir(tmpdir.path()+"/lumina-desktop").removeRecursively();
+     timer.start();
+     style = LTHEME::assembleStyleSheet(current[0], current[1], current[3], current[4]);
+     total += timer.nsecsElapsed();
+   }
+   if(style.isEmpty()){ qDebug() << "Empty stylesheet (theme files missing?)"; return 1; }
+   report("Assemble (no cache)", total, count);
+   qDebug() << "Stylesheet size:" << style.length() << "characters";
+
+   //Warm: loaded from the cache file written by the last run above
+   total = 0;
+   for(int i=0; i<count; i++){
+     timer.start();
+     QString cached = LTHEME::assembleStyleSheet(current[0], current[1], current[3], current[4]);
+     total += timer.nsecsElapsed();
+     if(cached!=style){ qDebug() << "Cached stylesheet does not match the assembled one"; return 1; }
+   }
+   report("Assemble (cached)", total, count);
+
+   //Applying it application-wide (what lumina-desktop does with the result)
+   total = 0;
+   for(int i=0; i<count; i++){
+     a.setStyleSheet("");
+     timer.start();
+     a.setStyleSheet(style);
+     total += timer.nsecsElapsed();
+   }
+   report("Apply stylesheet", total, count);
+
+   //The whole engine startup (settings, font/icons, file watchers)
+   total = 0;
+   for(int i=0; i<count; i++){
+     timer.start();
+     LuminaThemeEngine *engine = new LuminaThemeEngine(&a);
+     total += timer.nsecsElapsed();
+     delete engine;
+   }
+   report("Theme engine startup", total, count);
+   return 0;
+}
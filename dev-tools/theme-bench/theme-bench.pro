@@ -0,0 +1,15 @@
+# Benchmark for the theme engine startup (stylesheet assembly with and without the disk cache)
+# Usage: theme-bench [iterations]
+
+QT += core gui widgets
+
+TEMPLATE = app
+TARGET = theme-bench
+target.path = $${PWD}
+
+#Same libLumina classes as every Lumina utility uses for the theme
+include(../../src-qt5/core/libLumina/LuminaThemes.pri)
+
+INCLUDEPATH += ../../src-qt5/core/libLumina
+
+SOURCES = main.cpp
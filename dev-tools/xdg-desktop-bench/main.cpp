@@ -0,0 +1,77 @@
+//===========================================
+//  Lumina-DE source code
+//  Copyright (c) 2016, Ken Moore
+//  Available under the 3-clause BSD license
+//  See the LICENSE file for full details
+//===========================================
+//  Times the application list startup done by every Lumina process which uses it:
+//   cold (every *.desktop file parsed), warm (loaded from the disk cache),
+//   and a re-check of an already loaded list
+//  Note: A temporary cache directory is used (the user cache is never touched)
+//===========================================
+#include <QApplication>
+#include <QTemporaryDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QDebug>
+
+#include <LuminaXDG.h>
+
+#include <stdlib.h>
+
+static void report(QString stage, qint64 nsecs, int count){
+  qDebug() << QString("%1: %2 ms per run").arg(stage, -18).arg( (nsecs/count)/1000000.0, 0, 'f', 2) << "(" << count << "runs )";
+}
+
+int  main(int argc, char *argv[]) {
+   QTemporaryDir tmpdir;
+   if(!tmpdir.isValid()){ qDebug() << "Could not create a temporary directory"; return 1; }
+   setenv("XDG_CACHE_HOME", tmpdir.path().toLocal8Bit().constData(), 1); //before anything reads it
+   QApplication a(argc, argv);
+   int count = 10;
+   if(argc>1){ count = QString(argv[1]).toInt(); }
+   if(count<1){ qDebug() << "Usage: xdg-desktop-bench [iterations]"; return 1; }
+   QString cachefile = tmpdir.path()+"/lumina-desktop/desktopfiles.cache";
+   QElapsedTimer timer;
+   int found = 0;
+
+   //Cold: no cache file (every *.desktop file gets parsed)
+   qint64 total = 0;
+   for(int i=0; i<count; i++){
+     QFile::remove(cachefile);
+     XDGDesktopList *list = new XDGDesktopList();
+     timer.start();
+     list->updateList();
+     total += timer.nsecsElapsed();
+     found = list->files.count();
+     delete list;
+   }
+   report("Cold start", total, count);
+   qDebug() << "Applications:" << found << "Cache size:" << QFileInfo(cachefile).size() << "bytes";
+
+   //Warm: the cache file from the last cold run gets loaded
+   total = 0;
+   for(int i=0; i<count; i++){
+     XDGDesktopList *list = new XDGDesktopList();
+     timer.start();
+     list->updateList();
+     total += timer.nsecsElapsed();
+     if(list->files.count()!=found){ qDebug() << "Cached list does not match:" << list->files.count() << "apps"; }
+     delete list;
+   }
+   report("Warm start", total, count);
+
+   //Re-check of a loaded list (what the directory watcher/sync timer runs)
+   XDGDesktopList *list = new XDGDesktopList();
+   list->updateList();
+   total = 0;
+   for(int i=0; i<count; i++){
+     timer.start();
+     list->updateList();
+     total += timer.nsecsElapsed();
+   }
+   report("Re-check", total, count);
+   delete list;
+   return 0;
+}
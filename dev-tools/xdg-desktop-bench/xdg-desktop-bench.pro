@@ -0,0 +1,15 @@
+# Benchmark for loading the list of applications (XDGDesktopList) with and without the disk cache
+# Usage: xdg-desktop-bench [iterations]
+
+QT += core gui widgets
+
+TEMPLATE = app
+TARGET = xdg-desktop-bench
+target.path = $${PWD}
+
+#Same libLumina classes as the desktop/lumina-open/lumina-search use for the app list
+include(../../src-qt5/core/libLumina/LuminaXDG.pri)
+
+INCLUDEPATH += ../../src-qt5/core/libLumina
+
+SOURCES = main.cpp
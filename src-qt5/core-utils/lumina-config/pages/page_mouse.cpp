@@ -10,13 +10,17 @@
 
 #include <QSpinBox>
 #include <QDoubleSpinBox>
+#include <QtConcurrent>
 
 //==========
 //    PUBLIC
 //==========
 page_mouse::page_mouse(QWidget *parent) : PageWidget(parent), ui(new Ui::page_mouse()){
   ui->setupUi(this);
-  devices = LInput::listDevices();
+  //Reading the device properties runs xinput - do that in the background
+  loader = new QFutureWatcher< QList<LInputDevice*> >(this);
+  connect(loader, SIGNAL(finished()), this, SLOT(devicesLoaded()) );
+  loader->setFuture( QtConcurrent::run(&LInput::listDevices) );
    //DEBUG Code
     /*qDebug() << "List Devices:";
     for(int i=0; i<devices.length(); i++){
@@ -33,11 +37,15 @@ page_mouse::page_mouse(QWidget *parent) : PageWidget(parent), ui(new Ui::page_mo
         }
       }
     }*/
-  generateUI();
 }
 
 page_mouse::~page_mouse(){
-  for(int i=0; i<devices.length(); i++){ ::free(devices[i]); }
+  if(devices.isEmpty()){
+    //Page closed before the devices were loaded - make sure these get cleaned up too
+    loader->waitForFinished();
+    devices = loader->result();
+  }
+  for(int i=0; i<devices.length(); i++){ delete devices[i]; }
 }
 
 //================
@@ -100,6 +108,21 @@ void page_mouse::generateUI(){
   }
 }
 
+QTreeWidgetItem* page_mouse::findPropertyItem(QString id){
+  for(int t=0; t<ui->tabWidget->count(); t++){
+    QTreeWidget *tree = static_cast<QTreeWidget*>( ui->tabWidget->widget(t) );
+    for(int i=0; i<tree->topLevelItemCount(); i++){
+      QTreeWidgetItem *top = tree->topLevelItem(i);
+      for(int c=0; c<top->childCount(); c++){
+        QTreeWidgetItem *it = top->child(c);
+        QWidget *box = tree->itemWidget(it, 1);
+        if(it->whatsThis(1).section(":",1,-1)==id || (box!=0 && box->whatsThis().section(":",1,-1)==id) ){ return it; }
+      }
+    }
+  }
+  return 0;
+}
+
 void page_mouse::populateDeviceTree(QTreeWidget *tree, LInputDevice *device){
  QTreeWidgetItem *top = new QTreeWidgetItem(tree);
   if(device->isExtension()){ 
@@ -166,6 +189,14 @@ void page_mouse::populateDeviceItemValue(QTreeWidget *tree, QTreeWidgetItem *it,
 //=================
 //    PRIVATE SLOTS
 //=================
+void page_mouse::devicesLoaded(){
+  devices = loader->result();
+  for(int i=0; i<devices.length(); i++){
+    connect(devices[i], SIGNAL(propertySet(int, bool)), this, SLOT(propertySet(int, bool)) );
+  }
+  generateUI();
+}
+
 void page_mouse::valueChanged(){
   //Now get the currently focused widget
    QWidget *foc = this->focusWidget();
@@ -182,6 +213,7 @@ void page_mouse::valueChanged(){
   for(int i=0; i<devices.length(); i++){
     if(devices[i]->devNumber() == dev){
       bool ok = devices[i]->setPropertyValue(prop, value);
+      //Note: a failure from xinput itself gets flagged later (propertySet())
       if(ok){ foc->setStyleSheet(""); }
       else{ foc->setStyleSheet("background: red"); }
       //qDebug() << " - Changed property:" << (ok ? "success" : "failure");
@@ -209,9 +241,28 @@ void page_mouse::itemClicked(QTreeWidgetItem *it, int col){
         bool ok = devices[i]->setPropertyValue(prop, value);
         //if(ok){ foc->setStyleSheet(""); }
         //else{ foc->setStyleSheet("background: red"); }
-        qDebug() << " - Changed property:" << (ok ? "success" : "failure");
+        qDebug() << " - Changed property:" << (ok ? "started" : "failure");
       }
       break;
     }
   }
 }
+
+void page_mouse::propertySet(int prop, bool ok){
+  LInputDevice *dev = static_cast<LInputDevice*>(sender());
+  QTreeWidgetItem *it = findPropertyItem(QString::number(dev->devNumber())+":"+QString::number(prop));
+  if(it==0){ return; }
+  QWidget *box = it->treeWidget()->itemWidget(it, 1);
+  if(box!=0){
+    //Spinbox - flag the failure on the widget itself
+    if(ok){ box->setStyleSheet(""); }
+    else{ box->setStyleSheet("background: red"); }
+  }else{
+    //Checkable item - flag the failure and go back to the value the device still has
+    if(ok){ it->setBackground(1, QBrush()); }
+    else{
+      it->setBackground(1, QBrush(Qt::red));
+      it->setCheckState(1, dev->getPropertyValue(prop).toInt()==1 ? Qt::Checked : Qt::Unchecked);
+    }
+  }
+}
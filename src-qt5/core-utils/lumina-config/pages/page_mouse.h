@@ -11,6 +11,7 @@
 
 #include <LInputDevice.h>
 #include <QTreeWidgetItem>
+#include <QFutureWatcher>
 
 namespace Ui{
        class page_mouse;
@@ -30,14 +31,18 @@ public slots:
 private:
        Ui::page_mouse *ui;
 	QList<LInputDevice*> devices;
+	QFutureWatcher< QList<LInputDevice*> > *loader; //devices are probed in the background (xinput)
 
 	void generateUI();
 	void populateDeviceTree(QTreeWidget *tree, LInputDevice *device);
 	void populateDeviceItemValue(QTreeWidget *tree, QTreeWidgetItem *it, QVariant value, QString id);
+	QTreeWidgetItem* findPropertyItem(QString id); //id: "<device>:<property>"
 
 private slots:
+	void devicesLoaded();
 	void valueChanged();
 	void itemClicked(QTreeWidgetItem*, int);
+	void propertySet(int prop, bool ok);
 
 };
 #endif
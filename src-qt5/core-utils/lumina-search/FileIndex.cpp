@@ -0,0 +1,296 @@
+//===========================================
+//  Lumina-DE source code
+//  Copyright (c) 2016, Ken Moore
+//  Available under the 3-clause BSD license
+//  See the LICENSE file for full details
+//===========================================
+#include "FileIndex.h"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QAtomicInt>
+#include <QVector>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <string.h>
+#include <stdlib.h>
+
+//Header: [magic (8)][created (8)][number of entries (4)][names offset (4)][lowercase names offset (4)][unused (4)]
+#define INDEX_MAGIC "LSINDEX1"
+#define HEADER_SIZE 32
+//Entry: [parent][name offset][lowercase name offset][flags] (4 bytes each)
+#define ENTRY_SIZE 4
+#define FLAG_DIR 1
+
+struct IndexChild{
+  QString name;
+  bool isdir;
+};
+
+static QAtomicInt buildstop;
+
+static bool childLessThan(const IndexChild &a, const IndexChild &b){
+  return (a.name < b.name);
+}
+
+//Read the contents of a single directory (run in the thread pool)
+static QList<IndexChild> listDir(const QString &path){
+  QList<IndexChild> out;
+  if(buildstop.load()!=0){ return out; }
+  QDirIterator it(path, QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden | QDir::System);
+  while(it.hasNext()){
+    it.next();
+    IndexChild child;
+      child.name = it.fileName();
+      child.isdir = !it.fileInfo().isSymLink() && it.fileInfo().isDir(); //never follow links (loops)
+    out << child;
+  }
+  std::sort(out.begin(), out.end(), childLessThan);
+  return out;
+}
+
+static int appendEntry(QVector<qint32> &entries, QByteArray &names, QByteArray &lower, int parent, QString name, bool isdir){
+  int num = entries.size()/ENTRY_SIZE;
+  entries << parent << names.size() << lower.size() << (isdir ? FLAG_DIR : 0);
+  names.append(name.toUtf8()); names.append('\0');
+  lower.append(name.toLower().toUtf8()); lower.append('\0');
+  return num;
+}
+
+FileIndex::FileIndex(){
+  mapped = 0;
+  base = 0;
+  size = 0;
+  valid = false;
+}
+
+FileIndex::~FileIndex(){
+  clear();
+}
+
+bool FileIndex::load(QString dir){
+  clear();
+  file.setFileName(indexFile(dir));
+  if(!file.open(QIODevice::ReadOnly)){ return false; }
+  size = file.size();
+  mapped = file.map(0, size);
+  base = (const char*) mapped;
+  valid = validate();
+  if(!valid || root()!=dir){ clear(); return false; }
+  return true;
+}
+
+void FileIndex::setData(QByteArray newdata){
+  clear();
+  data = newdata;
+  base = data.constData();
+  size = data.size();
+  valid = validate();
+  if(!valid){ clear(); }
+}
+
+void FileIndex::clear(){
+  if(mapped!=0){ file.unmap(mapped); }
+  if(file.isOpen()){ file.close(); }
+  mapped = 0;
+  data.clear();
+  base = 0;
+  size = 0;
+  valid = false;
+}
+
+bool FileIndex::isValid(){
+  return (base!=0 && valid);
+}
+
+QString FileIndex::root(){
+  if(!isValid()){ return ""; }
+  return QString::fromUtf8(name(0));
+}
+
+qint64 FileIndex::created(){
+  if(base==0){ return 0; }
+  qint64 time;
+  memcpy(&time, base+8, 8);
+  return time;
+}
+
+int FileIndex::count(){
+  if(base==0){ return 0; }
+  return header(16);
+}
+
+// === Entry information ===
+int FileIndex::parent(int num){
+  return entry(num)[0];
+}
+
+bool FileIndex::isDir(int num){
+  return ( (entry(num)[3] & FLAG_DIR) == FLAG_DIR );
+}
+
+const char* FileIndex::name(int num){
+  return (base + header(20) + entry(num)[1]);
+}
+
+const char* FileIndex::lowerName(int num){
+  return (base + header(24) + entry(num)[2]);
+}
+
+QString FileIndex::path(int num){
+  if(num<=0){ return root(); }
+  QStringList names;
+  while(num>0){
+    names.prepend( QString::fromUtf8(name(num)) );
+    num = parent(num);
+  }
+  QString prefix = root();
+  if(!prefix.endsWith("/")){ prefix.append("/"); }
+  return (prefix + names.join("/"));
+}
+
+int FileIndex::find(QString path){
+  if(!isValid()){ return -1; }
+  QString prefix = root();
+  if(path==prefix){ return 0; }
+  if(!prefix.endsWith("/")){ prefix.append("/"); }
+  if(!path.startsWith(prefix)){ return -1; }
+  QStringList dirs = path.mid(prefix.length()).split("/", QString::SkipEmptyParts);
+  int cur = 0;
+  int total = count();
+  for(int d=0; d<dirs.length() && cur>=0; d++){
+    QByteArray dirname = dirs[d].toUtf8();
+    //Entries are sorted by parent - find the first child of the current dir
+    int lo = 1, hi = total;
+    while(lo<hi){
+      int mid = (lo+hi)/2;
+      if(parent(mid)<cur){ lo = mid+1; }
+      else{ hi = mid; }
+    }
+    int next = -1;
+    for(int i=lo; i<total && parent(i)==cur; i++){
+      if( strcmp(name(i), dirname.constData())==0 ){ next = i; break; }
+    }
+    cur = next;
+  }
+  return cur;
+}
+
+QStringList FileIndex::topDirs(int max){
+  QStringList out;
+  int total = count();
+  for(int i=0; i<total && out.length()<max; i++){
+    if(isDir(i)){ out << path(i); }
+  }
+  return out;
+}
+
+// === Index creation ===
+QByteArray FileIndex::build(QString dir){
+  buildstop.store(0);
+  QVector<qint32> entries;
+  QByteArray names, lower;
+  //The root entry uses the full path of the directory
+  appendEntry(entries, names, lower, -1, dir, true);
+  QStringList paths; paths << dir;
+  QVector<int> dirs; dirs << 0;
+  while(!paths.isEmpty() && buildstop.load()==0){
+    //Read all the directories on this level at the same time
+    QList< QList<IndexChild> > found = QtConcurrent::blockingMapped< QList< QList<IndexChild> > >(paths, listDir);
+    QStringList nextpaths;
+    QVector<int> nextdirs;
+    for(int i=0; i<found.length(); i++){
+      QString prefix = paths[i].endsWith("/") ? paths[i] : paths[i]+"/";
+      for(int c=0; c<found[i].length(); c++){
+        const IndexChild &child = found[i][c];
+        int num = appendEntry(entries, names, lower, dirs[i], child.name, child.isdir);
+        //Hidden directories are not searched, and neither is "proc" (highly-recursive layout for *every* process which is running)
+        if(child.isdir && !child.name.startsWith(".") && child.name!="proc"){
+          nextpaths << prefix+child.name;
+          nextdirs << num;
+        }
+      }
+    }
+    paths = nextpaths;
+    dirs = nextdirs;
+  }
+  if(buildstop.load()!=0){ return QByteArray(); } //cancelled
+  //Now assemble the index
+  qint64 created = QDateTime::currentMSecsSinceEpoch();
+  qint32 num = entries.size()/ENTRY_SIZE;
+  qint32 namesoffset = HEADER_SIZE + entries.size()*4;
+  qint32 loweroffset = namesoffset + names.size();
+  qint32 unused = 0;
+  QByteArray out;
+    out.reserve(loweroffset + lower.size());
+    out.append(INDEX_MAGIC, 8);
+    out.append( (const char*) &created, 8);
+    out.append( (const char*) &num, 4);
+    out.append( (const char*) &namesoffset, 4);
+    out.append( (const char*) &loweroffset, 4);
+    out.append( (const char*) &unused, 4);
+    out.append( (const char*) entries.constData(), entries.size()*4);
+    out.append(names);
+    out.append(lower);
+  save(dir, out); //keep it for the next time
+  return out;
+}
+
+void FileIndex::stopBuild(){
+  buildstop.store(1);
+}
+
+QString FileIndex::indexFile(QString dir){
+  QString cache = QString(getenv("XDG_CACHE_HOME"));
+  if(cache.isEmpty()){ cache = QDir::homePath()+"/.cache"; }
+  QString hash = QCryptographicHash::hash(dir.toUtf8(), QCryptographicHash::Md5).toHex();
+  return (cache+"/lumina-desktop/search/"+hash+".index");
+}
+
+// === PRIVATE ===
+bool FileIndex::validate(){
+  if(base==0 || size<HEADER_SIZE || size>0x7FFFFFFF){ return false; }
+  if(memcmp(base, INDEX_MAGIC, 8)!=0 || base[size-1]!='\0'){ return false; }
+  qint64 entries = header(16), names = header(20), lower = header(24);
+  if( !(entries>0 && (HEADER_SIZE + entries*ENTRY_SIZE*4) <= names && names < lower && lower < size) ){ return false; }
+  if(base[lower-1]!='\0'){ return false; } //last name runs into the lowercase names
+  //Every entry needs to point inside the index (the file might be truncated or corrupt)
+  qint64 namesize = lower-names, lowersize = size-lower;
+  for(qint64 i=0; i<entries; i++){
+    const qint32 *ent = entry(i);
+    if(ent[1]<0 || ent[1]>=namesize || ent[2]<0 || ent[2]>=lowersize){ return false; }
+    //Parents always come first, and the children are grouped by parent (path() and find() depend on it)
+    if(i==0){
+      if(ent[0]!=-1){ return false; }
+    }else if(ent[0]<0 || ent[0]>=i || (i>1 && ent[0]<entry(i-1)[0]) ){ return false; }
+  }
+  return true;
+}
+
+const qint32* FileIndex::entry(int num){
+  return ( (const qint32*) (base+HEADER_SIZE) ) + (num*ENTRY_SIZE);
+}
+
+qint32 FileIndex::header(int offset){
+  qint32 val;
+  memcpy(&val, base+offset, 4);
+  return val;
+}
+
+bool FileIndex::save(QString dir, QByteArray data){
+  QString path = indexFile(dir);
+  QDir cdir;
+  //Private to the user (lists all the file names)
+  if( !cdir.mkpath(path.section("/",0,-2)) ){ return false; }
+  QFile::setPermissions(path.section("/",0,-2), QFile::ReadOwner | QFile::WriteOwner | QFile::ExeOwner);
+  QSaveFile sfile(path);
+  if(!sfile.open(QIODevice::WriteOnly)){ return false; }
+  sfile.setPermissions(QFile::ReadOwner | QFile::WriteOwner);
+  sfile.write(data);
+  return sfile.commit();
+}
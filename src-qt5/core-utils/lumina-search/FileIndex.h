@@ -0,0 +1,62 @@
+//===========================================
+//  Lumina-DE source code
+//  Copyright (c) 2016, Ken Moore
+//  Available under the 3-clause BSD license
+//  See the LICENSE file for full details
+//===========================================
+//  This is the file name index used for the file searches
+//  Layout: [header][entries][names][lowercase names]
+//  NOTE: The entries are in breadth-first order (a parent is always before its
+//    children, and all the children of a directory are stored together)
+//===========================================
+#ifndef _LUMINA_SEARCH_FILE_INDEX_H
+#define _LUMINA_SEARCH_FILE_INDEX_H
+
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QFile>
+
+class FileIndex{
+public:
+	FileIndex();
+	~FileIndex();
+
+	bool load(QString dir); //map the saved index for a directory (false if there is none)
+	void setData(QByteArray newdata); //use a newly built index
+	void clear();
+
+	bool isValid();
+	QString root(); //directory which was indexed
+	qint64 created(); //time the index was built (ms since epoch)
+	int count(); //number of entries (the root directory is entry 0)
+
+	//Entry information
+	int parent(int num);
+	bool isDir(int num);
+	const char* name(int num); //UTF-8
+	const char* lowerName(int num); //UTF-8 (lowercase - for case-insensitive matching)
+	QString path(int num);
+	int find(QString path); //entry number for the given path (-1 if not indexed)
+	QStringList topDirs(int max); //the shallowest directories in the index
+
+	//Crawl a directory and save the new index (multi-threaded - can take a while)
+	static QByteArray build(QString dir);
+	static void stopBuild(); //cancel any build which is still running
+	static QString indexFile(QString dir);
+
+private:
+	QFile file; //saved index (mapped into memory)
+	uchar *mapped;
+	QByteArray data; //newly built index
+	const char *base;
+	qint64 size;
+	bool valid; //checked once when loaded
+
+	bool validate(); //check the header and every entry (a corrupt file is never used)
+	const qint32* entry(int num);
+	qint32 header(int offset);
+	static bool save(QString dir, QByteArray data);
+};
+
+#endif
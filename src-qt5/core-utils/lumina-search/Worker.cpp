@@ -1,22 +1,39 @@
 #include "Worker.h"
 
 #include <QTimer>
+#include <QSet>
+#include <QVector>
+#include <QRegExp>
+#include <QtConcurrent>
 #include <LuminaXDG.h>
 #include <LUtils.h>
 
+#include <string.h>
+
+#define INDEX_MAXAGE 600000 //rebuild indexes older than this in the background (ms)
+
 Worker::Worker(QObject *parent) : QObject(parent){
-  //Get the list of all applications and save them in an easily-searchable form
-  XDGDesktopList APPS;
-  APPS.updateList();
-  QList<XDGDesktop*> apps = APPS.apps(false,false);
-  for(int i=0; i<apps.length(); i++){
-    applist << ":::1:::"+apps[i]->name+":::2:::"+apps[i]->genericName+":::3:::"+apps[i]->comment+":::4:::"+apps[i]->filePath;
-  }
+  //Get the list of all applications and index them for searching
+  APPS = new XDGDesktopList(this, true); //keep it in sync with the system
+  APPS->updateList();
+  appindex.update( APPS->apps(false,false) );
+  connect(APPS, SIGNAL(appsUpdated()), this, SLOT(appsChanged()) );
   stopsearch = false;
+  searchqueued = false;
+  indexer = new QFutureWatcher<QByteArray>(this);
+  watcher = new QFileSystemWatcher(this);
+  rebuildTimer = new QTimer(this);
+    rebuildTimer->setSingleShot(true);
+    rebuildTimer->setInterval(10000); //wait for things to settle down a bit first
+  connect(indexer, SIGNAL(finished()), this, SLOT(indexFinished()) );
+  connect(watcher, SIGNAL(directoryChanged(const QString&)), rebuildTimer, SLOT(start()) );
+  connect(rebuildTimer, SIGNAL(timeout()), this, SLOT(rebuildIndex()) );
 }
 
 Worker::~Worker(){
   stopsearch = true;
+  FileIndex::stopBuild();
+  indexer->waitForFinished();
 }
 
 void Worker::StartSearch(QString term, bool isApp){
@@ -34,29 +51,63 @@ void Worker::StopSearch(){
   stopsearch = true;	
 }
 
-bool Worker::searchDir(QString dirpath){
-  //This is a recursive search algorithm for scanning a directory
-  QDir dir(dirpath);
-  //First look for files that match the search term	
-  if(stopsearch){ return true; }
-  emit SearchUpdate( QString(tr("Searching: %1")).arg(dirpath.replace(QDir::homePath(),"~")) );
-  QStringList tmp;
-  if(sterm.startsWith(".")){ tmp = dir.entryList(QStringList(sterm), QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden, QDir::Name); }
-  else{ tmp = dir.entryList(QStringList(sterm), QDir::AllEntries | QDir::NoDotAndDotDot , QDir::Name); }
-  for(int i=0; i<tmp.length(); i++){
-    if(stopsearch){ return true; }
-    emit FoundItem( dir.absoluteFilePath(tmp[i]) );
+bool Worker::searchIndex(QString dir){
+  int start = index.find(dir);
+  if(start<0){ return false; } //not indexed (hidden/skipped dir)
+  emit SearchUpdate( QString(tr("Searching: %1")).arg(dir.replace(QDir::homePath(),"~")) );
+  QSet<int> skip;
+  for(int i=0; i<skipDirs.length(); i++){
+    int num = index.find(skipDirs[i]);
+    if(num>=0){ skip << num; }
+  }
+  //Case-insensitive glob match (same as the directory name filters)
+  QRegExp rx(sterm, Qt::CaseInsensitive, QRegExp::WildcardUnix);
+  bool hidden = sterm.startsWith(".");
+  //Find the longest plain-text section of the search term to quickly rule out most names
+  QStringList pieces = sterm.split(QRegExp("[\\*\\?\\[\\]]"), QString::SkipEmptyParts);
+  QString literal;
+  for(int i=0; i<pieces.length(); i++){
+    if(pieces[i].length()>literal.length()){ literal = pieces[i]; }
   }
-  if(stopsearch){ return true; }
-  //Now recursively scan the sub directories
-  tmp = dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot , QDir::Name);
-  for(int i=0; i<tmp.length(); i++){
-    if(stopsearch){ return true; }
-    if( skipDirs.contains(dir.absoluteFilePath(tmp[i])) || tmp[i]=="proc" ){ continue; } //this dir is skipped
-       //Special case - skip the "proc" directory heirarchy (highly-recursive layout for *every* process which is running)
-    if( searchDir(dir.absoluteFilePath(tmp[i])) ){ return true; }
+  bool simple = (sterm == "*"+literal+"*"); //plain text search - no need for the glob
+  QByteArray text = literal.toLower().toUtf8();
+  //Entries are in breadth-first order: only the ones after the start dir can be inside it
+  int total = index.count();
+  QVector<char> state(total, 0); //[0: outside the search dir, 1: inside, 2: skipped]
+  state[start] = 1;
+  for(int i=start+1; i<total; i++){
+    if( (i % 4096)==0 && stopsearch ){ return true; }
+    char st = state[index.parent(i)];
+    if(st==1 && index.isDir(i) && skip.contains(i)){ st = 2; }
+    state[i] = st;
+    if(st!=1){ continue; }
+    if(!text.isEmpty() && strstr(index.lowerName(i), text.constData())==0){ continue; }
+    const char *name = index.name(i);
+    if(name[0]=='.' && !hidden){ continue; }
+    if(!simple && !rx.exactMatch(QString::fromUtf8(name)) ){ continue; }
+    emit FoundItem( index.path(i) );
   }
-  return false;
+  return stopsearch;
+}
+
+QString Worker::indexRoot(QString dir){
+  //Searches within the home dir all use the same index (hidden dirs are not in it though)
+  QString home = QDir::homePath();
+  if(dir==home || (dir.startsWith(home+"/") && !dir.mid(home.length()).contains("/.")) ){ return home; }
+  return dir;
+}
+
+void Worker::buildIndex(QString dir){
+  if(indexer->isRunning()){ return; } //already working on it
+  indexer->setFuture( QtConcurrent::run(&FileIndex::build, dir) );
+}
+
+void Worker::watchIndex(){
+  QStringList watched = watcher->directories();
+  if(!watched.isEmpty()){ watcher->removePaths(watched); }
+  //Only the top of the tree - there are not enough watches available for every directory
+  QStringList dirs = index.topDirs(256);
+  if(!dirs.isEmpty()){ watcher->addPaths(dirs); }
 }
 
 void Worker::beginsearch(){
@@ -64,51 +115,57 @@ void Worker::beginsearch(){
   emit SearchUpdate( QString(tr("Starting Search: %1")).arg(sterm) );
   //Now Perform the search
   if(sapp){
-    //First try to match based on the name
-    QStringList tmp = applist.filter(":::1:::"+sterm, Qt::CaseInsensitive);
-    tmp.sort();
-    for(int i=0; i<tmp.length(); i++){
-      if(stopsearch){ return; }
-      emit FoundItem( tmp[i].section(":::4:::",1,1) );
-    }
     //Check if this is a binary name
-    if(stopsearch){ return; }
-    if(LUtils::isValidBinary(sterm)){
-      emit FoundItem(sterm);
-      return;
-    }
-    //If items found, go ahead and stop now
-    if(stopsearch){ return; }
-    if(tmp.length()<1){
-      //Now try to match based on the generic name
-      tmp = applist.filter(":::2:::"+sterm, Qt::CaseInsensitive);
-      tmp.sort();
-      for(int i=0; i<tmp.length(); i++){
-        if(stopsearch){ return; }
-        emit FoundItem( tmp[i].section(":::4:::",1,1) );
-      }
-    }
-    //If items found, go ahead and stop now
-    if(stopsearch){ return; }
-    if(tmp.length()<1){
-      //Now try to match based on anything (name/genericname/comment)
-      tmp = applist.filter(sterm, Qt::CaseInsensitive);
-      tmp.sort();
-      for(int i=0; i<tmp.length(); i++){
-        if(stopsearch){ return; }
-        emit FoundItem( tmp[i].section(":::4:::",1,1) );
-      }
+    QString bin = sterm;
+    if(LUtils::isValidBinary(bin)){ emit FoundItem(bin); }
+    //Now list the matching apps (best match first)
+    QList<XDGDesktop*> apps = appindex.search(sterm);
+    for(int i=0; i<apps.length(); i++){
+      if(stopsearch){ return; }
+      emit FoundItem( apps[i]->filePath );
     }
-    
   }else{
     //Search through the user's home directory and look for a file/dir starting with that term
     if(!sterm.contains("*")){
       sterm.prepend("*"); sterm.append("*"); //make sure it is a search glob pattern
     }
     if(startDir.isEmpty()){ startDir = QDir::homePath(); }
-    searchDir(startDir);
-    
+    QString root = indexRoot(startDir);
+    if(index.root()!=root){
+      if(index.load(root)){ watchIndex(); }
+    }
+    if(!index.isValid()){
+      //No index yet - search as soon as it is ready
+      searchqueued = true;
+      buildIndex(root);
+      emit SearchUpdate( tr("Indexing files...") );
+      return;
+    }
+    //Refresh an old index in the background (this search still uses the current one)
+    if(index.created() < QDateTime::currentMSecsSinceEpoch()-INDEX_MAXAGE){ buildIndex(root); }
+    searchIndex(startDir);
   }
   emit SearchUpdate( tr("Search Finished") );
   emit SearchDone();
 }
+
+void Worker::indexFinished(){
+  QByteArray data = indexer->result();
+  if(!data.isEmpty()){
+    index.setData(data);
+    watchIndex();
+  }
+  if(searchqueued){
+    searchqueued = false;
+    if(index.isValid() && !stopsearch){ beginsearch(); }
+    else{ emit SearchUpdate( tr("Search Finished") ); emit SearchDone(); }
+  }
+}
+
+void Worker::rebuildIndex(){
+  if(index.isValid()){ buildIndex(index.root()); }
+}
+
+void Worker::appsChanged(){
+  appindex.update( APPS->apps(false,false) ); //only the changed apps get re-indexed
+}
@@ -10,6 +10,13 @@
 #include <QObject>
 #include <QString>
 #include <QDir>
+#include <QFileSystemWatcher>
+#include <QFutureWatcher>
+#include <QTimer>
+
+#include <LuminaXDG.h>
+
+#include "FileIndex.h"
 
 
 class Worker : public QObject{
@@ -26,14 +33,28 @@ public slots:
 	void StopSearch();
 
 private:
-	QStringList applist;
+	XDGDesktopList *APPS;
+	XDGAppIndex appindex;
 	bool stopsearch;
 	QString sterm;
 	bool sapp;
-	bool searchDir(QString);
+	//File name index (built in the background)
+	FileIndex index;
+	QFutureWatcher<QByteArray> *indexer;
+	QFileSystemWatcher *watcher; //top-level dirs in the index (changes start a rebuild)
+	QTimer *rebuildTimer;
+	bool searchqueued; //file search is waiting on the index
+
+	bool searchIndex(QString dir);
+	QString indexRoot(QString dir);
+	void buildIndex(QString dir);
+	void watchIndex();
 
 private slots:
 	void beginsearch();
+	void indexFinished();
+	void rebuildIndex();
+	void appsChanged();
 	
 signals:
 	void FoundItem(QString path);
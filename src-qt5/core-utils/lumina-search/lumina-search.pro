@@ -1,7 +1,7 @@
 include("$${PWD}/../../OS-detect.pri")
 
 QT       += core gui
-greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets concurrent
 
 
 TARGET = lumina-search
@@ -19,10 +19,12 @@ include(../../core/libLumina/LuminaThemes.pri)
 SOURCES += main.cpp \
 		MainUI.cpp \
 		Worker.cpp \
+		FileIndex.cpp \
 		ConfigUI.cpp
 
 HEADERS  += MainUI.h \
 		Worker.h \
+		FileIndex.h \
 		ConfigUI.h
 
 FORMS    += MainUI.ui \
@@ -9,6 +9,7 @@
 
 #include <LuminaXDG.h>
 #include <LUtils.h>
+#include <LCommand.h>
 
 #include <QTimer>
 
@@ -78,9 +79,24 @@ ScreenInfo MainUI::currentScreenInfo(){
   return ScreenInfo();
 }
 
+void MainUI::runXrandr(QStringList opts){
+  LCommand *cmd = LCommand::run("xrandr", opts);
+  connect(cmd, SIGNAL(finished(int, QStringList)), this, SLOT(xrandrFinished()) );
+}
+
+void MainUI::xrandrFinished(){
+  QTimer::singleShot(500, this, SLOT(UpdateScreens()) );
+}
+
 void MainUI::UpdateScreens(){
-  //First probe the server for current screens
-  SCREENS = RRSettings::CurrentScreens();
+  //First probe the server for current screens (in the background)
+  LCommand *cmd = LCommand::run("xrandr", QStringList() << "-q");
+  connect(cmd, SIGNAL(finished(int, QStringList)), this, SLOT(ScreensRead(int, QStringList)) );
+}
+
+void MainUI::ScreensRead(int retcode, QStringList info){
+  if(retcode!=0){ return; } //could not read the screens - leave the current info alone
+  SCREENS = RRSettings::ParseScreens(info);
   /*QStringList info = LUtils::getCmdOutput("xrandr -q");
   ScreenInfo cscreen;
   for(int i=0; i<info.length(); i++){
@@ -219,10 +235,9 @@ void MainUI::MoveScreenLeft(){
   }
   //Now run the command
   QStringList opts = currentOpts();
-  LUtils::runCmd("xrandr", opts); 
+  runXrandr(opts);
   //Now run the command
   //LUtils::runCmd("xrandr", QStringList() << "--output" << CID << "--left-of" << LID);
-  QTimer::singleShot(500, this, SLOT(UpdateScreens()) );
 }
 
 void MainUI::MoveScreenRight(){
@@ -241,8 +256,7 @@ void MainUI::MoveScreenRight(){
   }
   //Now run the command
   QStringList opts = currentOpts();
-  LUtils::runCmd("xrandr", opts);
-  QTimer::singleShot(500, this, SLOT(UpdateScreens()) );
+  runXrandr(opts);
 }
 
 void MainUI::DeactivateScreen(QString device){
@@ -261,8 +275,7 @@ void MainUI::DeactivateScreen(QString device){
   //Now run the command
   QStringList opts = currentOpts();
   opts << "--output" << device << "--off";
-  LUtils::runCmd("xrandr", opts);
-  QTimer::singleShot(500, this, SLOT(UpdateScreens()) );
+  runXrandr(opts);
 }
 
 void MainUI::ActivateScreen(){
@@ -274,8 +287,7 @@ void MainUI::ActivateScreen(){
   QStringList opts = currentOpts();
     opts << "--output" << ID << loc << DID <<"--auto";
   //qDebug() << "Activate Options:" << opts;
-  LUtils::runCmd("xrandr", opts );
-  QTimer::singleShot(500, this, SLOT(UpdateScreens()) );
+  runXrandr(opts);
 }
 
 void MainUI::ApplyChanges(){
@@ -296,6 +308,5 @@ void MainUI::ApplyChanges(){
   }
   //Now run the command
   QStringList opts = currentOpts();
-  LUtils::runCmd("xrandr", opts);
-  QTimer::singleShot(500, this, SLOT(UpdateScreens()) );
+  runXrandr(opts);
 }
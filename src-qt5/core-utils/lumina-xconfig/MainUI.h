@@ -11,6 +11,7 @@
 #include <QRect>
 #include <QString>
 #include <QList>
+#include <QStringList>
 
 #include "ScreenSettings.h"
 
@@ -37,9 +38,12 @@ private:
 	ScreenInfo currentScreenInfo();
 
 	QStringList currentOpts();
+	void runXrandr(QStringList opts); //screens are re-read once it is finished
 
 private slots:
 	void UpdateScreens();
+	void ScreensRead(int retcode, QStringList info);
+	void xrandrFinished();
 	void ScreenSelected();
 	void MoveScreenLeft();
 	void MoveScreenRight();
@@ -100,8 +100,11 @@ void RRSettings::ApplyPrevious(){
 
 //Read the current screen config from xrandr
 QList<ScreenInfo> RRSettings::CurrentScreens(){
+  return ParseScreens( LUtils::getCmdOutput("xrandr -q") );
+}
+
+QList<ScreenInfo> RRSettings::ParseScreens(QStringList info){
   QList<ScreenInfo> SCREENS;
-  QStringList info = LUtils::getCmdOutput("xrandr -q");
   ScreenInfo cscreen;
   for(int i=0; i<info.length(); i++){
     if(info[i].contains("connected") ){
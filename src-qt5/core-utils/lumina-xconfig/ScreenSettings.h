@@ -39,6 +39,7 @@ public:
 
 	//Read the current screen config from xrandr
 	static QList<ScreenInfo> CurrentScreens(); //reads xrandr information
+	static QList<ScreenInfo> ParseScreens(QStringList info); //parse the output of "xrandr -q"
 
 	//Save the screen config for later
 	static bool SaveScreens(QList<ScreenInfo> screens);
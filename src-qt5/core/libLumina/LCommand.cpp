@@ -0,0 +1,172 @@
+//===========================================
+//  Lumina-DE source code
+//  Copyright (c) 2016, Ken Moore
+//  Available under the 3-clause BSD license
+//  See the LICENSE file for full details
+//===========================================
+#include "LCommand.h"
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QHash>
+#include <QList>
+#include <QDateTime>
+#include <QTimer>
+#include <QProcessEnvironment>
+#include <QDebug>
+
+//Saved output of a command
+struct LCommandResult{
+  QDateTime time;
+  int retcode;
+  QStringList output;
+};
+
+//Shared between all the threads which run commands
+static QMutex cmdlock;
+static QList<LCommand*> cmdqueue; //commands waiting to start
+static int cmdrunning = 0;
+static int cmdmax = 4;
+static QHash<QString, LCommandResult> cmdcache;
+
+LCommand* LCommand::run(QString cmd, QStringList args, int timeout, int cacheSecs){
+  LCommand *C = new LCommand(cmd, args, timeout, cacheSecs);
+  if(C->loadCache()){ return C; } //output already known
+  QMutexLocker lock(&cmdlock);
+  if(cmdrunning<cmdmax){
+    cmdrunning++;
+    C->haveslot = true;
+    lock.unlock();
+    C->startProcess();
+  }else{
+    cmdqueue << C; //started once another command is finished
+  }
+  return C;
+}
+
+void LCommand::setMaxRunning(int max){
+  if(max<1){ max = 1; }
+  QMutexLocker lock(&cmdlock);
+  cmdmax = max;
+}
+
+void LCommand::clearCache(){
+  QMutexLocker lock(&cmdlock);
+  cmdcache.clear();
+}
+
+void LCommand::cancel(){
+  if(done){ return; }
+  done = true;
+  cmdlock.lock();
+  cmdqueue.removeAll(this);
+  cmdlock.unlock();
+  if(proc!=0){
+    disconnect(proc, 0, this, 0);
+    if(proc->state()!=QProcess::NotRunning){ proc->kill(); }
+  }
+  releaseSlot();
+  this->deleteLater();
+}
+
+// === PRIVATE ===
+LCommand::LCommand(QString command, QStringList arguments, int time, int cache) : QObject(){
+  proc = 0;
+  cmd = command;
+  args = arguments;
+  key = cmd+"\n"+args.join("\n");
+  timeout = time;
+  cacheSecs = cache;
+  retcode = -1;
+  haveslot = timedout = done = false;
+}
+
+LCommand::~LCommand(){
+  if(proc!=0){ proc->disconnect(); }
+  releaseSlot();
+}
+
+bool LCommand::loadCache(){
+  if(cacheSecs<1){ return false; }
+  QMutexLocker lock(&cmdlock);
+  if(!cmdcache.contains(key)){ return false; }
+  LCommandResult res = cmdcache.value(key);
+  if(res.time.secsTo(QDateTime::currentDateTime()) >= cacheSecs){ cmdcache.remove(key); return false; }
+  retcode = res.retcode;
+  output = res.output;
+  QMetaObject::invokeMethod(this, "deliver", Qt::QueuedConnection); //give the caller a chance to connect first
+  return true;
+}
+
+void LCommand::releaseSlot(){
+  if(!haveslot){ return; }
+  haveslot = false;
+  QMutexLocker lock(&cmdlock);
+  cmdrunning--;
+  while(!cmdqueue.isEmpty() && cmdrunning<cmdmax){
+    LCommand *next = cmdqueue.takeFirst();
+    next->haveslot = true;
+    cmdrunning++;
+    //Start it within the thread which created it
+    QMetaObject::invokeMethod(next, "startProcess", Qt::QueuedConnection);
+  }
+}
+
+// === PRIVATE SLOTS ===
+void LCommand::startProcess(){
+  if(done){ return; }
+  //An identical command might have finished while this one was waiting
+  if(loadCache()){ releaseSlot(); return; }
+  proc = new QProcess(this);
+  QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+    env.insert("LANG", "C");
+    env.insert("LC_MESSAGES", "C");
+  proc->setProcessEnvironment(env);
+  proc->setProcessChannelMode(QProcess::MergedChannels);
+  connect(proc, SIGNAL(finished(int, QProcess::ExitStatus)), this, SLOT(procFinished()) );
+  connect(proc, SIGNAL(error(QProcess::ProcessError)), this, SLOT(procError(QProcess::ProcessError)) );
+  if(timeout>0){ QTimer::singleShot(timeout, this, SLOT(procTimeout()) ); }
+  if(args.isEmpty()){ proc->start(cmd, QIODevice::ReadOnly); }
+  else{ proc->start(cmd, args, QIODevice::ReadOnly); }
+}
+
+void LCommand::procFinished(){
+  if(done){ return; }
+  output = QString(proc->readAllStandardOutput()).split("\n");
+  if(timedout || proc->exitStatus()!=QProcess::NormalExit){ retcode = -1; }
+  else{
+    retcode = proc->exitCode();
+    if(cacheSecs>0){
+      LCommandResult res;
+        res.time = QDateTime::currentDateTime();
+        res.retcode = retcode;
+        res.output = output;
+      QMutexLocker lock(&cmdlock);
+      cmdcache.insert(key, res);
+    }
+  }
+  releaseSlot();
+  deliver();
+}
+
+void LCommand::procError(QProcess::ProcessError err){
+  //Only a failure to start means that the finished() signal from the process will never come
+  if(err!=QProcess::FailedToStart || done){ return; }
+  retcode = -1;
+  releaseSlot();
+  QMetaObject::invokeMethod(this, "deliver", Qt::QueuedConnection); //might be reported within run()
+}
+
+void LCommand::procTimeout(){
+  if(done || proc==0 || proc->state()==QProcess::NotRunning){ return; }
+  qDebug() << "Command timed out:" << cmd << args;
+  timedout = true;
+  proc->kill(); //procFinished() gets called once it is gone
+}
+
+void LCommand::deliver(){
+  if(done){ return; }
+  done = true;
+  emit finished(retcode, output);
+  this->deleteLater();
+}
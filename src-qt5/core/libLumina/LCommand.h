@@ -0,0 +1,66 @@
+//===========================================
+//  Lumina-DE source code
+//  Copyright (c) 2016, Ken Moore
+//  Available under the 3-clause BSD license
+//  See the LICENSE file for full details
+//===========================================
+//  Non-blocking replacement for LUtils::runCmd()/getCmdOutput()
+//  The command is started with QProcess in the calling thread and the result is announced with
+//    the finished() signal (always delivered later - so it is safe to connect after run() returns)
+//  Only a limited number of commands are run at the same time (the rest wait in a queue),
+//    and the output of idempotent queries can be re-used for a number of seconds
+//  Note: The LCommand object deletes itself after finished() is emitted or it is cancelled
+//  Note: The calling thread needs a running event loop (GUI thread or a QThread worker)
+//===========================================
+#ifndef _LUMINA_LIBRARY_COMMAND_H
+#define _LUMINA_LIBRARY_COMMAND_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QProcess>
+
+#define LCOMMAND_TIMEOUT 30000 //default milliseconds before a command gets killed
+
+class LCommand : public QObject{
+	Q_OBJECT
+public:
+	//Start a command in the background
+	// timeout: milliseconds before the process is killed (0: never)
+	// cacheSecs: re-use the output of the same command for this long (0: always run it)
+	static LCommand* run(QString cmd, QStringList args = QStringList(), int timeout = LCOMMAND_TIMEOUT, int cacheSecs = 0);
+
+	static void setMaxRunning(int max); //number of commands allowed to run at the same time
+	static void clearCache(); //forget all the saved command outputs
+
+	void cancel(); //stop the command (finished() will not be emitted)
+	QString command(){ return cmd; }
+	bool timedOut(){ return timedout; }
+
+private:
+	LCommand(QString command, QStringList arguments, int timeout, int cache);
+	~LCommand();
+
+	QProcess *proc;
+	QString cmd, key;
+	QStringList args, output;
+	int timeout, cacheSecs, retcode;
+	bool haveslot, timedout, done;
+
+	bool loadCache(); //use a saved output if one is still valid
+	void releaseSlot(); //let the next command in the queue start
+
+private slots:
+	void startProcess();
+	void procFinished();
+	void procError(QProcess::ProcessError);
+	void procTimeout();
+	void deliver();
+
+signals:
+	//retcode: exit code of the command (-1 if it could not be started or was killed after the timeout)
+	//output: text output of the command (one line per entry, stdout and stderr merged)
+	void finished(int retcode, QStringList output);
+};
+
+#endif
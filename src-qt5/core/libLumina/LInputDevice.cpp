@@ -10,6 +10,7 @@
 #include <QString>
 #include <QX11Info>
 #include <QDebug>
+#include <QCoreApplication>
 
 //XCB Library includes
 #include <xcb/xcb.h>
@@ -18,6 +19,7 @@
 #include <xcb/xproto.h>
 
 #include <LUtils.h>
+#include <LCommand.h>
 
 //===================
 //    LInputDevice Class
@@ -83,20 +85,17 @@ bool LInputDevice::setPropertyValue(int prop, QVariant value){
     }
   }*/
   //Now setup the argument
-  bool ok = false;
   QStringList args;
    args << "--set-prop";
    args << QString::number(devID);
    args << QString::number(prop); //prop ID
    args << variantToString(value);
-  ok = (0 == LUtils::runCmd("xinput", args) );
-  if(ok){ 
-    //Need to update the value in the hash as well
-    propData dat = devProps[prop];
-      dat.value = value;
-    devProps.insert(prop, dat);
-  }
-  return ok;
+  //Note: xinput is run in the background (the UI does not wait for it)
+  //  the value in the hash is updated once xinput reports success (setFinished())
+  LCommand *cmd = LCommand::run("xinput", args);
+  pending.insert(cmd, qMakePair(prop, value));
+  connect(cmd, SIGNAL(finished(int, QStringList)), this, SLOT(setFinished(int, QStringList)) );
+  return true;
 }
 
 // === PRIVATE ===
@@ -247,6 +246,23 @@ QString LInputDevice::variantToString(QVariant value){
   return ""; //nothing to return
 }
 
+// === PRIVATE SLOTS ===
+void LInputDevice::setFinished(int retcode, QStringList output){
+  LCommand *cmd = static_cast<LCommand*>(sender());
+  if(!pending.contains(cmd)){ return; }
+  QPair<int, QVariant> change = pending.take(cmd);
+  bool ok = (retcode==0);
+  if(ok && devProps.contains(change.first)){
+    //Need to update the value in the hash as well
+    propData dat = devProps[change.first];
+      dat.value = change.second;
+    devProps.insert(change.first, dat);
+  }else if(!ok){
+    qDebug() << "Could not set input device property:" << devID << change.first << output.join("\n");
+  }
+  emit propertySet(change.first, ok);
+}
+
 //======================
 //  LInput Static Functions
 //======================
@@ -263,6 +279,8 @@ QList<LInputDevice*> LInput::listDevices(){
   //Now step through the reply
   while(iter.data != 0 ){
     devices << new LInputDevice(iter.data->device_id, iter.data->device_use);
+    //This might be run in a worker thread - the results of xinput calls need to be delivered on the main thread
+    if(QCoreApplication::instance()!=0){ devices.last()->moveToThread(QCoreApplication::instance()->thread()); }
     //qDebug() << "Found Input Device:" << iter.data->device_id;
     //qDebug() << "  - num_class_info:" << iter.data->num_class_info;
     if(iter.rem>0){ xcb_input_device_info_next(&iter); }
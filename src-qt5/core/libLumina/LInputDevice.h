@@ -10,6 +10,7 @@
 #ifndef _LUMINA_XCB_INPUT_DEVICES_H
 #define _LUMINA_XCB_INPUT_DEVICES_H
 
+#include <QObject>
 #include <QList>
 #include <QString>
 #include <QStringList>
@@ -18,6 +19,8 @@
 
 #include <xcb/xproto.h>
 
+class LCommand;
+
 //Internal data structure for storing the property information
 struct propData{
   int id;
@@ -26,7 +29,8 @@ struct propData{
   xcb_atom_t atom;
 };
 
-class LInputDevice{
+class LInputDevice : public QObject{
+	Q_OBJECT
 public:
 	LInputDevice(unsigned int id, unsigned int type); //don't use this directly - use the "listDevices()" function instead
 	~LInputDevice();
@@ -42,12 +46,13 @@ public:
 	QList<int> listProperties();
 	QString propertyName(int prop);
 	QVariant getPropertyValue(int prop);
-	bool setPropertyValue(int prop, QVariant value);
+	bool setPropertyValue(int prop, QVariant value); //the change is applied in the background - see propertySet() for the result
 
 private:
 	unsigned int devID; //device ID number - assigned at class creation
 	unsigned int devType; //device "use" identifier - assigned at class creation
 	QHash<int, propData> devProps; //Known device properties <id#, properties struct>
+	QHash<LCommand*, QPair<int, QVariant> > pending; //xinput calls still running <command, <property, new value> >
 
 	void getProperties();
 	void readProperties();
@@ -55,12 +60,18 @@ private:
 	QString variantToString(QVariant value); //QVariant to xinput input string
 
 	//QString devName; //device name - use this for cross-session management (id #'s can get changed every session)
+
+private slots:
+	void setFinished(int retcode, QStringList output);
+
+signals:
+	void propertySet(int prop, bool ok); //result of a setPropertyValue() call (the value is only saved if ok)
 };
 
 //Static functions for overall management
 class LInput{
   public:
-  static QList<LInputDevice*> listDevices(); //NOTE: Make sure you "free()" all the LInputDevice objects when finished
+  static QList<LInputDevice*> listDevices(); //NOTE: Make sure you "delete" all the LInputDevice objects when finished (they belong to the main thread)
 
 };
 
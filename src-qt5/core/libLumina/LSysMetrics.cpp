@@ -0,0 +1,243 @@
+//===========================================
+//  Lumina-DE source code
+//  Copyright (c) 2016, Ken Moore
+//  Available under the 3-clause BSD license
+//  See the LICENSE file for full details
+//===========================================
+#include "LSysMetrics.h"
+#include "LuminaOS.h"
+#include "LTimerService.h"
+
+#include <QtConcurrent>
+#include <QDateTime>
+
+#define BATTERY_INTERVAL 5000 //battery status every 5 seconds
+#define STATS_INTERVAL 2000 //CPU/memory/disk statistics every 2 seconds
+#define SAMPLE_TOLERANCE 500 //milliseconds a check may be delayed to share a wakeup
+
+LSysMetrics* LSysMetrics::instance(){
+  static LSysMetrics *metrics = 0;
+  if(metrics==0){ metrics = new LSysMetrics(); }
+  return metrics;
+}
+
+LSysMetrics::LSysMetrics() : QObject(){
+  last = takeSample(false, false, false, false); //nothing read yet
+  wantBattery = wantStats = false;
+  lastBattery = lastStats = 0;
+  watcher = new QFutureWatcher<LSysSample>(this);
+  connect(watcher, SIGNAL(finished()), this, SLOT(sampleFinished()) );
+  volume = brightness = newVolume = newBrightness = -1;
+  controlReader = new QFutureWatcher< QPair<int,int> >(this);
+  connect(controlReader, SIGNAL(finished()), this, SLOT(controlsReadFinished()) );
+  controlWriter = new QFutureWatcher<void>(this);
+  connect(controlWriter, SIGNAL(finished()), this, SLOT(controlsWriteFinished()) );
+}
+
+LSysMetrics::~LSysMetrics(){
+
+}
+
+// === PUBLIC ===
+void LSysMetrics::addBatteryConsumer(QWidget *widget){
+  LTimerService::instance()->subscribe(this, SLOT(sampleBattery()), BATTERY_INTERVAL, SAMPLE_TOLERANCE, widget);
+}
+
+void LSysMetrics::addStatsConsumer(QWidget *widget){
+  LTimerService::instance()->subscribe(this, SLOT(sampleStats()), STATS_INTERVAL, SAMPLE_TOLERANCE, widget);
+}
+
+void LSysMetrics::removeConsumer(QWidget *widget){
+  LTimerService::instance()->unsubscribe(this, SLOT(sampleBattery()), widget);
+  LTimerService::instance()->unsubscribe(this, SLOT(sampleStats()), widget);
+}
+
+int LSysMetrics::batteryCharge(){
+  if(!last.battery){ mergeSample(takeSample(true, false, false, false), false); }
+  return last.charge;
+}
+
+bool LSysMetrics::batteryIsCharging(){
+  if(!last.battery){ mergeSample(takeSample(true, false, false, false), false); }
+  return last.charging;
+}
+
+int LSysMetrics::batterySecondsLeft(){
+  if(!last.battery){ mergeSample(takeSample(true, false, false, false), false); }
+  return last.secondsLeft;
+}
+
+int LSysMetrics::cpuUsagePercent(){
+  if(!last.cpu){ mergeSample(takeSample(false, true, false, false), false); }
+  return last.cpuPercent;
+}
+
+QStringList LSysMetrics::cpuTemperatures(){
+  if(!last.cpu){ mergeSample(takeSample(false, true, false, false), false); }
+  return last.temps;
+}
+
+int LSysMetrics::memoryUsagePercent(){
+  if(!last.memory){ mergeSample(takeSample(false, false, true, false), false); }
+  return last.memPercent;
+}
+
+QStringList LSysMetrics::diskUsage(){
+  if(!last.disk){ mergeSample(takeSample(false, false, false, true), false); }
+  return last.diskUsage;
+}
+
+int LSysMetrics::audioVolume(){
+  readControls();
+  return volume;
+}
+
+int LSysMetrics::screenBrightness(){
+  readControls();
+  return brightness;
+}
+
+void LSysMetrics::setAudioVolume(int percent){
+  if(percent<0){ percent = 0; }
+  else if(percent>100){ percent = 100; }
+  if(percent==volume && newVolume<0){ return; } //already set (slider updated from the current value)
+  volume = newVolume = percent;
+  writeControls();
+}
+
+void LSysMetrics::setScreenBrightness(int percent){
+  if(percent<0){ percent = 0; }
+  else if(percent>100){ percent = 100; }
+  if(percent==brightness && newBrightness<0){ return; }
+  brightness = newBrightness = percent;
+  writeControls();
+}
+
+// === PRIVATE ===
+void LSysMetrics::readControls(){
+  //Never at the same time as a change (the LOS functions do not expect that)
+  if(controlReader->isRunning() || controlWriter->isRunning() || newVolume>=0 || newBrightness>=0){ return; }
+  QDateTime now = QDateTime::currentDateTime();
+  if(controlsRead.isValid() && controlsRead.msecsTo(now) < CONTROLS_CACHE){ return; }
+  controlsRead = now;
+  controlReader->setFuture( QtConcurrent::run(&LSysMetrics::readControlValues) );
+}
+
+void LSysMetrics::writeControls(){
+  if(controlReader->isRunning() || controlWriter->isRunning()){ return; } //started again once that is done
+  if(newVolume<0 && newBrightness<0){ return; }
+  controlWriter->setFuture( QtConcurrent::run(&LSysMetrics::writeControlValues, newVolume, newBrightness) );
+  newVolume = newBrightness = -1;
+}
+
+QPair<int,int> LSysMetrics::readControlValues(){
+  //Note: This is run in a worker thread
+  return qMakePair(LOS::audioVolume(), LOS::ScreenBrightness());
+}
+
+void LSysMetrics::writeControlValues(int volume, int brightness){
+  //Note: This is run in a worker thread
+  if(volume>=0){ LOS::setAudioVolume(volume); }
+  if(brightness>=0){ LOS::setScreenBrightness(brightness); }
+}
+
+void LSysMetrics::mergeSample(LSysSample sample, bool announce){
+  if(sample.battery){
+    bool changed = !last.battery || sample.charge!=last.charge || sample.charging!=last.charging || sample.secondsLeft!=last.secondsLeft;
+    last.battery = true;
+    last.charge = sample.charge;
+    last.charging = sample.charging;
+    last.secondsLeft = sample.secondsLeft;
+    if(changed && announce){ emit batteryChanged(); }
+  }
+  if(sample.cpu){
+    bool changed = !last.cpu || sample.cpuPercent!=last.cpuPercent || sample.temps!=last.temps;
+    last.cpu = true;
+    last.cpuPercent = sample.cpuPercent;
+    last.temps = sample.temps;
+    if(changed && announce){ emit cpuChanged(); }
+  }
+  if(sample.memory){
+    bool changed = !last.memory || sample.memPercent!=last.memPercent;
+    last.memory = true;
+    last.memPercent = sample.memPercent;
+    if(changed && announce){ emit memoryChanged(); }
+  }
+  if(sample.disk){
+    bool changed = !last.disk || sample.diskUsage!=last.diskUsage;
+    last.disk = true;
+    last.diskUsage = sample.diskUsage;
+    if(changed && announce){ emit diskUsageChanged(); }
+  }
+}
+
+LSysSample LSysMetrics::takeSample(bool battery, bool cpu, bool memory, bool disk){
+  //Note: This is run in a worker thread for the periodic checks
+  LSysSample sample;
+  sample.battery = battery;
+  sample.cpu = cpu;
+  sample.memory = memory;
+  sample.disk = disk;
+  sample.charge = sample.secondsLeft = sample.cpuPercent = sample.memPercent = -1;
+  sample.charging = false;
+  if(battery){
+    sample.charge = LOS::batteryCharge();
+    sample.charging = LOS::batteryIsCharging();
+    sample.secondsLeft = LOS::batterySecondsLeft();
+  }
+  if(cpu){
+    sample.cpuPercent = LOS::CPUUsagePercent();
+    sample.temps = LOS::CPUTemperatures();
+  }
+  if(memory){ sample.memPercent = LOS::MemoryUsagePercent(); }
+  if(disk){ sample.diskUsage = LOS::DiskUsage(); }
+  return sample;
+}
+
+// === PRIVATE SLOTS ===
+void LSysMetrics::sampleBattery(){
+  //Every visible consumer gets a call for the same tick - only check once
+  qint64 now = QDateTime::currentMSecsSinceEpoch();
+  if(now-lastBattery < BATTERY_INTERVAL/2){ return; }
+  lastBattery = now;
+  wantBattery = true;
+  startSample();
+}
+
+void LSysMetrics::sampleStats(){
+  qint64 now = QDateTime::currentMSecsSinceEpoch();
+  if(now-lastStats < STATS_INTERVAL/2){ return; }
+  lastStats = now;
+  wantStats = true;
+  startSample();
+}
+
+void LSysMetrics::startSample(){
+  if(watcher->isRunning()){ return; } //last check is still going (slow system command) - started again once it is done
+  //Only read the information that somebody is listening for
+  bool battery = wantBattery && receivers(SIGNAL(batteryChanged()))>0;
+  bool cpu = wantStats && receivers(SIGNAL(cpuChanged()))>0;
+  bool memory = wantStats && receivers(SIGNAL(memoryChanged()))>0;
+  bool disk = wantStats && receivers(SIGNAL(diskUsageChanged()))>0;
+  wantBattery = wantStats = false;
+  if(!battery && !cpu && !memory && !disk){ return; }
+  watcher->setFuture( QtConcurrent::run(&LSysMetrics::takeSample, battery, cpu, memory, disk) );
+}
+
+void LSysMetrics::controlsReadFinished(){
+  QPair<int,int> vals = controlReader->result();
+  //Values which were changed in the meantime are newer than these
+  if(newVolume<0 && vals.first!=volume){ volume = vals.first; emit audioVolumeChanged(); }
+  if(newBrightness<0 && vals.second!=brightness){ brightness = vals.second; emit screenBrightnessChanged(); }
+  writeControls();
+}
+
+void LSysMetrics::controlsWriteFinished(){
+  controlsRead = QDateTime::currentDateTime(); //the values were just set
+  writeControls(); //latest slider position
+}
+
+void LSysMetrics::sampleFinished(){
+  mergeSample(watcher->result(), true);
+  if(wantBattery || wantStats){ startSample(); } //requested while the last check was running
+}
@@ -0,0 +1,105 @@
+//===========================================
+//  Lumina-DE source code
+//  Copyright (c) 2016, Ken Moore
+//  Available under the 3-clause BSD license
+//  See the LICENSE file for full details
+//===========================================
+//  Shared provider for the system status information (battery, CPU, memory, disks)
+//  The LOS functions are sampled in a worker thread (LTimerService) for all the consumers at once,
+//    and the changes are announced with signals
+//  Note: Only the information which something is connected to gets sampled, and only while
+//    one of the consumer widgets can be seen (see LTimerService::setPaused())
+//  The audio volume/screen brightness controls are cached here too (the LOS functions might run
+//    external utilities): reads return the last known value, changes are applied in the background
+//===========================================
+#ifndef _LUMINA_LIBRARY_SYSTEM_METRICS_H
+#define _LUMINA_LIBRARY_SYSTEM_METRICS_H
+
+#include <QObject>
+#include <QWidget>
+#include <QString>
+#include <QStringList>
+#include <QFutureWatcher>
+#include <QDateTime>
+#include <QPair>
+
+#define CONTROLS_CACHE 3000 //ms before the volume/brightness get checked again
+
+//One set of readings (only the flagged sections are filled in)
+struct LSysSample{
+  bool battery, cpu, memory, disk;
+  int charge, secondsLeft;
+  bool charging;
+  int cpuPercent;
+  QStringList temps;
+  int memPercent;
+  QStringList diskUsage;
+};
+
+class LSysMetrics : public QObject{
+	Q_OBJECT
+public:
+	static LSysMetrics* instance(); //one provider for the whole process
+
+	//Widgets which show the readings (the periodic checks run while any of them is visible)
+	void addBatteryConsumer(QWidget *widget); //every 5 seconds
+	void addStatsConsumer(QWidget *widget); //CPU/memory/disk: every 2 seconds
+	void removeConsumer(QWidget *widget);
+
+	//Most recent readings (sampled right away if nothing was read yet)
+	int batteryCharge();
+	bool batteryIsCharging();
+	int batterySecondsLeft();
+	int cpuUsagePercent();
+	QStringList cpuTemperatures();
+	int memoryUsagePercent();
+	QStringList diskUsage();
+
+	//Audio volume/screen brightness (0-100, -1: not available)
+	// Note: These return the last known value right away (-1 before the first check is done)
+	//   and check for changes in the background (the "Changed" signal is sent when they are different)
+	int audioVolume();
+	int screenBrightness();
+	void setAudioVolume(int percent); //applied in the background (only the latest value while a slider moves)
+	void setScreenBrightness(int percent);
+
+private:
+	LSysMetrics();
+	~LSysMetrics();
+
+	QFutureWatcher<LSysSample> *watcher;
+	LSysSample last;
+	bool wantBattery, wantStats; //periodic checks waiting to be started
+	qint64 lastBattery, lastStats; //time of the last periodic check request (msecs)
+	//Volume/brightness controls
+	QFutureWatcher< QPair<int,int> > *controlReader;
+	QFutureWatcher<void> *controlWriter;
+	int volume, brightness; //last known values
+	int newVolume, newBrightness; //values waiting to be applied (-1: none)
+	QDateTime controlsRead;
+
+	void mergeSample(LSysSample sample, bool announce);
+	static LSysSample takeSample(bool battery, bool cpu, bool memory, bool disk);
+	void readControls(); //start a background check if the values are old
+	void writeControls(); //apply the waiting changes
+	static QPair<int,int> readControlValues();
+	static void writeControlValues(int volume, int brightness);
+
+private slots:
+	void sampleBattery();
+	void sampleStats();
+	void startSample();
+	void sampleFinished();
+	void controlsReadFinished();
+	void controlsWriteFinished();
+
+signals:
+	void batteryChanged();
+	void cpuChanged();
+	void memoryChanged();
+	void diskUsageChanged();
+	void audioVolumeChanged();
+	void screenBrightnessChanged();
+};
+
+#endif
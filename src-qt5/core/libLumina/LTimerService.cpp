@@ -0,0 +1,231 @@
+//===========================================
+//  Lumina-DE source code
+//  Copyright (c) 2016, Ken Moore
+//  Available under the 3-clause BSD license
+//  See the LICENSE file for full details
+//===========================================
+#include "LTimerService.h"
+
+#include <QDateTime>
+#include <QEvent>
+#include <QMetaObject>
+
+LTimerService* LTimerService::instance(){
+  static LTimerService *service = 0;
+  if(service==0){ service = new LTimerService(); }
+  return service;
+}
+
+// === PUBLIC ===
+void LTimerService::subscribe(QObject *obj, const char *slot, int period, int tolerance, QWidget *widget){
+  if(obj==0 || slot==0){ return; }
+  if(period<1){ period = 1; }
+  if(tolerance<0){ tolerance = 0; }
+  QByteArray name = slotName(slot);
+  int index = -1;
+  for(int i=0; i<subs.length() && index<0; i++){
+    if(subs[i].obj==obj && subs[i].method==name && subs[i].widget==widget){ index = i; }
+  }
+  if(index<0){
+    LTimerSub sub;
+      sub.obj = obj;
+      sub.method = name;
+    subs << sub;
+    index = subs.length()-1;
+    connect(obj, SIGNAL(destroyed(QObject*)), this, SLOT(objectDestroyed(QObject*)), Qt::UniqueConnection);
+  }
+  subs[index].period = period;
+  subs[index].tolerance = tolerance;
+  subs[index].widget = widget;
+  subs[index].tied = (widget!=0);
+  subs[index].next = nextTick(currentTime(), period);
+  subs[index].missed = false;
+  if(widget!=0){
+    widget->installEventFilter(this);
+    if(widget!=obj){ connect(widget, SIGNAL(destroyed(QObject*)), this, SLOT(objectDestroyed(QObject*)), Qt::UniqueConnection); }
+  }
+  schedule();
+}
+
+void LTimerService::unsubscribe(QObject *obj, const char *slot){
+  QByteArray name;
+  if(slot!=0){ name = slotName(slot); }
+  for(int i=0; i<subs.length(); i++){
+    if(subs[i].obj==obj && (name.isEmpty() || subs[i].method==name) ){ subs.removeAt(i); i--; }
+  }
+  schedule();
+}
+
+void LTimerService::unsubscribe(QObject *obj, const char *slot, QWidget *widget){
+  QByteArray name = slotName(slot);
+  for(int i=0; i<subs.length(); i++){
+    if(subs[i].obj==obj && subs[i].method==name && subs[i].widget==widget){ subs.removeAt(i); i--; }
+  }
+  schedule();
+}
+
+void LTimerService::setPaused(QWidget *container, bool pause){
+  if(container==0){ return; }
+  paused.removeAll(QPointer<QWidget>()); //clean up any deleted containers
+  if(pause){
+    if(!paused.contains(container)){ paused << container; }
+  }else{
+    paused.removeAll(container);
+    runMissed();
+  }
+  schedule();
+}
+
+void LTimerService::setBlanked(bool blank){
+  if(blanked==blank){ return; }
+  blanked = blank;
+  if(!blanked){ runMissed(); }
+  schedule();
+}
+
+// === PRIVATE ===
+LTimerService::LTimerService() : QObject(){
+  blanked = false;
+  lastTime = currentTime();
+  elapsed.start();
+  timer = new QTimer(this);
+    timer->setSingleShot(true);
+    timer->setTimerType(Qt::PreciseTimer); //stay on the wall-clock boundaries
+  connect(timer, SIGNAL(timeout()), this, SLOT(wake()) );
+}
+
+LTimerService::~LTimerService(){
+
+}
+
+QByteArray LTimerService::slotName(const char *slot){
+  //Turn the SLOT() string ("1name(args)") into the method name
+  QByteArray name(slot);
+  if(!name.isEmpty() && name[0]>='0' && name[0]<='9'){ name.remove(0,1); }
+  int index = name.indexOf('(');
+  if(index>=0){ name.truncate(index); }
+  return name;
+}
+
+qint64 LTimerService::currentTime(){
+  QDateTime now = QDateTime::currentDateTime();
+  return ( now.toMSecsSinceEpoch() + (now.offsetFromUtc()*1000) );
+}
+
+qint64 LTimerService::nextTick(qint64 now, int period){
+  return ( ((now/period)+1) * period );
+}
+
+bool LTimerService::isActive(const LTimerSub &sub){
+  if(sub.widget.isNull()){ return !sub.tied; } //not tied to something visible (or that widget is gone)
+  if(blanked || !sub.widget->isVisible()){ return false; }
+  for(int i=0; i<paused.length(); i++){
+    if(paused[i].isNull()){ continue; }
+    if(paused[i]==sub.widget || paused[i]->isAncestorOf(sub.widget)){ return false; }
+  }
+  return true;
+}
+
+void LTimerService::runMissed(){
+  qint64 now = currentTime();
+  QList< QPointer<QObject> > objs;
+  QList<QByteArray> methods;
+  for(int i=0; i<subs.length(); i++){
+    if( !(subs[i].missed || subs[i].next<=now) || !isActive(subs[i]) ){ continue; }
+    subs[i].missed = false;
+    subs[i].next = nextTick(now, subs[i].period);
+    objs << subs[i].obj;
+    methods << subs[i].method;
+  }
+  //Now run them (the list of subscribers might change during the calls)
+  for(int i=0; i<objs.length(); i++){
+    if(!objs[i].isNull()){ QMetaObject::invokeMethod(objs[i], methods[i].constData()); }
+  }
+}
+
+bool LTimerService::clockJumped(qint64 now){
+  //The wall clock should have moved just as far as the monotonic timer
+  qint64 drift = now - (lastTime + elapsed.elapsed());
+  return (drift > LTIMER_JUMP || drift < -LTIMER_JUMP);
+}
+
+void LTimerService::realign(qint64 now){
+  QList< QPointer<QObject> > objs;
+  QList<QByteArray> methods;
+  for(int i=0; i<subs.length(); i++){
+    subs[i].next = nextTick(now, subs[i].period);
+    if(isActive(subs[i])){
+      subs[i].missed = false;
+      objs << subs[i].obj;
+      methods << subs[i].method;
+    }else{
+      subs[i].missed = true;
+    }
+  }
+  for(int i=0; i<objs.length(); i++){
+    if(!objs[i].isNull()){ QMetaObject::invokeMethod(objs[i], methods[i].constData()); }
+  }
+}
+
+void LTimerService::schedule(){
+  //Wake up at the latest time which is still within the tolerance of every active subscriber
+  qint64 wakeup = -1;
+  for(int i=0; i<subs.length(); i++){
+    if(!isActive(subs[i])){ continue; } //does not need to wake anything up
+    qint64 last = subs[i].next + subs[i].tolerance;
+    if(wakeup<0 || last<wakeup){ wakeup = last; }
+  }
+  if(wakeup<0){ timer->stop(); return; } //nothing to run right now
+  qint64 now = currentTime();
+  qint64 wait = wakeup - now;
+  if(wait<0){ wait = 0; }
+  else if(wait>LTIMER_MAX_SLEEP){ wait = LTIMER_MAX_SLEEP; } //wake up early to look for clock jumps
+  lastTime = now;
+  elapsed.start();
+  timer->start( (int) wait );
+}
+
+// === PRIVATE SLOTS ===
+void LTimerService::wake(){
+  qint64 now = currentTime();
+  if(clockJumped(now)){
+    //Suspend/resume, the time was set, or the timezone changed: every tick is off now
+    realign(now);
+    schedule();
+    return;
+  }
+  QList< QPointer<QObject> > objs;
+  QList<QByteArray> methods;
+  for(int i=0; i<subs.length(); i++){
+    if(subs[i].next > now){ continue; } //not time yet
+    if(isActive(subs[i])){
+      objs << subs[i].obj;
+      methods << subs[i].method;
+      subs[i].missed = false;
+    }else{
+      subs[i].missed = true; //run it as soon as it is visible again
+    }
+    subs[i].next = nextTick(now, subs[i].period);
+  }
+  for(int i=0; i<objs.length(); i++){
+    if(!objs[i].isNull()){ QMetaObject::invokeMethod(objs[i], methods[i].constData()); }
+  }
+  schedule();
+}
+
+void LTimerService::objectDestroyed(QObject *obj){
+  //Note: The widget pointers are already cleared by the time this is called
+  for(int i=0; i<subs.length(); i++){
+    if(subs[i].obj==obj || (subs[i].tied && subs[i].widget.isNull()) ){ subs.removeAt(i); i--; }
+  }
+  schedule();
+}
+
+// === PROTECTED ===
+bool LTimerService::eventFilter(QObject *obj, QEvent *ev){
+  if(ev->type()==QEvent::Show){
+    runMissed();
+    schedule();
+  }
+  return QObject::eventFilter(obj, ev);
+}
@@ -0,0 +1,88 @@
+//===========================================
+//  Lumina-DE source code
+//  Copyright (c) 2016, Ken Moore
+//  Available under the 3-clause BSD license
+//  See the LICENSE file for full details
+//===========================================
+//  Shared timer for periodic updates (clocks, status icons, feeds, etc)
+//  All the subscribers are run from a single timer, with the ticks aligned to
+//    wall-clock boundaries of their period (every clock updates right on the second/minute),
+//    and the subscribers which allow some delay are grouped into the same wakeup
+//  Subscribers with a widget are skipped while that widget cannot be seen
+//    (hidden, inside a paused container such as an auto-hidden panel, or the screen is blanked)
+//    and get one catch-up call as soon as it is visible again
+//  Jumps of the wall clock (resume from suspend, time set, timezone change) are caught on the
+//    next wakeup (never more than LTIMER_MAX_SLEEP away): all the ticks are re-aligned and run right away
+//===========================================
+#ifndef _LUMINA_LIBRARY_TIMER_SERVICE_H
+#define _LUMINA_LIBRARY_TIMER_SERVICE_H
+
+#include <QObject>
+#include <QWidget>
+#include <QPointer>
+#include <QList>
+#include <QTimer>
+#include <QByteArray>
+#include <QElapsedTimer>
+
+#define LTIMER_MAX_SLEEP 30000 //ms: longest time between wakeups (check for wall clock jumps)
+#define LTIMER_JUMP 2000 //ms: difference between the wall clock and the elapsed time which counts as a jump
+
+//One subscription
+struct LTimerSub{
+  QObject *obj;
+  QByteArray method; //slot name (no arguments)
+  int period, tolerance; //milliseconds
+  QPointer<QWidget> widget;
+  bool tied; //subscribed with a widget (never run once that widget is gone)
+  qint64 next; //next tick (local msecs since epoch)
+  bool missed; //a tick was skipped while the widget was not visible
+};
+
+class LTimerService : public QObject{
+	Q_OBJECT
+public:
+	static LTimerService* instance(); //one timer for the whole process
+
+	//Call the slot (no arguments) of the object every "period" milliseconds
+	// tolerance: how many milliseconds late the call may be (so it can share a wakeup with others)
+	// widget: skip the call while this widget is not visible (0: always run it)
+	// Note: Subscribing the same object/slot/widget again just changes the settings
+	//   (the same object/slot can be subscribed for several widgets: it runs while any of them is visible)
+	void subscribe(QObject *obj, const char *slot, int period, int tolerance = 0, QWidget *widget = 0);
+	void unsubscribe(QObject *obj, const char *slot = 0); //no slot: everything for this object
+	void unsubscribe(QObject *obj, const char *slot, QWidget *widget); //just the subscription for this widget
+
+	void setPaused(QWidget *container, bool paused); //pause all the subscribers within this widget
+	void setBlanked(bool blanked); //the screen is blanked (screensaver): pause all subscribers with a widget
+	bool isBlanked(){ return blanked; }
+
+private:
+	LTimerService();
+	~LTimerService();
+
+	QTimer *timer;
+	QList<LTimerSub> subs;
+	QList< QPointer<QWidget> > paused;
+	bool blanked;
+	qint64 lastTime; //wall clock time when the timer was started
+	QElapsedTimer elapsed; //monotonic time since then (does not follow the wall clock)
+
+	static QByteArray slotName(const char *slot);
+	static qint64 currentTime(); //local time (so the boundaries match the clocks)
+	static qint64 nextTick(qint64 now, int period);
+	bool isActive(const LTimerSub &sub);
+	void runMissed(); //catch-up calls for subscribers which are visible again
+	bool clockJumped(qint64 now);
+	void realign(qint64 now); //new ticks for everything after a clock jump
+	void schedule(); //start the timer for the next wakeup
+
+private slots:
+	void wake();
+	void objectDestroyed(QObject*);
+
+protected:
+	bool eventFilter(QObject *obj, QEvent *ev); //catch widgets which are shown again
+};
+
+#endif
@@ -29,6 +29,8 @@
 class LUtils{
 public:
 
+	//Note: runCmd()/getCmdOutput() block until the command is finished
+	//  Use LCommand (LCommand.h) from the GUI thread instead
 	//Run an external command and return the exit code
 	static int runCmd(QString cmd, QStringList args = QStringList());
 	//Run an external command and return any text output (one line per entry)
@@ -29,6 +29,18 @@ exists($${PWD}/LuminaOS-$${LINUX_DISTRO}.cpp){
 SOURCES *= $${PWD}/LUtils.cpp
 HEADERS *= $${PWD}/LUtils.h
 
+#Shared timer for periodic updates
+SOURCES *= $${PWD}/LTimerService.cpp
+HEADERS *= $${PWD}/LTimerService.h
+
+#Shared system status provider (uses the LuminaOS functions)
+SOURCES *= $${PWD}/LSysMetrics.cpp
+HEADERS *= $${PWD}/LSysMetrics.h
+
+#Non-blocking external command runner
+SOURCES *= $${PWD}/LCommand.cpp
+HEADERS *= $${PWD}/LCommand.h
+
 INCLUDEPATH *= ${PWD}
 
 }
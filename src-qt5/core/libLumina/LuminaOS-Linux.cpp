@@ -9,10 +9,41 @@
 #include "LuminaOS.h"
 #include <unistd.h>
 #include <stdio.h> // Needed for BUFSIZ
+#include <sys/statvfs.h>
+#include <QCryptographicHash>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QHash>
+#include <QtMath>
 
 //can't read xbrightness settings - assume invalid until set
 static int screenbrightness = -1;
 
+//Previous readings for the statistics which are given as a change since the last check
+static QMutex statlock;
+static qint64 cpuLastTotal = 0, cpuLastIdle = 0;
+static QHash<QString, QPair<qint64, qint64> > diskLast; //device -> (reads, writes)
+static QElapsedTimer diskTimer;
+
+//Read the contents of a /proc or /sys file (these report a size of 0, so read until the end)
+static QString readSysFile(QString path){
+  QFile file(path);
+  if(!file.open(QIODevice::ReadOnly)){ return ""; }
+  return QString(file.readAll()).trimmed();
+}
+
+//List the batteries in /sys/class/power_supply
+static QStringList batteryDirs(){
+  QStringList out;
+  QDir dir("/sys/class/power_supply");
+  QStringList devs = dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
+  for(int i=0; i<devs.length(); i++){
+    QString path = dir.absoluteFilePath(devs[i]);
+    if(readSysFile(path+"/type")=="Battery" && readSysFile(path+"/present")!="0"){ out << path; }
+  }
+  return out;
+}
+
 QString LOS::OSName(){ return "Linux"; }
 
 //OS-specific prefix(s)
@@ -31,7 +62,8 @@ QStringList LOS::RSSFeeds(){ return QStringList(); }
 QStringList LOS::ExternalDevicePaths(){
     //Returns: QStringList[<type>::::<filesystem>::::<path>]
       //Note: <type> = [USB, HDRIVE, DVD, SDCARD, UNKNOWN]
-  QStringList devs = LUtils::getCmdOutput("mount");
+  //Format of /proc/mounts: <device> <mount point> <filesystem> <options> <dump> <pass>
+  QStringList devs = readSysFile("/proc/mounts").split("\n");
   //Now check the output
   for(int i=0; i<devs.length(); i++){
     if(devs[i].startsWith("/dev/")){
@@ -44,7 +76,8 @@ QStringList LOS::ExternalDevicePaths(){
       else if(type.contains("mapper")){ type="LVM"; }
       else{ type = "UNKNOWN"; }
       //Now put the device in the proper output format
-      devs[i] = type+"::::"+devs[i].section(" ",4,4)+"::::"+devs[i].section(" ",2,2);
+      QString path = devs[i].section(" ",1,1).replace("\\040"," "); //spaces are escaped in the mount point
+      devs[i] = type+"::::"+devs[i].section(" ",2,2)+"::::"+path;
     }else{
       //invalid device - remove it from the list
       devs.removeAt(i);
@@ -171,82 +204,144 @@ void LOS::systemSuspend(){
 
 //Battery Availability
 bool LOS::hasBattery(){
-  QString my_status = LUtils::getCmdOutput("acpi -b").join("");
-  bool no_battery = my_status.contains("No support");
-  if (no_battery) return false;
-  return true;
+  return !batteryDirs().isEmpty();
 }
 
 //Battery Charge Level
 int LOS::batteryCharge(){ //Returns: percent charge (0-100), anything outside that range is counted as an error
-  QString my_status = LUtils::getCmdOutput("acpi -b").join("");
-  int my_start = my_status.indexOf("%");
-  // get the number right before the % sign
-  int my_end = my_start;
-  my_start--;
-  while ( (my_status[my_start] != ' ') && (my_start > 0) )
-      my_start--;
-  my_start++;
-  int my_charge = my_status.mid(my_start, my_end - my_start).toInt();
-  if ( (my_charge < 0) || (my_charge > 100) ) return -1;
-  return my_charge;
+  QStringList bats = batteryDirs();
+  if(bats.isEmpty()){ return -1; }
+  //Combine all the batteries (energy_* in uWh, or charge_* in uAh depending on the driver)
+  qint64 now = 0, full = 0;
+  int capacity = 0;
+  for(int i=0; i<bats.length(); i++){
+    QString type = QFile::exists(bats[i]+"/energy_now") ? "/energy_" : "/charge_";
+    now += readSysFile(bats[i]+type+"now").toLongLong();
+    full += readSysFile(bats[i]+type+"full").toLongLong();
+    capacity += readSysFile(bats[i]+"/capacity").toInt();
+  }
+  int charge = (full>0) ? qRound(100.0*now/full) : capacity/bats.length();
+  if(charge<0){ return -1; }
+  return qMin(charge, 100); //can be slightly over the last "full" reading
 }
 
 //Battery Charging State
-// Many possible values are returned if the laptop is plugged in
-// these include "Unknown, Full and No support.
-// However, it seems just one status is returned when running
-// on battery and that is "Discharging". So if the value we get
-// is NOT Discharging then we assume the battery is charging.
+// Many possible status values are given if the laptop is plugged in
+// (Charging, Full, Unknown, Not charging), but only "Discharging"
+// when running on battery - so anything else counts as charging
 bool LOS::batteryIsCharging(){
-  QString my_status = LUtils::getCmdOutput("acpi -b").join("");
-  bool discharging = my_status.contains("Discharging");
-  if (discharging) return false;
+  QStringList bats = batteryDirs();
+  for(int i=0; i<bats.length(); i++){
+    if(readSysFile(bats[i]+"/status")=="Discharging"){ return false; }
+  }
   return true;
 }
 
 //Battery Time Remaining
 int LOS::batterySecondsLeft(){ //Returns: estimated number of seconds remaining
-  return 0; //not implemented yet for Linux
+  QStringList bats = batteryDirs();
+  qint64 now = 0, rate = 0;
+  for(int i=0; i<bats.length(); i++){
+    if(readSysFile(bats[i]+"/status")!="Discharging"){ continue; }
+    if(QFile::exists(bats[i]+"/energy_now")){
+      now += readSysFile(bats[i]+"/energy_now").toLongLong();
+      rate += readSysFile(bats[i]+"/power_now").toLongLong();
+    }else{
+      now += readSysFile(bats[i]+"/charge_now").toLongLong();
+      rate += readSysFile(bats[i]+"/current_now").toLongLong();
+    }
+  }
+  if(rate<=0){ return -1; } //not discharging (or unknown rate)
+  return (now*3600)/rate;
 }
 
 //File Checksums
 QStringList LOS::Checksums(QStringList filepaths){ //Return: checksum of the input file
-  QStringList info = LUtils::getCmdOutput("md5sum \""+filepaths.join("\" \"")+"\"");
-  for(int i=0; i<info.length(); i++){
-    // first: md5sum: = error ; second: there's always one empty entry generated by getCmdOutput
-    if( info[i].startsWith("md5sum:") || info[i].isEmpty()){ info.removeAt(i); i--; }
-    else{
-      //Strip out the extra information
-      info[i] = info[i].section(" ",0,0);
-    }
+  QStringList info;
+  for(int i=0; i<filepaths.length(); i++){
+    QFile file(filepaths[i]);
+    if(!file.open(QIODevice::ReadOnly)){ continue; } //unreadable files are skipped (same as before with md5sum)
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    if(hash.addData(&file)){ info << QString(hash.result().toHex()); }
   }
  return info;
 }
 
 //file system capacity
 QString LOS::FileSystemCapacity(QString dir) { //Return: percentage capacity as give by the df command
-  QStringList mountInfo = LUtils::getCmdOutput("df \"" + dir+"\"");
-  QString::SectionFlag skipEmpty = QString::SectionSkipEmpty;
-  //we take the 5th word on the 2 line
-  QString capacity = mountInfo[1].section(" ",4,4, skipEmpty) + " used";
-  return capacity;
+  struct statvfs fs;
+  if(0 != statvfs(dir.toLocal8Bit().constData(), &fs) ){ return ""; }
+  //Same calculation as df: used space out of the space available to normal users
+  quint64 used = fs.f_blocks - fs.f_bfree;
+  quint64 total = used + fs.f_bavail;
+  int percent = (total>0) ? qCeil(100.0*used/total) : 0;
+  return QString::number(percent)+"% used";
 }
 
 QStringList LOS::CPUTemperatures(){ //Returns: List containing the temperature of any CPU's ("50C" for example)
-  return QStringList(); //not implemented yet
+  QStringList temps;
+  QDir dir("/sys/class/thermal");
+  QStringList zones = dir.entryList(QStringList() << "thermal_zone*", QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
+  for(int i=0; i<zones.length(); i++){
+    QString val = readSysFile(dir.absoluteFilePath(zones[i])+"/temp"); //millidegrees C
+    if(!val.isEmpty()){ temps << QString::number(qRound(val.toInt()/1000.0))+"C"; }
+  }
+  return temps;
 }
 
 int LOS::CPUUsagePercent(){ //Returns: Overall percentage of the amount of CPU cycles in use (-1 for errors)
-  return -1; //not implemented yet
+  //First line of /proc/stat: "cpu <user> <nice> <system> <idle> <iowait> <irq> <softirq> <steal> ..."
+  QStringList info = readSysFile("/proc/stat").section("\n",0,0).split(" ", QString::SkipEmptyParts);
+  if(info.length()<5 || info[0]!="cpu"){ return -1; }
+  qint64 total = 0;
+  for(int i=1; i<info.length() && i<9; i++){ total += info[i].toLongLong(); } //guest time is already counted in user
+  qint64 idle = info[4].toLongLong() + (info.length()>5 ? info[5].toLongLong() : 0);
+  //Usage since the last check
+  QMutexLocker locker(&statlock);
+  qint64 dtotal = total - cpuLastTotal;
+  qint64 didle = idle - cpuLastIdle;
+  cpuLastTotal = total;
+  cpuLastIdle = idle;
+  if(dtotal<=0){ return 0; }
+  return qRound(100.0*(dtotal-didle)/dtotal);
 }
 
 int LOS::MemoryUsagePercent(){
-  return -1; //not implemented yet
+  QStringList info = readSysFile("/proc/meminfo").split("\n");
+  qint64 total = 0, avail = -1, freemem = 0; //all in kB
+  for(int i=0; i<info.length(); i++){
+    QString var = info[i].section(":",0,0);
+    qint64 val = info[i].section(":",1,1).simplified().section(" ",0,0).toLongLong();
+    if(var=="MemTotal"){ total = val; }
+    else if(var=="MemAvailable"){ avail = val; }
+    else if(var=="MemFree" || var=="Buffers" || var=="Cached"){ freemem += val; }
+  }
+  if(total<=0){ return -1; }
+  if(avail<0){ avail = freemem; } //older kernels do not provide the estimate
+  return qRound(100.0*(total-avail)/total);
 }
 
 QStringList LOS::DiskUsage(){ //Returns: List of current read/write stats for each device
-  return QStringList(); //not implemented yet
+  //Format of /proc/diskstats: <major> <minor> <device> <reads completed> <reads merged> <sectors read> <ms reading> <writes completed> ...
+  QStringList info = readSysFile("/proc/diskstats").split("\n");
+  QStringList out;
+  QString fmt = "%1: %2 %3";
+  QMutexLocker locker(&statlock);
+  double secs = diskTimer.isValid() ? diskTimer.restart()/1000.0 : 0;
+  if(secs<=0){ diskTimer.start(); }
+  for(int i=0; i<info.length(); i++){
+    QStringList data = info[i].split(" ", QString::SkipEmptyParts);
+    if(data.length()<8){ continue; }
+    if(!QFile::exists("/sys/block/"+data[2]+"/device")){ continue; } //only physical disks (no partitions or loop devices)
+    qint64 reads = data[3].toLongLong();
+    qint64 writes = data[7].toLongLong();
+    if(secs>0 && diskLast.contains(data[2])){
+      //Operations per second since the last check (same as iostat)
+      out << fmt.arg(data[2], QString::number( (reads-diskLast[data[2]].first)/secs, 'f', 1)+" r/s", QString::number( (writes-diskLast[data[2]].second)/secs, 'f', 1)+" w/s");
+    }
+    diskLast.insert(data[2], qMakePair(reads, writes));
+  }
+  return out;
 }
 
 #endif
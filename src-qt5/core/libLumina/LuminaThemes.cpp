@@ -14,6 +14,9 @@
 #include <QObject>
 #include <QPainter>
 #include <QPen>
+#include <QHash>
+#include <QCryptographicHash>
+#include <QSaveFile>
 
 #include "LuminaXDG.h"
 
@@ -218,49 +221,119 @@ bool LTHEME::setCursorTheme(QString cursorname){
 
   //Return the complete stylesheet for a given theme/colors
 QString LTHEME::assembleStyleSheet(QString themepath, QString colorpath, QString font, QString fontsize){
+  //Use the stylesheet assembled previously if none of the input files changed
+  QString cachefile = styleSheetCacheFile(themepath, colorpath, font, fontsize);
+  QFile cache(cachefile);
+  if(cache.open(QIODevice::ReadOnly)){
+    //FORMAT: [hash of the inputs, input files (separated by "::::"), checksum of the stylesheet, stylesheet]
+    QByteArray hash = cache.readLine().trimmed();
+    QStringList files = QString::fromUtf8(cache.readLine()).trimmed().split("::::");
+    QByteArray sum = cache.readLine().trimmed();
+    QByteArray body = cache.readAll();
+    cache.close();
+    //Make sure the stylesheet is complete before comparing the inputs (checks every input file)
+    if(!sum.isEmpty() && sum == QCryptographicHash::hash(body, QCryptographicHash::Md5).toHex()
+	&& hash == styleSheetHash(files, font, fontsize)){ return QString::fromUtf8(body); }
+  }
+  //Assemble it from scratch
+  QStringList files; files << themepath << colorpath; //all the files used for this stylesheet
   QString stylesheet = LUtils::readFile(themepath).join("\n");
   QStringList colors = LUtils::readFile(colorpath);
   //qDebug() << "Found Theme:" << themepath << stylesheet;
   //qDebug() << "Found Colors:" << colorpath << colors;
-  QStringList systhemes = availableSystemThemes();
-  QStringList locthemes = availableLocalThemes();
   //Now do any inheritance between themes
+  QStringList systhemes, locthemes;
   int start = stylesheet.indexOf("INHERITS=");
+  if(start>=0){
+    //Only look through the theme directories when needed
+    systhemes = availableSystemThemes();
+    locthemes = availableLocalThemes();
+  }
   while(start>=0){
     QString line = stylesheet.mid(start, stylesheet.indexOf("\n",start)-start); //only get this line
     QString inherit = line.section("=",1,1);
     QString rStyle; //replacement stylesheet
     if(!locthemes.filter(inherit+"::::").isEmpty()){
-       rStyle = LUtils::readFile(locthemes.filter(inherit+"::::").first().section("::::",1,1)).join("\n");
+       files << locthemes.filter(inherit+"::::").first().section("::::",1,1);
+       rStyle = LUtils::readFile(files.last()).join("\n");
     }else if(!systhemes.filter(inherit+"::::").isEmpty()){
-      rStyle = LUtils::readFile(systhemes.filter(inherit+"::::").first().section("::::",1,1)).join("\n");
+      files << systhemes.filter(inherit+"::::").first().section("::::",1,1);
+      rStyle = LUtils::readFile(files.last()).join("\n");
     }
     stylesheet.replace(line, rStyle);
     //Now look for the next one
     start = stylesheet.indexOf("INHERITS=");
   }
-  //Now perform the color replacements
+  //Now collect the values for the template variables
+  QStringList colorvars; colorvars << "PRIMARYCOLOR" << "SECONDARYCOLOR" << "HIGHLIGHTCOLOR" << "ACCENTCOLOR" \
+	<< "PRIMARYDISABLECOLOR" << "SECONDARYDISABLECOLOR" << "HIGHLIGHTDISABLECOLOR" << "ACCENTDISABLECOLOR" \
+	<< "BASECOLOR" << "ALTBASECOLOR" << "TEXTCOLOR" << "TEXTDISABLECOLOR" << "TEXTHIGHLIGHTCOLOR";
+  QHash<QString, QString> vars;
   for(int i=0; i<colors.length(); i++){
     if(colors[i].isEmpty() || colors[i].startsWith("#")){ continue; }
-    else if(colors[i].startsWith("PRIMARYCOLOR=")){ stylesheet = stylesheet.replace("%%PRIMARYCOLOR%%", colors[i].section("=",1,1).simplified()); }
-    else if(colors[i].startsWith("SECONDARYCOLOR=")){ stylesheet = stylesheet.replace("%%SECONDARYCOLOR%%", colors[i].section("=",1,1).simplified()); }
-    else if(colors[i].startsWith("HIGHLIGHTCOLOR=")){ stylesheet = stylesheet.replace("%%HIGHLIGHTCOLOR%%", colors[i].section("=",1,1).simplified()); }
-    else if(colors[i].startsWith("ACCENTCOLOR=")){ stylesheet = stylesheet.replace("%%ACCENTCOLOR%%", colors[i].section("=",1,1).simplified()); }
-    else if(colors[i].startsWith("PRIMARYDISABLECOLOR=")){ stylesheet = stylesheet.replace("%%PRIMARYDISABLECOLOR%%", colors[i].section("=",1,1).simplified()); }
-    else if(colors[i].startsWith("SECONDARYDISABLECOLOR=")){ stylesheet = stylesheet.replace("%%SECONDARYDISABLECOLOR%%", colors[i].section("=",1,1).simplified()); }
-    else if(colors[i].startsWith("HIGHLIGHTDISABLECOLOR=")){ stylesheet = stylesheet.replace("%%HIGHLIGHTDISABLECOLOR%%", colors[i].section("=",1,1).simplified()); }
-    else if(colors[i].startsWith("ACCENTDISABLECOLOR=")){ stylesheet = stylesheet.replace("%%ACCENTDISABLECOLOR%%", colors[i].section("=",1,1).simplified()); }
-    else if(colors[i].startsWith("BASECOLOR=")){ stylesheet = stylesheet.replace("%%BASECOLOR%%", colors[i].section("=",1,1).simplified()); }
-    else if(colors[i].startsWith("ALTBASECOLOR=")){ stylesheet = stylesheet.replace("%%ALTBASECOLOR%%", colors[i].section("=",1,1).simplified()); }
-    else if(colors[i].startsWith("TEXTCOLOR=")){ stylesheet = stylesheet.replace("%%TEXTCOLOR%%", colors[i].section("=",1,1).simplified()); }
-    else if(colors[i].startsWith("TEXTDISABLECOLOR=")){ stylesheet = stylesheet.replace("%%TEXTDISABLECOLOR%%", colors[i].section("=",1,1).simplified()); }
-    else if(colors[i].startsWith("TEXTHIGHLIGHTCOLOR=")){ stylesheet = stylesheet.replace("%%TEXTHIGHLIGHTCOLOR%%", colors[i].section("=",1,1).simplified()); }
+    QString var = colors[i].section("=",0,0);
+    if(colorvars.contains(var) && !vars.contains(var)){ vars.insert(var, colors[i].section("=",1,1).simplified()); }
+  }
+  vars.insert("FONT", "\""+font+"\"");
+  vars.insert("FONTSIZE", fontsize);
+  //Replace all the "%%VARIABLE%%" entries in a single pass
+  QString out;
+  out.reserve(stylesheet.length());
+  int last = 0;
+  start = stylesheet.indexOf("%%");
+  while(start>=0){
+    int end = stylesheet.indexOf("%%", start+2);
+    if(end<0){ break; }
+    QString var = stylesheet.mid(start+2, end-start-2);
+    if(vars.contains(var)){
+      out.append( stylesheet.midRef(last, start-last) );
+      out.append( vars.value(var) );
+      last = end+2;
+      start = stylesheet.indexOf("%%", last);
+    }else{
+      start = end; //not a known variable - the closing marker might start the next one
+    }
+  }
+  out.append( stylesheet.midRef(last) );
+  //qDebug() << "Assembled Style Sheet:\n" << out;
+  //Save it for the next time (and the other Lumina processes)
+  QDir dir;
+  dir.mkpath(cachefile.section("/",0,-2));
+  QSaveFile save(cachefile); //other processes never see a partial file
+  if(save.open(QIODevice::WriteOnly)){
+    QByteArray body = out.toUtf8();
+    save.write( styleSheetHash(files, font, fontsize)+"\n" );
+    save.write( files.join("::::").toUtf8()+"\n" );
+    save.write( QCryptographicHash::hash(body, QCryptographicHash::Md5).toHex()+"\n" );
+    save.write( body );
+    save.commit();
   }
-  stylesheet = stylesheet.replace("%%FONT%%", "\""+font+"\"");
-  stylesheet = stylesheet.replace("%%FONTSIZE%%", fontsize);
-  //qDebug() << "Assembled Style Sheet:\n" << stylesheet;
-  return stylesheet;
+  return out;
+}
+
+QString LTHEME::styleSheetCacheFile(QString themepath, QString colorpath, QString font, QString fontsize){
+  QString dir = QString(getenv("XDG_CACHE_HOME")).section(":",0,0);
+  if(dir.isEmpty()){ dir = QDir::homePath()+"/.cache"; }
+  QString id = themepath+"\n"+colorpath+"\n"+font+"\n"+fontsize;
+  return (dir+"/lumina-desktop/themes/"+QCryptographicHash::hash(id.toUtf8(), QCryptographicHash::Md5).toHex()+".qss");
 }
+
+QByteArray LTHEME::styleSheetHash(QStringList files, QString font, QString fontsize){
+  QCryptographicHash hash(QCryptographicHash::Md5);
+  hash.addData( (font+"\n"+fontsize+"\n").toUtf8() );
+  //A new theme in one of the theme directories might change which file gets inherited
+  hash.addData( QFileInfo(LOS::LuminaShare()+"themes").lastModified().toString(Qt::ISODate).toUtf8() );
+  hash.addData( QFileInfo(QString(getenv("XDG_CONFIG_HOME"))+"/lumina-desktop/themes").lastModified().toString(Qt::ISODate).toUtf8() );
+  //Now the contents of all the files
+  for(int i=0; i<files.length(); i++){
+    hash.addData( (files[i]+"\n").toUtf8() );
+    QFile file(files[i]);
+    if(file.open(QIODevice::ReadOnly)){ hash.addData(file.readAll()); file.close(); }
+    else{ hash.addData("[missing]"); }
+  }
+  return hash.result().toHex();
+}
+
 // Extra information about a cursor theme
 QStringList LTHEME::cursorInformation(QString name){
   //returns: [Name, Comment, Sample Image File]
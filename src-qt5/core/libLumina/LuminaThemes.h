@@ -44,6 +44,7 @@ public:
   static bool setCursorTheme(QString cursorname);
 
   //Return the complete stylesheet for a given theme/colors
+  // Note: The result is cached on disk (re-used until one of the input files changes)
   static QString assembleStyleSheet(QString themepath, QString colorpath, QString font, QString fontsize);
   
   //Additional info for a cursor theme
@@ -54,7 +55,11 @@ public:
   static void LoadCustomEnvSettings(); //will push the custom settings into the environment (recommended before loading the initial QApplication)
   static bool setCustomEnvSetting(QString var, QString val); //variable/value pair (use an empty val to clear it)
   static QString readCustomEnvSetting(QString var);
-  
+
+private:
+  //Stylesheet cache functions
+  static QString styleSheetCacheFile(QString themepath, QString colorpath, QString font, QString fontsize);
+  static QByteArray styleSheetHash(QStringList files, QString font, QString fontsize); //hash of all the inputs
 };
 
 // Qt Style override to allow custom themeing/colors
@@ -14,6 +14,7 @@
 #include <QApplication>
 #include <QDesktopWidget>
 #include <QScreen>
+#include <QVector>
 
 
 
@@ -27,6 +28,12 @@
 #include <xcb/xcb_aux.h>
 #include <xcb/composite.h>
 #include <xcb/damage.h>
+#include <xcb/sync.h>
+#include <xcb/shm.h>
+
+//Shared memory includes
+#include <sys/ipc.h>
+#include <sys/shm.h>
 
 //XLib includes
 #include <X11/extensions/Xdamage.h>
@@ -39,6 +46,13 @@
 //===============================
 //===============================
 LXCB::LXCB(){
+   usecache = clientsvalid = workspacevalid = activevalid = false;
+   cachedworkspace = 0;
+   cachedactive = 0;
+   shmstate = -1;
+   shmseg = 0;
+   shmdata = 0;
+   shmsize = 0;
    xcb_intern_atom_cookie_t *cookie = xcb_ewmh_init_atoms(QX11Info::connection(), &EWMH);
    if(!xcb_ewmh_init_atoms_replies(&EWMH, cookie, NULL) ){
      qDebug() << "Error with XCB atom initializations";
@@ -47,9 +61,48 @@ LXCB::LXCB(){
    }
 }
 LXCB::~LXCB(){
+  if(shmdata!=0){
+    xcb_shm_detach(QX11Info::connection(), shmseg);
+    shmdt(shmdata);
+  }
   xcb_ewmh_connection_wipe(&EWMH);
 }
 
+// private function
+bool LXCB::trayShmReserve(uint bytes){
+  if(shmstate==0){ return false; }
+  xcb_connection_t *conn = QX11Info::connection();
+  if(shmstate<0){
+    const xcb_query_extension_reply_t *ext = xcb_get_extension_data(conn, &xcb_shm_id);
+    shmstate = (ext!=0 && ext->present) ? 1 : 0;
+    if(shmstate==0){ return false; }
+  }
+  if(shmdata!=0 && bytes<=shmsize){ return true; } //already large enough
+  //(Re)create the segment
+  if(shmdata!=0){
+    xcb_shm_detach(conn, shmseg);
+    shmdt(shmdata);
+    shmdata = 0;
+  }
+  shmsize = qMax(bytes, (uint) 262144); //256KB - big enough for any normal tray icon
+  int id = shmget(IPC_PRIVATE, shmsize, IPC_CREAT | 0600);
+  if(id<0){ shmstate = 0; return false; }
+  void *addr = shmat(id, 0, 0);
+  if(addr == (void*) -1){ shmctl(id, IPC_RMID, 0); shmstate = 0; return false; }
+  shmseg = xcb_generate_id(conn);
+  xcb_generic_error_t *err = xcb_request_check(conn, xcb_shm_attach_checked(conn, shmseg, id, 0));
+  shmctl(id, IPC_RMID, 0); //removed automatically once both sides are detached
+  if(err!=0){
+    //Could not be attached (remote X server?) - use the normal image requests instead
+    free(err);
+    shmdt(addr);
+    shmstate = 0;
+    return false;
+  }
+  shmdata = (uchar*) addr;
+  return true;
+}
+
 // private function
 void LXCB::createWMAtoms(){
   ATOMS.clear();
@@ -80,25 +133,168 @@ void LXCB::createWMAtoms(){
   
 }
 
+// === Window-state cache ===
+void LXCB::EnableWindowCache(bool enable){
+  usecache = enable;
+  clientsvalid = workspacevalid = activevalid = false;
+  cachedclients.clear();
+  wincache.clear();
+}
+
+void LXCB::WindowCacheEvent(WId win, xcb_atom_t atom){
+  if(!usecache){ return; }
+  //Root window properties
+  if(win == QX11Info::appRootWindow()){
+    if(atom==EWMH._NET_CLIENT_LIST){ clientsvalid = false; }
+    else if(atom==EWMH._NET_CURRENT_DESKTOP){ workspacevalid = false; }
+    else if(atom==EWMH._NET_ACTIVE_WINDOW){ activevalid = false; }
+    return;
+  }
+  if(!wincache.contains(win)){ return; } //nothing cached for this window yet
+  //Client window properties - just flag the associated field as out of date (re-fetched on the next request)
+  int field = 0;
+  if(atom==XCB_ATOM_WM_CLASS){ field = C_CLASS; }
+  else if(atom==EWMH._NET_WM_DESKTOP){ field = C_WORKSPACE; }
+  else if(atom==EWMH._NET_WM_STATE){ field = C_STATES; }
+  else if(atom==EWMH._NET_WM_ICON){ field = C_ICON; }
+  else if(atom==EWMH._NET_WM_NAME || atom==EWMH._NET_WM_VISIBLE_NAME || atom==EWMH._NET_WM_ICON_NAME \
+	|| atom==EWMH._NET_WM_VISIBLE_ICON_NAME || atom==XCB_ATOM_WM_NAME || atom==XCB_ATOM_WM_ICON_NAME){ field = C_NAMES; }
+  wincache[win].valid &= ~field;
+}
+
+QList<WId> LXCB::CachedClientList(){
+  if(usecache && clientsvalid){ return cachedclients; }
+  QList<WId> clients;
+  xcb_get_property_cookie_t cookie = xcb_ewmh_get_client_list_unchecked( &EWMH, 0);
+  xcb_ewmh_get_windows_reply_t winlist;
+  if( 1 == xcb_ewmh_get_client_list_reply( &EWMH, cookie, &winlist, NULL) ){
+    for(unsigned int i=0; i<winlist.windows_len; i++){ clients << winlist.windows[i]; }
+    xcb_ewmh_get_windows_reply_wipe(&winlist);
+  }
+  if(usecache){
+    cachedclients = clients;
+    clientsvalid = true;
+    //Remove any windows which are no longer listed
+    QList<WId> old = wincache.keys();
+    for(int i=0; i<old.length(); i++){
+      if(!clients.contains(old[i])){ wincache.remove(old[i]); }
+    }
+  }
+  return clients;
+}
+
+bool LXCB::isCachedWindow(WId win, int fields){
+  //Only client windows are cached (property change events are selected for those)
+  if(!usecache || win==0){ return false; }
+  if(!CachedClientList().contains(win)){ return false; }
+  fillWindowCache(QList<WId>() << win, fields);
+  return true;
+}
+
+void LXCB::fillWindowCache(QList<WId> wins, int fields){
+  //Figure out which fields are missing for each window
+  QList<WId> need; QList<int> needfields;
+  for(int i=0; i<wins.length(); i++){
+    int missing = fields & ~(wincache.value(wins[i]).valid);
+    if(missing!=0){ need << wins[i]; needfields << missing; }
+  }
+  if(need.isEmpty()){ return; }
+  if(DEBUG){ qDebug() << "XCB: fillWindowCache()" << need.length() << fields; }
+  //Send out all the requests first (no round trip per window)
+  int num = need.length();
+  QVector<xcb_get_property_cookie_t> ccookie(num), dcookie(num), scookie(num);
+  QVector<xcb_get_property_cookie_t> vincookie(num), incookie(num), vncookie(num), ncookie(num), oncookie(num), oincookie(num);
+  for(int i=0; i<num; i++){
+    int f = needfields[i];
+    if(!wincache.contains(need[i])){ SelectInput(need[i]); } //make sure we get property events for this window
+    if(f & C_CLASS){ ccookie[i] = xcb_icccm_get_wm_class_unchecked(QX11Info::connection(), need[i]); }
+    if(f & C_WORKSPACE){ dcookie[i] = xcb_ewmh_get_wm_desktop_unchecked(&EWMH, need[i]); }
+    if(f & C_STATES){ scookie[i] = xcb_ewmh_get_wm_state_unchecked(&EWMH, need[i]); }
+    if(f & C_NAMES){
+      vincookie[i] = xcb_ewmh_get_wm_visible_icon_name_unchecked(&EWMH, need[i]);
+      incookie[i] = xcb_ewmh_get_wm_icon_name_unchecked(&EWMH, need[i]);
+      vncookie[i] = xcb_ewmh_get_wm_visible_name_unchecked(&EWMH, need[i]);
+      ncookie[i] = xcb_ewmh_get_wm_name_unchecked(&EWMH, need[i]);
+      oncookie[i] = xcb_icccm_get_wm_name_unchecked(QX11Info::connection(), need[i]);
+      oincookie[i] = xcb_icccm_get_wm_icon_name_unchecked(QX11Info::connection(), need[i]);
+    }
+  }
+  //Now collect all the replies
+  for(int i=0; i<num; i++){
+    int f = needfields[i];
+    CachedWindow &CW = wincache[need[i]];
+    if(f & C_CLASS){
+      CW.wclass.clear();
+      xcb_icccm_get_wm_class_reply_t value;
+      if( 1== xcb_icccm_get_wm_class_reply( QX11Info::connection(), ccookie[i], &value, NULL) ){
+        CW.wclass = QString::fromUtf8(value.class_name);
+        xcb_icccm_get_wm_class_reply_wipe(&value);
+      }
+    }
+    if(f & C_WORKSPACE){
+      uint32_t wkspace = 0;
+      xcb_ewmh_get_wm_desktop_reply(&EWMH, dcookie[i], &wkspace, NULL);
+      CW.workspace = wkspace;
+    }
+    if(f & C_STATES){
+      CW.states.clear();
+      xcb_ewmh_get_atoms_reply_t reply;
+      if(1==xcb_ewmh_get_wm_state_reply(&EWMH, scookie[i], &reply, NULL) ){
+        CW.states = StatesFromAtoms(&reply);
+        xcb_ewmh_get_atoms_reply_wipe(&reply);
+      }
+    }
+    if(f & C_NAMES){
+      CW.visiconname.clear(); CW.iconname.clear(); CW.visname.clear(); CW.name.clear(); CW.oldname.clear(); CW.oldiconname.clear();
+      xcb_ewmh_get_utf8_strings_reply_t data;
+      if( 1 == xcb_ewmh_get_wm_visible_icon_name_reply(&EWMH, vincookie[i], &data, NULL) ){
+        CW.visiconname = QString::fromUtf8(data.strings, data.strings_len);
+        xcb_ewmh_get_utf8_strings_reply_wipe(&data);
+      }
+      if( 1 == xcb_ewmh_get_wm_icon_name_reply(&EWMH, incookie[i], &data, NULL) ){
+        CW.iconname = QString::fromUtf8(data.strings, data.strings_len);
+        xcb_ewmh_get_utf8_strings_reply_wipe(&data);
+      }
+      if( 1 == xcb_ewmh_get_wm_visible_name_reply(&EWMH, vncookie[i], &data, NULL) ){
+        CW.visname = QString::fromUtf8(data.strings, data.strings_len);
+        xcb_ewmh_get_utf8_strings_reply_wipe(&data);
+      }
+      if( 1 == xcb_ewmh_get_wm_name_reply(&EWMH, ncookie[i], &data, NULL) ){
+        CW.name = QString::fromUtf8(data.strings, data.strings_len);
+        xcb_ewmh_get_utf8_strings_reply_wipe(&data);
+      }
+      xcb_icccm_get_text_property_reply_t reply;
+      if(1 == xcb_icccm_get_wm_name_reply(QX11Info::connection(), oncookie[i], &reply, NULL) ){
+        CW.oldname = QString::fromLocal8Bit(reply.name, reply.name_len);
+        xcb_icccm_get_text_property_reply_wipe(&reply);
+      }
+      if(1 == xcb_icccm_get_wm_icon_name_reply(QX11Info::connection(), oincookie[i], &reply, NULL) ){
+        CW.oldiconname = QString::fromLocal8Bit(reply.name, reply.name_len);
+        xcb_icccm_get_text_property_reply_wipe(&reply);
+      }
+    }
+    //Note: The icon is not batched (large data) - it is loaded on request by WindowIcon()
+    CW.valid |= (f & ~C_ICON);
+  }
+}
+
 // === WindowList() ===
 QList<WId> LXCB::WindowList(bool rawlist){
   if(DEBUG){ qDebug() << "XCB: WindowList()" << rawlist; }
   QList<WId> output;
-  //qDebug() << "Get Client list cookie";
-  xcb_get_property_cookie_t cookie = xcb_ewmh_get_client_list_unchecked( &EWMH, 0);
-  xcb_ewmh_get_windows_reply_t winlist;
   //qDebug() << "Get client list";
-  if( 1 == xcb_ewmh_get_client_list_reply( &EWMH, cookie, &winlist, NULL) ){
-    //qDebug() << " - Loop over items";
-    unsigned int wkspace = CurrentWorkspace();
-    for(unsigned int i=0; i<winlist.windows_len; i++){ 
-      //Filter out the Lumina Desktop windows
-      if(WindowClass(winlist.windows[i]) == "Lumina Desktop Environment"){ continue; }
-      //Also filter out windows not on the active workspace
-      else if( (WindowWorkspace(winlist.windows[i])!=wkspace) && !rawlist ){ continue; }
-      else{
-        output << winlist.windows[i]; 
-      }
+  QList<WId> winlist = CachedClientList();
+  //Fetch the info for all the windows at once (if the cache is used)
+  if(usecache){ fillWindowCache(winlist, C_CLASS | C_WORKSPACE | C_STATES); }
+  //qDebug() << " - Loop over items";
+  unsigned int wkspace = CurrentWorkspace();
+  for(int i=0; i<winlist.length(); i++){ 
+    //Filter out the Lumina Desktop windows
+    if(WindowClass(winlist[i]) == "Lumina Desktop Environment"){ continue; }
+    //Also filter out windows not on the active workspace
+    else if( (WindowWorkspace(winlist[i])!=wkspace) && !rawlist ){ continue; }
+    else{
+      output << winlist[i]; 
     }
   }
   return output;
@@ -107,11 +303,13 @@ QList<WId> LXCB::WindowList(bool rawlist){
 // === CurrentWorkspace() ===
 unsigned int LXCB::CurrentWorkspace(){
   if(DEBUG){ qDebug() << "XCB: CurrentWorkspace()"; }
+  if(usecache && workspacevalid){ return cachedworkspace; }
   //qDebug() << "Get Current Workspace";
   xcb_get_property_cookie_t cookie = xcb_ewmh_get_current_desktop_unchecked(&EWMH, 0);
   uint32_t wkspace = 0;
   xcb_ewmh_get_current_desktop_reply(&EWMH, cookie, &wkspace, NULL);
   //qDebug() << " - done:" << wkspace;
+  if(usecache){ cachedworkspace = wkspace; workspacevalid = true; }
   return wkspace;
 }
 
@@ -128,13 +326,14 @@ unsigned int LXCB::NumberOfWorkspaces(){
 // === ActiveWindow() ===
 WId LXCB::ActiveWindow(){
   if(DEBUG){ qDebug() << "XCB: ActiveWindow()"; }
+  if(usecache && activevalid){ return cachedactive; }
   xcb_get_property_cookie_t cookie = xcb_ewmh_get_active_window_unchecked(&EWMH, 0);
   xcb_window_t actwin;
-  if(1 == xcb_ewmh_get_active_window_reply(&EWMH, cookie, &actwin, NULL) ){
-    return actwin;
-  }else{
-    return 0; //invalid ID/failure
+  if(1 != xcb_ewmh_get_active_window_reply(&EWMH, cookie, &actwin, NULL) ){
+    actwin = 0; //invalid ID/failure
   }
+  if(usecache){ cachedactive = actwin; activevalid = true; }
+  return actwin;
 }
 
 // === CheckDisableXinerama() ===
@@ -192,6 +391,7 @@ QString LXCB::WindowClass(WId win){
   if(DEBUG){ qDebug() << "XCB: WindowClass()" << win; }
   QString out;
   if(win==0){ return ""; }
+  if(isCachedWindow(win, C_CLASS)){ return wincache.value(win).wclass; }
   xcb_get_property_cookie_t cookie = xcb_icccm_get_wm_class_unchecked(QX11Info::connection(), win);
   if(cookie.sequence == 0){ return out; } 
   xcb_icccm_get_wm_class_reply_t value;
@@ -207,6 +407,11 @@ unsigned int LXCB::WindowWorkspace(WId win){
   if(DEBUG){ qDebug() << "XCB: WindowWorkspace()" << win; }
   //qDebug() << "Get Window Workspace";
   if(win==0){ return 0; }
+  if(isCachedWindow(win, C_WORKSPACE | C_STATES)){
+    //Sticky windows are on the current workspace (on all of them)
+    if(wincache.value(win).states.contains(LXCB::S_STICKY)){ return CurrentWorkspace(); }
+    return wincache.value(win).workspace;
+  }
   uint32_t wkspace = 0;
   xcb_get_property_cookie_t scookie = xcb_ewmh_get_wm_state_unchecked(&EWMH, win);
   xcb_get_property_cookie_t cookie = xcb_ewmh_get_wm_desktop_unchecked(&EWMH, win);
@@ -290,24 +495,14 @@ QList<int> LXCB::WindowFrameGeometry(WId win){
 LXCB::WINDOWVISIBILITY LXCB::WindowState(WId win){
   if(DEBUG){ qDebug() << "XCB: WindowState()"; }
   if(win==0){ return IGNORE; }
-  xcb_get_property_cookie_t cookie = xcb_ewmh_get_wm_state_unchecked(&EWMH, win);
-  if(cookie.sequence == 0){ return IGNORE; } 
-  xcb_ewmh_get_atoms_reply_t states;
   WINDOWVISIBILITY cstate = IGNORE;
   //First Check for special states (ATTENTION in particular);
-  if( 1 == xcb_ewmh_get_wm_state_reply(&EWMH, cookie, &states, NULL) ){
-    for(unsigned int i=0; i<states.atoms_len; i++){
-      if(states.atoms[i] == EWMH._NET_WM_STATE_DEMANDS_ATTENTION){ cstate = ATTENTION; break; } //nothing more urgent - stop here
-      else if(states.atoms[i] == EWMH._NET_WM_STATE_HIDDEN){ cstate = INVISIBLE; }
-    }
-  }
+  QList<LXCB::WINDOWSTATE> states = WM_Get_Window_States(win);
+  if(states.contains(LXCB::S_ATTENTION)){ cstate = ATTENTION; } //nothing more urgent
+  else if(states.contains(LXCB::S_HIDDEN)){ cstate = INVISIBLE; }
   //Now check to see if the window is the active one
   if(cstate == IGNORE){
-    xcb_get_property_cookie_t cookie = xcb_ewmh_get_active_window_unchecked(&EWMH, 0);
-    xcb_window_t actwin;
-    if(1 == xcb_ewmh_get_active_window_reply(&EWMH, cookie, &actwin, NULL) ){
-      if(actwin == win){ cstate = ACTIVE; }
-    }
+    if(ActiveWindow() == win){ cstate = ACTIVE; }
   }
   //Now check for ICCCM Urgency hint (not sure if this is still valid with EWMH instead)
   /*if(cstate == IGNORE){
@@ -334,6 +529,7 @@ LXCB::WINDOWVISIBILITY LXCB::WindowState(WId win){
 QString LXCB::WindowVisibleIconName(WId win){ //_NET_WM_VISIBLE_ICON_NAME
   if(DEBUG){ qDebug() << "XCB: WindowVisibleIconName()"; }
   if(win==0){ return ""; }
+  if(isCachedWindow(win, C_NAMES)){ return wincache.value(win).visiconname; }
   QString out;
   xcb_get_property_cookie_t cookie = xcb_ewmh_get_wm_visible_icon_name_unchecked(&EWMH, win);
   if(cookie.sequence == 0){ return out; } 
@@ -348,6 +544,7 @@ QString LXCB::WindowVisibleIconName(WId win){ //_NET_WM_VISIBLE_ICON_NAME
 QString LXCB::WindowIconName(WId win){ //_NET_WM_ICON_NAME
   if(DEBUG){ qDebug() << "XCB: WindowIconName()"; }
   if(win==0){ return ""; }
+  if(isCachedWindow(win, C_NAMES)){ return wincache.value(win).iconname; }
   QString out;
   xcb_get_property_cookie_t cookie = xcb_ewmh_get_wm_icon_name_unchecked(&EWMH, win);
   if(cookie.sequence == 0){ return out; } 
@@ -362,6 +559,7 @@ QString LXCB::WindowIconName(WId win){ //_NET_WM_ICON_NAME
 QString LXCB::WindowVisibleName(WId win){ //_NET_WM_VISIBLE_NAME
   if(DEBUG){ qDebug() << "XCB: WindowVisibleName()"; }
   if(win==0){ return ""; }
+  if(isCachedWindow(win, C_NAMES)){ return wincache.value(win).visname; }
   QString out;
   xcb_get_property_cookie_t cookie = xcb_ewmh_get_wm_visible_name_unchecked(&EWMH, win);
   if(cookie.sequence == 0){ return out; } 
@@ -376,6 +574,7 @@ QString LXCB::WindowVisibleName(WId win){ //_NET_WM_VISIBLE_NAME
 QString LXCB::WindowName(WId win){ //_NET_WM_NAME
   if(DEBUG){ qDebug() << "XCB: WindowName()"; }
   if(win==0){ return ""; }
+  if(isCachedWindow(win, C_NAMES)){ return wincache.value(win).name; }
   QString out;
   xcb_get_property_cookie_t cookie = xcb_ewmh_get_wm_name_unchecked(&EWMH, win);
   if(cookie.sequence == 0){ return out; } 
@@ -390,6 +589,7 @@ QString LXCB::WindowName(WId win){ //_NET_WM_NAME
 QString LXCB::OldWindowName(WId win){ //WM_NAME (old standard)
   if(DEBUG){ qDebug() << "XCB: OldWindowName()"; }
   if(win==0){ return ""; }
+  if(isCachedWindow(win, C_NAMES)){ return wincache.value(win).oldname; }
   xcb_get_property_cookie_t cookie = xcb_icccm_get_wm_name_unchecked(QX11Info::connection(), win);
   xcb_icccm_get_text_property_reply_t reply;
   if(1 == xcb_icccm_get_wm_name_reply(QX11Info::connection(), cookie, &reply, NULL) ){
@@ -405,6 +605,7 @@ QString LXCB::OldWindowName(WId win){ //WM_NAME (old standard)
 QString LXCB::OldWindowIconName(WId win){ //WM_ICON_NAME (old standard)
   if(DEBUG){ qDebug() << "XCB: OldWindowIconName()"; }
   if(win==0){ return ""; }
+  if(isCachedWindow(win, C_NAMES)){ return wincache.value(win).oldiconname; }
   xcb_get_property_cookie_t cookie = xcb_icccm_get_wm_icon_name_unchecked(QX11Info::connection(), win);
   xcb_icccm_get_text_property_reply_t reply;
   if(1 == xcb_icccm_get_wm_icon_name_reply(QX11Info::connection(), cookie, &reply, NULL) ){
@@ -486,6 +687,8 @@ QIcon LXCB::WindowIcon(WId win){
   if(DEBUG){ qDebug() << "XCB: WindowIcon()"; }
   QIcon icon;
   if(win==0){ return icon; }
+  bool cached = isCachedWindow(win, 0);
+  if(cached && (wincache.value(win).valid & C_ICON) ){ return wincache.value(win).icon; }
   xcb_get_property_cookie_t cookie = xcb_ewmh_get_wm_icon_unchecked(&EWMH, win);
   xcb_ewmh_get_wm_icon_reply_t reply;
   if(1 == xcb_ewmh_get_wm_icon_reply(&EWMH, cookie, &reply, NULL)){
@@ -509,6 +712,10 @@ QIcon LXCB::WindowIcon(WId win){
     }
     xcb_ewmh_get_wm_icon_reply_wipe(&reply);
   }
+  if(cached){
+    wincache[win].icon = icon;
+    wincache[win].valid |= C_ICON;
+  }
   return icon;
 }
 
@@ -952,69 +1159,63 @@ bool LXCB::UnembedWindow(WId win){
 
 // === TrayImage() ===
 QPixmap LXCB::TrayImage(WId win){
-  QPixmap pix;
-	
-  //Get the current QScreen (for XCB->Qt conversion)
-  QList<QScreen*> scrnlist = QApplication::screens();
-  if(scrnlist.isEmpty()){ return pix; }	
-
-  //Try to grab the given window directly with Qt
-  if(pix.isNull()){
-      pix = scrnlist[0]->grabWindow(win);
+  QImage img;
+  if(!TrayImageUpdate(win, img)){ return QPixmap(); }
+  return QPixmap::fromImage(img);
+}
+
+// === TrayImageUpdate() ===
+bool LXCB::TrayImageUpdate(WId win, QImage &image, QRect area){
+  //Note: The tray windows are redirected (composite), so the contents are read straight from their offscreen pixmap
+  xcb_connection_t *conn = QX11Info::connection();
+  xcb_get_geometry_reply_t *Greply = xcb_get_geometry_reply(conn, xcb_get_geometry_unchecked(conn, win), NULL);
+  if(Greply==0){ return false; } //window is gone
+  QSize size(Greply->width, Greply->height);
+  bool alpha = (Greply->depth==32);
+  free(Greply);
+  if(size.isEmpty()){ return false; }
+  if(area.isNull() || image.size()!=size){
+    image = QImage(size, alpha ? QImage::Format_ARGB32_Premultiplied : QImage::Format_RGB32);
+    area = QRect(QPoint(0,0), size);
+  }else{
+    area = area.intersected( QRect(QPoint(0,0), size) );
+    if(area.isEmpty()){ return true; } //nothing to refresh
+  }
+  //Get the pixmap from the XCB compositing layer
+  xcb_pixmap_t pixmap = xcb_generate_id(conn);
+  xcb_generic_error_t *err = xcb_request_check(conn, xcb_composite_name_window_pixmap_checked(conn, win, pixmap));
+  if(err!=0){ free(err); return false; } //not viewable (yet)
+  //Now read the image data
+  const uchar *data = 0;
+  uint bpl = 0; //bytes per line
+  xcb_shm_get_image_reply_t *SIreply = 0;
+  xcb_get_image_reply_t *GIreply = 0;
+  if(trayShmReserve(area.width()*area.height()*4)){
+    //Shared memory - no pixel data on the socket
+    SIreply = xcb_shm_get_image_reply(conn, xcb_shm_get_image_unchecked(conn, pixmap, area.x(), area.y(), area.width(), area.height(), \
+			0xffffffff, XCB_IMAGE_FORMAT_Z_PIXMAP, shmseg, 0), NULL);
+    if(SIreply!=0){ data = shmdata; bpl = SIreply->size / area.height(); }
+  }
+  if(data==0){
+    GIreply = xcb_get_image_reply(conn, xcb_get_image_unchecked(conn, XCB_IMAGE_FORMAT_Z_PIXMAP, pixmap, area.x(), area.y(), area.width(), area.height(), \
+			0xffffffff), NULL);
+    if(GIreply!=0){ data = xcb_get_image_data(GIreply); bpl = xcb_get_image_data_length(GIreply) / area.height(); }
+  }
+  bool ok = (data!=0 && bpl >= (uint) area.width()*4); //only 32 bits per pixel is handled
+  if(ok){
+    //Copy the area into the image
+    for(int y=0; y<area.height(); y++){
+      QRgb *line = ((QRgb*) image.scanLine(area.y()+y)) + area.x();
+      memcpy(line, data+(y*bpl), area.width()*4);
+      if(!alpha){
+        for(int x=0; x<area.width(); x++){ line[x] |= 0xff000000; } //no alpha channel in the window
+      }
+    }
   }
-  return pix;	
-  
-  //NOTE: Code below here saved for reference later (as necessary)
-  // -------------------------------
-  /*//First get the pixmap from the XCB compositing layer (since the tray images are redirected there)
-  xcb_pixmap_t pixmap = xcb_generate_id(QX11Info::connection());
-  xcb_composite_name_window_pixmap(QX11Info::connection(), win, pixmap);
-  //Get the sizing information about the pixmap
-  xcb_get_geometry_cookie_t Gcookie = xcb_get_geometry_unchecked(QX11Info::connection(), pixmap);
-  xcb_get_geometry_reply_t *Greply = xcb_get_geometry_reply(QX11Info::connection(), Gcookie, NULL);
-  if(Greply==0){ qDebug() << "[Tray Image] - Geom Fetch Error:"; return QPixmap(); } //Error in geometry detection
-  
-  //Now convert the XCB pixmap into an XCB image
-  xcb_get_image_cookie_t GIcookie = xcb_get_image_unchecked(QX11Info::connection(), XCB_IMAGE_FORMAT_Z_PIXMAP, pixmap, 0, 0, Greply->width, Greply->height, 0xffffffff);
-  xcb_get_image_reply_t *GIreply = xcb_get_image_reply(QX11Info::connection(), GIcookie, NULL);
-  if(GIreply==0){ qDebug() << "[Tray Image] - Image Convert Error:"; return QPixmap(); } //Error in conversion
-  uint8_t *GIdata = xcb_get_image_data(GIreply);
-  uint32_t BPL = xcb_get_image_data_length(GIreply) / Greply->height; //bytes per line
-  //Now convert the XCB image into a Qt Image
-  QImage image(const_cast<uint8_t *>(GIdata), Greply->width, Greply->height, BPL, QImage::Format_ARGB32_Premultiplied);
-  //Free the various data structures 
-  free(GIreply); //done with get image reply
-  xcb_free_pixmap(QX11Info::connection(), pixmap); //done with the raw pixmap
-  free(Greply); //done with geom reply*/
-  
-  /* NOTE: Found these little bit in the Qt sources - not sure if it is needed, but keep it here for reference
-        // we may have to swap the byte order based on system type
-        uint8_t image_byte_order = connection->setup()->image_byte_order;
-        if ((QSysInfo::ByteOrder == QSysInfo::LittleEndian && image_byte_order == XCB_IMAGE_ORDER_MSB_FIRST)
-            || (QSysInfo::ByteOrder == QSysInfo::BigEndian && image_byte_order == XCB_IMAGE_ORDER_LSB_FIRST))
-        {
-            for (int i=0; i < image.height(); i++) {
-                    uint *p = (uint*)image.scanLine(i);
-                    uint *end = p + image.width();
-                    while (p < end) {
-                        *p = ((*p << 24) & 0xff000000) | ((*p << 8) & 0x00ff0000)
-                            | ((*p >> 8) & 0x0000ff00) | ((*p >> 24) & 0x000000ff);
-                        p++;
-                    }
-            }
-        }*/
-
-        // fix-up alpha channel
-        /*if (image.format() == QImage::Format_RGB32) {
-            QRgb *p = (QRgb *)image.bits();
-            for (int y = 0; y < height; ++y) {
-                for (int x = 0; x < width; ++x)
-                    p[x] |= 0xff000000;
-                p += bytes_per_line / 4;
-            }*/
-
-  //Convert the QImage into a QPixmap and return it
-  //return QPixmap::fromImage(image.copy());
+  if(SIreply!=0){ free(SIreply); }
+  if(GIreply!=0){ free(GIreply); }
+  xcb_free_pixmap(conn, pixmap); //done with the raw pixmap
+  return ok;
 }
 
 // ===== startSystemTray() =====
@@ -1877,25 +2078,34 @@ void LXCB::WM_Set_Window_Type(WId win, QList<LXCB::WINDOWTYPE> list){
 
 // _NET_WM_STATE
 QList<LXCB::WINDOWSTATE> LXCB::WM_Get_Window_States(WId win){
+  if(isCachedWindow(win, C_STATES)){ return wincache.value(win).states; }
   QList<LXCB::WINDOWSTATE> out;
   xcb_get_property_cookie_t cookie = xcb_ewmh_get_wm_state_unchecked(&EWMH, win);
   xcb_ewmh_get_atoms_reply_t reply;
   if(1==xcb_ewmh_get_wm_state_reply(&EWMH, cookie, &reply, NULL) ){
-    for(unsigned int i=0; i<reply.atoms_len; i++){
-      if(reply.atoms[i]==EWMH._NET_WM_STATE_MODAL){ out << LXCB::S_MODAL; }
-      else if(reply.atoms[i]==EWMH._NET_WM_STATE_STICKY){ out << LXCB::S_STICKY; }
-      else if(reply.atoms[i]==EWMH._NET_WM_STATE_MAXIMIZED_VERT){ out << LXCB::S_MAX_VERT; }
-      else if(reply.atoms[i]==EWMH._NET_WM_STATE_MAXIMIZED_HORZ){ out << LXCB::S_MAX_HORZ; }
-      else if(reply.atoms[i]==EWMH._NET_WM_STATE_SHADED){ out << LXCB::S_SHADED; }
-      else if(reply.atoms[i]==EWMH._NET_WM_STATE_SKIP_TASKBAR){ out << LXCB::S_SKIP_TASKBAR; }
-      else if(reply.atoms[i]==EWMH._NET_WM_STATE_SKIP_PAGER){ out << LXCB::S_SKIP_PAGER; }
-      else if(reply.atoms[i]==EWMH._NET_WM_STATE_HIDDEN){ out << LXCB::S_HIDDEN; }
-      else if(reply.atoms[i]==EWMH._NET_WM_STATE_FULLSCREEN){ out << LXCB::S_FULLSCREEN; }
-      else if(reply.atoms[i]==EWMH._NET_WM_STATE_ABOVE){ out << LXCB::S_ABOVE; }
-      else if(reply.atoms[i]==EWMH._NET_WM_STATE_BELOW){ out << LXCB::S_BELOW; }
-      else if(reply.atoms[i]==EWMH._NET_WM_STATE_DEMANDS_ATTENTION){ out << LXCB::S_ATTENTION; }
-      //else if(reply.atoms[i]==EWMH._NET_WM_STATE_FOCUSED){ out << LXCB::FOCUSED; }
-    }
+    out = StatesFromAtoms(&reply);
+    xcb_ewmh_get_atoms_reply_wipe(&reply);
+  }
+  return out;
+}
+
+QList<LXCB::WINDOWSTATE> LXCB::StatesFromAtoms(xcb_ewmh_get_atoms_reply_t *preply){
+  //Convert the _NET_WM_STATE atoms into the internal list format
+  QList<LXCB::WINDOWSTATE> out;
+  for(unsigned int i=0; i<preply->atoms_len; i++){
+    if(preply->atoms[i]==EWMH._NET_WM_STATE_MODAL){ out << LXCB::S_MODAL; }
+    else if(preply->atoms[i]==EWMH._NET_WM_STATE_STICKY){ out << LXCB::S_STICKY; }
+    else if(preply->atoms[i]==EWMH._NET_WM_STATE_MAXIMIZED_VERT){ out << LXCB::S_MAX_VERT; }
+    else if(preply->atoms[i]==EWMH._NET_WM_STATE_MAXIMIZED_HORZ){ out << LXCB::S_MAX_HORZ; }
+    else if(preply->atoms[i]==EWMH._NET_WM_STATE_SHADED){ out << LXCB::S_SHADED; }
+    else if(preply->atoms[i]==EWMH._NET_WM_STATE_SKIP_TASKBAR){ out << LXCB::S_SKIP_TASKBAR; }
+    else if(preply->atoms[i]==EWMH._NET_WM_STATE_SKIP_PAGER){ out << LXCB::S_SKIP_PAGER; }
+    else if(preply->atoms[i]==EWMH._NET_WM_STATE_HIDDEN){ out << LXCB::S_HIDDEN; }
+    else if(preply->atoms[i]==EWMH._NET_WM_STATE_FULLSCREEN){ out << LXCB::S_FULLSCREEN; }
+    else if(preply->atoms[i]==EWMH._NET_WM_STATE_ABOVE){ out << LXCB::S_ABOVE; }
+    else if(preply->atoms[i]==EWMH._NET_WM_STATE_BELOW){ out << LXCB::S_BELOW; }
+    else if(preply->atoms[i]==EWMH._NET_WM_STATE_DEMANDS_ATTENTION){ out << LXCB::S_ATTENTION; }
+    //else if(preply->atoms[i]==EWMH._NET_WM_STATE_FOCUSED){ out << LXCB::FOCUSED; }
   }
   return out;
 }
@@ -2182,6 +2392,30 @@ uint64_t LXCB::WM_Get_Sync_Request_Counter(WId win){
   
 }*/
 
+void LXCB::WM_Send_Sync_Request(WId win, uint64_t value){
+  xcb_ewmh_send_wm_sync_request(&EWMH, win, EWMH.WM_PROTOCOLS, EWMH._NET_WM_SYNC_REQUEST, XCB_TIME_CURRENT_TIME, value);
+  xcb_flush(QX11Info::connection());
+}
+
+uint64_t LXCB::WM_Get_Sync_Counter_Value(uint64_t counter){
+  static bool syncinit = false;
+  if(!syncinit){
+    //The SYNC extension needs to be initialized once before it can be used
+    xcb_sync_initialize_reply_t *ireply = xcb_sync_initialize_reply(QX11Info::connection(), \
+			xcb_sync_initialize(QX11Info::connection(), XCB_SYNC_MAJOR_VERSION, XCB_SYNC_MINOR_VERSION), NULL);
+    if(ireply!=0){ free(ireply); }
+    syncinit = true;
+  }
+  uint64_t value = 0;
+  xcb_sync_query_counter_reply_t *reply = xcb_sync_query_counter_reply(QX11Info::connection(), \
+			xcb_sync_query_counter(QX11Info::connection(), counter), NULL);
+  if(reply!=0){
+    value = ( ((uint64_t) (uint32_t) reply->counter_value.hi) << 32) | reply->counter_value.lo;
+    free(reply);
+  }
+  return value;
+}
+
 // _NET_WM_FULLSCREEN_MONITORS
 QList<unsigned int> LXCB::WM_Get_Fullscreen_Monitors(WId win){
   //Returns: [top,bottom,left,right] monitor numbers for window to use when fullscreen
@@ -15,6 +15,7 @@
 #include <QString>
 #include <QPixmap>
 #include <QImage>
+#include <QRect>
 #include <QIcon>
 #include <QPixmap>
 #include <QX11Info>
@@ -22,6 +23,7 @@
 #include <QPainter>
 #include <QObject>
 #include <QFlags>
+#include <QHash>
 
 
 #include <xcb/xcb_ewmh.h>
@@ -108,6 +110,12 @@ public:
 	unsigned int NumberOfWorkspaces();
 	WId ActiveWindow(); //fetch the ID for the currently active window
 	
+	//Window-state cache (class, workspace, states, names, icon of the client windows)
+	// When enabled, the window information functions are answered from memory and fields are only
+	// re-fetched after WindowCacheEvent() reports a change to the associated property
+	void EnableWindowCache(bool enable = true);
+	void WindowCacheEvent(WId win, xcb_atom_t atom); //PropertyNotify for the window (root window properties included)
+
 	//Session Modification
 	bool CheckDisableXinerama(); //returns true if Xinerama was initially set but now disabled
 	void RegisterVirtualRoots(QList<WId> roots);
@@ -156,6 +164,9 @@ public:
 	uint EmbedWindow(WId win, WId container); //returns the damage ID (or 0 for an error)
 	bool UnembedWindow(WId win);
 	QPixmap TrayImage(WId win);
+	//Refresh an area of a tray image (the whole window if the area is null or the size changed)
+	// Note: Reads the composite pixmap of the window (through MIT-SHM when available)
+	bool TrayImageUpdate(WId win, QImage &image, QRect area = QRect()); //returns false if the window could not be read
 	
 	//System Tray Management
 	WId startSystemTray(int screen = 0); //Startup the system tray (returns window ID for tray)
@@ -389,8 +400,11 @@ public:
 	void WM_Send_Ping(WId win);
 	
 	// _NET_WM_SYNC_REQUEST
-	uint64_t WM_Get_Sync_Request_Counter(WId win);
+	// Note: Used during interactive resizes so a new size is only sent after the client finished drawing the last one
+	uint64_t WM_Get_Sync_Request_Counter(WId win); //Returns the ID of the XSync counter for the window (0 if not supported)
 	//void WM_Set_Sync_Request_Counter(WId win, uint64_t count);
+	void WM_Send_Sync_Request(WId win, uint64_t value); //client sets its counter to this value once it has redrawn
+	uint64_t WM_Get_Sync_Counter_Value(uint64_t counter); //Current value of an XSync counter
 	
 	// _NET_WM_FULLSCREEN_MONITORS
 	QList<unsigned int> WM_Get_Fullscreen_Monitors(WId win); //Returns: [top,bottom,left,right] monitor numbers for window to use when fullscreen
@@ -412,6 +426,34 @@ private:
 	QStringList atoms;
 
 	void createWMAtoms(); //fill the private lists above
+
+	//Shared memory segment for the tray images
+	int shmstate; //-1: not checked yet, 0: not available, 1: available
+	uint32_t shmseg;
+	uchar *shmdata;
+	uint shmsize;
+	bool trayShmReserve(uint bytes); //make sure the segment is at least this large
+
+	//Window-state cache
+	enum CACHE_FIELD {C_CLASS=1<<0, C_WORKSPACE=1<<1, C_STATES=1<<2, C_NAMES=1<<3, C_ICON=1<<4};
+	struct CachedWindow{
+	  int valid; //CACHE_FIELD flags which are current
+	  QString wclass, visiconname, iconname, visname, name, oldname, oldiconname;
+	  unsigned int workspace;
+	  QList<LXCB::WINDOWSTATE> states;
+	  QIcon icon;
+	  CachedWindow(){ valid = 0; workspace = 0; }
+	};
+	bool usecache, clientsvalid, workspacevalid, activevalid;
+	QList<WId> cachedclients;
+	unsigned int cachedworkspace;
+	WId cachedactive;
+	QHash<WId, CachedWindow> wincache;
+
+	QList<WId> CachedClientList(); //update the client list (if needed) and prune the cache
+	bool isCachedWindow(WId win, int fields); //make sure the fields are current (returns false if the window is not cached)
+	void fillWindowCache(QList<WId> wins, int fields); //pipelined batch fetch of any missing fields
+	QList<LXCB::WINDOWSTATE> StatesFromAtoms(xcb_ewmh_get_atoms_reply_t *reply);
 };
 //Now also declare the flags for Qt to be able to use normal operations on them
 Q_DECLARE_OPERATORS_FOR_FLAGS(LXCB::ICCCM_PROTOCOLS);
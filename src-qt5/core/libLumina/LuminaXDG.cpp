@@ -11,9 +11,434 @@
 #include <QTimer>
 #include <QMediaPlayer>
 #include <QSvgRenderer>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QVector>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QSet>
+#include <QImageReader>
 
-static QStringList mimeglobs;
-static qint64 mimechecktime;
+#include <algorithm>
+
+//=============================
+//  Compiled "globs2" mime database (internal only)
+//=============================
+struct MimeGlob{
+  int weight;
+  QString mime, pattern;
+  bool casesensitive; //"cs" flag from the globs2 file
+};
+
+struct MimeSuffixNode{
+  QHash<QChar, int> next; //lowercase character -> child node index
+  QList<int> globs; //globs which end on this node
+};
+
+class MimeGlobIndex{
+public:
+  QStringList sources; //<globs2 file>::::<mtime> (used to detect changes)
+  QStringList lines; //raw entries: <weight>:<mime type>:<pattern>
+  QList<MimeGlob> globs;
+  QHash<QString, QList<int> > literals; //full file names (lowercase) -> globs
+  QVector<MimeSuffixNode> suffixes; //reverse-character trie for "*<suffix>" patterns (node 0 is the root)
+  QList<int> wildcards; //prefix ("README*") and other wildcard patterns
+  QHash<QString, QStringList> mimepatterns; //mime type -> patterns
+  QStringList avpatterns; //all the audio/video patterns
+
+  MimeGlobIndex(){
+    suffixes.resize(1); //root node
+  }
+
+  void addGlob(QString line){
+    //Line format: <weight>:<mime type>:<pattern>[:<flags>]
+    MimeGlob glob;
+    glob.weight = line.section(":",0,0).toInt();
+    glob.mime = line.section(":",1,1);
+    glob.pattern = line.section(":",2,2);
+    glob.casesensitive = line.section(":",3,-1).split(",").contains("cs");
+    if(glob.mime.isEmpty() || glob.pattern.isEmpty()){ return; }
+    int index = globs.length();
+    globs << glob;
+    lines << line;
+    if(glob.mime.startsWith("audio/") || glob.mime.startsWith("video/")){ avpatterns << glob.pattern; }
+    mimepatterns[glob.mime] << glob.pattern;
+    //Now sort it into the proper lookup structure
+    QString tail = glob.pattern.mid(1);
+    if(!isWildcard(glob.pattern)){
+      literals[glob.pattern.toLower()] << index;
+    }else if(glob.pattern.startsWith("*") && !tail.isEmpty() && !isWildcard(tail)){
+      int node = 0;
+      for(int i=tail.length()-1; i>=0; i--){
+        QChar ch = tail[i].toLower();
+        int child = suffixes[node].next.value(ch, -1);
+        if(child<0){
+          child = suffixes.size();
+          suffixes.resize(child+1);
+          suffixes[node].next.insert(ch, child);
+        }
+        node = child;
+      }
+      suffixes[node].globs << index;
+    }else{
+      wildcards << index;
+    }
+  }
+
+  QList<int> match(QString filename) const{
+    //Exact file name matches first
+    QList<int> out = filterCase(literals.value(filename.toLower()), filename, true);
+    //Now walk the suffix tree from the end of the filename (longest suffix wins)
+    if(out.isEmpty()){
+      int node = 0;
+      for(int i=filename.length()-1; i>=0; i--){
+        node = suffixes.at(node).next.value(filename[i].toLower(), -1);
+        if(node<0){ break; }
+        QList<int> found = filterCase(suffixes.at(node).globs, filename, false);
+        if(!found.isEmpty()){ out = found; }
+      }
+    }
+    //Finally check all the prefix/wildcard patterns
+    if(out.isEmpty()){
+      for(int i=0; i<wildcards.length(); i++){
+        const MimeGlob &glob = globs.at(wildcards.at(i));
+        Qt::CaseSensitivity cs = glob.casesensitive ? Qt::CaseSensitive : Qt::CaseInsensitive;
+        QString prefix = glob.pattern.section("*",0,0);
+        if(!filename.startsWith(prefix, cs)){ continue; }
+        if(glob.pattern == prefix+"*" || QRegExp(glob.pattern, cs, QRegExp::WildcardUnix).exactMatch(filename) ){ out << wildcards[i]; }
+      }
+    }
+    //Sort the matches by weight (highest first)
+    for(int i=1; i<out.length(); i++){
+      for(int j=i; j>0 && globs.at(out[j]).weight > globs.at(out[j-1]).weight; j--){ out.swap(j, j-1); }
+    }
+    return out;
+  }
+
+private:
+  static bool isWildcard(QString pattern){
+    return (pattern.contains("*") || pattern.contains("?") || pattern.contains("[") );
+  }
+
+  QList<int> filterCase(QList<int> found, QString filename, bool literal) const{
+    //Case-sensitive globs take priority over case-insensitive ones
+    QList<int> cs, ci;
+    for(int i=0; i<found.length(); i++){
+      const MimeGlob &glob = globs.at(found[i]);
+      if(!glob.casesensitive){ ci << found[i]; }
+      else if(literal && filename==glob.pattern){ cs << found[i]; }
+      else if(!literal && filename.endsWith(glob.pattern.mid(1), Qt::CaseSensitive)){ cs << found[i]; }
+    }
+    return (cs.isEmpty() ? ci : cs);
+  }
+};
+
+static QSharedPointer<MimeGlobIndex> mimeindex;
+static qint64 mimechecktime = 0;
+static QMutex mimeindexlock;
+
+static QStringList mimeGlobFiles(){
+  //List all the globs2 files (in priority order)
+  QStringList files;
+  QStringList dirs = LXDG::systemMimeDirs();
+  for(int i=0; i<dirs.length(); i++){
+    if(QFile::exists(dirs[i]+"/globs2")){ files << dirs[i]+"/globs2"; }
+  }
+  if(files.isEmpty()){
+    //Could not find the mimetype database on the system - use the fallback file distributed with Lumina
+    files << LOS::LuminaShare()+"globs2";
+  }
+  return files;
+}
+
+static QSharedPointer<MimeGlobIndex> currentMimeIndex(){
+  QMutexLocker locker(&mimeindexlock);
+  //Only re-check the files on disk every 30 seconds, and only re-compile the index if one of them changed
+  if( !mimeindex.isNull() && (mimechecktime >= (QDateTime::currentMSecsSinceEpoch()-30000)) ){ return mimeindex; }
+  mimechecktime = QDateTime::currentMSecsSinceEpoch();
+  QStringList files = mimeGlobFiles();
+  QStringList sources;
+  for(int i=0; i<files.length(); i++){
+    sources << files[i]+"::::"+QString::number(QFileInfo(files[i]).lastModified().toMSecsSinceEpoch());
+  }
+  if(!mimeindex.isNull() && mimeindex->sources == sources){ return mimeindex; }
+  //qDebug() << "Compiling globs2 mime DB files:" << files;
+  QSharedPointer<MimeGlobIndex> index(new MimeGlobIndex());
+  index->sources = sources;
+  for(int i=0; i<files.length(); i++){
+    QFile file(files[i]);
+    if(!file.open(QIODevice::ReadOnly | QIODevice::Text)){ continue; }
+    QTextStream in(&file);
+    while(!in.atEnd()){
+      QString line = in.readLine().simplified();
+      if(!line.startsWith("#") && !line.isEmpty()){ index->addGlob(line); }
+    }
+    file.close();
+  }
+  mimeindex = index;
+  return mimeindex;
+}
+
+//=============================
+//  On-disk cache of parsed *.desktop files (internal only)
+//=============================
+// File format (QDataStream): <magic> <version> <locale>
+//   <number of dirs> [<dir path> <dir mtime> <file list>]...
+//   <number of files> [<file path> <file mtime> <record length> <record>]...
+//   <number of bad files> [<file path> <file mtime>]...
+#define DESKTOP_CACHE_MAGIC 0x4C44534B
+#define DESKTOP_CACHE_VERSION 2
+
+class XDGDesktopCache{
+public:
+  XDGDesktopCache(){
+    map = 0;
+    file.setFileName(XDGDesktopCache::cacheFile());
+    if(!file.open(QIODevice::ReadOnly)){ return; }
+    map = file.map(0, file.size());
+    if(map==0){ file.close(); return; }
+    QByteArray raw = QByteArray::fromRawData( (const char*)map, file.size());
+    QDataStream in(raw);
+      in.setVersion(QDataStream::Qt_5_0);
+    quint32 magic = 0, version = 0; QString locale;
+    in >> magic >> version >> locale;
+    if(magic!=DESKTOP_CACHE_MAGIC || version!=DESKTOP_CACHE_VERSION || locale!=QLocale::system().name()){ return; }
+    quint32 num = 0;
+    in >> num;
+    for(quint32 i=0; i<num && in.status()==QDataStream::Ok; i++){
+      QString dir; qint64 mtime; QStringList list;
+      in >> dir >> mtime >> list;
+      dirtimes.insert(dir, mtime);
+      dirfiles.insert(dir, list);
+    }
+    in >> num;
+    for(quint32 i=0; i<num && in.status()==QDataStream::Ok; i++){
+      QString path; qint64 mtime; quint32 length;
+      in >> path >> mtime >> length;
+      qint64 offset = in.device()->pos();
+      if(in.skipRawData(length) != (int) length){ break; }
+      filetimes.insert(path, mtime);
+      records.insert(path, QPair<qint64, quint32>(offset, length) );
+    }
+    in >> num;
+    for(quint32 i=0; i<num && in.status()==QDataStream::Ok; i++){
+      QString path; qint64 mtime;
+      in >> path >> mtime;
+      badtimes.insert(path, mtime);
+    }
+    if(in.status()!=QDataStream::Ok){ dirtimes.clear(); dirfiles.clear(); filetimes.clear(); records.clear(); badtimes.clear(); }
+  }
+  ~XDGDesktopCache(){
+    if(map!=0){ file.unmap(map); }
+  }
+
+  static QString cacheFile(){
+    QString dir = QString(getenv("XDG_CACHE_HOME")).section(":",0,0);
+    if(dir.isEmpty()){ dir = QDir::homePath()+"/.cache"; }
+    return (dir+"/lumina-desktop/desktopfiles.cache");
+  }
+
+  //Return the cached list of *.desktop files if the directory was not modified since the cache was written
+  bool cachedDirList(QString dir, qint64 mtime, QStringList *list){
+    if(!dirtimes.contains(dir) || dirtimes.value(dir)!=mtime){ return false; }
+    *list = dirfiles.value(dir);
+    return true;
+  }
+
+  //The file could not be used when the cache was written, and was not modified since then
+  bool isBad(QString path, qint64 mtime){
+    return (badtimes.contains(path) && badtimes.value(path)==mtime);
+  }
+
+  //Fill the structure from the cache if the file was not modified since the cache was written
+  bool load(XDGDesktop *desk, qint64 mtime){
+    if(!records.contains(desk->filePath) || filetimes.value(desk->filePath)!=mtime){ return false; }
+    QPair<qint64, quint32> rec = records.value(desk->filePath);
+    QByteArray raw = QByteArray::fromRawData( (const char*)map+rec.first, rec.second);
+    QDataStream in(raw);
+      in.setVersion(QDataStream::Qt_5_0);
+    qint32 type; quint32 nactions;
+    in >> type >> desk->name >> desk->genericName >> desk->comment >> desk->icon;
+    in >> desk->showInList >> desk->notShowInList >> desk->isHidden;
+    in >> desk->exec >> desk->tryexec >> desk->path >> desk->startupWM;
+    in >> desk->actionList >> desk->mimeList >> desk->catList >> desk->keyList;
+    in >> desk->useTerminal >> desk->startupNotify >> desk->useVGL >> desk->url;
+    in >> nactions;
+    desk->actions.clear();
+    for(quint32 i=0; i<nactions && in.status()==QDataStream::Ok; i++){
+      XDGDesktopAction act;
+      in >> act.ID >> act.name >> act.icon >> act.exec;
+      desk->actions << act;
+    }
+    if(in.status()!=QDataStream::Ok){ return false; }
+    desk->type = (XDGDesktop::XDGDesktopType) type;
+    desk->lastRead = QDateTime::currentDateTime();
+    return true;
+  }
+
+  //Write a new cache file (atomic replacement - multiple processes may share it)
+  static bool save(QStringList dirs, QHash<QString, qint64> dirtimes, QHash<QString, QStringList> dirfiles, QHash<QString, XDGDesktop*> files, QHash<QString, qint64> bad){
+    QString path = XDGDesktopCache::cacheFile();
+    QDir dir; dir.mkpath(path.section("/",0,-2));
+    QSaveFile sfile(path);
+    if(!sfile.open(QIODevice::WriteOnly)){ return false; }
+    QDataStream out(&sfile);
+      out.setVersion(QDataStream::Qt_5_0);
+    out << (quint32) DESKTOP_CACHE_MAGIC << (quint32) DESKTOP_CACHE_VERSION << QLocale::system().name();
+    out << (quint32) dirs.length();
+    for(int i=0; i<dirs.length(); i++){
+      out << dirs[i] << dirtimes.value(dirs[i]) << dirfiles.value(dirs[i]);
+    }
+    QStringList paths = files.keys();
+    out << (quint32) paths.length();
+    for(int i=0; i<paths.length(); i++){
+      XDGDesktop *desk = files.value(paths[i]);
+      QByteArray rec;
+      QDataStream recout(&rec, QIODevice::WriteOnly);
+        recout.setVersion(QDataStream::Qt_5_0);
+      recout << (qint32) desk->type << desk->name << desk->genericName << desk->comment << desk->icon;
+      recout << desk->showInList << desk->notShowInList << desk->isHidden;
+      recout << desk->exec << desk->tryexec << desk->path << desk->startupWM;
+      recout << desk->actionList << desk->mimeList << desk->catList << desk->keyList;
+      recout << desk->useTerminal << desk->startupNotify << desk->useVGL << desk->url;
+      recout << (quint32) desk->actions.length();
+      for(int a=0; a<desk->actions.length(); a++){
+        recout << desk->actions[a].ID << desk->actions[a].name << desk->actions[a].icon << desk->actions[a].exec;
+      }
+      out << paths[i] << QFileInfo(paths[i]).lastModified().toMSecsSinceEpoch() << (quint32) rec.size();
+      out.writeRawData(rec.constData(), rec.size());
+    }
+    paths = bad.keys();
+    out << (quint32) paths.length();
+    for(int i=0; i<paths.length(); i++){
+      out << paths[i] << bad.value(paths[i]);
+    }
+    return sfile.commit();
+  }
+
+private:
+  QFile file;
+  uchar *map;
+  QHash<QString, qint64> dirtimes, filetimes, badtimes;
+  QHash<QString, QStringList> dirfiles;
+  QHash<QString, QPair<qint64, quint32> > records; //file path -> (offset, length) of the record in the mapped file
+};
+
+//=============================
+//  Icon theme index and lookup cache (internal only)
+//=============================
+static QString iconindextheme; //theme that the index/cache were built for (empty: needs rebuild)
+static QHash<QString, QString> iconindex; //<search set>:<icon file name> -> absolute path (best size first)
+static QStringList iconpixmaps; //contents of the share/pixmaps directory
+static QHash<QString, QIcon> iconcache; //<icon>::::<fallback> -> icon
+static QHash<QString, bool> iconsvgcheck; //svg file -> can be used
+static QMutex iconlock;
+
+static void clearIconIndex(){
+  QMutexLocker locker(&iconlock);
+  iconindextheme.clear();
+}
+
+static void loadIconIndex(QString cTheme){
+  //Note: iconlock needs to be held by the caller
+  // - Get all the base icon directories
+  QStringList paths;
+    paths << QDir::homePath()+"/.icons/"; //ordered by priority - local user dirs first
+    QStringList xdd = QString(getenv("XDG_DATA_HOME")).split(":");
+      xdd << QString(getenv("XDG_DATA_DIRS")).split(":");
+      for(int i=0; i<xdd.length(); i++){
+        if(QFile::exists(xdd[i]+"/icons")){ paths << xdd[i]+"/icons/"; }
+      }
+  //Now load all the dirs into the search paths: "icontheme" "oxygen" and "fallback" sets
+  QStringList theme, oxy, fall;
+  for(int i=0; i<paths.length(); i++){
+    theme << LXDG::getChildIconDirs( paths[i]+cTheme);
+    oxy << LXDG::getChildIconDirs(paths[i]+"oxygen"); //Lumina base icon set
+    fall << LXDG::getChildIconDirs(paths[i]+"hicolor"); //XDG fallback (apps add to this)
+  }
+  //fall << LOS::AppPrefix()+"share/pixmaps"; //always use this as well as a final fallback
+  QDir::setSearchPaths("icontheme", theme);
+  QDir::setSearchPaths("oxygen", oxy);
+  QDir::setSearchPaths("fallback", fall);
+  //qDebug() << "Setting Icon Search Paths:" << "\nicontheme:" << theme << "\noxygen:" << oxy << "\nfallback:" << fall;
+  //Index the files in every directory (first directory wins - these are already sorted by size priority)
+  iconindex.clear();
+  QHash<QString, QStringList> sets;
+    sets.insert("icontheme", theme);
+    sets.insert("oxygen", oxy);
+    sets.insert("fallback", fall);
+  QStringList setnames = sets.keys();
+  for(int s=0; s<setnames.length(); s++){
+    QStringList dirs = sets.value(setnames[s]);
+    for(int d=0; d<dirs.length(); d++){
+      QDir dir(dirs[d]);
+      QStringList imgs = dir.entryList(QStringList() << "*.png" << "*.svg", QDir::Files | QDir::NoDotAndDotDot, QDir::NoSort);
+      for(int i=0; i<imgs.length(); i++){
+        QString key = setnames[s]+":"+imgs[i];
+        if(!iconindex.contains(key)){ iconindex.insert(key, dir.absoluteFilePath(imgs[i])); }
+      }
+    }
+  }
+  iconpixmaps = QDir(LOS::AppPrefix()+"share/pixmaps").entryList(QDir::Files | QDir::NoDotAndDotDot, QDir::NoSort);
+  iconcache.clear();
+  iconindextheme = cTheme;
+}
+
+static bool isUsableSVG(QString path){
+  //Note: iconlock needs to be held by the caller
+  if(iconsvgcheck.contains(path)){ return iconsvgcheck.value(path); }
+  //Check that it is version 1.1+ (Qt has issues with 1.0? (LibreOffice Icons) )
+  // - only the start of the file is needed for this
+  float version = 1.1; //only downgrade files that explicitly set the version as older
+  QFile file(path);
+  if(file.open(QIODevice::ReadOnly)){
+    QString svginfo = QString(file.read(4096)).section("<svg",1,1).section(">",0,0);
+    file.close();
+    svginfo.replace("\t"," "); svginfo.replace("\n"," ");
+    if(svginfo.contains(" version=")){ version = svginfo.section(" version=\"",1,1).section("\"",0,0).toFloat(); }
+  }
+  bool ok = (version>=1.1);
+  if(ok){
+    //Be careful about how an SVG is loaded - needs to render the image onto a paint device
+    QSvgRenderer svg;
+    ok = svg.load(path);
+    if(!ok){ qDebug() << "Found bad SVG file:" << path; }
+  }
+  iconsvgcheck.insert(path, ok);
+  return ok;
+}
+
+static QStringList findIconFiles(QString iconName){
+  //Note: iconlock needs to be held by the caller
+  QStringList files;
+  QStringList srch; srch << "icontheme" << "oxygen" << "fallback";
+  for(int i=0; i<srch.length() && files.isEmpty(); i++){
+    //Look for a svg first
+    QString file = iconindex.value(srch[i]+":"+iconName+".svg");
+    if(!file.isEmpty() && isUsableSVG(file) ){ files << file; } //could be loaded/parsed successfully
+    file = iconindex.value(srch[i]+":"+iconName+".png");
+    if(!file.isEmpty()){ files << file; } //simple PNG image
+  }
+  //If still no icon found, look for any image format in the "pixmaps" directory
+  if(files.isEmpty()){
+    QString pixdir = LOS::AppPrefix()+"share/pixmaps/";
+    if(iconpixmaps.contains(iconName)){
+      files << pixdir+iconName;
+    }else{
+      //Need to scan for any close match in the directory
+      QStringList formats = LUtils::imageExtensions();
+      QStringList found = iconpixmaps.filter(QRegExp("^"+QRegExp::escape(iconName), Qt::CaseInsensitive));
+      //Use the first one found that is a valid format
+      for(int i=0; i<found.length(); i++){
+        if( formats.contains(found[i].section(".",-1).toLower()) ){
+	  files << pixdir+found[i];
+	  break;
+	}
+      }
+    }
+  }
+  return files;
+}
 
 //=============================
 //  XDGDesktop CLASS
@@ -476,33 +901,60 @@ void XDGDesktopList::updateList(){
   bool appschanged = false;
   bool firstrun = lastCheck.isNull() || oldkeys.isEmpty();
   lastCheck = QDateTime::currentDateTime();
+  //On the first run, load the previously-parsed files from the on-disk cache
+  XDGDesktopCache *cache = firstrun ? new XDGDesktopCache() : 0;
+  bool cachechanged = (cache==0);
+  QHash<QString, qint64> dirtimes, bad;
+  QHash<QString, QStringList> dirfiles;
   //Variables for internal loop use only (to prevent re-initializing variable on every iteration)
-  bool ok; QString path; QDir dir;  QStringList apps;
+  bool ok; QString path; QDir dir;  QStringList apps; qint64 mtime;
   for(int i=0; i<appDirs.length(); i++){
     if( !dir.cd(appDirs[i]) ){ continue; } //could not open dir for some reason
-    apps = dir.entryList(QStringList() << "*.desktop",QDir::Files, QDir::Name);
+    dirtimes.insert(appDirs[i], QFileInfo(appDirs[i]).lastModified().toMSecsSinceEpoch());
+    if(cache==0 || !cache->cachedDirList(appDirs[i], dirtimes[appDirs[i]], &apps) ){
+      apps = dir.entryList(QStringList() << "*.desktop",QDir::Files, QDir::Name);
+      cachechanged = true;
+    }
+    dirfiles.insert(appDirs[i], apps);
     for(int a=0; a<apps.length(); a++){
       path = dir.absoluteFilePath(apps[a]);
-      if(files.contains(path) && (files.value(path)->lastRead>QFileInfo(path).lastModified()) ){ 
+      QDateTime modified = QFileInfo(path).lastModified();
+      if(files.contains(path) && (files.value(path)->lastRead>modified) ){ 
         //Re-use previous data for this file (nothing changed)
         found << files[path]->name;  //keep track of which files were already found
         ok=true;
       }else{
       	ok=false;
         if(files.contains(path)){ appschanged = true; files.take(path)->deleteLater(); } //files.remove(path); }
-      	XDGDesktop *dFile = new XDGDesktop(path, this); //will change the "ok" variable as needed
+        mtime = modified.toMSecsSinceEpoch();
+        if( (badFiles.contains(path) && badFiles.value(path)==mtime) || (cache!=0 && cache->isBad(path, mtime)) ){
+          //Known bad file which was not modified since then - do not parse it again
+          bad.insert(path, mtime);
+          oldkeys.removeAll(path);
+          continue;
+        }
+        XDGDesktop *dFile = new XDGDesktop("", this);
+        dFile->filePath = path;
+        if(cache==0 || !cache->load(dFile, mtime)){ 
+          dFile->sync(); //parse the file itself
+          cachechanged = true;
+        }
         if(dFile->type!=XDGDesktop::BAD){
           appschanged = true; //flag that something changed - needed to load a file
           if(!oldkeys.contains(path)){ newfiles << path; } //brand new file (not an update to a previously-read file)
           files.insert(path, dFile);
           found << dFile->name;
         }else{
+          bad.insert(path, mtime);
           dFile->deleteLater(); //bad file - discard it
         }
       }
       oldkeys.removeAll(path); //make sure this key does not get cleaned up later
     } //end loop over apps
   } //end loop over appDirs
+  if(cache!=0){ delete cache; }
+  bool badchanged = (bad!=badFiles);
+  badFiles = bad; //files which are gone are dropped from the list too
   //Save the extra info to the internal lists
   if(!firstrun){ 
     removedApps = oldkeys;//files which were removed
@@ -515,6 +967,12 @@ void XDGDesktopList::updateList(){
     //files.remove(oldkeys[i]);
     files.take(oldkeys[i])->deleteLater();
   }
+  //Update the on-disk cache if anything had to be re-read
+  if(cachechanged && (appschanged || badchanged || firstrun) ){
+    XDGDesktopCache::save(appDirs, dirtimes, dirfiles, files, badFiles);
+  }
+  //New/updated applications might have installed new icons as well
+  if(appschanged && !firstrun){ clearIconIndex(); }
   //If this class is automatically managing the lists, update the watched files/dirs and send out notifications
   if(watcher!=0){
     if(appschanged){ qDebug() << "Auto App List Update:" << lastCheck  << "Files Found:" << files.count(); }
@@ -540,10 +998,207 @@ QList<XDGDesktop*> XDGDesktopList::apps(bool showAll, bool showHidden){
   return out;
 }
 
+//==== XDGAppIndex Functions ====
+//Score for a word found in each of the fields
+#define APPINDEX_NAME 100
+#define APPINDEX_GENERIC 60
+#define APPINDEX_KEYWORD 50
+#define APPINDEX_EXEC 40
+#define APPINDEX_COMMENT 20
+
+struct XDGAppMatch{
+  int score;
+  QString name;
+  XDGDesktop *desk;
+};
+
+static bool appMatchLessThan(const XDGAppMatch &a, const XDGAppMatch &b){
+  if(a.score != b.score){ return (a.score > b.score); }
+  return (a.name < b.name);
+}
+
+static QStringList appIndexWords(QString text){
+  return text.toLower().split(QRegExp("[^\\w]+"), QString::SkipEmptyParts);
+}
+
+//Check for a single typo (one letter wrong, missing, extra, or swapped with the next one)
+static bool withinOneEdit(const QString &a, const QString &b){
+  int la = a.length(), lb = b.length();
+  if(qAbs(la-lb)>1){ return false; }
+  int i=0;
+  while(i<la && i<lb && a[i]==b[i]){ i++; }
+  if(i==la && i==lb){ return true; } //identical
+  if(la==lb){
+    if( a.midRef(i+1)==b.midRef(i+1) ){ return true; }
+    return ( i+1<la && a[i]==b[i+1] && a[i+1]==b[i] && a.midRef(i+2)==b.midRef(i+2) );
+  }else if(la>lb){
+    return ( a.midRef(i+1)==b.midRef(i) );
+  }
+  return ( a.midRef(i)==b.midRef(i+1) );
+}
+
+XDGAppIndex::XDGAppIndex(){
+
+}
+
+XDGAppIndex::~XDGAppIndex(){
+
+}
+
+void XDGAppIndex::update(QList<XDGDesktop*> apps){
+  QSet<QString> current;
+  for(int i=0; i<apps.length(); i++){
+    QString path = apps[i]->filePath;
+    current << path;
+    int id = ids.value(path, -1);
+    if(id>=0){
+      if(entries[id].desk==apps[i] && entries[id].lastRead==apps[i]->lastRead){ continue; } //nothing changed
+      removeApp(id);
+    }
+    if(freeIDs.isEmpty()){ id = entries.size(); entries.resize(id+1); }
+    else{ id = freeIDs.takeLast(); }
+    ids.insert(path, id);
+    addApp(id, apps[i]);
+  }
+  //Now remove any apps which are gone
+  QStringList paths = ids.keys();
+  for(int i=0; i<paths.length(); i++){
+    if(!current.contains(paths[i])){ removeApp( ids.take(paths[i]) ); }
+  }
+}
+
+QList<XDGDesktop*> XDGAppIndex::search(QString text, int max){
+  QList<XDGDesktop*> out;
+  QStringList words = appIndexWords(text);
+  if(words.isEmpty()){ return out; }
+  QHash<int,int> scores; //app ID -> score
+  for(int w=0; w<words.length(); w++){
+    QString word = words[w];
+    QHash<int,int> found; //app ID -> best score for this word
+    //Whole words and the start of words
+    QMap<QString, QList<TokenHit> >::const_iterator it = tokens.lowerBound(word);
+    for( ; it!=tokens.constEnd() && it.key().startsWith(word); ++it){
+      addHits(found, it.value(), (it.key().length()==word.length()) ? 100 : 75);
+    }
+    //Typos in longer words (only checks the words starting with the same letter)
+    if(word.length()>=4){
+      it = tokens.lowerBound(word.left(1));
+      for( ; it!=tokens.constEnd() && it.key().startsWith(word[0]); ++it){
+        if(it.key().startsWith(word)){ continue; } //already found
+        if( withinOneEdit(it.key(), word) || (it.key().length()>word.length() && withinOneEdit(it.key().left(word.length()), word)) ){
+          addHits(found, it.value(), 50);
+        }
+      }
+    }
+    //Part of a longer name (like "office" in "libreoffice")
+    if(word.length()>=3){
+      for(int i=0; i<entries.size(); i++){
+        if(entries[i].desk!=0 && !found.contains(i) && entries[i].name.contains(word)){ found.insert(i, APPINDEX_NAME/2); }
+      }
+    }
+    //Every word needs to match
+    if(w==0){ scores = found; }
+    else{
+      QHash<int,int> both;
+      for(QHash<int,int>::const_iterator s = scores.constBegin(); s!=scores.constEnd(); ++s){
+        if(found.contains(s.key())){ both.insert(s.key(), s.value()+found.value(s.key())); }
+      }
+      scores = both;
+    }
+    if(scores.isEmpty()){ return out; }
+  }
+  //Now rank the matches (extra points for the full search matching the start of the name)
+  QString full = words.join(" ");
+  QList<XDGAppMatch> matches;
+  for(QHash<int,int>::const_iterator s = scores.constBegin(); s!=scores.constEnd(); ++s){
+    XDGAppMatch match;
+      match.score = s.value();
+      match.name = entries[s.key()].name;
+      match.desk = entries[s.key()].desk;
+    if(match.name==full){ match.score+= 1000; }
+    else if(match.name.startsWith(full)){ match.score+= 300; }
+    matches << match;
+  }
+  std::sort(matches.begin(), matches.end(), appMatchLessThan);
+  for(int i=0; i<matches.length() && (max<0 || i<max); i++){ out << matches[i].desk; }
+  return out;
+}
+
+// === PRIVATE ===
+void XDGAppIndex::addApp(int id, XDGDesktop *desk){
+  AppEntry &entry = entries[id];
+  entry.desk = desk;
+  entry.lastRead = desk->lastRead;
+  entry.name = desk->name.toLower();
+  entry.words.clear();
+  QStringList fields; QList<int> weights;
+  fields << desk->name << desk->genericName << desk->keyList.join(" ") << desk->exec.section(" ",0,0,QString::SectionSkipEmpty).section("/",-1) << desk->comment;
+  weights << APPINDEX_NAME << APPINDEX_GENERIC << APPINDEX_KEYWORD << APPINDEX_EXEC << APPINDEX_COMMENT;
+  for(int f=0; f<fields.length(); f++){
+    QStringList words = appIndexWords(fields[f]);
+    for(int w=0; w<words.length(); w++){
+      QList<TokenHit> &hits = tokens[words[w]];
+      //Only keep the best field for each word (this app is always the last one in the list)
+      if(!hits.isEmpty() && hits.last().app==id){
+        if(hits.last().weight < weights[f]){ hits.last().weight = weights[f]; }
+        continue;
+      }
+      TokenHit hit;
+        hit.app = id;
+        hit.weight = weights[f];
+      hits << hit;
+      entry.words << words[w];
+    }
+  }
+}
+
+void XDGAppIndex::removeApp(int id){
+  AppEntry &entry = entries[id];
+  for(int w=0; w<entry.words.length(); w++){
+    QMap<QString, QList<TokenHit> >::iterator it = tokens.find(entry.words[w]);
+    if(it==tokens.end()){ continue; }
+    for(int h=it.value().length()-1; h>=0; h--){
+      if(it.value()[h].app==id){ it.value().removeAt(h); }
+    }
+    if(it.value().isEmpty()){ tokens.erase(it); }
+  }
+  entry.desk = 0;
+  entry.words.clear();
+  entry.name.clear();
+  freeIDs << id;
+}
+
+void XDGAppIndex::addHits(QHash<int,int> &found, const QList<TokenHit> &hits, int percent){
+  for(int i=0; i<hits.length(); i++){
+    int score = (hits[i].weight*percent)/100;
+    if(found.value(hits[i].app, -1) < score){ found.insert(hits[i].app, score); }
+  }
+}
+
 //==== LFileInfo Functions ====
+//  Per-directory cache of the extra file information (internal only)
+struct LFileInfoExtra{
+  QString mime, icon;
+  qint64 mtime; //modification time of the file when the info was loaded
+};
+static QHash<QString, QHash<QString, LFileInfoExtra> > fileinfocache; //directory -> (file name -> info)
+static QStringList fileinfodirs; //directories in the cache (most recently used last)
+static QMutex fileinfolock;
+
+//Note: fileinfolock needs to be locked before calling this
+static QHash<QString, LFileInfoExtra>* fileInfoCache(QString dir){
+  if(fileinfodirs.isEmpty() || fileinfodirs.last()!=dir){
+    fileinfodirs.removeAll(dir);
+    fileinfodirs << dir;
+    //Only keep the last few directories around
+    if(fileinfodirs.length()>16){ fileinfocache.remove(fileinfodirs.takeFirst()); }
+  }
+  return &fileinfocache[dir];
+}
+
 //Need some extra information not usually available by a QFileInfo
 void LFileInfo::loadExtraInfo(){
-  desk = 0;
+  extraloaded = true;
   //Now load the extra information
   if(this->isDir()){
     mime = "inode/directory";
@@ -559,40 +1214,70 @@ void LFileInfo::loadExtraInfo(){
     else if(name=="documents"){ icon = "folder-documents"; }
     else if(name=="images" || name=="pictures"){ icon = "folder-image"; }
     else if( !this->isReadable() ){ icon = "folder-locked"; }
-  }else if( this->suffix()=="desktop"){
+    return;
+  }
+  //See if this file was already looked at (and has not changed since then)
+  bool cacheable = this->exists();
+  QString dir = this->absolutePath();
+  qint64 mtime = cacheable ? this->lastModified().toMSecsSinceEpoch() : 0;
+  if(cacheable){
+    QMutexLocker locker(&fileinfolock);
+    QHash<QString, LFileInfoExtra> *cache = fileInfoCache(dir);
+    QHash<QString, LFileInfoExtra>::const_iterator it = cache->constFind(this->fileName());
+    if(it!=cache->constEnd() && it.value().mtime==mtime){
+      mime = it.value().mime;
+      icon = it.value().icon;
+      return;
+    }
+  }
+  if( this->suffix()=="desktop"){
     mime = "application/x-desktop";
     icon = "application-x-desktop"; //default value
-    desk = new XDGDesktop(this->absoluteFilePath(), 0);
-    if(desk->type!=XDGDesktop::BAD){
+    XDGDesktop *xdg = this->XDG();
+    if(xdg->type!=XDGDesktop::BAD){
       //use the specific desktop file info (if possible)
-      if(!desk->icon.isEmpty()){ icon = desk->icon; }
+      if(!xdg->icon.isEmpty()){ icon = xdg->icon; }
     }
-  }else{
-    //Generic file, just determine the mimetype
+  }else if(mime.isEmpty()){
+    //Generic file, just determine the mimetype (if not given ahead of time)
     mime = LXDG::findAppMimeForFile(this->fileName());
   }
+  if(cacheable){
+    LFileInfoExtra extra;
+      extra.mime = mime;
+      extra.icon = icon;
+      extra.mtime = mtime;
+    QMutexLocker locker(&fileinfolock);
+    fileInfoCache(dir)->insert(this->fileName(), extra);
+  }
 }
 LFileInfo::LFileInfo(){
-  desk = 0;
+  extraloaded = false;
 }
 LFileInfo::LFileInfo(QString filepath){ //overloaded contructor
   this->setFile(filepath);
-  loadExtraInfo();
+  extraloaded = false;
 }	
 LFileInfo::LFileInfo(QFileInfo info){ //overloaded contructor
   this->swap(info); //use the given QFileInfo without re-loading it
-  loadExtraInfo();
+  extraloaded = false;
 }		
 
 //Functions for accessing the extra information
 // -- Return the mimetype for the file
 QString LFileInfo::mimetype(){
+  if(!extraloaded){ loadExtraInfo(); }
   if(mime=="inode/directory"){ return ""; }
   else{ return mime; }
 }
 
+void LFileInfo::setMimetype(QString mimetype){
+  if(!extraloaded){ mime = mimetype; }
+}
+
 // -- Return the icon to use for this file
 QString LFileInfo::iconfile(){
+  if(!extraloaded){ loadExtraInfo(); }
   if(!icon.isEmpty()){
     return icon;
   }else{
@@ -609,23 +1294,28 @@ QString LFileInfo::iconfile(){
 
 // -- Check if this is an XDG desktop file
 bool LFileInfo::isDesktopFile(){
-  if(desk==0){ return false; }
-  return (!desk->filePath.isEmpty());	
+  return ( !this->filePath().isEmpty() && !this->isDir() && this->suffix()=="desktop" );
 }
 
 // -- Allow access to the XDG desktop data structure
 XDGDesktop* LFileInfo::XDG(){
-  return desk;
+  //Only parse the file when the structure is actually needed (no file yet: new/empty structure)
+  if(desk.isNull() && (this->isDesktopFile() || this->filePath().isEmpty()) ){
+    desk = QSharedPointer<XDGDesktop>(new XDGDesktop(this->filePath().isEmpty() ? "" : this->absoluteFilePath(), 0), &QObject::deleteLater);
+  }
+  return desk.data();
 }
 
 // -- Check if this is a readable image file (for thumbnail support)
 bool LFileInfo::isImage(){
+  if(!extraloaded){ loadExtraInfo(); }
   if(!mime.startsWith("image/")){ return false; } //quick return for non-image files
   //Check the Qt subsystems to see if this image file can be read
   return ( !LUtils::imageExtensions().filter(this->suffix().toLower()).isEmpty() );
 }
 
 bool LFileInfo::isAVFile(){
+  if(!extraloaded){ loadExtraInfo(); }
   return (mime.startsWith("audio/") || mime.startsWith("video/") );
 }
 
@@ -768,92 +1458,55 @@ QIcon LXDG::findIcon(QString iconName, QString fallback){
     QIcon::setThemeName("oxygen"); 
     cTheme = "oxygen";	  
   }
-  //Make sure the current search paths correspond to this theme
-  if( QDir::searchPaths("icontheme").filter("/"+cTheme+"/").isEmpty() ){
-    //Need to reset search paths: setup the "icontheme" "oxygen" and "fallback" sets
-    // - Get all the base icon directories
-    QStringList paths;
-      paths << QDir::homePath()+"/.icons/"; //ordered by priority - local user dirs first
-      QStringList xdd = QString(getenv("XDG_DATA_HOME")).split(":");
-        xdd << QString(getenv("XDG_DATA_DIRS")).split(":");
-        for(int i=0; i<xdd.length(); i++){
-          if(QFile::exists(xdd[i]+"/icons")){ paths << xdd[i]+"/icons/"; }
-        }
-    //Now load all the dirs into the search paths
-    QStringList theme, oxy, fall;
-    for(int i=0; i<paths.length(); i++){
-      theme << getChildIconDirs( paths[i]+cTheme);
-      oxy << getChildIconDirs(paths[i]+"oxygen"); //Lumina base icon set
-      fall << getChildIconDirs(paths[i]+"hicolor"); //XDG fallback (apps add to this)
-    }
-    //fall << LOS::AppPrefix()+"share/pixmaps"; //always use this as well as a final fallback
-    QDir::setSearchPaths("icontheme", theme);
-    QDir::setSearchPaths("oxygen", oxy);
-    QDir::setSearchPaths("fallback", fall);
-    //qDebug() << "Setting Icon Search Paths:" << "\nicontheme:" << theme << "\noxygen:" << oxy << "\nfallback:" << fall;
-  }
+  QMutexLocker locker(&iconlock);
+  //Make sure the index corresponds to this theme (this also resets the cache)
+  if(cTheme != iconindextheme){ loadIconIndex(cTheme); }
+  //Check for a previous lookup of the same icon
+  QString cachekey = iconName+"::::"+fallback;
+  if(iconcache.contains(cachekey)){ return iconcache.value(cachekey); }
   //Find the icon in the search paths
   QIcon ico;
-  QStringList srch; srch << "icontheme" << "oxygen" << "fallback";
-  for(int i=0; i<srch.length() && ico.isNull(); i++){
-    //Look for a svg first
-    if(QFile::exists(srch[i]+":"+iconName+".svg") ){
-        //Be careful about how an SVG is loaded - needs to render the image onto a paint device
-        QSvgRenderer svg;
-        if( svg.load(srch[i]+":"+iconName+".svg") ){
-	  //Could be loaded - now check that it is version 1.1+ (Qt has issues with 1.0? (LibreOffice Icons) )
-	  float version = 1.1; //only downgrade files that explicitly set the version as older
-	  QString svginfo = LUtils::readFile(srch[i]+":"+iconName+".svg").join("\n").section("<svg",1,1).section(">",0,0);
-	  svginfo.replace("\t"," "); svginfo.replace("\n"," ");
-	  if(svginfo.contains(" version=")){ version = svginfo.section(" version=\"",1,1).section("\"",0,0).toFloat(); }
-	  if(version>=1.1){
-            ico.addFile(srch[i]+":"+iconName+".svg"); //could be loaded/parsed successfully
-	  }else{
-	    //qDebug() << "Old SVG Version file:" << iconName+".svg  Theme:" << srch[i];
-	    //qDebug() << "SVGInfo:" << svginfo;
-	  }
-        }else{
-          qDebug() << "Found bad SVG file:" << iconName+".svg  Theme:" << srch[i];
-        }
-    }
-    if(QFile::exists(srch[i]+":"+iconName+".png")){
-      //simple PNG image - load directly into the QIcon structure
-      ico.addFile(srch[i]+":"+iconName+".png");
-    }
-    
-  }
-  //If still no icon found, look for any image format in the "pixmaps" directory
-  if(ico.isNull()){
-    if(QFile::exists(LOS::AppPrefix()+"share/pixmaps/"+iconName)){
-      ico.addFile(LOS::AppPrefix()+"share/pixmaps/"+iconName);
-    }else{
-      //Need to scan for any close match in the directory
-      QDir pix(LOS::AppPrefix()+"share/pixmaps");
-      QStringList formats = LUtils::imageExtensions();
-      QStringList found = pix.entryList(QStringList() << iconName, QDir::Files, QDir::Unsorted);
-      if(found.isEmpty()){ found = pix.entryList(QStringList() << iconName+"*", QDir::Files, QDir::Unsorted); }
-      //qDebug() << "Found pixmaps:" << found << formats;
-      //Use the first one found that is a valid format
-      for(int i=0; i<found.length(); i++){
-        if( formats.contains(found[i].section(".",-1).toLower()) ){
-	  ico.addFile( pix.absoluteFilePath(found[i]) );
-	  break;
-	}
-      }
-      
-    }
-  }
+  QStringList files = findIconFiles(iconName);
+  for(int i=0; i<files.length(); i++){ ico.addFile(files[i]); }
   //Use the fallback icon if necessary
   if(ico.isNull() && !fallback.isEmpty()){
+    locker.unlock();
     ico = LXDG::findIcon(fallback,"");	  
+    locker.relock();
   }
   if(ico.isNull()){
     qDebug() << "Could not find icon:" << iconName << fallback;
   }
+  //Save this result for later (only if the theme was not changed in the meantime)
+  if(cTheme == iconindextheme){ iconcache.insert(cachekey, ico); }
   //Return the icon
   return ico;
 }
 
+QImage LXDG::findIconImage(QString iconName, QString fallback, int size){
+  //Same search as findIcon(), but the file is decoded directly at the requested size
+  QStringList files;
+  if(QFile::exists(iconName) && iconName.startsWith("/")){ files << iconName; }
+  else{
+    if(iconName.startsWith("/")){ iconName = iconName.section("/",-1); } //Invalid absolute path, just look for the icon
+    QString cTheme = QIcon::themeName();
+    if(cTheme.isEmpty()){ cTheme = "oxygen"; }
+    QMutexLocker locker(&iconlock);
+    if(cTheme != iconindextheme){ loadIconIndex(cTheme); }
+    if(!iconName.isEmpty()){ files = findIconFiles(iconName); }
+  }
+  for(int i=0; i<files.length(); i++){
+    QImageReader reader(files[i]);
+    QSize fullsize = reader.size();
+    if(fullsize.isValid() && size>0 && fullsize!=QSize(size,size) ){ reader.setScaledSize( fullsize.scaled(size, size, Qt::KeepAspectRatio) ); }
+    QImage img;
+    if(reader.read(&img)){ return img; }
+  }
+  //Use the fallback icon if necessary
+  if(!fallback.isEmpty()){ return LXDG::findIconImage(fallback, "", size); }
+  return QImage();
+}
+
 QStringList LXDG::getChildIconDirs(QString parent){
   //This is a recursive function that returns the absolute path(s) of directories with *.png files
   QDir D(parent);
@@ -906,59 +1559,24 @@ QIcon LXDG::findMimeIcon(QString extension){
   return ico;
 }
 
-QString LXDG::findAppMimeForFile(QString filename, bool multiple){
+//Note: Internal version which uses the given mime index
+static QString mimeForFile(MimeGlobIndex *index, QString filename, bool multiple){
   QString out;
-  QString extension = filename.section(".",1,-1);
-  if("."+extension == filename){ extension.clear(); } //hidden file without extension
-  //qDebug() << "MIME SEARCH:" << filename << extension;
-  QStringList mimefull = LXDG::loadMimeFileGlobs2();
-  QStringList mimes;
   //Just in case the filename is a mimetype itself
-  if( mimefull.filter(":"+filename+":").length() == 1){
-    return filename;
-  }
-while(mimes.isEmpty()){
-  //Check for an exact mimetype match
-  if(mimefull.filter(":"+extension+":").length() == 1){
-    return extension;
-  }
-  //Look for globs at the end of the filename
-  if(!extension.isEmpty()){ 
-    mimes = mimefull.filter(":*."+extension); 
-    //If nothing found, try a case-insensitive search
-    if(mimes.isEmpty()){ mimes = mimefull.filter(":*."+extension, Qt::CaseInsensitive); }
-    //Now ensure that the filter was accurate (*.<extention>.<something> will still be caught)
-    for(int i=0; i<mimes.length(); i++){
-      if(!filename.endsWith( mimes[i].section(":*",-1), Qt::CaseInsensitive )){ mimes.removeAt(i); i--; }
-      else if(mimes[i].section(":",0,0).length()==2){ mimes[i].prepend("0"); } //ensure 3-character priority number
-      else if(mimes[i].section(":",0,0).length()==1){ mimes[i].prepend("00"); } //ensure 3-character priority number
-    }
-  }
-  //Look for globs at the start of the filename
-  if(mimes.isEmpty()){ 
-    mimes = mimefull.filter(":"+filename.left(2)); //look for the first 2 characters initially
-	//Note: This initial filter will only work if the wildcard (*) is not within the first 2 characters of the pattern
-    //Now ensure that the filter was accurate
-    for(int i=0; i<mimes.length(); i++){
-      if(!filename.startsWith( mimes[i].section(":",3,-1,QString::SectionSkipEmpty).section("*",0,0), Qt::CaseInsensitive )){ mimes.removeAt(i); i--; }
-    }
-  }
-    if(mimes.isEmpty()){
-      if(extension.contains(".")){ extension = extension.section(".",1,-1); }
-      else{ break; }
-    }
-  } //end of mimes while loop
-  mimes.sort(); //this automatically puts them in reverse weight order (100 on down)
+  if( index->mimepatterns.contains(filename) ){ return filename; }
+  //qDebug() << "MIME SEARCH:" << filename;
+  QList<int> found = index->match(filename);
   QStringList matches;
-  //qDebug() << "Mimes:" << mimes;
-  for(int m=mimes.length()-1; m>=0; m--){
-    QString mime = mimes[m].section(":",1,1,QString::SectionSkipEmpty);
-    matches << mime;
+  for(int i=0; i<found.length(); i++){
+    QString mime = index->globs.at(found[i]).mime;
+    if(!matches.contains(mime)){ matches << mime; }
   }
   //qDebug() << "Matches:" << matches;
   if(multiple && !matches.isEmpty() ){ out = matches.join("::::"); }
   else if( !matches.isEmpty() ){ out = matches.first(); }
   else{ //no mimetype found - assign one (internal only - no system database changes)
+    QString extension = filename.section(".",1,-1);
+    if("."+extension == filename){ extension.clear(); } //hidden file without extension
     if(extension.isEmpty()){ out = "unknown/"+filename.toLower(); }
     else{ out = "unknown/"+extension.toLower(); }
   }
@@ -966,12 +1584,25 @@ while(mimes.isEmpty()){
   return out;
 }
 
-QStringList LXDG::findFilesForMime(QString mime){
+QString LXDG::findAppMimeForFile(QString filename, bool multiple){
+  return mimeForFile(currentMimeIndex().data(), filename, multiple);
+}
+
+QStringList LXDG::findAppMimeForFiles(QFileInfoList files){
+  //Same rules as LFileInfo, but only check the mime database once for the whole list
+  QSharedPointer<MimeGlobIndex> index = currentMimeIndex();
   QStringList out;
-  QStringList mimes = LXDG::loadMimeFileGlobs2().filter(mime);
-  for(int i=0; i<mimes.length(); i++){
-    out << mimes[i].section(":",2,2); // "*.<extension>"
+  for(int i=0; i<files.length(); i++){
+    if(files[i].isDir()){ out << "inode/directory"; }
+    else if(files[i].suffix()=="desktop"){ out << "application/x-desktop"; }
+    else{ out << mimeForFile(index.data(), files[i].fileName(), false); }
   }
+  return out;
+}
+
+QStringList LXDG::findFilesForMime(QString mime){
+  QStringList out = currentMimeIndex()->mimepatterns.value(mime); // "*.<extension>"
+  out.removeDuplicates();
   //qDebug() << "Mime to Files:" << mime << out;
   return out;
 }
@@ -1182,48 +1813,16 @@ void LXDG::setDefaultAppForMime(QString mime, QString app){
 
 QStringList LXDG::findAVFileExtensions(){
   //output format: QDir name filter for valid A/V file extensions
-  QStringList globs = LXDG::loadMimeFileGlobs2();
-  QStringList av = globs.filter(":audio/");
-  av << globs.filter(":video/");
-  for(int i=0; i<av.length(); i++){
-    //Just use all audio/video mimetypes (for now)
-    av[i] = av[i].section(":",2,2);
-    //Qt5 Auto detection (broken - QMediaPlayer seg faults with Qt 5.3 - 11/24/14)
-    /*if( QMultimedia::NotSupported != QMediaPlayer::hasSupport(av[i].section(":",1,1)) ){ av[i] = av[i].section(":",2,2); }
-    else{ av.removeAt(i); i--; }*/
-  }
+  //Just use all audio/video mimetypes (for now)
+  //Qt5 Auto detection (broken - QMediaPlayer seg faults with Qt 5.3 - 11/24/14)
+  QStringList av = currentMimeIndex()->avpatterns;
   av.removeDuplicates();
   return av;
 }
 
 QStringList LXDG::loadMimeFileGlobs2(){
   //output format: <weight>:<mime type>:<file extension (*.something)>
-  if(mimeglobs.isEmpty() || (mimechecktime < (QDateTime::currentMSecsSinceEpoch()-30000)) ){
-    //qDebug() << "Loading globs2 mime DB files";
-    mimeglobs.clear();
-    mimechecktime = QDateTime::currentMSecsSinceEpoch(); //save the current time this was last checked
-    QStringList dirs = LXDG::systemMimeDirs();
-    for(int i=0; i<dirs.length(); i++){
-      if(QFile::exists(dirs[i]+"/globs2")){
-        QFile file(dirs[i]+"/globs2");
-        if(!file.exists()){ continue; }
-        if(!file.open(QIODevice::ReadOnly | QIODevice::Text)){ continue; }
-        QTextStream in(&file);
-        while(!in.atEnd()){
-          QString line = in.readLine();
-          if(!line.startsWith("#")){
-            mimeglobs << line.simplified();
-          }
-        }
-	file.close();
-      }
-      if(i==dirs.length()-1 && mimeglobs.isEmpty()){
-        //Could not find the mimetype database on the system - use the fallback file distributed with Lumina
-        dirs << LOS::LuminaShare();
-      }
-    }//end loop over dirs
-  }
-  return mimeglobs;
+  return currentMimeIndex()->lines;
 }
 
 //Find all the autostart *.desktop files
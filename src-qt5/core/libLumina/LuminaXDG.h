@@ -24,11 +24,15 @@
 #include <QStringList>
 #include <QString>
 #include <QIcon>
+#include <QImage>
 #include <QList>
 #include <QHash>
+#include <QMap>
+#include <QVector>
 #include <QLocale>
 #include <QTextStream>
 #include <QDateTime>
+#include <QSharedPointer>
 #include <QDebug>
 
 
@@ -110,6 +114,7 @@ private:
 	QFileSystemWatcher *watcher;
 	QTimer *synctimer;
 	bool keepsynced;
+	QHash<QString, qint64> badFiles; //<filepath>/<mtime> of files which could not be used (skipped until modified)
 
 private slots:
 	void watcherChanged();
@@ -117,14 +122,52 @@ signals:
 	void appsUpdated();
 };
 
+// ========================
+//  Ranked search index for a list of applications
+//   (name, generic name, keywords, executable and comment)
+// ========================
+class XDGAppIndex{
+public:
+	XDGAppIndex();
+	~XDGAppIndex();
+
+	//Sync the index with a list of apps (only new/changed entries get re-indexed)
+	//NOTE: The structures are not copied - sync again whenever the list changes (XDGDesktopList::appsUpdated)
+	void update(QList<XDGDesktop*> apps);
+	//Find the apps which match the search terms (best match first, max<0: all matches)
+	QList<XDGDesktop*> search(QString text, int max = -1);
+
+private:
+	struct AppEntry{
+	  XDGDesktop *desk; //0 for an unused ID
+	  QDateTime lastRead;
+	  QString name; //lowercase
+	  QStringList words; //tokens which point to this app
+	};
+	struct TokenHit{
+	  int app, weight;
+	};
+	QVector<AppEntry> entries; //app ID -> entry
+	QList<int> freeIDs;
+	QHash<QString, int> ids; //file path -> app ID
+	QMap<QString, QList<TokenHit> > tokens; //sorted for prefix lookups
+
+	void addApp(int id, XDGDesktop *desk);
+	void removeApp(int id);
+	void addHits(QHash<int,int> &found, const QList<TokenHit> &hits, int percent);
+};
+
 // ========================
 // File Information simplification class (combine QFileInfo with XDGDesktop)
 //  Need some extra information not usually available by a QFileInfo
 // ========================
+//  NOTE: The extra information is only loaded the first time it is used
+//    (and is shared between all the files in the same directory)
 class LFileInfo : public QFileInfo{
 private:
 	QString mime, icon;
-	XDGDesktop *desk;
+	bool extraloaded;
+	QSharedPointer<XDGDesktop> desk; //shared between copies of this file info
 
 	void loadExtraInfo();
 	
@@ -133,13 +176,13 @@ public:
 	LFileInfo();
 	LFileInfo(QString filepath);
 	LFileInfo(QFileInfo info);
-	~LFileInfo(){ 
-	  desk->deleteLater(); 
-	}
+	~LFileInfo(){}
 	
 	//Functions for accessing the extra information
 	// -- Return the mimetype for the file
 	QString mimetype();
+	// -- Use a mimetype which was already found for this file (LXDG::findAppMimeForFiles())
+	void setMimetype(QString mimetype);
 	
 	// -- Return the icon file to use for this file
 	QString iconfile(); //Note: This string is auto-formatted for use in the LXDG::findIcon() routine.
@@ -185,6 +228,8 @@ public:
 	static void setEnvironmentVars();
 	//Find an icon from the current/default theme
 	static QIcon findIcon(QString iconName, QString fallback = "");
+	//Load an icon image at the given size (safe to use in a worker thread - no QIcon/QPixmap involved)
+	static QImage findIconImage(QString iconName, QString fallback, int size);
 	//Recursivly compile a list of child directories with *.png files in them
 	static QStringList getChildIconDirs(QString parent);
 	//List all the mime-type directories
@@ -193,6 +238,8 @@ public:
 	static QIcon findMimeIcon(QString extension);
 	//Find the mime-type of a particular file extension
 	static QString findAppMimeForFile(QString filename, bool multiple = false);
+	//Find the mime-types for a whole list of files at once (same order as the input)
+	static QStringList findAppMimeForFiles(QFileInfoList files);
 	//Find the file extension for a particular mime-type
 	static QStringList findFilesForMime(QString mime);
 	// Simplification function for finding all info regarding current mime defaults
@@ -32,6 +32,7 @@ public:
 	~AppMenu();
 
 	QHash<QString, QList<XDGDesktop*> > *currentAppHash();
+	XDGAppIndex *currentAppIndex(); //for searching the apps
 	QDateTime lastHashUpdate;
 
 private:
@@ -40,6 +41,7 @@ private:
 	QList<QMenu> MLIST;
 	XDGDesktopList *sysApps;
 	QHash<QString, QList<XDGDesktop*> > APPS;
+	XDGAppIndex APPINDEX;
 
 	void updateAppList(); //completely update the menu lists
 
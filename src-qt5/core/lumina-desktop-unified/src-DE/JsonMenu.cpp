@@ -0,0 +1,141 @@
+//===========================================
+//  Lumina Desktop source code
+//  Copyright (c) 2016, Ken Moore
+//  Available under the 3-clause BSD license
+//  See the LICENSE file for full details
+//===========================================
+#include "JsonMenu.h"
+
+#include <QHash>
+#include <QStyle>
+#include <QtConcurrent>
+
+//Last output of each script (shared by all the menus which use the same script)
+struct JsonMenuCache{
+  QDateTime time;
+  QList<JsonMenuItem> items;
+};
+static QHash<QString, JsonMenuCache> menucache;
+
+JsonMenu::JsonMenu(QString execpath, QWidget *parent) : QMenu(parent){
+  exec = execpath;
+  cmd = 0;
+  parser = new QFutureWatcher< QList<JsonMenuItem> >(this);
+  connect(parser, SIGNAL(finished()), this, SLOT(parseFinished()) );
+  connect(this, SIGNAL(aboutToShow()), this, SLOT(aboutToShowMenu()) );
+  connect(this, SIGNAL(triggered(QAction*)), this, SLOT(itemTriggered(QAction*)) );
+  if(outdated()){ fetch(); } //have the output ready before the menu gets opened
+}
+
+JsonMenu::~JsonMenu(){
+  if(cmd!=0){ cmd->cancel(); }
+}
+
+// === PRIVATE ===
+bool JsonMenu::outdated(){
+  if(!menucache.contains(exec)){ return true; }
+  int secs = LSession::handle()->sessionSettings()->value("JsonMenuCacheSecs", JSONMENU_CACHE).toInt();
+  return (menucache.value(exec).time.secsTo(QDateTime::currentDateTime()) >= secs);
+}
+
+void JsonMenu::fetch(){
+  if(cmd!=0 || parser->isRunning()){ return; } //already refreshing
+  cmd = LCommand::run(exec, QStringList(), JSONMENU_TIMEOUT);
+  connect(cmd, SIGNAL(finished(int, QStringList)), this, SLOT(scriptFinished(int, QStringList)) );
+}
+
+void JsonMenu::fillMenu(){
+  //Remove the old sub-menus too (not removed by clear())
+  QList<JsonMenu*> menus = this->findChildren<JsonMenu*>(QString(), Qt::FindDirectChildrenOnly);
+  for(int i=0; i<menus.length(); i++){ menus[i]->deleteLater(); }
+  this->clear();
+  if(!menucache.contains(exec)){
+    filled = QDateTime();
+    this->addAction( tr("Loading...") )->setEnabled(false);
+    return;
+  }
+  filled = menucache.value(exec).time;
+  QList<JsonMenuItem> items = menucache.value(exec).items;
+  for(int i=0; i<items.length(); i++){
+    if(items[i].type=="error"){
+      this->addAction( QString(tr("Error parsing script output: %1")).arg("\n"+exec) )->setEnabled(false);
+    }else if(items[i].type=="item"){
+      QAction *act = this->addAction(items[i].label);
+      if(!items[i].icon.isNull()){ act->setIcon( QIcon(QPixmap::fromImage(items[i].icon)) ); }
+      if(!items[i].action.isEmpty()){ act->setWhatsThis(items[i].action); }
+      else{ act->setEnabled(false); } //not interactive
+    }else if(items[i].type=="jsonmenu"){
+      //This is a recursive JSON menu object
+      JsonMenu *menu = new JsonMenu(items[i].exec, this);
+        menu->setTitle(items[i].label);
+        if(!items[i].icon.isNull()){ menu->setIcon( QIcon(QPixmap::fromImage(items[i].icon)) ); }
+      this->addMenu(menu);
+    }
+  }
+}
+
+QList<JsonMenuItem> JsonMenu::parseOutput(QString output, int iconsize){
+  //Note: This is run in a worker thread (icon files get loaded here too)
+  QList<JsonMenuItem> items;
+  QJsonDocument doc = QJsonDocument::fromJson( output.toLocal8Bit() );
+  if(doc.isNull() || !doc.isObject()){
+    JsonMenuItem err;
+      err.type = "error";
+    items << err;
+    return items;
+  }
+  QStringList keys = doc.object().keys();
+  for(int i=0; i<keys.length(); i++){
+    if(keys[i].isEmpty() || !doc.object().value(keys[i]).isObject()){ continue; }
+    QJsonObject obj = doc.object().value(keys[i]).toObject();
+    JsonMenuItem item;
+      item.type = obj.value("type").toString().toLower();
+      item.label = keys[i];
+    if(item.type=="item"){
+      if(obj.contains("action")){ item.action = obj.value("action").toString(); }
+    }else if(item.type=="jsonmenu"){
+      if(!obj.contains("exec")){ continue; }
+      item.exec = obj.value("exec").toString();
+    }else{
+      continue; //"menu" is not supported yet
+    }
+    if(obj.contains("icon")){ item.icon = LXDG::findIconImage(obj.value("icon").toString(), "", iconsize); }
+    items << item;
+  }
+  return items;
+}
+
+// === PRIVATE SLOTS ===
+void JsonMenu::aboutToShowMenu(){
+  //Show whatever is available right now, and refresh it in the background as needed
+  if(!menucache.contains(exec) || menucache.value(exec).time!=filled){ fillMenu(); }
+  if(outdated()){ fetch(); }
+}
+
+void JsonMenu::scriptFinished(int retcode, QStringList output){
+  bool timedout = cmd->timedOut();
+  cmd = 0; //deletes itself
+  if(timedout && menucache.contains(exec)){
+    qDebug() << "JSON menu script timed out (keeping the last output):" << exec;
+    return;
+  }
+  Q_UNUSED(retcode); //scripts are not required to return 0 (only the output matters)
+  int iconsize = this->style()->pixelMetric(QStyle::PM_SmallIconSize);
+  parser->setFuture( QtConcurrent::run(&JsonMenu::parseOutput, output.join(" "), iconsize) );
+}
+
+void JsonMenu::parseFinished(){
+  JsonMenuCache data;
+    data.time = QDateTime::currentDateTime();
+    data.items = parser->result();
+  menucache.insert(exec, data);
+  if(this->isVisible()){ fillMenu(); } //otherwise it is updated the next time it is opened
+}
+
+void JsonMenu::itemTriggered(QAction *act){
+  if(act->parent()!=this || act->whatsThis().isEmpty() ){ return; } //only handle direct child actions - needed for recursive nature of menu
+  QString cmd = act->whatsThis();
+  QString bin = cmd.section(" ",0,0);
+  if( !LUtils::isValidBinary(bin) ){ cmd.prepend("lumina-open "); }
+  LSession::handle()->LaunchApplication(cmd);
+}
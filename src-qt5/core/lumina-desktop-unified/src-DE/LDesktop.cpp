@@ -223,6 +223,7 @@ void LDesktop::InitDesktop(){
     connect(QApplication::instance(), SIGNAL(DesktopFilesChanged()), this, SLOT(UpdateDesktop()) );
     connect(QApplication::instance(), SIGNAL(LocaleChanged()), this, SLOT(LocaleChanged()) );
     connect(QApplication::instance(), SIGNAL(WorkspaceChanged()), this, SLOT(UpdateBackground()) );
+    connect(LBackgroundCache::instance(), SIGNAL(loaded(QString)), this, SLOT(BackgroundLoaded(QString)) );
   //if(DEBUG){ qDebug() << "Create bgWindow"; }
   /*bgWindow = new QWidget(); //LDesktopBackground();
 	bgWindow->setObjectName("bgWindow");
@@ -532,8 +533,12 @@ void LDesktop::UpdateBackground(){
   //Now set this file as the current background
   QString format = settings->value(DPREFIX+"background/format","stretch").toString();
   //bgWindow->setBackground(bgFile, format);
-  QPixmap backPix = LDesktopBackground::setBackground(bgFile, format, LSession::handle()->screenGeom(Screen()));
-  bgDesktop->setBackground(backPix);
+  //Note: The background is prepared in a worker thread (and shared with any other screens of the same size)
+  QSize size = LSession::handle()->screenGeom(Screen()).size();
+  bgKey = LBackgroundCache::instance()->key(bgFile, format, size);
+  QPixmap backPix = LBackgroundCache::instance()->pixmap(bgKey);
+  if(!backPix.isNull()){ bgDesktop->setBackground(backPix); }
+  else{ LBackgroundCache::instance()->load(bgFile, format, size); } //BackgroundLoaded() is called when finished
   //Now reset the timer for the next change (if appropriate)
   if(bgtimer->isActive()){ bgtimer->stop(); }
   if(bgL.length() > 1){
@@ -551,3 +556,9 @@ void LDesktop::UpdateBackground(){
   }
   bgupdating=false;
 }
+
+void LDesktop::BackgroundLoaded(QString key){
+  if(key!=bgKey || bgDesktop==0){ return; } //for a different screen/background
+  bgDesktop->setBackground( LBackgroundCache::instance()->pixmap(key) );
+  for(int i=0; i<PANELS.length(); i++){ PANELS[i]->update(); }
+}
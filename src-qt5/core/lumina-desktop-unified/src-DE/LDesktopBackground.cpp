@@ -9,9 +9,19 @@
 #include <QPainter>
 #include <QPaintEvent>
 #include <QDebug>
+#include <QImageReader>
+#include <QFile>
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QDateTime>
+#include <QCryptographicHash>
+#include <QtConcurrent>
 
 #include "LSession.h"
 
+#define BG_CACHE_FILES 50 //number of rendered backgrounds to keep on disk
+
 void LDesktopBackground::paintEvent(QPaintEvent *ev) {
   //return; //do nothing - always invisible
     if (bgPixmap != NULL) {
@@ -25,59 +35,72 @@ void LDesktopBackground::paintEvent(QPaintEvent *ev) {
 }
 
 QPixmap LDesktopBackground::setBackground(const QString& bgFile, const QString& format, QRect geom) {
-    //if (bgPixmap != NULL) delete bgPixmap;
-    QPixmap bgPixmap(geom.size());// = new QPixmap(size());
+    return QPixmap::fromImage( renderBackground(bgFile, format, geom.size()) );
+}
+
+QImage LDesktopBackground::renderBackground(QString bgFile, QString format, QSize size) {
+    //Note: This is run in a worker thread - only use QImage here (not QPixmap)
+    QImage bgImage(size, QImage::Format_RGB32);
 
     if (bgFile.startsWith("rgb(")) {
         QStringList colors = bgFile.section(")",0,0).section("(",1,1).split(",");
         QColor color = QColor(colors[0].toInt(), colors[1].toInt(), colors[2].toInt());
-        bgPixmap.fill(color);
+        bgImage.fill(color);
     } else {
-        bgPixmap.fill(Qt::black);
-
-        // Load the background file and scale
-        QPixmap bgImage(bgFile);
-        if (format == "stretch" || format == "full" || format == "fit") {
-            Qt::AspectRatioMode mode;
-            if (format == "stretch") {
-                mode = Qt::IgnoreAspectRatio;
-            } else if (format == "full") {
-                mode = Qt::KeepAspectRatioByExpanding;
+        bgImage.fill(Qt::black);
+
+        // Load the background file (already scaled while decoding if possible)
+        QImageReader reader(bgFile);
+        bool scale = (format == "stretch" || format == "full" || format == "fit");
+        Qt::AspectRatioMode mode;
+        if (format == "stretch") {
+            mode = Qt::IgnoreAspectRatio;
+        } else if (format == "full") {
+            mode = Qt::KeepAspectRatioByExpanding;
+        } else {
+            mode = Qt::KeepAspectRatio;
+        }
+        QSize fileSize = reader.size();
+        if (scale && fileSize.isValid()) {
+            if (fileSize.height() != size.height() && fileSize.width() != size.width()) {
+                reader.setScaledSize( fileSize.scaled(size, mode) );
             } else {
-                mode = Qt::KeepAspectRatio;
+                scale = false; //already the right size
             }
-            if(bgImage.height() != geom.height() && bgImage.width() != geom.width() ){ bgImage = bgImage.scaled(geom.size(), mode);  }
-            //bgImage = bgImage.scaled(size(), mode);
+        }
+        QImage img = reader.read();
+        if (img.isNull()) { return bgImage; } //could not read the file
+        if (scale && !fileSize.isValid() && img.height() != size.height() && img.width() != size.width()) {
+            //Reader could not tell the size ahead of time - scale it now
+            img = img.scaled(size, mode, Qt::SmoothTransformation);
         }
 
         // Calculate the offset
         int dx = 0, dy = 0;
-        int drawWidth = bgImage.width(), drawHeight = bgImage.height();
+        int drawWidth = img.width(), drawHeight = img.height();
         if (format == "fit" || format == "center" || format == "full") {
-            dx = (geom.width() - bgImage.width()) / 2;
-            dy = (geom.height() - bgImage.height()) / 2;
+            dx = (size.width() - img.width()) / 2;
+            dy = (size.height() - img.height()) / 2;
         } else if (format == "tile") {
-            drawWidth = geom.width();
-            drawHeight = geom.height();
+            drawWidth = size.width();
+            drawHeight = size.height();
         } else {
             if (format.endsWith("right")) {
-                dx = geom.width() - bgImage.width();
+                dx = size.width() - img.width();
             }
             if (format.startsWith("bottom")) {
-                dy = geom.height() - bgImage.height();
+                dy = size.height() - img.height();
             }
         }
 
         // Draw the background image
-        QPainter painter(&bgPixmap);
-        painter.setBrush(bgImage);
+        QPainter painter(&bgImage);
+        painter.setPen(Qt::NoPen);
+        painter.setBrush(img);
         painter.setBrushOrigin(dx, dy);
         painter.drawRect(dx, dy, drawWidth, drawHeight);
     }
-    //this->repaint(); //make sure the entire thing gets repainted right away
-   //LSession::handle()->XCB->paintRoot(geom, &bgPixmap);
-    return bgPixmap;
-    //show();
+    return bgImage;
 }
 
 LDesktopBackground::LDesktopBackground() : QWidget() {
@@ -88,3 +111,86 @@ LDesktopBackground::LDesktopBackground() : QWidget() {
 LDesktopBackground::~LDesktopBackground() {
     if (bgPixmap != NULL) delete bgPixmap;
 }
+
+// ===================
+//   LBackgroundCache
+// ===================
+LBackgroundCache* LBackgroundCache::instance(){
+  static LBackgroundCache *cache = 0;
+  if(cache==0){ cache = new LBackgroundCache(); }
+  return cache;
+}
+
+LBackgroundCache::LBackgroundCache() : QObject(){
+
+}
+
+LBackgroundCache::~LBackgroundCache(){
+
+}
+
+QString LBackgroundCache::key(QString bgFile, QString format, QSize size){
+  QString sz = QString::number(size.width())+"x"+QString::number(size.height());
+  if(bgFile.startsWith("rgb(")){ return bgFile+"::::"+sz; } //format does not matter for a solid color
+  QString mtime = QString::number( QFileInfo(bgFile).lastModified().toMSecsSinceEpoch() );
+  return bgFile+"::::"+mtime+"::::"+sz+"::::"+format;
+}
+
+QPixmap LBackgroundCache::pixmap(QString key){
+  return pixmaps.value(key, QPixmap());
+}
+
+void LBackgroundCache::load(QString bgFile, QString format, QSize size){
+  QString id = key(bgFile, format, size);
+  if(pixmaps.contains(id)){ emit loaded(id); return; }
+  if(loading.contains(id)){ return; } //already being loaded for another screen
+  QString cacheFile;
+  if(!bgFile.startsWith("rgb(")){
+    cacheFile = cacheDir()+QCryptographicHash::hash(id.toUtf8(), QCryptographicHash::Md5).toHex()+".jpg";
+  }
+  QFutureWatcher<QImage> *watcher = new QFutureWatcher<QImage>(this);
+  connect(watcher, SIGNAL(finished()), this, SLOT(imageReady()) );
+  loading.insert(id, watcher);
+  watcher->setFuture( QtConcurrent::run(&LBackgroundCache::prepareImage, bgFile, format, size, cacheFile) );
+}
+
+// === PRIVATE ===
+QString LBackgroundCache::cacheDir(){
+  QString dir = QString(getenv("XDG_CACHE_HOME")).section(":",0,0);
+  if(dir.isEmpty()){ dir = QDir::homePath()+"/.cache"; }
+  return (dir+"/lumina-desktop/wallpapers/");
+}
+
+QImage LBackgroundCache::prepareImage(QString bgFile, QString format, QSize size, QString cacheFile){
+  //Note: This is run in a worker thread
+  if(!cacheFile.isEmpty() && QFile::exists(cacheFile)){
+    QImage img(cacheFile);
+    if(img.size()==size){ return img; } //rendered previously
+  }
+  QImage img = LDesktopBackground::renderBackground(bgFile, format, size);
+  if(!cacheFile.isEmpty()){
+    QDir dir(cacheDir());
+    if(!dir.exists()){ dir.mkpath(cacheDir()); }
+    QSaveFile save(cacheFile); //another session never reads a partial image
+    if(save.open(QIODevice::WriteOnly) && img.save(&save, "JPG", 95)){ save.commit(); }
+    //Only keep the most recent files
+    QFileInfoList files = dir.entryInfoList(QStringList() << "*.jpg", QDir::Files, QDir::Time);
+    for(int i=BG_CACHE_FILES; i<files.length(); i++){ QFile::remove(files[i].absoluteFilePath()); }
+  }
+  return img;
+}
+
+// === PRIVATE SLOTS ===
+void LBackgroundCache::imageReady(){
+  QFutureWatcher<QImage> *watcher = static_cast<QFutureWatcher<QImage>*>(sender());
+  QString id = loading.key(watcher);
+  loading.remove(id);
+  //Drop any backgrounds which are not shown anymore (nothing else is using that pixmap)
+  QStringList keys = pixmaps.keys();
+  for(int i=0; i<keys.length(); i++){
+    if(pixmaps[keys[i]].isDetached()){ pixmaps.remove(keys[i]); }
+  }
+  if(!id.isEmpty()){ pixmaps.insert(id, QPixmap::fromImage(watcher->result())); }
+  watcher->deleteLater();
+  if(!id.isEmpty()){ emit loaded(id); }
+}
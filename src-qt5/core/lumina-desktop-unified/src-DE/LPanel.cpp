@@ -7,6 +7,7 @@
 #include "LPanel.h"
 #include "LSession.h"
 #include <QScreen>
+#include <LTimerService.h>
 
 #include "panel-plugins/systemtray/LSysTray.h"
 
@@ -299,6 +300,7 @@ void LPanel::UpdatePanel(bool geomonly){
   this->update();
   this->show(); //make sure the panel is visible now
   if(hidden){ this->move(hidepoint); }
+  LTimerService::instance()->setPaused(this, hidden); //no periodic plugin updates while tucked away
   //Now go through and send the orientation update signal to each plugin
   for(int i=0; i<PLUGINS.length(); i++){
     QTimer::singleShot(0,PLUGINS[i], SLOT(OrientationChange()));
@@ -333,6 +335,7 @@ void LPanel::checkPanelFocus(){
       this->setMinimumSize(sz);
       this->setMaximumSize(sz);
       this->setGeometry( QRect(hidepoint, sz) );
+      LTimerService::instance()->setPaused(this, true);
     }
     //Re-active the old window
     if(LSession::handle()->activeWindow()!=0){
@@ -343,6 +346,7 @@ void LPanel::checkPanelFocus(){
       this->setMinimumSize(sz);
       this->setMaximumSize(sz);
       this->setGeometry( QRect(showpoint, sz) );
+      LTimerService::instance()->setPaused(this, false); //plugins catch up right away
   }  
 }
 
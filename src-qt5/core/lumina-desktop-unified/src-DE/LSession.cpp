@@ -16,6 +16,8 @@
 //LibLumina X11 class
 #include <LuminaX11.h>
 #include <LUtils.h>
+#include <LCommand.h>
+#include <LTimerService.h>
 
 #include <unistd.h> //for usleep() usage
 
@@ -46,6 +48,9 @@ LSession::LSession(int &argc, char ** argv) : LSingleApplication(argc, argv, "lu
   lastActiveWin = 0; 
   cleansession = true;
   TrayStopping = false;
+  ssaverWatch = 0;
+  ssaverDelay = SSAVER_RESTART;
+  ssaverPending = false;
   screenTimer = new QTimer(this);
     screenTimer->setSingleShot(true);
     screenTimer->setInterval(50);
@@ -186,6 +191,7 @@ void LSession::CleanupSession(){
   if( playaudio ){ playAudioFile(LOS::LuminaShare()+"Logout.ogg"); }
   //Stop the background system tray (detaching/closing apps as necessary)
   stopSystemTray(!cleansession);
+  if(ssaverWatch!=0){ ssaverWatch->disconnect(); ssaverWatch->kill(); ssaverWatch = 0; }
   //Now perform any other cleanup
   if(cleansession){
     //Close any open windows
@@ -259,10 +265,49 @@ void LSession::NewCommunication(QStringList list){
   }	  
 }
 
+void LSession::screensaverEvent(){
+  //One line per event: "BLANK <time>", "LOCK <time>", "UNBLANK <time>", "RUN <n>"
+  QStringList lines = QString(ssaverWatch->readAllStandardOutput()).split("\n", QString::SkipEmptyParts);
+  for(int i=0; i<lines.length(); i++){
+    QString event = lines[i].section(" ",0,0).simplified();
+    if(event=="BLANK" || event=="LOCK"){ LTimerService::instance()->setBlanked(true); }
+    else if(event=="UNBLANK"){ LTimerService::instance()->setBlanked(false); }
+  }
+}
+
+void LSession::startScreensaverWatch(){
+  ssaverPending = false;
+  if(ssaverWatch==0 || ssaverWatch->state()!=QProcess::NotRunning){ return; } //session is closing, or still running
+  ssaverStarted = QDateTime::currentDateTime();
+  ssaverWatch->start("xscreensaver-command -watch", QIODevice::ReadOnly);
+}
+
+void LSession::screensaverWatchStopped(){
+  //Note: a crash gives both the error() and finished() signals (the process is still flagged as running for the first)
+  if(ssaverWatch==0 || ssaverPending || ssaverWatch->state()!=QProcess::NotRunning){ return; }
+  ssaverPending = true;
+  LTimerService::instance()->setBlanked(false); //unknown now - do not leave everything paused
+  //Back off while it keeps failing (xscreensaver not running yet/anymore)
+  if(ssaverStarted.secsTo(QDateTime::currentDateTime()) >= SSAVER_STABLE){ ssaverDelay = SSAVER_RESTART; }
+  qDebug() << "xscreensaver watcher stopped - restarting in" << ssaverDelay << "seconds";
+  QTimer::singleShot(ssaverDelay*1000, this, SLOT(startScreensaverWatch()) );
+  ssaverDelay = qMin(ssaverDelay*2, SSAVER_RESTART_MAX);
+}
+
 void LSession::launchStartupApps(){
   //First start any system-defined startups, then do user defined
   qDebug() << "Launching startup applications";
 
+  //Watch for the screen getting blanked (no periodic updates of the visuals while nothing can be seen)
+  if(LUtils::isValidBinary("xscreensaver-command")){
+    ssaverWatch = new QProcess(this);
+      ssaverWatch->setProcessChannelMode(QProcess::MergedChannels);
+    connect(ssaverWatch, SIGNAL(readyReadStandardOutput()), this, SLOT(screensaverEvent()) );
+    connect(ssaverWatch, SIGNAL(finished(int, QProcess::ExitStatus)), this, SLOT(screensaverWatchStopped()) );
+    connect(ssaverWatch, SIGNAL(error(QProcess::ProcessError)), this, SLOT(screensaverWatchStopped()) );
+    startScreensaverWatch();
+  }
+
   //Enable Numlock
   if(LUtils::isValidBinary("numlockx")){ //make sure numlockx is installed
     if(sessionsettings->value("EnableNumlock",false).toBool()){
@@ -381,7 +426,7 @@ void LSession::checkUserFiles(){
 }
 
 void LSession::refreshWindowManager(){
-  LUtils::runCmd("touch \""+QString(getenv("XDG_CONFIG_HOME"))+"/lumina-desktop/fluxbox-init\"" );
+  LCommand::run("touch", QStringList() << QString(getenv("XDG_CONFIG_HOME"))+"/lumina-desktop/fluxbox-init" ); //no need to wait
 }
 
 void LSession::updateDesktops(){
@@ -671,11 +716,11 @@ void LSession::WindowConfigureEvent(WId win){
     }
 }
 
-void LSession::WindowDamageEvent(WId win){
+void LSession::WindowDamageEvent(WId win, QRect area){
   if(TrayStopping){ return; }
     if(RunningTrayApps.contains(win)){
-      if(DEBUG){ qDebug() << "SysTray: Damage Event"; }
-      emit TrayIconChanged(win); //trigger a repaint event
+      if(DEBUG){ qDebug() << "SysTray: Damage Event" << area; }
+      emit TrayIconDamaged(win, area); //refresh just the changed part of the icon
     }
 }
 
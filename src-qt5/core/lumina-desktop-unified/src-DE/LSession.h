@@ -21,6 +21,8 @@
 #include <QMediaPlayer>
 #include <QThread>
 #include <QUrl>
+#include <QProcess>
+#include <QDateTime>
 
 #include "Globals.h"
 #include "AppMenu.h"
@@ -38,6 +40,11 @@
 #define SYSTEM_TRAY_BEGIN_MESSAGE 1
 #define SYSTEM_TRAY_CANCEL_MESSAGE 2
 
+//Restarts of the xscreensaver watcher (seconds)
+#define SSAVER_RESTART 5 //first delay (doubled on every quick failure)
+#define SSAVER_RESTART_MAX 600
+#define SSAVER_STABLE 60 //ran at least this long: restart quickly again
+
 /*class MenuProxyStyle : public QProxyStyle{
 public: 
 	int pixelMetric(PixelMetric metric, const QStyleOption *option=0, const QWidget *widget=0) const{
@@ -71,7 +78,7 @@ public:
 	void SysTrayDockRequest(WId);
 	void WindowClosedEvent(WId);
 	void WindowConfigureEvent(WId);
-	void WindowDamageEvent(WId);
+	void WindowDamageEvent(WId, QRect area = QRect()); //null area: whole window
 	void WindowSelectionClearEvent(WId);
 	
 	//System Access
@@ -109,6 +116,10 @@ private:
 	QList<LDesktop*> DESKTOPS;
 	QFileSystemWatcher *watcher;
 	QTimer *screenTimer;
+	QProcess *ssaverWatch; //"xscreensaver-command -watch" (screen blanked/unblanked)
+	QDateTime ssaverStarted;
+	int ssaverDelay; //seconds before the watcher gets restarted (doubled on every quick failure)
+	bool ssaverPending; //restart already scheduled
 
 	//Internal variable for global usage
 	AppMenu *appmenu;
@@ -148,6 +159,9 @@ public slots:
 private slots:
 	void NewCommunication(QStringList);
 	void launchStartupApps(); //used during initialization
+	void screensaverEvent();
+	void startScreensaverWatch();
+	void screensaverWatchStopped();
 	void watcherChange(QString);
 	void screensChanged();
 	void screenResized(int);
@@ -173,6 +187,7 @@ signals:
 	void VisualTrayAvailable(); //new Visual Tray Plugin can be registered
 	void TrayListChanged(); //Item added/removed from the list
 	void TrayIconChanged(WId); //WinID of Tray App
+	void TrayIconDamaged(WId, QRect); //WinID of Tray App, changed area (null: everything)
 	//Start Button signals
 	void StartButtonAvailable();
 	void StartButtonActivated();
@@ -35,6 +35,7 @@ private slots:
 	void sysShutdown();
 	
 	void sysSuspend();
+	void sysSuspendLocked(); //second half of sysSuspend() (screen is locked)
 
 	void sysCancel(){
 	  this->close();
@@ -7,8 +7,23 @@
 #include "RSSObjects.h"
 #include <QNetworkRequest>
 #include <QXmlStreamReader>
+#include <QCryptographicHash>
+#include <QSettings>
+#include <QDir>
+#include <QFile>
+#include <QRegExp>
+#include <QtConcurrent>
 
 #include "LSession.h"
+#include <LTimerService.h>
+
+//Seconds the server says a reply stays fresh (-1: not given)
+static int cacheMaxAge(QNetworkReply *reply){
+  QString cc = QString(reply->rawHeader("Cache-Control")).toLower();
+  QRegExp exp("max-age\\s*=\\s*(\\d+)");
+  if(exp.indexIn(cc)>=0){ return exp.cap(1).toInt(); }
+  return -1;
+}
 
 //============
 //    PUBLIC
@@ -19,10 +34,8 @@ RSSReader::RSSReader(QObject *parent, QString settingsPrefix) : QObject(parent){
   connect(NMAN, SIGNAL(sslErrors(QNetworkReply*, const QList<QSslError>&)), this, SLOT(sslErrors(QNetworkReply*, const QList<QSslError>&)) );
 
   setprefix = settingsPrefix;
-  syncTimer = new QTimer(this);
-    syncTimer->setInterval(300000); //5 minutes
-    connect(syncTimer, SIGNAL(timeout()), this, SLOT(checkTimes()));
-  syncTimer->start();
+  //Check the feeds every 5 minutes (a minute late is fine - shares the wakeup with other plugins)
+  LTimerService::instance()->subscribe(this, SLOT(checkTimes()), 300000, 60000);
 }
 
 RSSReader::~RSSReader(){
@@ -63,15 +76,24 @@ void RSSReader::addUrls(QStringList urls){
     if(hash.contains(key)){ continue; } //already handled
     RSSchannel blank;
       blank.originalURL = url;
+      blank.timetolive = -1;
+      blank.errors = 0;
     hash.insert(url, blank); //put the empty struct into the hash for now
-    requestRSS(url); //startup the initial request for this url
+    //Show the copy from the last session right away (only fetched again once it is outdated)
+    if(!loadCache(url)){ requestRSS(url); } //startup the initial request for this url
   }
   emit newChannelsAvailable();
 }
 
 void RSSReader::removeUrl(QString ID){
   QString key = keyForUrl(ID);
-  if(hash.contains(key)){ hash.remove(key); }
+  if(hash.contains(key)){
+    QString url = hash.take(key).originalURL;
+    //Also remove the cached copy of the feed
+    QFile::remove( cacheFile(url, ".xml") );
+    QFile::remove( cacheFile(url, ".conf") );
+    QFile::remove( cacheFile(url, ".icon") );
+  }
   emit newChannelsAvailable();
 }
 
@@ -101,11 +123,133 @@ QString RSSReader::keyForUrl(QString url){
 void RSSReader::requestRSS(QString url){
   if(!outstandingURLS.contains(url)){
     //qDebug() << "Request URL:" << url;
-    NMAN->get( QNetworkRequest( QUrl(url) ) );
+    QNetworkRequest req( (QUrl(url)) );
+    QString key = keyForUrl(url);
+    if(hash.contains(key) && !hash[key].title.isEmpty()){
+      //Only send the feed again if it changed since the copy we have
+      if(!hash[key].etag.isEmpty()){ req.setRawHeader("If-None-Match", hash[key].etag.toLatin1()); }
+      if(!hash[key].lastmodified.isEmpty()){ req.setRawHeader("If-Modified-Since", hash[key].lastmodified.toLatin1()); }
+    }
+    NMAN->get(req);
     outstandingURLS << url;
   }
 }
 
+void RSSReader::syncFailed(QString key){
+  if(!hash.contains(key)){ return; }
+  hash[key].errors++;
+  int mins = RSS_RETRY_MINUTES;
+  for(int i=1; i<hash[key].errors && mins<RSS_RETRY_MAX; i++){ mins = mins*2; }
+  if(mins>RSS_RETRY_MAX){ mins = RSS_RETRY_MAX; }
+  hash[key].nextsync = QDateTime::currentDateTime().addSecs(mins*60);
+  //qDebug() << "RSS sync failed:" << key << "retry in (minutes):" << mins;
+}
+
+//Disk cache functions
+QString RSSReader::cacheFile(QString url, QString suffix){
+  QString dir = QString(getenv("XDG_CACHE_HOME")).section(":",0,0);
+  if(dir.isEmpty()){ dir = QDir::homePath()+"/.cache"; }
+  return (dir+"/lumina-desktop/rss/"+QCryptographicHash::hash(url.toUtf8(), QCryptographicHash::Md5).toHex()+suffix);
+}
+
+bool RSSReader::loadCache(QString key){
+  QString url = hash[key].originalURL;
+  if(!QFile::exists(cacheFile(url, ".xml"))){ return false; }
+  QSettings info(cacheFile(url, ".conf"), QSettings::IniFormat);
+  hash[key].etag = info.value("etag").toString();
+  hash[key].lastmodified = info.value("lastmodified").toString();
+  hash[key].lastsync = info.value("lastsync").toDateTime();
+  hash[key].nextsync = info.value("nextsync").toDateTime();
+  RSSparse job;
+    job.key = key;
+    job.fromcache = true;
+    job.maxage = -1;
+  startParse(job, QByteArray()); //the file is read in the worker thread
+  return true;
+}
+
+void RSSReader::saveCacheInfo(QString key){
+  QString file = cacheFile(hash[key].originalURL, ".conf");
+  QDir dir;
+  dir.mkpath(file.section("/",0,-2));
+  QSettings info(file, QSettings::IniFormat);
+  info.setValue("url", hash[key].originalURL);
+  info.setValue("etag", hash[key].etag);
+  info.setValue("lastmodified", hash[key].lastmodified);
+  info.setValue("lastsync", hash[key].lastsync);
+  info.setValue("nextsync", hash[key].nextsync);
+}
+
+//Feed parsing
+void RSSReader::startParse(RSSparse job, QByteArray data){
+  QFutureWatcher<RSSchannel> *watcher = new QFutureWatcher<RSSchannel>(this);
+  connect(watcher, SIGNAL(finished()), this, SLOT(parseFinished()) );
+  parsing.insert(watcher, job);
+  watcher->setFuture( QtConcurrent::run(&RSSReader::readFeed, data, cacheFile(hash[job.key].originalURL, ".xml")) );
+}
+
+RSSchannel RSSReader::readFeed(QByteArray data, QString cachefile){
+  //Note: This is run in a worker thread
+  // No data: read the cached copy, otherwise save the new data once it is known to be a valid feed
+  bool fromcache = data.isEmpty();
+  if(fromcache){
+    QFile file(cachefile);
+    if(file.open(QIODevice::ReadOnly)){ data = file.readAll(); file.close(); }
+  }
+  RSSchannel info = readRSS(data);
+  if(!fromcache && !info.title.isEmpty() && !info.link.isEmpty() && !info.description.isEmpty()){
+    QDir dir;
+    dir.mkpath(cachefile.section("/",0,-2));
+    QFile file(cachefile);
+    if(file.open(QIODevice::WriteOnly | QIODevice::Truncate)){ file.write(data); file.close(); }
+  }
+  return info;
+}
+
+void RSSReader::channelReady(RSSparse job, RSSchannel info){
+  QString key = job.key;
+  if(!hash.contains(key)){ return; } //removed while it was being parsed
+  //Validate the info and announce any changes
+  if(info.title.isEmpty() || info.link.isEmpty() || info.description.isEmpty()){ 
+    qDebug() << "Missing XML Information:" << key << info.title << info.link << info.description;
+    if(job.fromcache){ requestRSS(key); } //bad cache file - get a fresh copy
+    else{ syncFailed(key); }
+    return; 
+  } //bad info/read
+  //Update the bookkeeping elements of the info
+  if(info.timetolive<=0){ info.timetolive = LSession::handle()->DesktopPluginSettings()->value(setprefix+"default_interval_minutes", 60).toInt(); }
+  if(info.timetolive <=0){ info.timetolive = 60; } //error in integer conversion from settings?
+  QDateTime cdt = QDateTime::currentDateTime();
+  if(job.fromcache){
+    //Keep the sync times from the last session
+    info.lastsync = hash[key].lastsync; info.nextsync = hash[key].nextsync;
+    info.etag = hash[key].etag; info.lastmodified = hash[key].lastmodified;
+  }else{
+    //Do not check again before either the feed or the server says it could change
+    info.lastsync = cdt; info.nextsync = info.lastsync.addSecs( qMax(info.timetolive * 60, job.maxage) ); 
+    info.etag = job.etag; info.lastmodified = job.lastmodified;
+  }
+  info.errors = 0;
+  //Now see if anything changed and save the info into the hash
+  bool changed = (hash[key].lastBuildDate.isNull() || (hash[key].lastBuildDate < info.lastBuildDate) );
+  bool newinfo = false;
+  if(changed){ newinfo = hash[key].title.isEmpty(); } //no previous info from this URL
+  info.originalURL = hash[key].originalURL; //make sure this info gets preserved across updates
+  if(!hash[key].icon.isNull()){ info.icon = hash[key].icon; } //copy over the icon from the previous reply
+  else if(!info.icon_url.isEmpty()){
+    //Use the cached icon if there is one, otherwise kick off the request for it
+    QImage img(cacheFile(info.originalURL, ".icon"));
+    if(!img.isNull()){ info.icon = QIcon( QPixmap::fromImage(img) ); }
+    else{ requestRSS(info.icon_url); }
+  }
+  hash.insert(key, info);
+  if(!job.fromcache){ saveCacheInfo(key); }
+  if(newinfo){ emit newChannelsAvailable(); } //new channel
+  else if(changed){ emit rssChanged(info.originalURL); } //update to existing channel
+  //Refresh the cached copy if it is already outdated
+  if(job.fromcache && (info.nextsync.isNull() || info.nextsync < cdt) ){ requestRSS(key); }
+}
+
 //RSS parsing functions
 RSSchannel RSSReader::readRSS(QByteArray bytes){
   //Note: We could expand this later to support multiple "channel"s per Feed
@@ -183,8 +327,6 @@ void RSSReader::readRSSImage(RSSchannel *item, QXmlStreamReader *rss){
     else if(rss->name()=="height"){ item->icon_size.setHeight(rss->readElementText().toInt()); }
     else if(rss->name()=="description"){ item->icon_description = rss->readElementText(); }
   }
-  //Go ahead and kick off the request for the icon
-  if(!item->icon_url.isEmpty()){ requestRSS(item->icon_url); }
 }
 
 QDateTime RSSReader::RSSDateTime(QString datetime){
@@ -198,13 +340,24 @@ void RSSReader::replyFinished(QNetworkReply *reply){
   QString url = reply->request().url().toString();
   //qDebug() << "Got Reply:" << url;
   QString key = keyForUrl(url); //current hash key for this URL
-  QByteArray data = reply->readAll();
   outstandingURLS.removeAll(url);
+  if(hash.contains(key) && reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt()==304){
+    //Not modified since the last sync - just push back the next check
+    QDateTime cdt = QDateTime::currentDateTime();
+    hash[key].lastsync = cdt;
+    hash[key].nextsync = cdt.addSecs( qMax(hash[key].timetolive * 60, cacheMaxAge(reply)) );
+    hash[key].errors = 0;
+    saveCacheInfo(key);
+    reply->deleteLater();
+    return;
+  }
+  QByteArray data = reply->readAll();
   if(data.isEmpty()){
     //qDebug() << "No data returned:" << url;
     //see if the URL can be adjusted for known issues
     bool handled = false;
     QUrl redirecturl = reply->attribute(QNetworkRequest::RedirectionTargetAttribute).toUrl();
+    reply->deleteLater();
     if(redirecturl.isValid() && (redirecturl.toString() != url )){
       //New URL redirect - make the change and send a new request
       QString newurl = redirecturl.toString();
@@ -217,6 +370,7 @@ void RSSReader::replyFinished(QNetworkReply *reply){
       }      
     }
     if(!handled && hash.contains(key) ){ 
+      syncFailed(key); //do not try again right away
       emit rssChanged(hash[key].originalURL);
     }
     return;
@@ -236,33 +390,31 @@ void RSSReader::replyFinished(QNetworkReply *reply){
         info.icon = QIcon( QPixmap::fromImage(img) );
         //qDebug() << "Got Icon response:" << url << info.icon;
         hash.insert(keys[i], info); //insert back into the hash
+        if(!img.isNull()){
+          //Save it for the next session
+          QFile file(cacheFile(info.originalURL, ".icon"));
+          if(file.open(QIODevice::WriteOnly | QIODevice::Truncate)){ file.write(data); file.close(); }
+        }
         emit rssChanged( hash[keys[i]].originalURL );
         break;
       }
     }
     reply->deleteLater();
+  }else if(reply->error()!=QNetworkReply::NoError){
+    //Error page from the server
+    qDebug() << "RSS sync error:" << url << reply->errorString();
+    reply->deleteLater();
+    syncFailed(key);
   }else{
-    //RSS reply
-    RSSchannel info = readRSS(data); //QNetworkReply can be used as QIODevice
+    //RSS reply - parse it in a worker thread
+    RSSparse job;
+      job.key = key;
+      job.fromcache = false;
+      job.etag = QString(reply->rawHeader("ETag"));
+      job.lastmodified = QString(reply->rawHeader("Last-Modified"));
+      job.maxage = cacheMaxAge(reply);
     reply->deleteLater(); //clean up
-    //Validate the info and announce any changes
-    if(info.title.isEmpty() || info.link.isEmpty() || info.description.isEmpty()){ 
-      qDebug() << "Missing XML Information:" << url << info.title << info.link << info.description;
-      return; 
-    } //bad info/read
-    //Update the bookkeeping elements of the info
-    if(info.timetolive<=0){ info.timetolive = LSession::handle()->DesktopPluginSettings()->value(setprefix+"default_interval_minutes", 60).toInt(); }
-    if(info.timetolive <=0){ info.timetolive = 60; } //error in integer conversion from settings?
-    info.lastsync = QDateTime::currentDateTime(); info.nextsync = info.lastsync.addSecs(info.timetolive * 60); 
-    //Now see if anything changed and save the info into the hash
-    bool changed = (hash[key].lastBuildDate.isNull() || (hash[key].lastBuildDate < info.lastBuildDate) );
-    bool newinfo = false;
-    if(changed){ newinfo = hash[key].title.isEmpty(); } //no previous info from this URL
-    info.originalURL = hash[key].originalURL; //make sure this info gets preserved across updates
-    if(!hash[key].icon.isNull()){ info.icon = hash[key].icon; } //copy over the icon from the previous reply
-    hash.insert(key, info);
-    if(newinfo){ emit newChannelsAvailable(); } //new channel
-    else if(changed){ emit rssChanged(info.originalURL); } //update to existing channel
+    startParse(job, data);
   }
 }
 
@@ -285,3 +437,12 @@ void RSSReader::checkTimes(){
     if(hash[urls[i]].nextsync < cdt){ requestRSS(urls[i]); }
   }
 }
+
+void RSSReader::parseFinished(){
+  QFutureWatcher<RSSchannel> *watcher = static_cast<QFutureWatcher<RSSchannel>*>(sender());
+  if(!parsing.contains(watcher)){ return; }
+  RSSparse job = parsing.take(watcher);
+  RSSchannel info = watcher->result();
+  watcher->deleteLater();
+  channelReady(job, info);
+}
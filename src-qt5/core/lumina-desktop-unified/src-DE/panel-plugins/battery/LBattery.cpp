@@ -14,23 +14,19 @@ LBattery::LBattery(QWidget *parent, QString id, bool horizontal) : LPPlugin(pare
     label->setScaledContents(true);
     //label->setAlignment(Qt::AlignCenter);
   this->layout()->addWidget(label);
-  //Setup the timer
-  timer = new QTimer();
-  timer->setInterval(5000); //update every 5 seconds
-  connect(timer,SIGNAL(timeout()), this, SLOT(updateBattery()) );
-  timer->start();
+  //The battery status is checked periodically by the shared system metrics provider
+  connect(LSysMetrics::instance(), SIGNAL(batteryChanged()), this, SLOT(updateBattery()) );
+  LSysMetrics::instance()->addBatteryConsumer(this); //only checked while this can be seen
   QTimer::singleShot(0,this,SLOT(OrientationChange()) ); //update the sizing/icon
 }
 
 LBattery::~LBattery(){
-  timer->stop();
-  delete timer;
 }
 
 void LBattery::updateBattery(bool force){
   // Get current state of charge
   //QStringList result = LUtils::getCmdOutput("/usr/sbin/apm", QStringList() << "-al");
-  int charge = LOS::batteryCharge(); //result.at(1).toInt();
+  int charge = LSysMetrics::instance()->batteryCharge(); //result.at(1).toInt();
 //qDebug() << "1: " << result.at(0).toInt() << " 2: " << result.at(1).toInt();
   int icon = -1;
   if (charge > 90) { icon = 4; }
@@ -38,7 +34,7 @@ void LBattery::updateBattery(bool force){
   else if (charge > 20) { icon = 2; }
   else if (charge > 5) { icon = 1; }
   else if (charge > 0 ) { icon = 0; }
-  if(LOS::batteryIsCharging()){ icon = icon+10; }
+  if(LSysMetrics::instance()->batteryIsCharging()){ icon = icon+10; }
   //icon = icon + result.at(0).toInt() * 10;
   if (icon != iconOld || force) {
     switch (icon) {
@@ -95,7 +91,7 @@ void LBattery::updateBattery(bool force){
 }
 
 QString LBattery::getRemainingTime(){
-  int secs = LOS::batterySecondsLeft();
+  int secs = LSysMetrics::instance()->batterySecondsLeft();
   if(secs < 0){ return "??"; }
   QString rem; //remaining
   if(secs > 3600){
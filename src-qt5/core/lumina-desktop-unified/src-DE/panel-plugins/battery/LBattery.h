@@ -15,6 +15,7 @@
 #include <LUtils.h>
 #include <LuminaXDG.h>
 #include <LuminaOS.h>
+#include <LSysMetrics.h>
 
 #include "../../Globals.h"
 //#include "../LTBWidget.h"
@@ -27,7 +28,6 @@ public:
 	~LBattery();
 	
 private:
-	QTimer *timer;
 	QLabel *label;
 	int iconOld;
 	
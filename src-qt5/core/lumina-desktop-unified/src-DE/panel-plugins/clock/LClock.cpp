@@ -8,6 +8,7 @@
 #include "LSession.h"
 #include <LuminaThemes.h>
 #include <LuminaXDG.h>
+#include <LTimerService.h>
 
 LClock::LClock(QWidget *parent, QString id, bool horizontal) : LPPlugin(parent, id, horizontal){
   button = new QToolButton(this); //RotateToolButton(this);
@@ -33,22 +34,16 @@ LClock::LClock(QWidget *parent, QString id, bool horizontal) : LPPlugin(parent,
   this->layout()->setContentsMargins(0,0,0,0); //reserve some space on left/right
   this->layout()->addWidget(button);
 	
-  //Setup the timer
-  timer = new QTimer();
-  //Load all the initial settings
+  //Load all the initial settings (also starts the updates)
   updateFormats();
   LocaleChange();
   ThemeChange();
   OrientationChange();
-  //Now connect/start the timer
-  connect(timer,SIGNAL(timeout()), this, SLOT(updateTime()) );
   connect(QApplication::instance(), SIGNAL(SessionConfigChanged()), this, SLOT(updateFormats()) );
-  timer->start();
 }
 
 LClock::~LClock(){
-  timer->stop();
-  delete timer;
+  LTimerService::instance()->unsubscribe(this);
 }
 
 
@@ -117,12 +112,14 @@ void LClock::updateFormats(){
   datefmt = LSession::handle()->sessionSettings()->value("DateFormat","").toString();
   deftime = timefmt.simplified().isEmpty();
   defdate = datefmt.simplified().isEmpty();
-  //Adjust the timer interval based on the smallest unit displayed
-  if(deftime){ timer->setInterval(500); } //1/2 second
-  else if(timefmt.contains("z")){ timer->setInterval(1); } //every millisecond (smallest unit)
-  else if(timefmt.contains("s")){ timer->setInterval(500); } //1/2 second
-  else if(timefmt.contains("m")){ timer->setInterval(2000); } //2 seconds
-  else{ timer->setInterval(1000); } //unknown format - use 1 second interval
+  //Adjust the update interval based on the smallest unit displayed
+  // Note: The ticks land right on the second/minute boundaries, so there is no need to check more often
+  int interval = 1000; //unknown format - use 1 second interval
+  if(deftime){ interval = QLocale().timeFormat(QLocale::ShortFormat).contains("s") ? 1000 : 60000; }
+  else if(timefmt.contains("z")){ interval = 50; } //milliseconds - more often than this cannot be seen anyway
+  else if(timefmt.contains("s")){ interval = 1000; } //1 second
+  else if(timefmt.contains("m")){ interval = 60000; } //1 minute
+  LTimerService::instance()->subscribe(this, SLOT(updateTime()), interval, 0, this);
   datetimeorder = LSession::handle()->sessionSettings()->value("DateTimeOrder", "timeonly").toString().toLower();
   //this->setSizePolicy(QSizePolicy::Preferred, QSizePolicy::Preferred);
   updateTime(true);
@@ -9,6 +9,7 @@
 
 #include "../../LSession.h"
 #include <LuminaX11.h>
+#include <LSysMetrics.h>
 
 LSysMenuQuick::LSysMenuQuick(QWidget *parent) : QWidget(parent), ui(new Ui::LSysMenuQuick){
   ui->setupUi(this);
@@ -28,6 +29,8 @@ LSysMenuQuick::LSysMenuQuick(QWidget *parent) : QWidget(parent), ui(new Ui::LSys
   connect(ui->tool_vol_mixer, SIGNAL(clicked()), this, SLOT(startMixer()) );
   connect(brighttimer, SIGNAL(timeout()), this, SLOT(setCurrentBrightness()) );
   connect(ui->combo_locale, SIGNAL(currentIndexChanged(int)), this, SLOT(changeLocale()) );
+  connect(LSysMetrics::instance(), SIGNAL(audioVolumeChanged()), this, SLOT(UpdateControls()) );
+  connect(LSysMetrics::instance(), SIGNAL(screenBrightnessChanged()), this, SLOT(UpdateControls()) );
   //And setup the default icons
   ui->label_bright_icon->setPixmap( LXDG::findIcon("preferences-system-power-management","").pixmap(ui->label_bright_icon->maximumSize()) );
   ui->tool_wk_prev->setIcon( LXDG::findIcon("go-previous-view",""));
@@ -41,35 +44,9 @@ LSysMenuQuick::~LSysMenuQuick(){
 
 void LSysMenuQuick::UpdateMenu(){
   ui->retranslateUi(this);
-  //Audio Volume
-  int val = LOS::audioVolume();	
-  QIcon ico;
-  if(val > 66){ ico= LXDG::findIcon("audio-volume-high",""); }
-  else if(val > 33){ ico= LXDG::findIcon("audio-volume-medium",""); }
-  else if(val > 0){ ico= LXDG::findIcon("audio-volume-low",""); }
-  else{ ico= LXDG::findIcon("audio-volume-muted",""); }
-  bool hasMixer = LOS::hasMixerUtility();
-  ui->label_vol_icon->setVisible(!hasMixer);
-  ui->tool_vol_mixer->setVisible(hasMixer);
-  if(!hasMixer){ ui->label_vol_icon->setPixmap( ico.pixmap(ui->label_vol_icon->maximumSize()) ); }
-  else{ ui->tool_vol_mixer->setIcon(ico); }
-  QString txt = QString::number(val)+"%";
-  if(val<100){ txt.prepend(" "); } //make sure no widget resizing
-  ui->label_vol_text->setText(txt);
-  if(ui->slider_volume->value()!= val){ ui->slider_volume->setValue(val); }
-  //Screen Brightness
-  val = LOS::ScreenBrightness();
-  if(val < 0){
-    //No brightness control - hide it
-    ui->group_brightness->setVisible(false);
-  }else{
-    ui->group_brightness->setVisible(true);
-    txt = QString::number(val)+"%";
-    if(val<100){ txt.prepend(" "); } //make sure no widget resizing
-    ui->label_bright_text->setText(txt);
-    if(ui->slider_brightness->value()!=val){ ui->slider_brightness->setValue(val); }
-  }
-  
+  //Audio Volume/Screen Brightness (last known values)
+  UpdateControls();
+  int val;
   //Do any one-time checks
   if(firstrun){
     hasBat = LOS::hasBattery(); //No need to check this more than once - will not change in the middle of a session
@@ -120,9 +97,40 @@ void LSysMenuQuick::UpdateMenu(){
   ui->label_wk_text->setText( QString(tr("%1 of %2")).arg(QString::number(val+1), QString::number(tot)) );
 }
 
+void LSysMenuQuick::UpdateControls(){
+  //Audio Volume
+  int val = LSysMetrics::instance()->audioVolume();
+  QIcon ico;
+  if(val > 66){ ico= LXDG::findIcon("audio-volume-high",""); }
+  else if(val > 33){ ico= LXDG::findIcon("audio-volume-medium",""); }
+  else if(val > 0){ ico= LXDG::findIcon("audio-volume-low",""); }
+  else{ ico= LXDG::findIcon("audio-volume-muted",""); }
+  bool hasMixer = LOS::hasMixerUtility();
+  ui->label_vol_icon->setVisible(!hasMixer);
+  ui->tool_vol_mixer->setVisible(hasMixer);
+  if(!hasMixer){ ui->label_vol_icon->setPixmap( ico.pixmap(ui->label_vol_icon->maximumSize()) ); }
+  else{ ui->tool_vol_mixer->setIcon(ico); }
+  QString txt = QString::number(val)+"%";
+  if(val<100){ txt.prepend(" "); } //make sure no widget resizing
+  ui->label_vol_text->setText(txt);
+  if(val>=0 && ui->slider_volume->value()!= val && !ui->slider_volume->isSliderDown()){ ui->slider_volume->setValue(val); }
+  //Screen Brightness
+  val = LSysMetrics::instance()->screenBrightness();
+  if(val < 0){
+    //No brightness control - hide it
+    ui->group_brightness->setVisible(false);
+  }else{
+    ui->group_brightness->setVisible(true);
+    txt = QString::number(val)+"%";
+    if(val<100){ txt.prepend(" "); } //make sure no widget resizing
+    ui->label_bright_text->setText(txt);
+    if(ui->slider_brightness->value()!=val && !ui->slider_brightness->isSliderDown()){ ui->slider_brightness->setValue(val); }
+  }
+}
+
 void LSysMenuQuick::volSliderChanged(){
   int val = ui->slider_volume->value();
-  LOS::setAudioVolume(val);
+  LSysMetrics::instance()->setAudioVolume(val); //applied in the background
   QString txt = QString::number(val)+"%";
   if(val<100){ txt.prepend(" "); } //make sure no widget resizing
   ui->label_vol_text->setText( txt );
@@ -150,7 +158,7 @@ void LSysMenuQuick::brightSliderChanged(){
 
 void LSysMenuQuick::setCurrentBrightness(){
   int val = ui->slider_brightness->value();
-  LOS::setScreenBrightness(val);
+  LSysMetrics::instance()->setScreenBrightness(val); //applied in the background
   QString txt = QString::number(val)+"%";
   if(val<100){ txt.prepend(" "); } //make sure no widget resizing
   ui->label_bright_text->setText( txt );	
@@ -36,6 +36,7 @@ private:
 	QString getRemainingTime(); //battery time left
 
 private slots:
+	void UpdateControls(); //audio volume/screen brightness
 	void volSliderChanged();
 	void brightSliderChanged(); //start the delay/collection timer
 	void setCurrentBrightness(); //perform the change
@@ -7,6 +7,7 @@
 #include "ItemWidget.h"
 #include <LUtils.h>
 #include <QMenu>
+#include <QtConcurrent>
 #include "../../LSession.h"
 
 
@@ -20,8 +21,7 @@ ItemWidget::ItemWidget(QWidget *parent, QString itemPath, QString type, bool gob
     gooditem = item.isValid();
     //qDebug() << "Good Item:" << gooditem << itemPath;
     if(gooditem){
-      icon->setPixmap( LXDG::findIcon(item.icon, "preferences-system-windows-actions").pixmap(32,32) );
-      iconPath = item.icon;
+      setLazyIcon(item.icon, "preferences-system-windows-actions");
       text = item.name;
       if(!item.genericName.isEmpty() && item.name!=item.genericName){ text.append("<br><i> -- "+item.genericName+"</i>"); }
       name->setText(text);
@@ -49,7 +49,7 @@ ItemWidget::ItemWidget(QWidget *parent, QString itemPath, QString type, bool gob
     actButton->setVisible(false);
     iconPath = LXDG::DesktopCatToIcon(type.section("::::",1,50));
     if(goback){ iconPath = "go-previous"; type = "chcat::::"; itemPath = "<B>("+itemPath+")</B>"; }
-    icon->setPixmap( LXDG::findIcon(iconPath,"applications-other").pixmap(64,64) );
+    setLazyIcon(iconPath, "applications-other");
     name->setText(itemPath);
     text = itemPath;
     icon->setWhatsThis(type);
@@ -84,8 +84,7 @@ ItemWidget::ItemWidget(QWidget *parent, QString itemPath, QString type, bool gob
   if(isShortcut && name->toolTip().isEmpty()){
     name->setToolTip(icon->whatsThis()); //also allow the user to see the full shortcut path
   }
-  //Now setup the button appropriately
-  setupContextMenu();
+  //Note: The context menu is setup when it is requested (depends on the current favorites/quicklaunch)
 }
 
 // - Application constructor
@@ -105,16 +104,14 @@ ItemWidget::ItemWidget(QWidget *parent, XDGDesktop *item) : QFrame(parent){
     name->setToolTip(icon->whatsThis()); //also allow the user to see the full shortcut path
   }
   //Now fill it appropriately
-  icon->setPixmap( LXDG::findIcon(item->icon,"preferences-system-windows-actions").pixmap(64,64) );
+  setLazyIcon(item->icon, "preferences-system-windows-actions");
       text = item->name;
       if(!item->genericName.isEmpty() && item->name!=item->genericName){ text.append("<br><i> -- "+item->genericName+"</i>"); }
       name->setText(text);
       name->setToolTip(item->comment);
   this->setWhatsThis(item->name);
   icon->setWhatsThis(item->filePath);
-  iconPath = item->icon;
   //Now setup the buttons appropriately
-  setupContextMenu();
   setupActions(item);
 }
 
@@ -144,6 +141,8 @@ void ItemWidget::createWidget(){
   //Initialize the widgets
   gooditem = true;
   menuopen = false;
+  iconPending = false;
+  iconLoader = 0;
   menureset = new QTimer(this);
     menureset->setSingleShot(true);
     menureset->setInterval(1000); //1 second	
@@ -169,6 +168,12 @@ void ItemWidget::createWidget(){
   this->setObjectName("LuminaItemWidget");
 }
 
+void ItemWidget::setLazyIcon(QString path, QString fallback){
+  iconPath = path;
+  iconFallback = fallback;
+  iconPending = true; //most items in the menu are never scrolled into view - only load the visible ones
+}
+
 void ItemWidget::setupContextMenu(){
   //Now refresh the context menu
   contextMenu->clear();
@@ -197,13 +202,15 @@ void ItemWidget::setupActions(XDGDesktop *app){
   //Actions Available - go ahead and list them all
   actButton->setMenu( new QMenu(this) );
   for(int i=0; i<app->actions.length(); i++){
-    QAction *act = new QAction(LXDG::findIcon(app->actions[i].icon, app->icon), app->actions[i].name, this);
+    QAction *act = new QAction(app->actions[i].name, this);
+	act->setData( QStringList() << app->actions[i].icon << app->icon ); //icon is loaded when the menu is opened
 	act->setToolTip(app->actions[i].ID);
         act->setWhatsThis(app->actions[i].ID);
         actButton->menu()->addAction(act);	
   }
   connect(actButton->menu(), SIGNAL(triggered(QAction*)), this, SLOT(actionClicked(QAction*)) );
   connect(actButton->menu(), SIGNAL(aboutToShow()), this, SLOT(actionMenuOpen()) );
+  connect(actButton->menu(), SIGNAL(aboutToShow()), this, SLOT(loadActionIcons()) );
   connect(actButton->menu(), SIGNAL(aboutToHide()), this, SLOT(actionMenuClosed()) );
   connect(menureset, SIGNAL(timeout()), this, SLOT(resetmenuflag()) );
 }
@@ -227,7 +234,7 @@ void ItemWidget::updateItems(){
           icon->setPixmap( LXDG::findMimeIcon(icon->whatsThis().section("/",-1)).pixmap(H-4,H-4).scaledToHeight(H-4,Qt::SmoothTransformation) );
         }
       }else{
-        icon->setPixmap( LXDG::findIcon(iconPath,"preferences-system-windows-actions").pixmap(H-4,H-4).scaledToHeight(H-4,Qt::SmoothTransformation) );
+        icon->setPixmap( LXDG::findIcon(iconPath, iconFallback.isEmpty() ? "preferences-system-windows-actions" : iconFallback).pixmap(H-4,H-4).scaledToHeight(H-4,Qt::SmoothTransformation) );
       }
     }else if(icon->pixmap()->size().height() > (H-4) ){
       icon->setPixmap( icon->pixmap()->scaled(H-4, H-4, Qt::IgnoreAspectRatio, Qt::SmoothTransformation) );
@@ -270,6 +277,26 @@ void ItemWidget::ItemClicked(){
   else{ emit RunItem(icon->whatsThis()); }
 }
 
+void ItemWidget::iconLoaded(){
+  QImage img = iconLoader->result();
+  iconLoader->deleteLater();
+  iconLoader = 0;
+  if(img.isNull()){ return; }
+  QPixmap pix = QPixmap::fromImage(img);
+  if(pix.height() > icon->height()){ pix = pix.scaledToHeight(icon->height(), Qt::SmoothTransformation); }
+  icon->setPixmap(pix);
+}
+
+void ItemWidget::loadActionIcons(){
+  //Look up the action icons the first time the menu is opened
+  QList<QAction*> acts = actButton->menu()->actions();
+  for(int i=0; i<acts.length(); i++){
+    QStringList ico = acts[i]->data().toStringList();
+    if(ico.length()<2 || !acts[i]->icon().isNull()){ continue; }
+    acts[i]->setIcon( LXDG::findIcon(ico[0], ico[1]) );
+  }
+}
+
 void ItemWidget::actionClicked(QAction *act){
   actButton->menu()->hide();
   QString cmd = "lumina-open -action \""+act->whatsThis()+"\" \"%1\"";
@@ -277,3 +304,14 @@ void ItemWidget::actionClicked(QAction *act){
   else{ cmd = cmd.arg(icon->whatsThis()); }
   emit RunItem(cmd);
 }
+
+void ItemWidget::paintEvent(QPaintEvent *ev){
+  if(iconPending){
+    //First time this item is visible - load the icon at the current size in a worker thread
+    iconPending = false;
+    iconLoader = new QFutureWatcher<QImage>(this);
+    connect(iconLoader, SIGNAL(finished()), this, SLOT(iconLoaded()) );
+    iconLoader->setFuture( QtConcurrent::run(&LXDG::findIconImage, iconPath, iconFallback, icon->height()) );
+  }
+  QFrame::paintEvent(ev);
+}
@@ -22,6 +22,9 @@
 #include <QMenu>
 #include <QTimer>
 #include <QResizeEvent>
+#include <QPaintEvent>
+#include <QFutureWatcher>
+#include <QImage>
 
 #include <LuminaXDG.h>
 
@@ -47,8 +50,13 @@ private:
 	bool isDirectory, isShortcut, menuopen;
 	QString linkPath, iconPath, text;
 	QTimer *menureset;
+	//Icon which is loaded in the background the first time the item is painted
+	QString iconFallback;
+	bool iconPending;
+	QFutureWatcher<QImage> *iconLoader;
 	
 	void createWidget();
+	void setLazyIcon(QString path, QString fallback);
 
 	void setupContextMenu();
 	void setupActions(XDGDesktop*);
@@ -63,6 +71,8 @@ private slots:
 	void AddQL();
 	void ItemClicked();
 	void actionClicked(QAction*);
+	void iconLoaded();
+	void loadActionIcons();
 	//Functions to fix the submenu open/close issues
 	void actionMenuOpen(){ 
 	  if(menureset->isActive()){ menureset->stop(); } 
@@ -86,6 +96,8 @@ protected:
 	  updateItems(); //update the sizing of everything
 	  QFrame::resizeEvent(ev); // do the normal procedures
 	}
+
+	void paintEvent(QPaintEvent *ev);
 	
 signals:
 	void NewShortcut();
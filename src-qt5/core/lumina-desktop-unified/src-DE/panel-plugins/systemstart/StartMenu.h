@@ -35,12 +35,15 @@ private:
 	QStringList favs;
 	QString CCat, CSearch, topsearch; //current category/search
 	QTimer *searchTimer;        
+	QHash<QString, QWidget*> appViews; //cached contents of the apps list for each view (see UpdateApps)
+	QHash<QString, QWidget*> favItems; //favorite entry/widget (see UpdateFavs)
 
 	//Simple utility functions
 	//void deleteChildren(QWidget *obj); //recursive function
 	void ClearScrollArea(QScrollArea *area);
 	void SortScrollArea(QScrollArea *area);
 	void do_search(QString search, bool force);	
+	QWidget* createAppView(QString view);
 
 	bool promptAboutUpdates(bool &skip);
 
@@ -49,12 +52,14 @@ private slots:
 
 	//Application/Favorite Listings
 	void ChangeCategory(QString cat);
+	void AppsChanged(); //throw away the cached views
 	void UpdateApps();
 	void UpdateFavs();
 
 	// Page update routines
 	void on_stackedWidget_currentChanged(int); //page changed
 	void catViewChanged(); //application categorization view mode changed
+	void UpdateControls(); //audio volume/screen brightness
 
 	//Page Change Buttons
 	void on_tool_goto_apps_clicked();
@@ -75,6 +80,7 @@ private slots:
 	void on_tool_restart_clicked();
 	void on_tool_shutdown_clicked();
 	void on_tool_suspend_clicked();
+	void suspendLocked(); //second half of on_tool_suspend_clicked() (screen is locked)
 
 	//Audio Volume
 	void on_slider_volume_valueChanged(int);
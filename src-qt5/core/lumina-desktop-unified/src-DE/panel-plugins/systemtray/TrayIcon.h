@@ -20,10 +20,14 @@
 #include <QPainter>
 #include <QPixmap>
 #include <QImage>
+#include <QRegion>
 //#include <QWindow>
 // libLumina includes
 //#include <LuminaX11.h>
 
+#define TRAY_REFRESH 50 //minimum milliseconds between image refreshes
+#define TRAY_MAX_RECTS 8 //damaged rectangles to read separately (more: read the bounding area)
+
 class TrayIcon : public QWidget{
 	Q_OBJECT
 public:
@@ -39,11 +43,21 @@ public:
 public slots:
 	void detachApp();
 	void updateIcon();
+	void damaged(QRect area = QRect()); //area of the app window which changed (null: everything)
 
 private:
 	WId IID, AID; //icon ID and app ID
 	int badpaints;
 	uint dmgID; 
+	//Cached copy of the app window and the scaled version which gets painted
+	QImage trayImg;
+	QPixmap scaledPix;
+	QRegion dirty;
+	bool dirtyAll;
+	QTimer *refreshTimer;
+
+private slots:
+	void refreshImage();
 
 protected:
 	void paintEvent(QPaintEvent *event);
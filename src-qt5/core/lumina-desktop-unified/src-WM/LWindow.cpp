@@ -11,6 +11,9 @@ LWindowFrame::LWindowFrame(WId client, QWidget *parent) : QFrame(parent, Qt::X11
   CID = client;
   lastAction = LWM::WA_NONE;
   Closing = false;
+  geomPending = syncWaiting = outlineResize = false;
+  syncCounter = syncValue = 0;
+  outline = 0;
   //qDebug() << "New Window:" << CID << "Frame:" << this->winId();
   this->setMouseTracking(true); //need this to determine mouse location when not clicked
   this->setObjectName("LWindowFrame");
@@ -36,6 +39,9 @@ void LWindowFrame::InitWindow(){
 	  anim->setTargetObject(this);
 	  anim->setDuration(ANIMTIME); //In milliseconds
 	  connect(anim, SIGNAL(finished()), this, SLOT(finishedAnimation()) );
+	moveTimer = new QTimer(this); //Compresses pointer motion during move/resize
+	  moveTimer->setInterval(MOVETIME);
+	  connect(moveTimer, SIGNAL(timeout()), this, SLOT(applyPendingGeometry()) );
 	titleBar = new QLabel(this); //This is the "container" for all the title buttons/widgets
 	  titleBar->setObjectName("TitleBar");
 	  titleBar->setSizePolicy(QSizePolicy::Minimum,QSizePolicy::Minimum);
@@ -331,6 +337,21 @@ void LWindowFrame::finishedAnimation(){
   }
 }
 
+void LWindowFrame::finishMoveResize(){
+  //Apply the final geometry right away (no need to wait on the client anymore)
+  moveTimer->stop();
+  if(outline!=0){
+    //The last pointer position might not have reached the outline yet (moveTimer) - that one wins
+    if(!geomPending){ pendingGeom = outline->geometry(); }
+    geomPending = (pendingGeom != this->geometry());
+    delete outline;
+    outline = 0;
+  }
+  if(geomPending){ this->setGeometry(pendingGeom); }
+  geomPending = syncWaiting = false;
+  syncCounter = 0;
+}
+
 // =================
 //    PUBLIC SLOTS
 // =================
@@ -340,6 +361,8 @@ void LWindowFrame::updateAppearance(){
   maxB->setIcon(LXDG::findIcon("view-fullscreen",""));
   closeB->setIcon(LXDG::findIcon("application-exit",""));
   otherB->setIcon(LXDG::findIcon("configure",""));
+  QSettings set("lumina-desktop","lumina-wm");
+  outlineResize = set.value("outlineResize", false).toBool();
 }
 
 void LWindowFrame::windowChanged(LWM::WindowAction act){
@@ -390,6 +413,27 @@ void LWindowFrame::otherClicked(QAction* act){
   QString action = act->whatsThis();
 }
 
+void LWindowFrame::applyPendingGeometry(){
+  if(!geomPending){ moveTimer->stop(); return; } //pointer has not moved
+  bool resize = (pendingGeom.size() != this->size());
+  if(outline!=0 && resize){
+    //Outline mode - the client does not get resized until the mouse is released
+    outline->setGeometry(pendingGeom);
+    geomPending = false;
+    return;
+  }
+  if(resize && syncCounter!=0){
+    //Wait until the client has finished drawing the last size (unless it is taking too long)
+    if(syncWaiting && syncTime.elapsed()<SYNCTIME && LWM::SYSTEM->WM_Get_Sync_Counter_Value(syncCounter)<syncValue){ return; }
+    syncValue++;
+    LWM::SYSTEM->WM_Send_Sync_Request(CID, syncValue); //needs to be sent before the configure event
+    syncWaiting = true;
+    syncTime.start();
+  }
+  geomPending = false;
+  this->setGeometry(pendingGeom);
+}
+
 void LWindowFrame::CloseAll(){
   qDebug() << " - Closing Frame";
   this->hide();
@@ -413,6 +457,20 @@ void LWindowFrame::mousePressEvent(QMouseEvent *ev){
     //Clicked on the frame somewhere
     activeState = getStateAtPoint(ev->pos(), true); //also have it set the offset variable
   }
+  pendingGeom = this->geometry();
+  geomPending = false;
+  if(activeState!=Normal && activeState!=Move){
+    if(outlineResize){
+      outline = new QRubberBand(QRubberBand::Rectangle);
+      outline->setGeometry(pendingGeom);
+      outline->show();
+    }else{
+      //See if the client can tell us when it is finished drawing each size
+      syncCounter = LWM::SYSTEM->WM_Get_Sync_Request_Counter(CID);
+      if(syncCounter!=0){ syncValue = LWM::SYSTEM->WM_Get_Sync_Counter_Value(syncCounter); }
+      syncWaiting = false;
+    }
+  }
   setMouseCursor(activeState, true); //this one is an override cursor
   
 }
@@ -423,8 +481,8 @@ void LWindowFrame::mouseMoveEvent(QMouseEvent *ev){
     setMouseCursor( getStateAtPoint(ev->pos()) ); //just update the mouse cursor
 
   }else{
-    //Currently in a modification state
-    QRect geom = this->geometry();
+    //Currently in a modification state (start from the last requested geometry - it might not be applied yet)
+    QRect geom = pendingGeom;
     switch(activeState){
       case Move:
         geom.moveTopLeft(ev->globalPos()-offset); //will not change size
@@ -456,7 +514,10 @@ void LWindowFrame::mouseMoveEvent(QMouseEvent *ev){
       default:
 	break;
     }
-    this->setGeometry(geom);
+    //Only saved here - the frame is changed on the next tick of the move timer
+    pendingGeom = geom;
+    geomPending = true;
+    if(!moveTimer->isActive()){ moveTimer->start(); }
   }
 }
 
@@ -468,6 +529,7 @@ void LWindowFrame::mouseReleaseEvent(QMouseEvent *ev){
     otherM->popup(ev->globalPos());
     return;
   }
+  if(activeState!=Normal){ finishMoveResize(); }
   activeState = Normal;
   QApplication::restoreOverrideCursor();
   setMouseCursor( getStateAtPoint(ev->pos()) );
@@ -6,7 +6,7 @@ greaterThan(QT_MAJOR_VERSION, 4): QT += widgets x11extras
 TARGET = lumina-wm
 target.path = $${L_BINDIR}
 
-LIBS     += -lLuminaUtils -lxcb -lxcb-damage -lxcb-composite -lxcb-screensaver -lxcb-util
+LIBS     += -lLuminaUtils -lxcb -lxcb-damage -lxcb-composite -lxcb-screensaver -lxcb-sync -lxcb-shm -lxcb-util
 
 DEPENDPATH	+= ../libLumina
 
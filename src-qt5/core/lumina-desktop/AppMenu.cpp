@@ -29,6 +29,10 @@ QHash<QString, QList<XDGDesktop*> >* AppMenu::currentAppHash(){
   return &APPS;
 }
 
+XDGAppIndex* AppMenu::currentAppIndex(){
+  return &APPINDEX;
+}
+
 //===========
 //  PRIVATE
 //===========
@@ -72,6 +76,7 @@ void AppMenu::updateAppList(){
   QList<XDGDesktop*> allfiles = sysApps->apps(false,false); //only valid, non-hidden apps
   APPS = LXDG::sortDesktopCats(allfiles);
   APPS.insert("All", LXDG::sortDesktopNames(allfiles));
+  APPINDEX.update(allfiles); //only the changed apps get re-indexed
   lastHashUpdate = QDateTime::currentDateTime();
   //Now fill the menu
     //Add link to the file manager
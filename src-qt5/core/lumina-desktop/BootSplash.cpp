@@ -4,6 +4,7 @@
 #include <LuminaXDG.h>
 #include <LUtils.h>
 #include <LDesktopUtils.h>
+#include <LCommand.h>
 
 BootSplash::BootSplash() : QWidget(0, Qt::SplashScreen | Qt::X11BypassWindowManagerHint | Qt::WindowStaysOnTopHint | Qt::WindowDoesNotAcceptFocus), ui(new Ui::BootSplash){
   ui->setupUi(this);
@@ -25,8 +26,9 @@ void BootSplash::generateTipOfTheDay(){
 
   QString tip;
   if(sysMOTD.contains("/") && LUtils::isValidBinary(sysMOTD)){
-    //is binary - run it to generate text
-    tip = LUtils::getCmdOutput(sysMOTD).join("\n");
+    //is binary - run it to generate text (shown once it is finished)
+    LCommand *cmd = LCommand::run(sysMOTD, QStringList(), 10000);
+    connect(cmd, SIGNAL(finished(int, QStringList)), this, SLOT(motdFinished(int, QStringList)) );
 
   }else if(QFile::exists(sysMOTD)){
     //text file - read it to generate text
@@ -133,6 +135,11 @@ void BootSplash::generateTipOfTheDay(){
   ui->label_welcome->setText( tip);
 }
 
+void BootSplash::motdFinished(int retcode, QStringList output){
+  if(retcode<0){ return; } //could not be run
+  ui->label_welcome->setText( output.join("\n") );
+}
+
 void BootSplash::showScreen(QString loading){ //update icon, text, and progress
   QString txt, icon;
   int per = 0;
@@ -8,6 +8,7 @@
 #include <QPoint>
 #include <QApplication>
 #include <QDesktopWidget>
+#include <QStringList>
 
 namespace Ui{
 	class BootSplash;
@@ -20,6 +21,9 @@ private:
 
 	void generateTipOfTheDay();
 
+private slots:
+	void motdFinished(int retcode, QStringList output); //output of the lumina-motd binary
+
 public:
 	BootSplash();
 	~BootSplash(){}
@@ -4,76 +4,59 @@
 //  Available under the 3-clause BSD license
 //  See the LICENSE file for full details
 //===========================================
-//  This menu is used to automatically generate menu contents 
+//  This menu is used to automatically generate menu contents
 //    based on the JSON output of an external script/utility
+//  The script is run in the background (prefetched when the menu is created),
+//    the last result is shown right away and refreshed once it is older than
+//    the "JsonMenuCacheSecs" session setting
 //===========================================
 #ifndef _LUMINA_DESKTOP_JSON_MENU_H
 #define _LUMINA_DESKTOP_JSON_MENU_H
 
 #include <QMenu>
 #include <QString>
+#include <QImage>
+#include <QDateTime>
+#include <QFutureWatcher>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
 
 #include <LUtils.h>
+#include <LCommand.h>
 #include <LuminaXDG.h>
 #include "LSession.h"
 
+#define JSONMENU_TIMEOUT 10000 //milliseconds before a slow script gets stopped
+#define JSONMENU_CACHE 60 //default seconds before the script output gets refreshed
+
+//One entry of the menu (parsed in a worker thread)
+struct JsonMenuItem{
+  QString type, label, action, exec;
+  QImage icon;
+};
+
 class JsonMenu : public QMenu{
 	Q_OBJECT
+public:
+	JsonMenu(QString execpath, QWidget *parent = 0);
+	~JsonMenu();
+
 private:
 	QString exec;
+	LCommand *cmd; //script which is currently running
+	QFutureWatcher< QList<JsonMenuItem> > *parser;
+	QDateTime filled; //time stamp of the cached output currently in the menu
 
-public:
-	JsonMenu(QString execpath, QWidget *parent = 0) : QMenu(parent){
-	  exec = execpath;
-	  connect(this, SIGNAL(aboutToShow()), this, SLOT(updateMenu()) );
-	  connect(this, SIGNAL(triggered(QAction*)), this, SLOT(itemTriggered(QAction*)) );
-	}
+	bool outdated(); //the cached output is missing or older than the refresh time
+	void fetch(); //start the script in the background
+	void fillMenu();
+	static QList<JsonMenuItem> parseOutput(QString output, int iconsize);
 
 private slots:
-	void parseObject(QString label, QJsonObject obj){
-	  if( label.isEmpty() || !obj.contains("type") ){ return; }
-          QString type = obj.value("type").toString();
-	  if(type.toLower()=="item"){
-	    QAction *act = this->addAction(label);
-	    if(obj.contains("icon")){ act->setIcon( LXDG::findIcon(obj.value("icon").toString(),"") ); }
-	    if(obj.contains("action")){ act->setWhatsThis( obj.value("action").toString() ); }
-	    else{ act->setEnabled(false); } //not interactive
-	  }else if(type.toLower()=="menu"){
-	    
-	  }else if(type.toLower()=="jsonmenu"){
-	    //This is a recursive JSON menu object
-	    if(!obj.contains("exec")){ return; }
-	    JsonMenu *menu = new JsonMenu(obj.value("exec").toString(), this);
-	      menu->setTitle(label);
-	      if(obj.contains("icon")){ menu->setIcon(LXDG::findIcon(obj.value("icon").toString(),"") ); }
-	    this->addMenu(menu);
-	  }
-	}
-
-	void updateMenu(){
-          this->clear();
-	  QJsonDocument doc = QJsonDocument::fromJson( LUtils::getCmdOutput(exec).join(" ").toLocal8Bit() );
-          if(doc.isNull() || !doc.isObject()){
-	    this->addAction( QString(tr("Error parsing script output: %1")).arg("\n"+exec) )->setEnabled(false);
-	  }else{
-	    QStringList keys = doc.object().keys();
-	    for(int i=0; i<keys.length(); i++){
-	      if(doc.object().value(keys[i]).isObject()){
-	        parseObject(keys[i], doc.object().value(keys[i]).toObject());
-	      }
-	    }
-	  }
-	}
-
-	void itemTriggered(QAction *act){
-	  if(act->parent()!=this || act->whatsThis().isEmpty() ){ return; } //only handle direct child actions - needed for recursive nature of menu
-	  QString cmd = act->whatsThis();
-	  QString bin = cmd.section(" ",0,0);
-	  if( !LUtils::isValidBinary(bin) ){ cmd.prepend("lumina-open "); }
-	  LSession::handle()->LaunchApplication(cmd);
-	}
+	void aboutToShowMenu();
+	void scriptFinished(int retcode, QStringList output);
+	void parseFinished();
+	void itemTriggered(QAction*);
 };
 #endif
@@ -75,6 +75,7 @@ private:
 	QWidgetAction *wkspaceact;
 	QList<LDPlugin*> PLUGINS;
 	QString CBG; //current background
+	QString bgKey; //ID of the background which is being loaded/shown (LBackgroundCache)
 	QRect globalWorkRect;
 	
 private slots:
@@ -103,5 +104,6 @@ private slots:
 	void UpdateDesktopPluginArea(); //make sure the area is not underneath any panels
 
 	void UpdateBackground();
+	void BackgroundLoaded(QString key);
 };
 #endif
@@ -10,6 +10,9 @@
 #include <QString>
 #include <QWidget>
 #include <QPixmap>
+#include <QImage>
+#include <QHash>
+#include <QFutureWatcher>
 
 class LDesktopBackground: public QWidget {
     Q_OBJECT
@@ -19,9 +22,39 @@ public:
 
     virtual void paintEvent(QPaintEvent*);
     static QPixmap setBackground(const QString&, const QString&, QRect geom);
+    //Thread-safe version of setBackground (decodes the file at the needed size)
+    static QImage renderBackground(QString bgFile, QString format, QSize size);
 
 private:
     QPixmap *bgPixmap;
 };
 
+//Prepares the wallpapers in a worker thread and shares them between the screens
+//  The rendered images are also saved on disk, so they can be re-used on the next startup/rotation
+class LBackgroundCache : public QObject{
+    Q_OBJECT
+public:
+    static LBackgroundCache* instance();
+
+    QString key(QString bgFile, QString format, QSize size); //file, modification time, size and format
+    QPixmap pixmap(QString key); //null pixmap if it is not loaded yet
+    void load(QString bgFile, QString format, QSize size); //emits loaded() once the pixmap is available
+
+private:
+    LBackgroundCache();
+    ~LBackgroundCache();
+
+    QHash<QString, QPixmap> pixmaps; //loaded backgrounds
+    QHash<QString, QFutureWatcher<QImage>*> loading;
+
+    static QString cacheDir();
+    static QImage prepareImage(QString bgFile, QString format, QSize size, QString cacheFile);
+
+private slots:
+    void imageReady();
+
+signals:
+    void loaded(QString key);
+};
+
 #endif // _LUMINA_DESKTOP_LDESKTOPBACKGROUND_H_
@@ -16,6 +16,8 @@
 //LibLumina X11 class
 #include <LuminaX11.h>
 #include <LUtils.h>
+#include <LCommand.h>
+#include <LTimerService.h>
 #include <ExternalProcess.h>
 
 #include <unistd.h> //for usleep() usage
@@ -45,8 +47,12 @@ LSession::LSession(int &argc, char ** argv) : LSingleApplication(argc, argv, "lu
   TrayDmgEvent = 0;
   TrayDmgError = 0;
   lastActiveWin = 0; 
+  eventActiveWin = 0;
   cleansession = true;
   TrayStopping = false;
+  ssaverWatch = 0;
+  ssaverDelay = SSAVER_RESTART;
+  ssaverPending = false;
   screenTimer = new QTimer(this);
     screenTimer->setSingleShot(true);
     screenTimer->setInterval(50);
@@ -64,6 +70,7 @@ LSession::LSession(int &argc, char ** argv) : LSingleApplication(argc, argv, "lu
   //Setup the event filter for Qt5
   evFilter =  new XCBEventFilter(this);
   this->installNativeEventFilter( evFilter );
+  XCB->EnableWindowCache(); //window info is kept current by the property events from the filter
   connect(this, SIGNAL(screenAdded(QScreen*)), this, SLOT(screensChanged()) );
   connect(this, SIGNAL(screenRemoved(QScreen*)), this, SLOT(screensChanged()) );
   connect(this, SIGNAL(primaryScreenChanged(QScreen*)), this, SLOT(screensChanged()) );
@@ -187,6 +194,7 @@ void LSession::CleanupSession(){
   if( playaudio ){ playAudioFile(LOS::LuminaShare()+"Logout.ogg"); }
   //Stop the background system tray (detaching/closing apps as necessary)
   stopSystemTray(!cleansession);
+  if(ssaverWatch!=0){ ssaverWatch->disconnect(); ssaverWatch->kill(); ssaverWatch = 0; }
   //Now perform any other cleanup
   if(cleansession){
     //Close any open windows
@@ -260,10 +268,49 @@ void LSession::NewCommunication(QStringList list){
   }	  
 }
 
+void LSession::screensaverEvent(){
+  //One line per event: "BLANK <time>", "LOCK <time>", "UNBLANK <time>", "RUN <n>"
+  QStringList lines = QString(ssaverWatch->readAllStandardOutput()).split("\n", QString::SkipEmptyParts);
+  for(int i=0; i<lines.length(); i++){
+    QString event = lines[i].section(" ",0,0).simplified();
+    if(event=="BLANK" || event=="LOCK"){ LTimerService::instance()->setBlanked(true); }
+    else if(event=="UNBLANK"){ LTimerService::instance()->setBlanked(false); }
+  }
+}
+
+void LSession::startScreensaverWatch(){
+  ssaverPending = false;
+  if(ssaverWatch==0 || ssaverWatch->state()!=QProcess::NotRunning){ return; } //session is closing, or still running
+  ssaverStarted = QDateTime::currentDateTime();
+  ssaverWatch->start("xscreensaver-command -watch", QIODevice::ReadOnly);
+}
+
+void LSession::screensaverWatchStopped(){
+  //Note: a crash gives both the error() and finished() signals (the process is still flagged as running for the first)
+  if(ssaverWatch==0 || ssaverPending || ssaverWatch->state()!=QProcess::NotRunning){ return; }
+  ssaverPending = true;
+  LTimerService::instance()->setBlanked(false); //unknown now - do not leave everything paused
+  //Back off while it keeps failing (xscreensaver not running yet/anymore)
+  if(ssaverStarted.secsTo(QDateTime::currentDateTime()) >= SSAVER_STABLE){ ssaverDelay = SSAVER_RESTART; }
+  qDebug() << "xscreensaver watcher stopped - restarting in" << ssaverDelay << "seconds";
+  QTimer::singleShot(ssaverDelay*1000, this, SLOT(startScreensaverWatch()) );
+  ssaverDelay = qMin(ssaverDelay*2, SSAVER_RESTART_MAX);
+}
+
 void LSession::launchStartupApps(){
   //First start any system-defined startups, then do user defined
   qDebug() << "Launching startup applications";
 
+  //Watch for the screen getting blanked (no periodic updates of the visuals while nothing can be seen)
+  if(LUtils::isValidBinary("xscreensaver-command")){
+    ssaverWatch = new QProcess(this);
+      ssaverWatch->setProcessChannelMode(QProcess::MergedChannels);
+    connect(ssaverWatch, SIGNAL(readyReadStandardOutput()), this, SLOT(screensaverEvent()) );
+    connect(ssaverWatch, SIGNAL(finished(int, QProcess::ExitStatus)), this, SLOT(screensaverWatchStopped()) );
+    connect(ssaverWatch, SIGNAL(error(QProcess::ProcessError)), this, SLOT(screensaverWatchStopped()) );
+    startScreensaverWatch();
+  }
+
   //Enable Numlock
   if(LUtils::isValidBinary("numlockx")){ //make sure numlockx is installed
     if(sessionsettings->value("EnableNumlock",false).toBool()){
@@ -383,7 +430,7 @@ void LSession::checkUserFiles(){
 }
 
 void LSession::refreshWindowManager(){
-  LUtils::runCmd("touch \""+QString(getenv("XDG_CONFIG_HOME"))+"/lumina-desktop/fluxbox-init\"" );
+  LCommand::run("touch", QStringList() << QString(getenv("XDG_CONFIG_HOME"))+"/lumina-desktop/fluxbox-init" ); //no need to wait
 }
 
 void LSession::updateDesktops(){
@@ -623,32 +670,50 @@ void LSession::RootSizeChange(){
 void LSession::WindowPropertyEvent(){
   if(DEBUG){ qDebug() << "Window Property Event"; }
   QList<WId> newapps = XCB->WindowList();
-  if(RunningApps.length() < newapps.length()){
+  QList<WId> added, removed;
+  for(int i=0; i<newapps.length(); i++){
+    if(!RunningApps.contains(newapps[i])){ added << newapps[i]; }
+  }
+  for(int i=0; i<RunningApps.length(); i++){
+    if(!newapps.contains(RunningApps[i])){ removed << RunningApps[i]; }
+  }
+  if(!added.isEmpty()){
     //New Window found
     //qDebug() << "New window found";
     LSession::restoreOverrideCursor(); //restore the mouse cursor back to normal (new window opened?)
     //Perform sanity checks on any new window geometries
-    for(int i=0; i<newapps.length() && !TrayStopping; i++){
-      if(!RunningApps.contains(newapps[i])){ 
-        checkWin << newapps[i]; 
-	XCB->SelectInput(newapps[i]); //make sure we get property/focus events for this window
-	if(DEBUG){ qDebug() << "New Window - check geom in a moment:" << XCB->WindowClass(newapps[i]); }
-	QTimer::singleShot(50, this, SLOT(checkWindowGeoms()) );
-      }
+    for(int i=0; i<added.length() && !TrayStopping; i++){
+      checkWin << added[i]; 
+      XCB->SelectInput(added[i]); //make sure we get property/focus events for this window
+      if(DEBUG){ qDebug() << "New Window - check geom in a moment:" << XCB->WindowClass(added[i]); }
+      QTimer::singleShot(50, this, SLOT(checkWindowGeoms()) );
     }
   }
   
-  //Now save the list and send out the event
+  //Now save the list and send out the events
   RunningApps = newapps;
-  emit WindowListEvent();
+  for(int i=0; i<removed.length(); i++){ emit WindowRemoved(removed[i]); }
+  for(int i=0; i<added.length(); i++){ emit WindowAdded(added[i]); }
+  //Active window changes are state changes for both the old and new window
+  WId active = activeWindow();
+  if(active != eventActiveWin){
+    if(RunningApps.contains(eventActiveWin)){ emit WindowStateChanged(eventActiveWin); }
+    if(RunningApps.contains(active) && !added.contains(active)){ emit WindowStateChanged(active); }
+    eventActiveWin = active;
+  }
+  if(!added.isEmpty() || !removed.isEmpty()){ emit WindowListEvent(); }
 }
 
-void LSession::WindowPropertyEvent(WId win){
-  //Emit the single-app signal if the window in question is one used by the task manager
-  if(RunningApps.contains(win)){
+void LSession::WindowPropertyEvent(WId win, xcb_atom_t atom){
+  //Send out the typed signal for windows used by the task manager
+  if(atom==XCB->EWMH._NET_WM_DESKTOP || atom==XCB->EWMH._NET_WM_STATE){
+    //Workspace/sticky changes can move a window into or out of the list
+    WindowPropertyEvent();
+    if(atom==XCB->EWMH._NET_WM_STATE && RunningApps.contains(win)){ emit WindowStateChanged(win); }
+  }else if(RunningApps.contains(win)){
     if(DEBUG){ qDebug() << "Single-window property event"; }
-    //emit WindowListEvent();
-    WindowPropertyEvent(); //Run through the entire routine for window checks
+    if(atom==XCB->EWMH._NET_WM_ICON){ emit WindowIconChanged(win); }
+    else{ emit WindowTitleChanged(win); } //one of the name properties
   }else if(RunningTrayApps.contains(win)){
     emit TrayIconChanged(win);
   }
@@ -674,11 +739,11 @@ void LSession::WindowConfigureEvent(WId win){
     }
 }
 
-void LSession::WindowDamageEvent(WId win){
+void LSession::WindowDamageEvent(WId win, QRect area){
   if(TrayStopping){ return; }
     if(RunningTrayApps.contains(win)){
-      if(DEBUG){ qDebug() << "SysTray: Damage Event"; }
-      emit TrayIconChanged(win); //trigger a repaint event
+      if(DEBUG){ qDebug() << "SysTray: Damage Event" << area; }
+      emit TrayIconDamaged(win, area); //refresh just the changed part of the icon
     }
 }
 
@@ -23,7 +23,10 @@ XCBEventFilter::XCBEventFilter(LSession *sessionhandle) : QAbstractNativeEventFi
 
 void XCBEventFilter::setTrayDamageFlag(int flag){
   //Special flag for system tray damage events
-  TrayDmgFlag = flag + XCB_DAMAGE_NOTIFY; //save the whole flag (no calculations later)
+  // Note: the event code comes from the damage extension ("flag" is only checked for an active tray)
+  const xcb_query_extension_reply_t *ext = xcb_get_extension_data(QX11Info::connection(), &xcb_damage_id);
+  if(flag==0 || ext==0 || !ext->present){ TrayDmgFlag = 0; }
+  else{ TrayDmgFlag = ext->first_event + XCB_DAMAGE_NOTIFY; } //save the whole flag (no calculations later)
 }
 
 //This function format taken directly from the Qt5.3 documentation
@@ -41,6 +44,8 @@ bool XCBEventFilter::nativeEventFilter(const QByteArray &eventType, void *messag
 		//qDebug() << "Property Notify Event:";
 	        //qDebug() << " - Root Window:" << QX11Info::appRootWindow();
 		//qDebug() << " - Given Window:" << ((xcb_property_notify_event_t*)ev)->window;
+		//Flag the changed property in the window cache first
+		session->XCB->WindowCacheEvent( ((xcb_property_notify_event_t*)ev)->window, ((xcb_property_notify_event_t*)ev)->atom);
 		//System-specific proprty change
 		if( ((xcb_property_notify_event_t*)ev)->window == QX11Info::appRootWindow() \
 			&& ( ( ((xcb_property_notify_event_t*)ev)->atom == session->XCB->EWMH._NET_DESKTOP_GEOMETRY) \
@@ -50,15 +55,16 @@ bool XCBEventFilter::nativeEventFilter(const QByteArray &eventType, void *messag
 			&& ( ( ((xcb_property_notify_event_t*)ev)->atom == session->XCB->EWMH._NET_CURRENT_DESKTOP) )){
  		  //qDebug() << "Got Workspace Change";
 		  session->emit WorkspaceChanged();
-		}else if( SysNotifyAtoms.contains( ((xcb_property_notify_event_t*)ev)->atom ) ){
+		  session->WindowPropertyEvent(); //the list of visible windows changes with the workspace
+		}else if( ((xcb_property_notify_event_t*)ev)->window == QX11Info::appRootWindow() \
+			&& SysNotifyAtoms.contains( ((xcb_property_notify_event_t*)ev)->atom ) ){
 		  //Update the status/list of all running windows
 		  session->WindowPropertyEvent();	
 			
 		//window-specific property change
 		}else if( WinNotifyAtoms.contains( ((xcb_property_notify_event_t*)ev)->atom ) ){
 		  //Ping only that window
-		  //session->WindowPropertyEvent( ((xcb_property_notify_event_t*)ev)->window );
-		  session->WindowPropertyEvent();
+		  session->WindowPropertyEvent( ((xcb_property_notify_event_t*)ev)->window, ((xcb_property_notify_event_t*)ev)->atom );
 	        }
 		break;
 //==============================	    
@@ -103,10 +109,9 @@ bool XCBEventFilter::nativeEventFilter(const QByteArray &eventType, void *messag
 	        break;
 //==============================	    
 	    default:
-		if(TrayDmgFlag!=0){
-		  //if( (ev->response_type & ~0x80)==TrayDmgFlag){
-		    session->WindowDamageEvent( ((xcb_damage_notify_event_t*)ev)->drawable );
-		  //}
+		if(TrayDmgFlag!=0 && (ev->response_type & ~0x80)==TrayDmgFlag){
+		  xcb_damage_notify_event_t *dmg = (xcb_damage_notify_event_t*)ev;
+		  session->WindowDamageEvent( dmg->drawable, QRect(dmg->area.x, dmg->area.y, dmg->area.width, dmg->area.height) );
 		}/*else{
 	          qDebug() << "Default Event:" << (ev->response_type & ~0x80);
 	        }*/
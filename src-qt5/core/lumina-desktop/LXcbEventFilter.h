@@ -72,16 +72,16 @@ private:
 					<< session->XCB->EWMH._NET_WM_ICON_NAME \
 					<< session->XCB->EWMH._NET_WM_VISIBLE_ICON_NAME \
 					<< session->XCB->EWMH._NET_WM_ICON \
-					<< session->XCB->EWMH._NET_WM_ICON_GEOMETRY;
+					<< session->XCB->EWMH._NET_WM_STATE \
+					<< session->XCB->EWMH._NET_WM_DESKTOP \
+					<< XCB_ATOM_WM_NAME \
+					<< XCB_ATOM_WM_ICON_NAME;
 		
 	  SysNotifyAtoms.clear();
 	    SysNotifyAtoms << session->XCB->EWMH._NET_CLIENT_LIST \
 					<< session->XCB->EWMH._NET_CLIENT_LIST_STACKING \
 					<< session->XCB->EWMH._NET_CURRENT_DESKTOP \
-					<< session->XCB->EWMH._NET_WM_STATE \
-					<< session->XCB->EWMH._NET_ACTIVE_WINDOW \
-					<< session->XCB->EWMH._NET_WM_ICON \
-					<< session->XCB->EWMH._NET_WM_ICON_GEOMETRY;
+					<< session->XCB->EWMH._NET_ACTIVE_WINDOW;
 	  //_NET_SYSTEM_TRAY_OPCODE
 	  xcb_intern_atom_cookie_t cookie = xcb_intern_atom(QX11Info::connection(), 0, 23,"_NET_SYSTEM_TRAY_OPCODE");
 	    xcb_intern_atom_reply_t *r = xcb_intern_atom_reply(QX11Info::connection(), cookie, NULL);
@@ -3,6 +3,7 @@
 
 #include "LSession.h"
 #include <LuminaOS.h>
+#include <LCommand.h>
 #include <QPoint>
 #include <QCursor>
 #include <QDebug>
@@ -91,7 +92,11 @@ void SystemWindow::sysSuspend(){
   this->hide();
   LSession::processEvents();
   //Make sure to lock the system first (otherwise anybody can access it again)
-  LUtils::runCmd("xscreensaver-command -lock");
+  LCommand *cmd = LCommand::run("xscreensaver-command -lock", QStringList(), 5000);
+  connect(cmd, SIGNAL(finished(int, QStringList)), this, SLOT(sysSuspendLocked()) );
+}
+
+void SystemWindow::sysSuspendLocked(){
   //Now suspend the system
   LOS::systemSuspend();
 }
@@ -16,6 +16,10 @@
 #include <QTimer>
 #include <QXmlStreamReader> //Contained in the Qt "core" module - don't need the full "xml" module for this
 #include <QSslError>
+#include <QFutureWatcher>
+
+#define RSS_RETRY_MINUTES 5 //first retry after a failed sync (doubled after every failure)
+#define RSS_RETRY_MAX 360 //maximum minutes between retries of a failing feed
 
 struct RSSitem{
   //Required Fields
@@ -51,6 +55,16 @@ struct RSSchannel{
   //Internal data for bookkeeping
   QDateTime lastsync, nextsync;
   QString originalURL; //in case it was redirected to some "fixed" url later
+  QString etag, lastmodified; //validators from the server for conditional requests
+  int errors; //number of failed syncs in a row
+};
+
+//Feed which is being parsed in a worker thread
+struct RSSparse{
+  QString key; //hash key when the parse started
+  bool fromcache; //loaded from the disk cache instead of the network
+  QString etag, lastmodified;
+  int maxage; //seconds the server says the feed stays fresh (-1: not given)
 };
 
 class RSSReader : public QObject{
@@ -74,9 +88,9 @@ private:
 	//Internal data objects
 	QHash<QString, RSSchannel> hash; // ID/data
         QString setprefix;
-	QTimer *syncTimer;	
 	QNetworkAccessManager *NMAN;
         QStringList outstandingURLS;
+	QHash<QFutureWatcher<RSSchannel>*, RSSparse> parsing;
 
 
 	//Simple hash data search functions
@@ -84,18 +98,30 @@ private:
 
 	//Network request function
 	void requestRSS(QString url);
+	void syncFailed(QString key); //back off before the next attempt
+
+	//Disk cache functions (one set of files per feed, named after the original URL)
+	static QString cacheFile(QString url, QString suffix);
+	bool loadCache(QString key);
+	void saveCacheInfo(QString key);
+
+	//Feed parsing (worker thread)
+	void startParse(RSSparse job, QByteArray data);
+	static RSSchannel readFeed(QByteArray data, QString cachefile);
+	void channelReady(RSSparse job, RSSchannel info);
 	
 	//RSS parsing functions
-	RSSchannel readRSS(QByteArray bytes);
-	RSSchannel readRSSChannel(QXmlStreamReader *rss);
-	RSSitem readRSSItem(QXmlStreamReader *rss);
-        void readRSSImage(RSSchannel *item, QXmlStreamReader *rss);
-	QDateTime RSSDateTime(QString datetime);
+	static RSSchannel readRSS(QByteArray bytes);
+	static RSSchannel readRSSChannel(QXmlStreamReader *rss);
+	static RSSitem readRSSItem(QXmlStreamReader *rss);
+        static void readRSSImage(RSSchannel *item, QXmlStreamReader *rss);
+	static QDateTime RSSDateTime(QString datetime);
 
 private slots:
 	void replyFinished(QNetworkReply *reply);
 	void sslErrors(QNetworkReply *reply, const QList<QSslError> &errors);
 	void checkTimes();
+	void parseFinished();
 
 signals:
 	void rssChanged(QString); //ID
@@ -10,14 +10,17 @@
 
 #include <LuminaXDG.h>
 #include <LuminaOS.h>
+#include <LSysMetrics.h>
 
 MonitorWidget::MonitorWidget(QWidget *parent) : QWidget(parent), ui(new Ui::MonitorWidget()){
   ui->setupUi(this); //load the designer form
-  upTimer = new QTimer(this);
-    upTimer->setInterval(2000); //update every 2 seconds
-  connect(upTimer, SIGNAL(timeout()), this, SLOT(UpdateStats()) );
+  //The statistics are checked periodically by the shared system metrics provider
+  connect(LSysMetrics::instance(), SIGNAL(cpuChanged()), this, SLOT(UpdateStats()) );
+  connect(LSysMetrics::instance(), SIGNAL(memoryChanged()), this, SLOT(UpdateStats()) );
+  connect(LSysMetrics::instance(), SIGNAL(diskUsageChanged()), this, SLOT(UpdateStats()) );
+  LSysMetrics::instance()->addStatsConsumer(this); //only checked while this can be seen
   LoadIcons();
-  upTimer->start();
+  UpdateStats();
 }
 
 MonitorWidget::~MonitorWidget(){
@@ -33,18 +36,19 @@ void MonitorWidget::LoadIcons(){
 
 void MonitorWidget::UpdateStats(){ 
   //qDebug() << "Updating System statistics...";
-  ui->label_temps->setText( LOS::CPUTemperatures().join(", ") );
+  LSysMetrics *metrics = LSysMetrics::instance();
+  ui->label_temps->setText( metrics->cpuTemperatures().join(", ") );
   if(ui->progress_cpu->isEnabled()){
-    int perc = LOS::CPUUsagePercent();
+    int perc = metrics->cpuUsagePercent();
     ui->progress_cpu->setValue(perc);
     if(perc<0){ ui->progress_cpu->setEnabled(false); } //disable this for future checks
   }
   if(ui->progress_mem->isEnabled()){
-    int perc = LOS::MemoryUsagePercent();
+    int perc = metrics->memoryUsagePercent();
     ui->progress_mem->setValue(perc);
     if(perc<0){ ui->progress_mem->setEnabled(false); } //disable this for future checks
   }
-  ui->label_diskinfo->setText( LOS::DiskUsage().join("\n") );
+  ui->label_diskinfo->setText( metrics->diskUsage().join("\n") );
   //Also perform/update the logs as necessary
   // -- TO DO --
 }
@@ -29,7 +29,6 @@ public slots:
 
 private:
 	Ui::MonitorWidget *ui;
-	QTimer *upTimer;
 
 private slots:
 	void UpdateStats();
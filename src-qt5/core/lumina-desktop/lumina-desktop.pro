@@ -32,6 +32,7 @@ SOURCES += main.cpp \
 	SettingsMenu.cpp \
 	SystemWindow.cpp \
 	BootSplash.cpp \
+	JsonMenu.cpp \
 	desktop-plugins/LDPlugin.cpp
 
 
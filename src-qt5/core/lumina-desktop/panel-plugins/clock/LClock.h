@@ -31,7 +31,6 @@ public:
 	~LClock();
 	
 private:
-	QTimer *timer;
 	QToolButton *button; //RotateToolButton
 	QString timefmt, datefmt, datetimeorder;
 	bool deftime, defdate;
@@ -5,11 +5,10 @@
 //  See the LICENSE file for full details
 //===========================================
 #include "LSysDashboard.h"
+#include <LTimerService.h>
 
 LSysDashboard::LSysDashboard(QWidget *parent, QString id, bool horizontal) : LPPlugin(parent, id, horizontal){
-  upTimer = new QTimer(this);
-    upTimer->setInterval(10000); //10 second update ping
-    connect(upTimer, SIGNAL(timeout()), this, SLOT(updateIcon()));
+  polling = false;
   button = new QToolButton(this);
     button->setAutoRaise(true);
     button->setToolButtonStyle(Qt::ToolButtonIconOnly);
@@ -30,7 +29,7 @@ LSysDashboard::LSysDashboard(QWidget *parent, QString id, bool horizontal) : LPP
 }
 
 LSysDashboard::~LSysDashboard(){
-
+  LTimerService::instance()->unsubscribe(this);
 }
 
 // ========================
@@ -66,12 +65,16 @@ void LSysDashboard::updateIcon(bool force){
       }
     //Save the values for comparison later
     batcharging = charging;
-    if( !upTimer->isActive() ){ upTimer->start(); } //only use the timer if a battery is present
+    if( !polling ){
+      //only use the timer if a battery is present (10 second update ping)
+      LTimerService::instance()->subscribe(this, SLOT(updateIcon()), 10000, 5000, this);
+      polling = true;
+    }
 
   // No battery - just use/set the normal icon
   }else if(force || button->icon().isNull()){
     resetIcon();
-    if(upTimer->isActive() ){ upTimer->stop(); } //no battery available - no refresh timer needed
+    if(polling){ LTimerService::instance()->unsubscribe(this); polling = false; } //no battery available - no refresh timer needed
   }
   
 }
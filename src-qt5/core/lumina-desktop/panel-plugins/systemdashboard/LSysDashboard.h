@@ -41,7 +41,7 @@ private:
 	QWidgetAction *mact;
 	LSysMenuQuick *sysmenu;
 	QToolButton *button;
-	QTimer *upTimer;
+	bool polling; //battery refresh is running
 	
 private slots:
 	void updateIcon(bool force = false);
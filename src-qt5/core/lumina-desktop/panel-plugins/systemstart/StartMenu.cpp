@@ -9,6 +9,8 @@
 //#include <QtConcurrent>
 
 #include <LuminaOS.h>
+#include <LCommand.h>
+#include <LSysMetrics.h>
 #include "../../LSession.h"
 #include <QtConcurrent>
 #include <QMessageBox>
@@ -23,8 +25,11 @@ StartMenu::StartMenu(QWidget *parent) : QWidget(parent), ui(new Ui::StartMenu){
     searchTimer->setInterval(300); //~1/3 second
     searchTimer->setSingleShot(true);
   connect(searchTimer, SIGNAL(timeout()), this, SLOT(startSearch()) );
-  connect(LSession::handle()->applicationMenu(), SIGNAL(AppMenuUpdated()), this, SLOT(UpdateApps()) );
+  connect(LSession::handle()->applicationMenu(), SIGNAL(AppMenuUpdated()), this, SLOT(AppsChanged()) );
   connect(LSession::handle(), SIGNAL(FavoritesChanged()), this, SLOT(UpdateFavs()) );
+  //The volume/brightness are read in the background (the first time, or when they change)
+  connect(LSysMetrics::instance(), SIGNAL(audioVolumeChanged()), this, SLOT(UpdateControls()) );
+  connect(LSysMetrics::instance(), SIGNAL(screenBrightnessChanged()), this, SLOT(UpdateControls()) );
   //Need to load the last used setting of the application list
   QString state = LSession::handle()->DesktopPluginSettings()->value("panelPlugs/systemstart/showcategories", "partial").toString();
   if(state=="partial"){ui->check_apps_showcats->setCheckState(Qt::PartiallyChecked); }
@@ -37,7 +42,11 @@ StartMenu::StartMenu(QWidget *parent) : QWidget(parent), ui(new Ui::StartMenu){
 }
 
 StartMenu::~StartMenu(){
-	
+  //The cached views which are not currently shown do not have a parent
+  QList<QWidget*> views = appViews.values();
+  for(int i=0; i<views.length(); i++){
+    if(views[i]!=ui->scroll_apps->widget()){ delete views[i]; }
+  }
 }
 
 void StartMenu::UpdateAll(){
@@ -87,10 +96,8 @@ void StartMenu::UpdateAll(){
        ui->tool_launch_store->setIcon(LXDG::findIcon(desk.icon,"utilities-file-archiver"));
     }else{ ui->tool_launch_store->setVisible(false); }
   }else{ ui->tool_launch_store->setVisible(false); }
-  //Audio Controls
-  ui->frame_audio->setVisible( LOS::audioVolume() >=0 );
-  //Brightness controls
-  ui->frame_bright->setVisible( LOS::ScreenBrightness() >=0 );
+  //Audio/Brightness Controls (last known values)
+  UpdateControls();
   //Shutdown/restart
   bool ok = LOS::userHasShutdownAccess();
   ui->frame_leave_system->setWhatsThis(ok ? "allowed": "");
@@ -240,37 +247,25 @@ void StartMenu::do_search(QString search, bool force){
   ClearScrollArea(ui->scroll_search);
   topsearch.clear();
   //Now find any items which match the search
-  QStringList found; //syntax: [<sorter>::::<mimetype>::::<filepath>]
   QString tmp = search;
-  if(LUtils::isValidBinary(tmp)){ found << "0::::application/x-executable::::"+tmp; }
-  QList<XDGDesktop*> apps = LSession::handle()->applicationMenu()->currentAppHash()->value("All");
-  for(int i=0; i<apps.length(); i++){
-    int priority = -1;
-    if(apps[i]->name.toLower()==search.toLower()){ priority = 10; }
-    else if(apps[i]->name.startsWith(search, Qt::CaseInsensitive)){ priority = 15; }
-    else if(apps[i]->name.contains(search, Qt::CaseInsensitive)){ priority = 19; }
-    else if(apps[i]->genericName.contains(search, Qt::CaseInsensitive)){ priority = 20; }
-    else if(apps[i]->comment.contains(search, Qt::CaseInsensitive)){ priority = 30; }
-    //Can add other filters here later
-
-    if(priority>0){
-      found << QString::number(priority)+"::::app::::"+apps[i]->filePath;
-    }
-  }
-  found.sort(Qt::CaseInsensitive); //sort by priority/type (lower numbers are higher on list)
-  //qDebug() << "Sorted Items:" << found;
-  //Now add the items to the menu in order
-  for(int i=0; i<found.length(); i++){
-    if( !QFile::exists(found[i].section("::::",2,-1)) ){ continue; } //invalid favorite - skip it
-    if(topsearch.isEmpty()){ topsearch = found[i].section("::::",2,-1); }
-    ItemWidget *it = 0;
-    if( found[i].section("::::",2,-1).endsWith(".desktop")){
-      XDGDesktop item(found[i].section("::::",2,-1));
-      if(item.isValid()){ it = new ItemWidget(ui->scroll_favs->widget(), &item); }
+  if(LUtils::isValidBinary(tmp) && QFile::exists(tmp)){
+    ItemWidget *it = new ItemWidget(ui->scroll_favs->widget(), tmp, "application/x-executable");
+    if(it->gooditem){
+      topsearch = tmp;
+      ui->scroll_search->widget()->layout()->addWidget(it);
+      connect(it, SIGNAL(NewShortcut()), this, SLOT(UpdateFavs()) );
+      connect(it, SIGNAL(RemovedShortcut()), this, SLOT(UpdateFavs()) );
+      connect(it, SIGNAL(RunItem(QString)), this, SLOT(LaunchItem(QString)) );
+      connect(it, SIGNAL(toggleQuickLaunch(QString, bool)), this, SLOT(UpdateQuickLaunch(QString, bool)) );
     }else{
-      it = new ItemWidget(ui->scroll_favs->widget(), found[i].section("::::",2,-1), found[i].section("::::",1,1) );
+      it->deleteLater();
     }
-    if(it==0){ continue; }
+  }
+  //Apps are ranked by the index (best match first) and use the already-loaded structures
+  QList<XDGDesktop*> apps = LSession::handle()->applicationMenu()->currentAppIndex()->search(search);
+  for(int i=0; i<apps.length(); i++){
+    if(topsearch.isEmpty()){ topsearch = apps[i]->filePath; }
+    ItemWidget *it = new ItemWidget(ui->scroll_favs->widget(), apps[i]);
     if(!it->gooditem){ it->deleteLater(); continue; } //invalid for some reason
     ui->scroll_search->widget()->layout()->addWidget(it);
     connect(it, SIGNAL(NewShortcut()), this, SLOT(UpdateFavs()) );
@@ -325,14 +320,50 @@ void StartMenu::ChangeCategory(QString cat){
 }
 
 //Listing Update routines
+void StartMenu::AppsChanged(){
+  //Application list changed - the cached views need to be re-created
+  QWidget *cur = ui->scroll_apps->takeWidget();
+  if(cur!=0 && !appViews.values().contains(cur)){ cur->deleteLater(); }
+  QList<QWidget*> views = appViews.values();
+  for(int i=0; i<views.length(); i++){ views[i]->deleteLater(); }
+  appViews.clear();
+  UpdateApps();
+}
+
 void StartMenu::UpdateApps(){
-  ClearScrollArea(ui->scroll_apps);
-  //Now assemble the apps list
-  //qDebug() << "Update Apps:";// << CCat << ui->check_apps_showcats->checkState();
+  //Determine which view of the apps to show
+  QString view;
   if(ui->check_apps_showcats->checkState() == Qt::PartiallyChecked){
+    CCat.clear();
+    view = "partial";
+  }else if(ui->check_apps_showcats->checkState() == Qt::Checked){
+    view = CCat.isEmpty() ? "cats" : "cat::::"+CCat;
+  }else{
+    CCat.clear();
+    view = "all";
+  }
+  //Views are only assembled the first time they are needed (until the apps change)
+  if(!appViews.contains(view)){ appViews.insert(view, createAppView(view)); }
+  QWidget *cur = ui->scroll_apps->widget();
+  if(cur == appViews.value(view)){ return; } //already shown
+  ui->scroll_apps->takeWidget(); //keep the old view around for later
+  if(cur!=0 && !appViews.values().contains(cur)){ cur->deleteLater(); }
+  ui->scroll_apps->setWidget(appViews.value(view));
+}
+
+QWidget* StartMenu::createAppView(QString view){
+  //Assemble the apps list
+  //qDebug() << "Create Apps View:" << view;
+  QWidget *list = new QWidget(ui->scroll_apps);
+  QVBoxLayout *layout = new QVBoxLayout(list);
+    layout->setSpacing(2);
+    layout->setContentsMargins(3,1,3,1);
+    layout->setDirection(QBoxLayout::TopToBottom);
+    layout->setAlignment(Qt::AlignTop);
+    list->setContentsMargins(0,0,0,0);
+  if(view=="partial"){
     //qDebug() << " - Partially Checked";
     //Show a single page of apps, but still divided up by categories
-    CCat.clear();
     QStringList cats = LSession::handle()->applicationMenu()->currentAppHash()->keys();
     cats.sort();
     cats.removeAll("All");
@@ -340,14 +371,14 @@ void StartMenu::UpdateApps(){
       QList<XDGDesktop*> apps = LSession::handle()->applicationMenu()->currentAppHash()->value(cats[c]);
       if(apps.isEmpty()){ continue; }
       //Add the category label to the scroll
-      QLabel *catlabel = new QLabel("<b>"+cats[c]+"</b>",ui->scroll_apps->widget());
+      QLabel *catlabel = new QLabel("<b>"+cats[c]+"</b>",list);
         catlabel->setAlignment(Qt::AlignCenter);
-      ui->scroll_apps->widget()->layout()->addWidget(catlabel);
+      layout->addWidget(catlabel);
       //Now add all the apps for this category
       for(int i=0; i<apps.length(); i++){
-        ItemWidget *it = new ItemWidget(ui->scroll_apps->widget(), apps[i] );
+        ItemWidget *it = new ItemWidget(list, apps[i] );
         if(!it->gooditem){ qDebug() << "Invalid Item:"; it->deleteLater(); continue; } //invalid for some reason
-        ui->scroll_apps->widget()->layout()->addWidget(it);
+        layout->addWidget(it);
         connect(it, SIGNAL(NewShortcut()), this, SLOT(UpdateFavs()) );
         connect(it, SIGNAL(RemovedShortcut()), this, SLOT(UpdateFavs()) );
         connect(it, SIGNAL(RunItem(QString)), this, SLOT(LaunchItem(QString)) );
@@ -355,59 +386,54 @@ void StartMenu::UpdateApps(){
       }
     }
     
-  }else if(ui->check_apps_showcats->checkState() == Qt::Checked){
+  }else if(view=="cats"){
     //qDebug() << " - Checked";
     //Only show categories to start with - and have the user click-into a cat to see apps
-    if(CCat.isEmpty()){
-      //No cat selected yet - show cats only
-      QStringList cats = LSession::handle()->applicationMenu()->currentAppHash()->keys();
-      cats.sort();
-      cats.removeAll("All"); //This is not a "real" category
-      for(int c=0; c<cats.length(); c++){
-	ItemWidget *it = new ItemWidget(ui->scroll_apps->widget(), cats[c], "chcat::::"+cats[c] );
-        if(!it->gooditem){ qDebug() << "Invalid Item:";it->deleteLater(); continue; } //invalid for some reason
-        ui->scroll_apps->widget()->layout()->addWidget(it);
-        connect(it, SIGNAL(RunItem(QString)), this, SLOT(LaunchItem(QString)) );
-      }
-    }else{
-      //qDebug() << "Show Apps For category:" << CCat;
-      //Show the "go back" button
-      ItemWidget *it = new ItemWidget(ui->scroll_apps->widget(), CCat, "chcat::::"+CCat, true);
-        //if(!it->gooditem){ continue; } //invalid for some reason
-        ui->scroll_apps->widget()->layout()->addWidget(it);
-        connect(it, SIGNAL(RunItem(QString)), this, SLOT(LaunchItem(QString)) );
-      //Show apps for this cat
-      QList<XDGDesktop*> apps = LSession::handle()->applicationMenu()->currentAppHash()->value(CCat); 
-      for(int i=0; i<apps.length(); i++){
-	//qDebug() << " - App:" << apps[i].name;
-        ItemWidget *it = new ItemWidget(ui->scroll_apps->widget(), apps[i] );
-        if(!it->gooditem){ qDebug() << "Invalid Item:"; it->deleteLater(); continue; } //invalid for some reason
-        ui->scroll_apps->widget()->layout()->addWidget(it);
-        connect(it, SIGNAL(NewShortcut()), this, SLOT(UpdateFavs()) );
-        connect(it, SIGNAL(RemovedShortcut()), this, SLOT(UpdateFavs()) );
-        connect(it, SIGNAL(RunItem(QString)), this, SLOT(LaunchItem(QString)) );
-        connect(it, SIGNAL(toggleQuickLaunch(QString, bool)), this, SLOT(UpdateQuickLaunch(QString, bool)) );
-      }
+    QStringList cats = LSession::handle()->applicationMenu()->currentAppHash()->keys();
+    cats.sort();
+    cats.removeAll("All"); //This is not a "real" category
+    for(int c=0; c<cats.length(); c++){
+      ItemWidget *it = new ItemWidget(list, cats[c], "chcat::::"+cats[c] );
+      if(!it->gooditem){ qDebug() << "Invalid Item:";it->deleteLater(); continue; } //invalid for some reason
+      layout->addWidget(it);
+      connect(it, SIGNAL(RunItem(QString)), this, SLOT(LaunchItem(QString)) );
     }
-    
+
+  }else if(view.startsWith("cat::::")){
+    QString cat = view.section("::::",1,-1);
+    //qDebug() << "Show Apps For category:" << cat;
+    //Show the "go back" button
+    ItemWidget *it = new ItemWidget(list, cat, "chcat::::"+cat, true);
+      layout->addWidget(it);
+      connect(it, SIGNAL(RunItem(QString)), this, SLOT(LaunchItem(QString)) );
+    //Show apps for this cat
+    QList<XDGDesktop*> apps = LSession::handle()->applicationMenu()->currentAppHash()->value(cat); 
+    for(int i=0; i<apps.length(); i++){
+      //qDebug() << " - App:" << apps[i].name;
+      ItemWidget *it = new ItemWidget(list, apps[i] );
+      if(!it->gooditem){ qDebug() << "Invalid Item:"; it->deleteLater(); continue; } //invalid for some reason
+      layout->addWidget(it);
+      connect(it, SIGNAL(NewShortcut()), this, SLOT(UpdateFavs()) );
+      connect(it, SIGNAL(RemovedShortcut()), this, SLOT(UpdateFavs()) );
+      connect(it, SIGNAL(RunItem(QString)), this, SLOT(LaunchItem(QString)) );
+      connect(it, SIGNAL(toggleQuickLaunch(QString, bool)), this, SLOT(UpdateQuickLaunch(QString, bool)) );
+    }
+
   }else{
     //qDebug() << " - Not Checked";
     //No categories at all - just alphabetize all the apps
     QList<XDGDesktop*> apps = LSession::handle()->applicationMenu()->currentAppHash()->value("All"); 
-    CCat.clear();
-    //Now add all the apps for this category
-   for(int i=0; i<apps.length(); i++){
-      ItemWidget *it = new ItemWidget(ui->scroll_apps->widget(), apps[i] );
+    for(int i=0; i<apps.length(); i++){
+      ItemWidget *it = new ItemWidget(list, apps[i] );
       if(!it->gooditem){ it->deleteLater(); continue; } //invalid for some reason
-      ui->scroll_apps->widget()->layout()->addWidget(it);
+      layout->addWidget(it);
       connect(it, SIGNAL(NewShortcut()), this, SLOT(UpdateFavs()) );
       connect(it, SIGNAL(RemovedShortcut()), this, SLOT(UpdateFavs()) );
       connect(it, SIGNAL(RunItem(QString)), this, SLOT(LaunchItem(QString)) );
       connect(it, SIGNAL(toggleQuickLaunch(QString, bool)), this, SLOT(UpdateQuickLaunch(QString, bool)) );
     }
   }
-  
-  
+  return list;
 }
 
 void StartMenu::UpdateFavs(){
@@ -415,64 +441,52 @@ void StartMenu::UpdateFavs(){
   QStringList newfavs = LDesktopUtils::listFavorites();
   if(favs == newfavs){ return; } //nothing to do - same as before
   favs = newfavs;
-  ClearScrollArea(ui->scroll_favs);
   favs.sort();
-  //Iterate over types of favorites
-  QStringList rest = favs;
-  QStringList tmp;
-  for(int type = 0; type<3; type++){
-    if(type==0){ tmp = favs.filter("::::app::::"); } //apps first
-    else if(type==1){ tmp = favs.filter("::::dir::::"); } //dirs next
-    else{ tmp = rest;  } //everything left over
-    if(type==1){
-      SortScrollArea(ui->scroll_favs);
-      //Need to run a special routine for sorting the apps (already in the widget)
-      //qDebug() << "Sort App Widgets...";
-      // Since each app actually might have a different name listed within the file
-      /*QLayout *lay = ui->scroll_favs->widget()->layout();
-      QStringList items;
-      for(int i=0; i<lay->count(); i++){
-        items << lay->itemAt(i)->widget()->whatsThis().toLower();
-      }
-  
-      items.sort();
-     // qDebug() << " - Sorted Items:" << items;
-      for(int i=0; i<items.length(); i++){
-        if(items[i].isEmpty()){ continue; }
-        //QLayouts are weird in that they can only add items to the end - need to re-insert almost every item
-        for(int j=0; j<lay->count(); j++){
-          //Find this item
-          if(lay->itemAt(j)->widget()->whatsThis().toLower()==items[i]){
-	    //Found it - now move it if necessary
-	    //qDebug() << "Found Item:" << items[i] << i << j;
-	    lay->addItem( lay->takeAt(j) );
-	    break;
-          }
-        }
-      }*/
-      
-    }//end of special app sorting routine
-    tmp.sort(); //Sort alphabetically by name (dirs/files)
-    for(int i=0; i<tmp.length(); i++){
-      if(type<2){ rest.removeAll(tmp[i]); }
-      if( !QFile::exists(tmp[i].section("::::",2,-1)) ){ continue; } //invalid favorite - skip it
-      ItemWidget *it = 0;
-      if( tmp[i].section("::::",2,-1).endsWith(".desktop")){
-        XDGDesktop item(tmp[i].section("::::",2,-1));
-	if(item.isValid()){ it = new ItemWidget(ui->scroll_favs->widget(), &item); }
-      }else{
-        it = new ItemWidget(ui->scroll_favs->widget(), tmp[i].section("::::",2,-1), tmp[i].section("::::",1,1) );
-      }
-      if(it==0){ continue; }
-      if(!it->gooditem){ it->deleteLater(); continue; } //invalid for some reason
-      ui->scroll_favs->widget()->layout()->addWidget(it);
-      connect(it, SIGNAL(NewShortcut()), this, SLOT(UpdateFavs()) );
-      connect(it, SIGNAL(RemovedShortcut()), this, SLOT(UpdateFavs()) );
-      connect(it, SIGNAL(RunItem(QString)), this, SLOT(LaunchItem(QString)) );
-      connect(it, SIGNAL(toggleQuickLaunch(QString, bool)), this, SLOT(UpdateQuickLaunch(QString, bool)) );
+  if(ui->scroll_favs->widget()->layout()==0){ ClearScrollArea(ui->scroll_favs); } //first run - setup the layout
+  //Only changed entries get new widgets (each one loads an icon and checks the file)
+  QStringList old = favItems.keys();
+  for(int i=0; i<old.length(); i++){
+    if(favs.contains(old[i]) && QFile::exists(old[i].section("::::",2,-1)) ){ continue; } //keep this one
+    QWidget *it = favItems.take(old[i]);
+    ui->scroll_favs->widget()->layout()->removeWidget(it);
+    it->deleteLater();
+  }
+  for(int i=0; i<favs.length(); i++){
+    if(favItems.contains(favs[i])){ continue; } //already loaded
+    if( !QFile::exists(favs[i].section("::::",2,-1)) ){ continue; } //invalid favorite - skip it
+    ItemWidget *it = 0;
+    if( favs[i].section("::::",2,-1).endsWith(".desktop")){
+      XDGDesktop item(favs[i].section("::::",2,-1));
+      if(item.isValid()){ it = new ItemWidget(ui->scroll_favs->widget(), &item); }
+    }else{
+      it = new ItemWidget(ui->scroll_favs->widget(), favs[i].section("::::",2,-1), favs[i].section("::::",1,1) );
     }
-    //QApplication::processEvents();
-  } //end loop over types
+    if(it==0){ continue; }
+    if(!it->gooditem){ it->deleteLater(); continue; } //invalid for some reason
+    connect(it, SIGNAL(NewShortcut()), this, SLOT(UpdateFavs()) );
+    connect(it, SIGNAL(RemovedShortcut()), this, SLOT(UpdateFavs()) );
+    connect(it, SIGNAL(RunItem(QString)), this, SLOT(LaunchItem(QString)) );
+    connect(it, SIGNAL(toggleQuickLaunch(QString, bool)), this, SLOT(UpdateQuickLaunch(QString, bool)) );
+    favItems.insert(favs[i], it);
+  }
+  //Now put them in order: apps first (sorted by the displayed name), then dirs, then everything else
+  QStringList apps, dirs, rest;
+  for(int i=0; i<favs.length(); i++){
+    if(!favItems.contains(favs[i])){ continue; }
+    if(favs[i].contains("::::app::::")){ apps << favItems[favs[i]]->whatsThis()+"\n"+favs[i]; }
+    else if(favs[i].contains("::::dir::::")){ dirs << favs[i]; }
+    else{ rest << favs[i]; }
+  }
+  apps.sort();
+  for(int i=0; i<apps.length(); i++){ apps[i] = apps[i].section("\n",-1); }
+  QStringList order; order << apps << dirs << rest;
+  QBoxLayout *lay = static_cast<QBoxLayout*>(ui->scroll_favs->widget()->layout());
+  for(int i=0; i<order.length(); i++){
+    QWidget *it = favItems.value(order[i]);
+    if(lay->indexOf(it)==i){ continue; } //already in the right place
+    lay->removeWidget(it);
+    lay->insertWidget(i, it);
+  }
   ui->scroll_favs->update();
   //qDebug() << "End updateFavs";
 }
@@ -522,14 +536,8 @@ void StartMenu::on_stackedWidget_currentChanged(int val){
     }else{
       ui->frame_wkspace->setVisible(false);
     }
-    // -- Brightness Controls
-    int tmp = LOS::ScreenBrightness();
-    ui->frame_bright->setVisible(tmp >= 0);
-    if(tmp >= 0){ ui->slider_bright->setValue(tmp); }
-    // -- Audio Controls
-    tmp = LOS::audioVolume();
-    ui->frame_audio->setVisible(tmp >= 0);
-    if(tmp >= 0){ ui->slider_volume->setValue(tmp); }
+    // -- Brightness/Audio Controls
+    UpdateControls();
   }else if(page == ui->page_leave){
     if( !ui->frame_leave_system->whatsThis().isEmpty() ){
       //This frame is allowed/visible - need to adjust the shutdown detection
@@ -543,6 +551,17 @@ void StartMenu::on_stackedWidget_currentChanged(int val){
   
 }
 
+void StartMenu::UpdateControls(){
+  // -- Brightness Controls
+  int tmp = LSysMetrics::instance()->screenBrightness();
+  ui->frame_bright->setVisible(tmp >= 0);
+  if(tmp >= 0 && !ui->slider_bright->isSliderDown()){ ui->slider_bright->setValue(tmp); }
+  // -- Audio Controls
+  tmp = LSysMetrics::instance()->audioVolume();
+  ui->frame_audio->setVisible(tmp >= 0);
+  if(tmp >= 0 && !ui->slider_volume->isSliderDown()){ ui->slider_volume->setValue(tmp); }
+}
+
 void StartMenu::catViewChanged(){
   QString state;
   switch(ui->check_apps_showcats->checkState()){
@@ -629,7 +648,11 @@ void StartMenu::on_tool_shutdown_clicked(){
 void StartMenu::on_tool_suspend_clicked(){
   //Make sure to lock the system first (otherwise anybody can access it again)
   emit CloseMenu();
-  LUtils::runCmd("xscreensaver-command -lock");
+  LCommand *cmd = LCommand::run("xscreensaver-command -lock", QStringList(), 5000);
+  connect(cmd, SIGNAL(finished(int, QStringList)), this, SLOT(suspendLocked()) );
+}
+
+void StartMenu::suspendLocked(){
   LOS::systemSuspend();
 }
 
@@ -637,7 +660,7 @@ void StartMenu::on_tool_suspend_clicked(){
 //Audio Volume
 void StartMenu::on_slider_volume_valueChanged(int val){
   ui->label_vol->setText(QString::number(val)+"%");
-  LOS::setAudioVolume(val);
+  LSysMetrics::instance()->setAudioVolume(val); //applied in the background
   //Also adjust the icon for the volume
   if(val<1){ ui->tool_mute_audio->setIcon(LXDG::findIcon("audio-volume-muted","")); }
   else if(val<33){ ui->tool_mute_audio->setIcon(LXDG::findIcon("audio-volume-low","")); }
@@ -664,7 +687,7 @@ void StartMenu::on_tool_mute_audio_clicked(){
 //Screen Brightness
 void StartMenu::on_slider_bright_valueChanged(int val){
   ui->label_bright->setText(QString::number(val)+"%");
-  LOS::setScreenBrightness(val);
+  LSysMetrics::instance()->setScreenBrightness(val); //applied in the background
 }
 
 	
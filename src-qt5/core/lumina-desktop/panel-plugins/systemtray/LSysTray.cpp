@@ -28,6 +28,7 @@ LSysTray::LSysTray(QWidget *parent, QString id, bool horizontal) : LPPlugin(pare
   QTimer::singleShot(90000,this, SLOT(checkAll()) ); 
   connect(LSession::handle(), SIGNAL(TrayListChanged()), this, SLOT(checkAll()) );
   connect(LSession::handle(), SIGNAL(TrayIconChanged(WId)), this, SLOT(UpdateTrayWindow(WId)) );
+  connect(LSession::handle(), SIGNAL(TrayIconDamaged(WId, QRect)), this, SLOT(UpdateTrayDamage(WId, QRect)) );
   connect(LSession::handle(), SIGNAL(VisualTrayAvailable()), this, SLOT(start()) );
 }
 
@@ -152,11 +153,15 @@ void LSysTray::checkAll(){
 }
 
 void LSysTray::UpdateTrayWindow(WId win){
+  UpdateTrayDamage(win, QRect()); //re-read the whole icon
+}
+
+void LSysTray::UpdateTrayDamage(WId win, QRect area){
   if(!isRunning || stopping || checking){ return; }
   for(int i=0; i<trayIcons.length(); i++){
     if(trayIcons[i]->appID()==win){
-      //qDebug() << "System Tray: Update Window " << win;
-      trayIcons[i]->repaint(); //don't use update() because we need an instant repaint (not a cached version)
+      //qDebug() << "System Tray: Update Window " << win << area;
+      trayIcons[i]->damaged(area); //the icon refreshes its cached image at a limited rate
       return; //finished now
     }
   }
@@ -15,6 +15,11 @@ TrayIcon::TrayIcon(QWidget *parent) : QWidget(parent){
   IID = 0;
   dmgID = 0;
   badpaints = 0;
+  dirtyAll = true;
+  refreshTimer = new QTimer(this);
+    refreshTimer->setSingleShot(true);
+    refreshTimer->setInterval(TRAY_REFRESH);
+  connect(refreshTimer, SIGNAL(timeout()), this, SLOT(refreshImage()) );
   //this->setLayout(new QHBoxLayout);
   //this->layout()->setContentsMargins(0,0,0,0);
 }
@@ -24,6 +29,7 @@ TrayIcon::~TrayIcon(){
 
 void TrayIcon::cleanup(){
   AID = IID = 0;
+  refreshTimer->stop();
 }
 
 WId TrayIcon::appID(){
@@ -70,6 +76,17 @@ void TrayIcon::detachApp(){
   LSession::handle()->XCB->UnembedWindow(tmp);
   //qDebug() << " - finished app:" << tmp;
   IID = 0;
+  refreshTimer->stop();
+  trayImg = QImage();
+  scaledPix = QPixmap();
+}
+
+void TrayIcon::damaged(QRect area){
+  if(AID==0){ return; }
+  if(area.isNull()){ dirtyAll = true; }
+  else{ dirty += area; }
+  //Collect all the damage until the next refresh (caps the refresh rate)
+  if(!refreshTimer->isActive()){ refreshTimer->start(); }
 }
 
 // ==============
@@ -80,7 +97,47 @@ void TrayIcon::updateIcon(){
   //Make sure the icon is square
   QSize icosize = this->size();
   LSession::handle()->XCB->ResizeWindow(AID,  icosize.width(), icosize.height());
-  QTimer::singleShot(500, this, SLOT(update()) ); //make sure to re-draw the window in a moment
+  QTimer::singleShot(500, this, SLOT(damaged()) ); //make sure to re-draw the window in a moment
+}
+
+void TrayIcon::refreshImage(){
+  if(AID==0){ return; }
+  //Only read the parts of the app window which changed since the last time
+  bool ok = true;
+  if(dirtyAll || trayImg.isNull()){
+    ok = LSession::handle()->XCB->TrayImageUpdate(AID, trayImg);
+  }else if(dirty.rectCount() > TRAY_MAX_RECTS){
+    ok = LSession::handle()->XCB->TrayImageUpdate(AID, trayImg, dirty.boundingRect());
+  }else{
+    QVector<QRect> rects = dirty.rects();
+    for(int i=0; i<rects.length() && ok; i++){
+      ok = LSession::handle()->XCB->TrayImageUpdate(AID, trayImg, rects[i]);
+    }
+  }
+  dirty = QRegion();
+  dirtyAll = false;
+  if(!ok){
+    badpaints++;
+    if(badpaints>5){
+      qWarning() << " - -  No Tray Icon/Image found!" << "ID:" << AID;
+      AID = 0; //reset back to nothing
+      IID = 0;
+      emit BadIcon(); //removed/destroyed in some non-valid way?
+    }else{
+      dirtyAll = true;
+      QTimer::singleShot(500, this, SLOT(refreshImage()) ); //try again in a moment (the damage refresh rate stays the same)
+    }
+    return;
+  }
+  badpaints = 0; //good image
+  if(this->size() != trayImg.size()){ 
+    QTimer::singleShot(10, this, SLOT(updateIcon()));
+    //Scale it once here instead of on every paint
+    scaledPix = QPixmap::fromImage( trayImg.scaled(this->size(), Qt::KeepAspectRatio, Qt::SmoothTransformation) );
+  }else{
+    scaledPix = QPixmap::fromImage(trayImg);
+  }
+  this->update();
 }
 
 // =============
@@ -89,33 +146,11 @@ void TrayIcon::updateIcon(){
 void TrayIcon::paintEvent(QPaintEvent *event){
   QWidget::paintEvent(event); //make sure the background is already painted
   if(AID!=0){
-    //Update the background on the tray app
-    //qDebug() << "Paint Tray Background";
-    //LSession::handle()->XCB->SetWindowBackground(this, this->geometry(), AID);
-    //qDebug() << "Paint Tray:" << AID;
+    //Now paint the cached tray image on top of the background
+    // Note: the image itself is refreshed by the damage events (see refreshImage())
+    if(scaledPix.isNull()){ damaged(); return; } //nothing read yet
     QPainter painter(this);
-	//Now paint the tray app on top of the background
-	//qDebug() << " - Draw tray:" << AID << IID << this->winId();
-	//qDebug() << " - - " << event->rect().x() << event->rect().y() << event->rect().width() << event->rect().height();
-	//qDebug() << " - Get image:" << AID;
-	QPixmap pix = LSession::handle()->XCB->TrayImage(AID); //= WIN->icon().pixmap(this->size());
-
-	//qDebug() << " - Pix size:" << pix.size().width() << pix.size().height();
-	//qDebug() << " - Geom:" << this->geometry().x() << this->geometry().y() << this->geometry().width() << this->geometry().height();
-	if(!pix.isNull()){
-	  if(this->size() != pix.size()){ QTimer::singleShot(10, this, SLOT(updateIcon())); }
-	  painter.drawPixmap(0,0,this->width(), this->height(), pix.scaled(this->size(), Qt::KeepAspectRatio, Qt::SmoothTransformation) );
-	  badpaints = 0; //good paint
-	}else{
-	  badpaints++;
-	  if(badpaints>5){
-	    qWarning() << " - -  No Tray Icon/Image found!" << "ID:" << AID;
-	    AID = 0; //reset back to nothing
-	    IID = 0;
-	    emit BadIcon(); //removed/destroyed in some non-valid way?
-	  }
-	}
-    //qDebug() << " - Done";
+    painter.drawPixmap(0,0,this->width(), this->height(), scaledPix);
   }
 }
 
@@ -123,6 +158,6 @@ void TrayIcon::resizeEvent(QResizeEvent *event){
   //qDebug() << "Resize Event:" << event->size().width() << event->size().height();	
   if(AID!=0){
     LSession::handle()->XCB->ResizeWindow(AID,  event->size());
-    QTimer::singleShot(500, this, SLOT(update()) ); //make sure to re-draw the window in a moment
+    QTimer::singleShot(500, this, SLOT(damaged()) ); //make sure to re-draw the window in a moment
   }
 }
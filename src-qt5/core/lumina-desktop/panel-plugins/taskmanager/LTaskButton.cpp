@@ -79,6 +79,25 @@ LWinInfo LTaskButton::currentWindow(){
   }
 }
 
+void LTaskButton::setupText(){
+  if(WINLIST.length() == 1){
+    //single window
+    if(showText){ 
+      QString txt = WINLIST[0].text();
+      if(txt.length()>30){ txt.truncate(27); txt.append("..."); }
+      else if(txt.length()<30){ txt = txt.leftJustified(30, ' '); }
+      this->setToolButtonStyle(Qt::ToolButtonTextBesideIcon); this->setText(txt);
+     }else if(noicon){ this->setToolButtonStyle(Qt::ToolButtonTextBesideIcon); this->setText( cname ); }
+    else{ this->setToolButtonStyle(Qt::ToolButtonIconOnly); this->setText(""); }
+    this->setToolTip(WINLIST[0].text());
+  }else if(WINLIST.length() > 1){
+    //multiple windows
+    this->setToolButtonStyle(Qt::ToolButtonTextBesideIcon);
+    if(noicon || showText){ "("+QString::number(WINLIST.length())+") "+cname; }
+    else{ this->setText("("+QString::number(WINLIST.length())+")"); }
+  }
+}
+
 //=============
 //   PUBLIC SLOTS
 //=============
@@ -122,26 +141,53 @@ void LTaskButton::UpdateButton(){
     //single window
     this->setPopupMode(QToolButton::DelayedPopup);
     this->setMenu(actMenu);
-    if(showText){ 
-      QString txt = WINLIST[0].text();
-      if(txt.length()>30){ txt.truncate(27); txt.append("..."); }
-      else if(txt.length()<30){ txt = txt.leftJustified(30, ' '); }
-      this->setToolButtonStyle(Qt::ToolButtonTextBesideIcon); this->setText(txt);
-     }else if(noicon){ this->setToolButtonStyle(Qt::ToolButtonTextBesideIcon); this->setText( cname ); }
-    else{ this->setToolButtonStyle(Qt::ToolButtonIconOnly); this->setText(""); }
-    this->setToolTip(WINLIST[0].text());
   }else if(WINLIST.length() > 1){
     //multiple windows
     this->setPopupMode(QToolButton::InstantPopup);
     this->setMenu(winMenu);
-    this->setToolButtonStyle(Qt::ToolButtonTextBesideIcon);
-    if(noicon || showText){ "("+QString::number(WINLIST.length())+") "+cname; }
-    else{ this->setText("("+QString::number(WINLIST.length())+")"); }
   }
+  setupText();
   this->setState(showstate); //Make sure this is after the button setup so that it properly sets the margins/etc
   cstate = showstate; //save this for later
 }
 
+void LTaskButton::UpdateWindowText(WId win){
+  //Only the title of one window changed - no need to re-sync everything else
+  int index = windows().indexOf(win);
+  if(index<0){ return; }
+  QList<QAction*> acts = winMenu->actions();
+  if(index < acts.length()){ acts[index]->setText( WINLIST[index].text() ); }
+  setupText();
+}
+
+void LTaskButton::UpdateWindowIcon(WId win){
+  int index = windows().indexOf(win);
+  if(index<0){ return; }
+  bool junk;
+  QList<QAction*> acts = winMenu->actions();
+  if(index < acts.length()){ acts[index]->setIcon( WINLIST[index].icon(junk) ); }
+  if(index==0){
+    //The button visuals come from the first window
+    this->setIcon(WINLIST[0].icon(noicon));
+    setupText(); //the text style depends on whether an icon is available
+  }
+}
+
+void LTaskButton::UpdateWindowState(WId win){
+  if(!windows().contains(win)){ return; }
+  LXCB::WINDOWVISIBILITY showstate = LXCB::IGNORE;
+  WId active = LSession::handle()->activeWindow();
+  for(int i=0; i<WINLIST.length(); i++){
+    LXCB::WINDOWVISIBILITY stat = WINLIST[i].status(WINLIST[i].windowID()==win); //only re-read the changed window
+    if(stat<LXCB::ACTIVE && WINLIST[i].windowID() == active){ stat = LXCB::ACTIVE; }
+    if(stat > showstate){ showstate = stat; } //higher priority
+  }
+  if(showstate == cstate){ return; } //nothing to change
+  this->setVisible(showstate != LXCB::IGNORE);
+  this->setState(showstate);
+  cstate = showstate; //save this for later
+}
+
 void LTaskButton::UpdateMenus(){
   //Action menu should be auto-created for the state of the current window (cWin/cstate)
   actMenu->clear();
@@ -49,11 +49,16 @@ private:
 	bool noicon, showText;
 
 	LWinInfo currentWindow(); //For getting the currently-active window
+	void setupText(); //update the button text/tooltip from the current windows
 	LXCB::WINDOWVISIBILITY cstate; //current state of the button
 
 public slots:
 	void UpdateButton(); //re-sync the current window infomation
 	void UpdateMenus(); //re-create the menus (text + icons)
+	//Single-window changes (only touch the parts of the button which are affected)
+	void UpdateWindowText(WId);
+	void UpdateWindowIcon(WId);
+	void UpdateWindowState(WId);
 
 private slots:
 	void buttonClicked();
@@ -8,14 +8,14 @@
 #include "../../LSession.h"
 
 LTaskManagerPlugin::LTaskManagerPlugin(QWidget *parent, QString id, bool horizontal) : LPPlugin(parent, id, horizontal){
-  timer = new QTimer(this);
-	timer->setSingleShot(true);
-	timer->setInterval(10); // 1/100 second
-	connect(timer, SIGNAL(timeout()), this, SLOT(UpdateButtons()) ); 
   usegroups = true; //backwards-compatible default value
   if(id.contains("-nogroups")){ usegroups = false; }
-  connect(LSession::handle(), SIGNAL(WindowListEvent()), this, SLOT(checkWindows()) );
   connect(LSession::handle(), SIGNAL(WindowListEvent(WId)), this, SLOT(UpdateButton(WId)) );
+  connect(LSession::handle(), SIGNAL(WindowAdded(WId)), this, SLOT(WindowAdded(WId)) );
+  connect(LSession::handle(), SIGNAL(WindowRemoved(WId)), this, SLOT(WindowRemoved(WId)) );
+  connect(LSession::handle(), SIGNAL(WindowTitleChanged(WId)), this, SLOT(WindowTitleChanged(WId)) );
+  connect(LSession::handle(), SIGNAL(WindowIconChanged(WId)), this, SLOT(WindowIconChanged(WId)) );
+  connect(LSession::handle(), SIGNAL(WindowStateChanged(WId)), this, SLOT(WindowStateChanged(WId)) );
   this->layout()->setContentsMargins(0,0,0,0);
   QTimer::singleShot(0,this, SLOT(UpdateButtons()) ); //perform an initial sync
   //QTimer::singleShot(100,this, SLOT(OrientationChange()) ); //perform an initial sync
@@ -25,6 +25,58 @@ LTaskManagerPlugin::~LTaskManagerPlugin(){
 	
 }
 
+//==============
+//    PRIVATE
+//==============
+int LTaskManagerPlugin::buttonForWindow(WId win){
+  for(int i=0; i<BUTTONS.length(); i++){
+    if(BUTTONS[i]->windows().contains(win)){ return i; }
+  }
+  return -1;
+}
+
+bool LTaskManagerPlugin::skipTaskbar(WId win){
+  return LSession::handle()->XCB->WM_Get_Window_States(win).contains(LXCB::S_SKIP_TASKBAR);
+}
+
+void LTaskManagerPlugin::addWindowButton(WId win){
+  //Check for a button that this can just be added to
+  QString ctxt = LSession::handle()->XCB->WindowClass(win);
+  for(int b=0; b<BUTTONS.length() && usegroups; b++){
+    if(BUTTONS[b]->classname()== ctxt){
+      //This adds a window to an existing group
+      //qDebug() << "Add Window to Button:" << b;
+      BUTTONS[b]->addWindow(win);
+      return;
+    }
+  }
+  //No group, create a new button
+  //qDebug() << "New Button";
+  LTaskButton *but = new LTaskButton(this, usegroups);
+    but->addWindow( win );
+    if(this->layout()->direction()==QBoxLayout::LeftToRight){
+	but->setIconSize(QSize(this->height(), this->height()));
+    }else{
+	but->setIconSize(QSize(this->width(), this->width()));
+    }
+  this->layout()->addWidget(but);
+  connect(but, SIGNAL(MenuClosed()), this, SIGNAL(MenuClosed()));
+  BUTTONS << but;
+}
+
+void LTaskManagerPlugin::removeWindowButton(WId win){
+  int i = buttonForWindow(win);
+  if(i<0){ return; }
+  if(BUTTONS[i]->windows().length()==1){
+    //Remove the entire button
+    //qDebug() << "Window Closed: Remove Button" ;
+    this->layout()->removeWidget(BUTTONS[i]); //remove from the layout
+    BUTTONS.takeAt(i)->deleteLater();
+  }else{
+    BUTTONS[i]->rmWindow(win); // one of the multiple windows for the button
+  }
+}
+
 //==============
 //    PRIVATE SLOTS
 //==============
@@ -95,34 +147,7 @@ void LTaskManagerPlugin::UpdateButtons(){
   for(int i=0; i<winlist.length(); i++){
     //New windows, create buttons for each (add grouping later)
     if(updating > ctime){ return; } //another thread kicked off already - stop this one
-    //Check for a button that this can just be added to
-    QString ctxt = LSession::handle()->XCB->WindowClass(winlist[i]);
-    bool found = false;
-    for(int b=0; b<BUTTONS.length(); b++){
-      if(updating > ctime){ return; } //another thread kicked off already - stop this one
-      if(BUTTONS[b]->classname()== ctxt && usegroups){
-	//This adds a window to an existing group
-        found = true;
-	//qDebug() << "Add Window to Button:" << b;
-	BUTTONS[b]->addWindow(winlist[i]);
-	break;
-      }
-    }
-    if(!found){
-      if(updating > ctime){ return; } //another thread kicked off already - stop this one
-      //No group, create a new button
-      //qDebug() << "New Button";
-      LTaskButton *but = new LTaskButton(this, usegroups);
-        but->addWindow( winlist[i] );
-	if(this->layout()->direction()==QBoxLayout::LeftToRight){
-	    but->setIconSize(QSize(this->height(), this->height()));
-	}else{
-	    but->setIconSize(QSize(this->width(), this->width()));
-	}
-      this->layout()->addWidget(but);
-      connect(but, SIGNAL(MenuClosed()), this, SIGNAL(MenuClosed()));
-      BUTTONS << but;
-    }
+    addWindowButton(winlist[i]);
   }
 }
 
@@ -136,6 +161,30 @@ void LTaskManagerPlugin::UpdateButton(WId win){
   }
 }
 
-void LTaskManagerPlugin::checkWindows(){
-  timer->start();
+void LTaskManagerPlugin::WindowAdded(WId win){
+  if(buttonForWindow(win)>=0 || skipTaskbar(win)){ return; }
+  addWindowButton(win);
+}
+
+void LTaskManagerPlugin::WindowRemoved(WId win){
+  removeWindowButton(win);
+}
+
+void LTaskManagerPlugin::WindowTitleChanged(WId win){
+  int i = buttonForWindow(win);
+  if(i>=0){ BUTTONS[i]->UpdateWindowText(win); }
+}
+
+void LTaskManagerPlugin::WindowIconChanged(WId win){
+  int i = buttonForWindow(win);
+  if(i>=0){ BUTTONS[i]->UpdateWindowIcon(win); }
+}
+
+void LTaskManagerPlugin::WindowStateChanged(WId win){
+  int i = buttonForWindow(win);
+  //The skip-taskbar flag is part of the window state
+  bool skip = skipTaskbar(win);
+  if(i<0 && !skip){ addWindowButton(win); }
+  else if(i>=0 && skip){ removeWindowButton(win); }
+  else if(i>=0){ BUTTONS[i]->UpdateWindowState(win); }
 }
@@ -32,14 +32,23 @@ public:
 
 private:
 	QList<LTaskButton*> BUTTONS; //to keep track of the current buttons
-	QTimer *timer;
 	QDateTime updating; //quick flag for if it is currently working
 	bool usegroups;
 
+	int buttonForWindow(WId win); //index of the button containing the window (-1 if none)
+	bool skipTaskbar(WId win);
+	void addWindowButton(WId win); //add a window to a matching group or a new button
+	void removeWindowButton(WId win); //remove a window (and the button if now empty)
+
 private slots:
 	void UpdateButtons();
 	void UpdateButton(WId win);
-	void checkWindows();
+	//Single-window changes from the session
+	void WindowAdded(WId win);
+	void WindowRemoved(WId win);
+	void WindowTitleChanged(WId win);
+	void WindowIconChanged(WId win);
+	void WindowStateChanged(WId win);
 
 public slots:
 	void LocaleChange(){
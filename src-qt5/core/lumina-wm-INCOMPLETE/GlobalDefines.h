@@ -43,6 +43,9 @@
 #include <QDesktopWidget>
 #include <QStyleOption>
 #include <QThread>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QRubberBand>
 
 // libLumina includes
 #include <LuminaX11.h>
@@ -60,6 +63,8 @@
 #include <xcb/xcb_aux.h> //included in libxcb-util.so
 
 #define ANIMTIME 80 //animation time in milliseconds
+#define MOVETIME 16 //milliseconds between geometry changes during an interactive move/resize (~60Hz)
+#define SYNCTIME 100 //milliseconds to wait on a client to redraw before sending it the next size anyway
 //Global flags/structures
 namespace LWM{
 	//Flags/enumerations
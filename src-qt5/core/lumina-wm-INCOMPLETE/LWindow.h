@@ -22,6 +22,16 @@ private:
 	enum ModState{Normal, Move, ResizeTop, ResizeTopRight, ResizeRight, ResizeBottomRight, ResizeBottom, ResizeBottomLeft, ResizeLeft, ResizeTopLeft};
 	ModState activeState;
 	QPoint offset; //needed for movement calculations (offset from mouse click to movement point)
+	//Interactive move/resize (pointer motion is compressed to one geometry change per MOVETIME)
+	QTimer *moveTimer;
+	QRect pendingGeom; //latest geometry requested by the pointer
+	bool geomPending;
+	uint64_t syncCounter, syncValue; //_NET_WM_SYNC_REQUEST counter ID and last value requested (0: not supported)
+	QElapsedTimer syncTime; //time since the last sync request was sent
+	bool syncWaiting;
+	bool outlineResize; //only draw an outline of the new size until the mouse is released
+	QRubberBand *outline;
+	void finishMoveResize();
 	//Functions for getting/setting state
 	ModState getStateAtPoint(QPoint pt, bool setoffset = false); //generally used for mouse location detection
 	void setMouseCursor(ModState, bool override = false);  //Update the mouse cursor based on state
@@ -55,6 +65,7 @@ public slots:
 
 private slots:
 	void finishedAnimation(); //uses lastAction
+	void applyPendingGeometry(); //tied to the "moveTimer"
 	void closeClicked();
 	void minClicked();
 	void maxClicked();
@@ -11,6 +11,7 @@
 
 #include <LuminaOS.h>
 #include <LuminaXDG.h>
+#include <LCommand.h>
 
 #include <unistd.h>
 #include <sys/types.h>
@@ -129,7 +130,14 @@ void imgDialog::loadDeviceList(){
 
 void imgDialog::getProcStatus(){
   if(ddProc==0 || ddProc->state()!=QProcess::Running ){ return; }
-  QStringList pidlist = LUtils::getCmdOutput("pgrep -S -f \"dd if="+ui->label_iso->whatsThis()+"\"");
+  //Look for the dd process in the background (this is run every second)
+  LCommand *cmd = LCommand::run("pgrep", QStringList() << "-S" << "-f" << "dd if="+ui->label_iso->whatsThis(), 5000);
+  connect(cmd, SIGNAL(finished(int, QStringList)), this, SLOT(procPidFound(int, QStringList)) );
+}
+
+void imgDialog::procPidFound(int, QStringList pidlist){
+  if(ddProc==0 || ddProc->state()!=QProcess::Running ){ return; }
+  pidlist.removeAll("");
   if(pidlist.isEmpty()){ return; }
   int pid = pidlist.first().simplified().toInt(); //just use the first pid - the pgrep should be detailed enough to only match one
   //qDebug() << "Sending signal to show status on PID:" << pid;
@@ -41,6 +41,7 @@ private slots:
 	void loadDeviceList();
 
 	void getProcStatus();
+	void procPidFound(int, QStringList);
 	void procInfoAvailable();
 	void procFinished();
 
@@ -5,21 +5,45 @@
 //  See the LICENSE file for full details
 //===========================================
 #include "Browser.h"
+#include "BrowserModel.h"
 
 #include <QStringList>
 #include <QTimer>
 #include <QtConcurrent>
 #include <QDebug>
+#include <QImageReader>
+#include <QCryptographicHash>
+#include <QSaveFile>
+#include <QUrl>
+#include <QThread>
+#include <QDirIterator>
 
 #include <LUtils.h>
 
+#include <algorithm>
+
 Browser::Browser(QObject *parent) : QObject(parent){
   watcher = new QFileSystemWatcher(this);
-  connect(watcher, SIGNAL(fileChanged(const QString&)), this, SLOT(fileChanged(QString)) );
   connect(watcher, SIGNAL(directoryChanged(const QString&)), this, SLOT(dirChanged(QString)) );
+  changeTimer = new QTimer(this);
+    changeTimer->setSingleShot(true);
+    changeTimer->setInterval(500);
+  connect(changeTimer, SIGNAL(timeout()), this, SLOT(applyChanges()) );
+  scanner = new QFutureWatcher<BrowserScan>(this);
+  connect(scanner, SIGNAL(finished()), this, SLOT(scanFinished()) );
+  rescan = false;
   showHidden = false;
   imageFormats = LUtils::imageExtensions(false); //lowercase suffixes
-  connect(this, SIGNAL(threadDone(QString, QByteArray)), this, SLOT(futureFinished(QString, QByteArray)), Qt::QueuedConnection); //will always be between different threads
+  listPos = listDirs = 0;
+  batchTimer = new QTimer(this);
+    batchTimer->setSingleShot(true);
+    batchTimer->setInterval(0);
+  connect(batchTimer, SIGNAL(timeout()), this, SLOT(sendNextBatch()) );
+  running = 0;
+  maxRunning = qMax(2, QThread::idealThreadCount());
+  thumbSize = 128;
+  qRegisterMetaType<LFileInfo>("LFileInfo");
+  connect(this, SIGNAL(threadDone(int, QString, QImage, LFileInfo)), this, SLOT(futureFinished(int, QString, QImage, LFileInfo)), Qt::QueuedConnection); //will always be between different threads
 }
 
 Browser::~Browser(){
@@ -38,53 +62,127 @@ bool Browser::showingHiddenFiles(){
   return showHidden;
 }
 
+void Browser::setThumbnailSize(int px){
+  thumbSize = px;
+}
+
 //   PRIVATE
-void Browser::loadItem(QString info){
-  //qDebug() << "LoadItem:" << info;
-  ////FileItem item;
-     //itemame = info;
-  QByteArray bytes;
-  if(imageFormats.contains(info.section(".",-1).toLower()) ){
-    QFile file(info);
-    if(file.open(QIODevice::ReadOnly)){
-      bytes = file.readAll();
-      file.close();
+void Browser::startScan(bool full){
+  rescan = false;
+  //A full scan stats everything, otherwise only the items which are new or recently modified
+  QHash<QString, QPair<qint64,qint64> > known;
+  if(!full){ known = oldFiles; }
+  scanner->setFuture( QtConcurrent::run(&Browser::scanDirectory, currentDir, showHidden, known, loadID.load(), full) );
+}
+
+BrowserScan Browser::scanDirectory(QString dir, bool hidden, QHash<QString, QPair<qint64,qint64> > known, int id, bool full){
+  //Note: This is run in a worker thread
+  BrowserScan scan;
+    scan.id = id;
+    scan.full = full;
+  QDir::Filters filter = QDir::Dirs | QDir::Files | QDir::NoDotAndDotDot;
+  if(hidden){ filter |= QDir::Hidden; }
+  QFileInfoList newfiles;
+  QDirIterator it(dir, filter);
+  while(it.hasNext()){
+    QString path = it.next();
+    QFileInfo info = it.fileInfo(); //file type comes from the directory entry - not stat'd yet
+    bool isknown = known.contains(path);
+    if(info.isDir()){ scan.dirs << path; }
+    else{
+      scan.files << path;
+      if(!isknown){ newfiles << info; }
     }
+    //Every item gets stat'd (in-place writes and renames over a file do not change the directory listing)
+    // but only the new files need a mimetype lookup
+    QPair<qint64,qint64> stamp = qMakePair(info.lastModified().toMSecsSinceEpoch(), info.size());
+    if(isknown && stamp!=known.value(path)){ scan.changed << path; }
+    scan.stamps.insert(path, stamp);
+  }
+  //Mimetypes of the new files (one pass over the mime database)
+  QStringList mimes = LXDG::findAppMimeForFiles(newfiles);
+  for(int i=0; i<newfiles.length(); i++){ scan.mimes.insert(newfiles[i].absoluteFilePath(), mimes[i]); }
+  //Sorted by name - the default order of the view
+  QCollator collator = BrowserModel::nameCollator();
+  std::sort(scan.dirs.begin(), scan.dirs.end(), collator);
+  std::sort(scan.files.begin(), scan.files.end(), collator);
+  return scan;
+}
+
+void Browser::queueItem(QString path){
+  pending << path;
+  startJobs();
+}
 
-    /*QPixmap pix;
-    if(pix.load(item.info.absoluteFilePath()) ){
-      if(pix.height()>128){ pix = pix.scaled(128, 128, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation); }
-      item.icon.addPixmap(pix);
-    }*/
-  }/*else if(item.info.isDir()){
-    item.icon = LXDG::findIcon("folder","inode/directory");
+void Browser::startJobs(){
+  //Only keep a limited number of jobs in the thread pool - the rest wait here (and can be dropped)
+  while(running < maxRunning && !pending.isEmpty()){
+    running++;
+    QString path = pending.takeFirst();
+    QtConcurrent::run(this, &Browser::loadItem, path, loadID.load(), thumbSize, fileMimes.value(path) );
   }
-  if(item.icon.isNull()){ item.icon = LXDG::findIcon(item.info.mimetype(), "unknown"); }*/
-  //qDebug() << " - done with item:" << info;
-  emit threadDone(info, bytes);
-  //return item;
 }
 
-// PRIVATE SLOTS
-void Browser::fileChanged(QString file){
-  if(file.startsWith(currentDir+"/") ){ 
-    if(QFile::exists(file) ){ QtConcurrent::run(this, &Browser::loadItem, file ); } //file modified but not removed
-    else{ QTimer::singleShot(0, this, SLOT(loadDirectory()) ); } //file removed - need to update entire dir
-  }else if(file==currentDir){ QTimer::singleShot(0, this, SLOT(loadDirectory()) ); }
+void Browser::loadItem(QString info, int id, int size, QString mime){
+  //qDebug() << "LoadItem:" << info;
+  QImage thumb;
+  if(id != loadID.load() || info.endsWith(".desktop") ){
+    //Directory changed (stale job) or XDG desktop entry (loaded on the main thread with the desktop data)
+    emit threadDone(id, info, thumb, LFileInfo());
+    return;
+  }
+  LFileInfo finfo(info);
+  if(!mime.isEmpty()){ finfo.setMimetype(mime); } //found with the directory scan
+  finfo.mimetype(); //the extra info is loaded on first use - do it here instead of on the main thread
+  if(imageFormats.contains(finfo.suffix().toLower()) ){
+    thumb = loadThumbnail(finfo.absoluteFilePath(), size);
+  }
+  //qDebug() << " - done with item:" << info;
+  emit threadDone(id, info, thumb, finfo);
 }
 
-void Browser::dirChanged(QString dir){
-  if(dir==currentDir){ QTimer::singleShot(500, this, SLOT(loadDirectory()) ); }
-  else if(dir.startsWith(currentDir)){ QtConcurrent::run(this, &Browser::loadItem, dir ); }
+QImage Browser::loadThumbnail(QString path, int size){
+  //Freedesktop thumbnail specification: [cache]/thumbnails/[normal|large]/<MD5 of the file URI>.png
+  int tsize = (size>128) ? 256 : 128;
+  QString thumbdir = QString(getenv("XDG_CACHE_HOME")).section(":",0,0);
+  if(thumbdir.isEmpty()){ thumbdir = QDir::homePath()+"/.cache"; }
+  thumbdir.append("/thumbnails");
+  QString cachedir = thumbdir+ ( (tsize>128) ? "/large" : "/normal" );
+  QFileInfo finfo(path);
+  QByteArray uri = QUrl::fromLocalFile(finfo.absoluteFilePath()).toEncoded();
+  QString mtime = QString::number(finfo.lastModified().toTime_t());
+  QString thumbfile = cachedir+"/"+QString(QCryptographicHash::hash(uri, QCryptographicHash::Md5).toHex())+".png";
+  QImage img;
+  //Use the cached thumbnail if it is still valid for this file
+  if(QFile::exists(thumbfile)){
+    QImageReader reader(thumbfile);
+    if(reader.text("Thumb::MTime")==mtime && reader.text("Thumb::URI")==QString(uri) && reader.read(&img) ){ return img; }
+    img = QImage();
+  }
+  //Decode the image directly at the thumbnail size (never load the full resolution)
+  QImageReader reader(path);
+  QSize fullsize = reader.size();
+  bool scaled = (fullsize.isValid() && (fullsize.width()>tsize || fullsize.height()>tsize) );
+  if(scaled){ reader.setScaledSize( fullsize.scaled(tsize, tsize, Qt::KeepAspectRatio) ); }
+  if(!reader.read(&img)){ return QImage(); }
+  //Save it to the cache (small images are quicker to just read directly, and never thumbnail the thumbnails)
+  if(scaled && !path.startsWith(thumbdir+"/") && (QFile::exists(cachedir) || QDir().mkpath(cachedir)) ){
+    QFile::setPermissions(cachedir, QFileDevice::ReadOwner | QFileDevice::WriteOwner | QFileDevice::ExeOwner);
+    img.setText("Thumb::URI", QString(uri));
+    img.setText("Thumb::MTime", mtime);
+    img.setText("Software", "Lumina-DE");
+    QSaveFile file(thumbfile); //other processes/threads never see a partial file
+    if(file.open(QIODevice::WriteOnly) && img.save(&file, "png") && file.commit() ){
+      QFile::setPermissions(thumbfile, QFileDevice::ReadOwner | QFileDevice::WriteOwner);
+    }
+  }
+  return img;
 }
 
-void Browser::futureFinished(QString name, QByteArray icon){
-  //Note: this will be called once for every item that loads
+void Browser::showItem(QImage thumb, LFileInfo info){
       QIcon ico;
-      LFileInfo info(name);
-      if(!icon.isEmpty()){
-        QPixmap pix;
-        if(pix.loadFromData(icon) ){ ico.addPixmap(pix); }
+      if(!thumb.isNull()){
+        ico.addPixmap( QPixmap::fromImage(thumb) );
       }else if(info.isDir()){
         ico = LXDG::findIcon("folder","inode/directory");
       }
@@ -95,6 +193,83 @@ void Browser::futureFinished(QString name, QByteArray icon){
       this->emit itemDataAvailable( ico, info );
 }
 
+// PRIVATE SLOTS
+void Browser::dirChanged(QString dir){
+  if(dir!=currentDir){ return; }
+  //Wait a moment for any other changes (things like copies or extractions are lots of changes at once)
+  if(!changeTimer->isActive()){ changeTimer->start(); }
+}
+
+void Browser::applyChanges(){
+  if(!QFileInfo::exists(currentDir)){ loadDirectory(); return; }
+  if(scanner->isRunning()){ rescan = true; return; } //check again once the current scan is done
+  startScan(false);
+}
+
+void Browser::scanFinished(){
+  BrowserScan scan = scanner->result();
+  if(scan.id != loadID.load()){ return; } //scan of a previous directory load
+  //Removed items
+  QHash<QString, QPair<qint64,qint64> >::const_iterator it = oldFiles.constBegin();
+  for( ; it!=oldFiles.constEnd(); ++it){
+    if(!scan.stamps.contains(it.key())){ fileMimes.remove(it.key()); emit itemRemoved(it.key()); }
+  }
+  if(scan.full){
+    //Dirs first, then files
+    emit itemsLoading(scan.dirs.length()+scan.files.length());
+    oldFiles = scan.stamps; //save for next time
+    fileMimes = scan.mimes;
+    listDirs = scan.dirs.length();
+    listPaths = scan.dirs + scan.files;
+    //Send out the first batch right away, the rest as the event loop allows
+    if(listPaths.isEmpty()){ emit listingFinished(); }
+    else{ sendNextBatch(); }
+  }else{
+    //New or modified items
+    QStringList newdirs, newfiles;
+    for(int i=0; i<scan.dirs.length(); i++){
+      if(!oldFiles.contains(scan.dirs[i])){ newdirs << scan.dirs[i]; }
+    }
+    for(int i=0; i<scan.files.length(); i++){
+      if(!oldFiles.contains(scan.files[i])){ newfiles << scan.files[i]; }
+    }
+    for(int i=0; i<scan.changed.length(); i++){ queueItem(scan.changed[i]); } //re-load the information for it
+    oldFiles = scan.stamps; //save for the next time
+    QHash<QString, QString>::const_iterator mit = scan.mimes.constBegin();
+    for( ; mit!=scan.mimes.constEnd(); ++mit){ fileMimes.insert(mit.key(), mit.value()); }
+    //qDebug() << "Directory Changes:" << newdirs.length() << newfiles.length() << scan.changed.length();
+    if(!newdirs.isEmpty()){ emit itemsListed(newdirs, true); }
+    if(!newfiles.isEmpty()){ emit itemsListed(newfiles, false); }
+    if(!newdirs.isEmpty() || !newfiles.isEmpty()){ emit listingFinished(); }
+  }
+  if(rescan){ startScan(false); }
+}
+
+void Browser::futureFinished(int id, QString name, QImage thumb, LFileInfo info){
+  //Note: this will be called once for every item that loads
+  running--;
+  startJobs(); //keep the queue moving
+  if(id != loadID.load()){ return; } //result for a previous directory load - discard it
+  if(info.filePath().isEmpty()){ showItem(thumb, LFileInfo(name)); } //not loaded in the background
+  else{ showItem(thumb, info); }
+}
+
+void Browser::sendNextBatch(){
+  if(listPos >= listPaths.length()){ return; }
+  //Dirs and files are sent in separate batches
+  bool dirs = (listPos < listDirs);
+  int end = qMin( listPos+2000, (dirs ? listDirs : listPaths.length()) );
+  QStringList batch = listPaths.mid(listPos, end-listPos);
+  listPos = end;
+  emit itemsListed(batch, dirs);
+  if(listPos < listPaths.length()){ batchTimer->start(); } //let the event loop run (paint) before the next batch
+  else{
+    listPaths.clear();
+    listPos = listDirs = 0;
+    emit listingFinished();
+  }
+}
+
 // PUBLIC SLOTS
 void Browser::loadDirectory(QString dir){
   //qDebug() << "Load Directory" << dir;
@@ -102,39 +277,33 @@ void Browser::loadDirectory(QString dir){
   if(dir.isEmpty()){ return; } //nothing to do - nothing previously loaded
   if(currentDir != dir){ //let the main widget know to clear all current items (completely different dir)
     oldFiles.clear();
+    fileMimes.clear();
     emit clearItems(); 
   } 
   currentDir = dir; //save this for later
+  //cancel any jobs still pending from the last load
+  loadID.ref();
+  pending.clear();
+  changeTimer->stop(); //about to re-scan the entire dir anyway
   //clean up the watcher first
   QStringList watched; watched << watcher->files() << watcher->directories();
   if(!watched.isEmpty()){ watcher->removePaths(watched); }
-  QStringList old = oldFiles; //copy this over for the moment (both lists will change in a moment)
-  oldFiles.clear(); //get ready for re-creating this list
-  // read the given directory
-  QDir directory(dir);
-  if(directory.exists()){
-    QStringList files;
-    if(showHidden){ files = directory.entryList( QDir::Dirs | QDir::Files | QDir::Hidden | QDir::NoDotAndDotDot, QDir::NoSort); }
-    else{ files = directory.entryList( QDir::Dirs | QDir::Files | QDir::NoDotAndDotDot, QDir::NoSort); }
-    emit itemsLoading(files.length());
-    QCoreApplication::processEvents();
-    for(int i=0; i<files.length(); i++){
-      watcher->addPath(directory.absoluteFilePath(files[i]));
-      //qDebug() << "Future Starting:" << files[i];
-      QString path = directory.absoluteFilePath(files[i]);
-      if(old.contains(path)){ old.removeAll(path); }
-      oldFiles << path; //add to list for next time
-      QtConcurrent::run(this, &Browser::loadItem, path );
-      QCoreApplication::sendPostedEvents();
-    }
-    watcher->addPath(directory.absolutePath());
-    if(!old.isEmpty()){
-      old.removeAll(directory.absolutePath());
-      for(int i=0; i<old.length(); i++){
-        emit itemRemoved(old[i]);
-      }
-    }
+  batchTimer->stop();
+  listPaths.clear();
+  listPos = listDirs = 0;
+  rescan = false;
+  // read the given directory (in the background)
+  if(QFileInfo(dir).isDir()){
+    //Only the directory itself is watched - changes to the items are found by comparing with the last scan
+    watcher->addPath(dir);
+    startScan(true);
   }else{
+    oldFiles.clear();
+    fileMimes.clear();
     emit itemsLoading(0); //nothing to load
   }
 }
+
+void Browser::requestItem(QString path){
+  queueItem(path);
+}
@@ -13,7 +13,13 @@
 #include <QString>
 #include <QFileSystemWatcher>
 #include <QIcon>
-//#include <QFutureWatcher>
+#include <QImage>
+#include <QAtomicInt>
+#include <QTimer>
+#include <QHash>
+#include <QPair>
+#include <QDir>
+#include <QFutureWatcher>
 
 #include <LuminaXDG.h>
 /*class FileItem{
@@ -25,6 +31,16 @@ public:
 	~FileItem(){};
 };*/
 
+//Result of a directory scan (run in a worker thread)
+struct BrowserScan{
+	int id; //loadID at the time of the scan
+	bool full; //full listing for loadDirectory() (otherwise just the changes)
+	QStringList dirs, files; //everything in the directory (sorted by name)
+	QStringList changed; //known items which were modified
+	QHash<QString, QPair<qint64,qint64> > stamps;
+	QHash<QString, QString> mimes; //mimetypes of the new files (found all at once)
+};
+
 class Browser : public QObject{
 	Q_OBJECT
 public:
@@ -34,6 +50,7 @@ public:
 	QString currentDirectory();
 	void showHiddenFiles(bool);
 	bool showingHiddenFiles();
+	void setThumbnailSize(int px); //size of the image thumbnails to generate
 
 	//FileItem loadItem(QString info); //this is the main loader class - multiple instances each run in a separate thread
 
@@ -41,30 +58,53 @@ private:
 	QString currentDir;
 	QFileSystemWatcher *watcher;
 	bool showHidden;
-	QStringList imageFormats, oldFiles;
+	QStringList imageFormats;
+	QHash<QString, QPair<qint64,qint64> > oldFiles; //path -> (modification time, size) of the items currently listed
+	QHash<QString, QString> fileMimes; //path -> mimetype of the files currently listed
+	QTimer *changeTimer; //collects the directory change events into one update
+	QFutureWatcher<BrowserScan> *scanner;
+	bool rescan; //more changes came in while the last scan was running
+	QStringList listPaths; //directory listing which is still being sent out
+	int listPos, listDirs; //position in the listing, number of dirs at the start of it
+	QTimer *batchTimer;
+	QStringList pending; //items waiting for a background job
+	int running, maxRunning; //number of background jobs currently started (bounded)
+	QAtomicInt loadID; //changes with the directory - pending/running jobs for the old one are dropped
+	int thumbSize;
 
-	void loadItem(QString info); //this is the main loader class - multiple instances each run in a separate thread
+	void startScan(bool full);
+	static BrowserScan scanDirectory(QString dir, bool hidden, QHash<QString, QPair<qint64,qint64> > known, int id, bool full);
+	void queueItem(QString path);
+	void startJobs();
+	void loadItem(QString info, int id, int size, QString mime); //this is the main loader class - multiple instances each run in a separate thread
+	static QImage loadThumbnail(QString path, int size); //scaled image using the freedesktop thumbnail cache
+	void showItem(QImage thumb, LFileInfo info);
 
 private slots:
-	void fileChanged(QString); //tied into the watcher - for file change notifications
-	void dirChanged(QString); // tied into the watcher - for new/removed files in the current dir
+	void dirChanged(QString); // tied into the watcher - for new/removed/changed files in the current dir
+	void applyChanges(); //update the listing with the differences since the last scan
+	void scanFinished();
 
-	void futureFinished(QString, QByteArray);
+	void futureFinished(int, QString, QImage, LFileInfo);
+	void sendNextBatch(); //send out the next part of the directory listing
 
 public slots:
 	void loadDirectory(QString dir = "");
+	void requestItem(QString path); //load the full information for an item (icon, mime type, etc)
 
 signals:
 	//Main Signals
 	void itemRemoved(QString item); //emitted if a file was removed from the underlying
 	void clearItems(); //emitted when dirs change for example
 	void itemDataAvailable(QIcon, LFileInfo);
+	void itemsListed(QStringList, bool); //batch of paths in the directory (all dirs or all files)
+	void listingFinished(); //all the items in the directory have been listed
 
 	//Start/Stop signals for loading of data
 	void itemsLoading(int); //number of items which are getting loaded
 
 	//Internal signal for the alternate threads
-	void threadDone(QString, QByteArray);
+	void threadDone(int, QString, QImage, LFileInfo);
 };
 
 #endif
@@ -0,0 +1,307 @@
+//===========================================
+//  Lumina-DE source code
+//  Copyright (c) 2016, Ken Moore
+//  Available under the 3-clause BSD license
+//  See the LICENSE file for full details
+//===========================================
+#include "BrowserModel.h"
+
+#include <QFileInfo>
+#include <QDebug>
+
+#include <LUtils.h>
+
+#include <algorithm>
+
+//Sorting rules for the items (by row number)
+class BrowserItemSorter{
+public:
+  const QVector<BrowserItem> *items;
+  const QList<QCollatorSortKey> *keys; //collation keys for the name/type text of each item
+  int column;
+  bool reverse;
+
+  BrowserItemSorter(const QVector<BrowserItem> *list, const QList<QCollatorSortKey> *textkeys, int col, bool rev){
+    items = list; keys = textkeys; column = col; reverse = rev;
+  }
+
+  bool operator()(int a, int b) const{
+    if(reverse){ return lessThan(b, a); }
+    return lessThan(a, b);
+  }
+
+  bool lessThan(int ia, int ib) const{
+    const BrowserItem &a = items->at(ia);
+    const BrowserItem &b = items->at(ib);
+    switch(column){
+      case 1:
+	//Size: put all the dirs together instead of mixing them with files with 0 bytes
+        return ( (a.isdir ? -1 : a.size) < (b.isdir ? -1 : b.size) );
+      case 2:
+        return (keys->at(ia).compare(keys->at(ib)) < 0);
+      case 3:
+        return (a.modified < b.modified);
+      case 4:
+        return (a.created < b.created);
+    }
+    //Name - still sort by type too (folders first)
+    if(a.isdir != b.isdir){ return a.isdir; }
+    return (keys->at(ia).compare(keys->at(ib)) < 0);
+  }
+};
+
+BrowserModel::BrowserModel(QObject *parent) : QAbstractTableModel(parent){
+  ndirs = unsized = sortcol = 0;
+  bytes = 0;
+  sortorder = Qt::AscendingOrder;
+  dirIcon = LXDG::findIcon("folder","inode/directory");
+  fileIcon = LXDG::findIcon("unknown","");
+}
+
+BrowserModel::~BrowserModel(){
+
+}
+
+QCollator BrowserModel::nameCollator(){
+  QCollator collator;
+    collator.setNumericMode(true);
+    collator.setCaseSensitivity(Qt::CaseInsensitive);
+  return collator;
+}
+
+// === Item management ===
+void BrowserModel::clearItems(){
+  beginResetModel();
+  items.clear();
+  rows.clear();
+  ndirs = unsized = 0;
+  bytes = 0;
+  endResetModel();
+}
+
+void BrowserModel::addItems(QStringList paths, bool dirs){
+  if(paths.isEmpty()){ return; }
+  QString dir = QFileInfo(paths.first()).absolutePath();
+  if(dir != currentDir){
+    clearItems();
+    currentDir = dir;
+    prefix = currentDir.endsWith("/") ? currentDir : currentDir+"/";
+  }
+  QVector<BrowserItem> newitems;
+  int first = -1, last = -1; //range of existing items which were reloaded
+  for(int i=0; i<paths.length(); i++){
+    QString name = paths[i].section("/",-1);
+    if(rows.contains(name)){
+      //Existing item - keep showing the old information until the new info is loaded
+      int row = rows.value(name);
+      items[row].requested = false;
+      if(first<0 || row<first){ first = row; }
+      if(row>last){ last = row; }
+    }else{
+      BrowserItem item;
+        item.name = name;
+        item.isdir = dirs;
+      newitems << item;
+    }
+  }
+  if(first>=0){ emit dataChanged(index(first,0), index(last, columnCount()-1)); }
+  if(newitems.isEmpty()){ return; }
+  int start = items.count();
+  beginInsertRows(QModelIndex(), start, start+newitems.count()-1);
+  items << newitems;
+  indexRows(start);
+  if(dirs){ ndirs += newitems.count(); }
+  else{ unsized += newitems.count(); }
+  endInsertRows();
+}
+
+void BrowserModel::updateItem(QIcon ico, LFileInfo info){
+  if(info.absolutePath() != currentDir){ return; } //not in this directory
+  int row = rows.value(info.fileName(), -1);
+  if(row<0){
+    //New item which was not listed yet
+    addItems(QStringList() << info.absoluteFilePath(), info.isDir());
+    row = rows.value(info.fileName(), -1);
+    if(row<0){ return; }
+  }
+  BrowserItem &item = items[row];
+  item.icon = ico;
+  item.mime = info.mimetype();
+  if(!item.isdir){ setSize(item, info.size()); }
+  item.modified = info.lastModified();
+  item.created = info.created();
+  item.loaded = item.requested = item.statted = true;
+  emit dataChanged(index(row,0), index(row, columnCount()-1));
+}
+
+void BrowserModel::removeItem(QString path){
+  if(QFileInfo(path).absolutePath() != currentDir){ return; }
+  int row = rows.value(path.section("/",-1), -1);
+  if(row<0){ return; }
+  beginRemoveRows(QModelIndex(), row, row);
+  if(items[row].isdir){ ndirs--; }
+  else{ setSize(items[row], -1); }
+  rows.remove(items[row].name);
+  items.remove(row);
+  indexRows(row);
+  endRemoveRows();
+}
+
+void BrowserModel::setHeaderLabels(QStringList labels){
+  headers = labels;
+  emit headerDataChanged(Qt::Horizontal, 0, columnCount()-1);
+}
+
+// === Item information ===
+QString BrowserModel::itemPath(int row){
+  if(row<0 || row>=items.count()){ return ""; }
+  return (prefix+items[row].name);
+}
+
+bool BrowserModel::isDir(int row){
+  if(row<0 || row>=items.count()){ return false; }
+  return items[row].isdir;
+}
+
+// === Model interface ===
+int BrowserModel::rowCount(const QModelIndex &parent) const{
+  if(parent.isValid()){ return 0; } //flat list
+  return items.count();
+}
+
+int BrowserModel::columnCount(const QModelIndex &parent) const{
+  if(parent.isValid()){ return 0; }
+  return 5; //name, size, type, date modified, date created
+}
+
+QVariant BrowserModel::data(const QModelIndex &index, int role) const{
+  if(!index.isValid() || index.row()>=items.count()){ return QVariant(); }
+  const BrowserItem &item = items.at(index.row());
+  //The icon and detail columns are only asked for when the item is actually shown - load the info now
+  if(!item.requested && ( role==Qt::DecorationRole || (role==Qt::DisplayRole && index.column()>0) ) ){
+    BrowserModel *self = const_cast<BrowserModel*>(this);
+    self->items[index.row()].requested = true;
+    emit self->itemNeeded(prefix+item.name);
+  }
+  switch(role){
+    case Qt::DisplayRole:
+      switch(index.column()){
+        case 0:
+	  return item.name;
+        case 1:
+	  if(item.isdir || !item.statted){ return ""; }
+	  return LUtils::BytesToDisplaySize(item.size);
+        case 2:
+	  return item.mime;
+        case 3:
+	  if(!item.statted){ return ""; }
+	  return DTtoString(item.modified);
+        case 4:
+	  if(!item.statted){ return ""; }
+	  return DTtoString(item.created);
+      }
+      break;
+    case Qt::DecorationRole:
+      if(index.column()!=0){ break; }
+      if(item.loaded && !item.icon.isNull()){ return item.icon; }
+      return (item.isdir ? dirIcon : fileIcon);
+    case Qt::WhatsThisRole:
+      return (prefix+item.name);
+    case Qt::UserRole:
+      return (item.isdir ? "dir" : "file");
+  }
+  return QVariant();
+}
+
+QVariant BrowserModel::headerData(int section, Qt::Orientation orientation, int role) const{
+  if(orientation==Qt::Horizontal && role==Qt::DisplayRole && section<headers.length()){ return headers[section]; }
+  return QAbstractTableModel::headerData(section, orientation, role);
+}
+
+Qt::ItemFlags BrowserModel::flags(const QModelIndex &index) const{
+  if(!index.isValid()){ return Qt::ItemIsDropEnabled; }
+  Qt::ItemFlags flags = Qt::ItemIsSelectable | Qt::ItemIsEnabled | Qt::ItemIsDragEnabled;
+  if(items.at(index.row()).isdir){ flags |= Qt::ItemIsDropEnabled; }
+  return flags;
+}
+
+void BrowserModel::sort(int column, Qt::SortOrder order){
+  sortcol = column;
+  sortorder = order;
+  if(items.isEmpty()){ return; }
+  emit layoutAboutToBeChanged();
+  if(column==1 || column==3 || column==4){
+    //Need the size/date of every item to sort on them
+    for(int i=0; i<items.count(); i++){
+      if(!items[i].statted){ statItem(items[i]); }
+    }
+  }
+  //Text columns: get the collation key of each item once (much faster than collating on every comparison)
+  QList<QCollatorSortKey> keys;
+  if(column==0 || column==2){
+    QCollator collator = nameCollator();
+    keys.reserve(items.count());
+    for(int i=0; i<items.count(); i++){
+      keys << collator.sortKey( column==0 ? items[i].name : items[i].mime );
+    }
+  }
+  //Sort the row numbers, then move the items (and any persistent indexes - selection/current item) over
+  QVector<int> order_rows(items.count());
+  for(int i=0; i<order_rows.count(); i++){ order_rows[i] = i; }
+  std::stable_sort(order_rows.begin(), order_rows.end(), BrowserItemSorter(&items, &keys, column, order==Qt::DescendingOrder) );
+  QVector<BrowserItem> sorted;
+    sorted.reserve(items.count());
+  QVector<int> newrow(items.count());
+  for(int i=0; i<order_rows.count(); i++){
+    sorted << items[order_rows[i]];
+    newrow[order_rows[i]] = i;
+  }
+  items = sorted;
+  indexRows();
+  QModelIndexList from = persistentIndexList();
+  QModelIndexList to;
+  for(int i=0; i<from.length(); i++){
+    to << index(newrow[from[i].row()], from[i].column());
+  }
+  changePersistentIndexList(from, to);
+  emit layoutChanged();
+}
+
+// === PRIVATE ===
+void BrowserModel::statItem(BrowserItem &item){
+  QFileInfo info(prefix+item.name);
+  if(!item.isdir){ setSize(item, info.size()); }
+  item.modified = info.lastModified();
+  item.created = info.created();
+  item.statted = true;
+}
+
+void BrowserModel::setSize(BrowserItem &item, qint64 size){
+  //Note: a negative size removes the item from the totals
+  if(item.statted){ bytes -= item.size; }
+  else{ unsized--; }
+  if(size<0){ return; }
+  item.size = size;
+  bytes += size;
+}
+
+void BrowserModel::indexRows(int start){
+  for(int i=start; i<items.count(); i++){ rows.insert(items[i].name, i); }
+}
+
+QString BrowserModel::DTtoString(QDateTime dt) const{
+  QStringList fmt = date_format;
+  if(fmt.isEmpty() || fmt.length()!=2 || (fmt[0].isEmpty() && fmt[1].isEmpty()) ){
+    //Default formatting
+    return dt.toString(Qt::DefaultLocaleShortDate);
+  }else if(fmt[0].isEmpty()){
+    //Time format only
+    return (dt.date().toString(Qt::DefaultLocaleShortDate)+" "+dt.time().toString(fmt[1]));
+  }else if(fmt[1].isEmpty()){
+    //Date format only
+    return (dt.date().toString(fmt[0])+" "+dt.time().toString(Qt::DefaultLocaleShortDate));
+  }else{
+    //both date/time formats set
+    return dt.toString(fmt.join(" "));
+  }
+}
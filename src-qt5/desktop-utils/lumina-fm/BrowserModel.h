@@ -0,0 +1,89 @@
+//===========================================
+//  Lumina-DE source code
+//  Copyright (c) 2016, Ken Moore
+//  Available under the 3-clause BSD license
+//  See the LICENSE file for full details
+//===========================================
+//  This is the item model for the directory listing of the file manager
+//  NOTE: Only the name/type of each item is known up front - the rest
+//    of the information is requested from the backend when first shown
+//===========================================
+#ifndef _LUMINA_FM_BROWSE_MODEL_H
+#define _LUMINA_FM_BROWSE_MODEL_H
+
+#include <QAbstractTableModel>
+#include <QString>
+#include <QStringList>
+#include <QDateTime>
+#include <QVector>
+#include <QHash>
+#include <QIcon>
+#include <QCollator>
+
+#include <LuminaXDG.h>
+
+struct BrowserItem{
+	QString name, mime;
+	QIcon icon;
+	qint64 size;
+	QDateTime modified, created;
+	bool isdir, loaded, requested, statted;
+	BrowserItem(){ size = 0; isdir = loaded = requested = statted = false; }
+};
+
+class BrowserModel : public QAbstractTableModel{
+	Q_OBJECT
+public:
+	BrowserModel(QObject *parent = 0);
+	~BrowserModel();
+
+	//Item management (from the browser backend)
+	void clearItems();
+	void addItems(QStringList paths, bool dirs); //new/reloaded items (one batch at a time)
+	void updateItem(QIcon ico, LFileInfo info); //full information about an item is available
+	void removeItem(QString path);
+
+	//Item information
+	QString itemPath(int row);
+	bool isDir(int row);
+	int dirCount(){ return ndirs; }
+	int fileCount(){ return items.count() - ndirs; }
+	qint64 knownBytes(){ return bytes; } //total size of all the files loaded so far
+	bool allSizesKnown(){ return (unsized==0); }
+
+	void setDateFormat(QStringList fmt){ date_format = fmt; }
+	void setHeaderLabels(QStringList labels);
+
+	//Model interface
+	int rowCount(const QModelIndex &parent = QModelIndex()) const;
+	int columnCount(const QModelIndex &parent = QModelIndex()) const;
+	QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+	QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+	Qt::ItemFlags flags(const QModelIndex &index) const;
+	void sort(int column, Qt::SortOrder order = Qt::AscendingOrder);
+
+	static QCollator nameCollator(); //natural order for names ("file2" before "file10", case-insensitive)
+
+	int sortColumn(){ return sortcol; }
+	Qt::SortOrder sortOrder(){ return sortorder; }
+
+private:
+	QString currentDir, prefix; //directory of the items, and the path prefix for them
+	QVector<BrowserItem> items;
+	QHash<QString, int> rows; //file name -> row
+	QStringList date_format, headers;
+	QIcon dirIcon, fileIcon; //placeholders until the real icon is loaded
+	int ndirs, unsized, sortcol;
+	qint64 bytes;
+	Qt::SortOrder sortorder;
+
+	void statItem(BrowserItem &item); //quick size/date info (without the rest of the data)
+	void setSize(BrowserItem &item, qint64 size); //keep the total bytes up to date
+	void indexRows(int start = 0);
+	QString DTtoString(QDateTime dt) const;  //QDateTime to string simplification routine
+
+signals:
+	void itemNeeded(QString); //path of an item which is shown but not loaded yet
+};
+
+#endif
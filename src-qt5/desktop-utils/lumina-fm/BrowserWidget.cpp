@@ -19,10 +19,14 @@ BrowserWidget::BrowserWidget(QString objID, QWidget *parent) : QWidget(parent){
   ID = objID;
   //Setup the backend browser object
   BROWSER = new Browser(this);
+  MODEL = new BrowserModel(this);
   connect(BROWSER, SIGNAL(clearItems()), this, SLOT(clearItems()) );
   connect(BROWSER, SIGNAL(itemRemoved(QString)), this, SLOT(itemRemoved(QString)) );
   connect(BROWSER, SIGNAL(itemDataAvailable(QIcon, LFileInfo)), this, SLOT(itemDataAvailable(QIcon, LFileInfo)) );
   connect(BROWSER, SIGNAL(itemsLoading(int)), this, SLOT(itemsLoading(int)) );
+  connect(BROWSER, SIGNAL(itemsListed(QStringList, bool)), this, SLOT(itemsListed(QStringList, bool)) );
+  connect(BROWSER, SIGNAL(listingFinished()), this, SLOT(listingFinished()) );
+  connect(MODEL, SIGNAL(itemNeeded(QString)), BROWSER, SLOT(requestItem(QString)) );
   connect(this, SIGNAL(dirChange(QString)), BROWSER, SLOT(loadDirectory(QString)) );
   listWidget = 0;
   treeWidget = 0;
@@ -68,29 +72,33 @@ void BrowserWidget::showDetails(bool show){
     treeWidget = 0;
   }
   qDebug() << "Create Widget: details:" << show;
-  //Now create any new widgets
+  //Now create any new widgets (both views share the same model - no need to reload the directory)
   if(show && treeWidget == 0){
-    treeWidget = new DDTreeWidget(this);
+    treeWidget = new DDTreeView(this);
       treeWidget->setContextMenuPolicy(Qt::CustomContextMenu);
+      treeWidget->setModel(MODEL);
       if(!iconsize.isNull()){ treeWidget->setIconSize(iconsize); }
     this->layout()->addWidget(treeWidget);
-    connect(treeWidget, SIGNAL(itemActivated(QTreeWidgetItem*,int)), this, SIGNAL(itemsActivated()) );
+    connect(treeWidget, SIGNAL(activated(const QModelIndex&)), this, SIGNAL(itemsActivated()) );
     connect(treeWidget, SIGNAL(customContextMenuRequested(const QPoint&)), this, SIGNAL(contextMenuRequested()) );
     connect(treeWidget, SIGNAL(DataDropped(QString, QStringList)), this, SIGNAL(DataDropped(QString, QStringList)) );
     connect(treeWidget, SIGNAL(GotFocus()), this, SLOT(selectionChanged()) );
+    treeWidget->setWhatsThis(BROWSER->currentDirectory());
     retranslate();
-    treeWidget->sortItems(0, Qt::AscendingOrder);
-    if(!BROWSER->currentDirectory().isEmpty()){ emit dirChange(""); }
+    treeWidget->sortByColumn(0, Qt::AscendingOrder);
+    for(int i=0; i<MODEL->columnCount(); i++){ treeWidget->resizeColumnToContents(i); }
   }else if(!show && listWidget==0){
-    listWidget = new DDListWidget(this);
+    listWidget = new DDListView(this);
      listWidget->setContextMenuPolicy(Qt::CustomContextMenu);
+     listWidget->setModel(MODEL);
      if(!iconsize.isNull()){ listWidget->setIconSize(iconsize); }
     this->layout()->addWidget(listWidget);
-    connect(listWidget, SIGNAL(itemActivated(QListWidgetItem*)), this, SIGNAL(itemsActivated()) );
+    connect(listWidget, SIGNAL(activated(const QModelIndex&)), this, SIGNAL(itemsActivated()) );
     connect(listWidget, SIGNAL(customContextMenuRequested(const QPoint&)), this, SIGNAL(contextMenuRequested()) );
     connect(listWidget, SIGNAL(DataDropped(QString, QStringList)), this, SIGNAL(DataDropped(QString, QStringList)) );
     connect(listWidget, SIGNAL(GotFocus()), this, SLOT(selectionChanged()) );
-    if(!BROWSER->currentDirectory().isEmpty()){ emit dirChange(""); }
+    listWidget->setWhatsThis(BROWSER->currentDirectory());
+    MODEL->sort(0, Qt::AscendingOrder); //the list only sorts by name (dirs first)
   }
   qDebug() << "  Done making widget";
 }
@@ -108,6 +116,7 @@ bool BrowserWidget::hasHiddenFiles(){
 }
 
 void BrowserWidget::setThumbnailSize(int px){
+  BROWSER->setThumbnailSize(px);
   bool larger = true;
   if(listWidget!=0){ 
     larger = listWidget->iconSize().height() < px;
@@ -151,49 +160,28 @@ void BrowserWidget::readDateFormat() {
   // If value doesn't exist or is not setted, empty string is returned
   date_format << settings.value("DateFormat").toString();
   date_format << settings.value("TimeFormat").toString();
+  MODEL->setDateFormat(date_format);
 }
 
 
 QStringList BrowserWidget::currentSelection(){
   QStringList out;
   if(listWidget!=0){
-    QList<QListWidgetItem*> sel = listWidget->selectedItems();
-    //qDebug() << "Selection number:" << sel.length();
-    //if(sel.isEmpty() && listWidget->currentItem()!=0){ sel << listWidget->currentItem(); }
-    //qDebug() << "Selection number:" << sel.length();
-    for(int i=0; i<sel.length(); i++){ out << sel[i]->whatsThis(); qDebug() << "Selection:" << sel[i]->text() << sel[i]->whatsThis(); }
+    out = listWidget->selectedPaths();
   }else if(treeWidget!=0){
-    QList<QTreeWidgetItem*> sel = treeWidget->selectedItems();
-    //if(sel.isEmpty() && treeWidget->currentItem()!=0){ sel << treeWidget->currentItem(); }
-    for(int i=0; i<sel.length(); i++){ out << sel[i]->whatsThis(0); }
+    out = treeWidget->selectedPaths();
   }
-  out.removeDuplicates(); //just in case - tree widgets sometimes "select" each column as an individual item
+  out.removeDuplicates(); //just in case
   return out;
 }
 
 QStringList BrowserWidget::currentItems(int type){
   //type: 0=all, -1=files, +1=dirs
   QStringList paths;
-  if(listWidget!=0){
-    for(int i=0; i<listWidget->count(); i++){
-      if(i<0 && (listWidget->item(i)->data(Qt::UserRole).toString()=="file") ){ //FILES
-        paths << listWidget->item(i)->whatsThis();
-      }else if(i>0 &&  (listWidget->item(i)->data(Qt::UserRole).toString()=="dir")){ //DIRS
-        paths << listWidget->item(i)->whatsThis();
-      }else if(i==0){ //ALL
-        paths << listWidget->item(i)->whatsThis();
-      }
-    }   
-  }else if(treeWidget!=0){
-    for(int i=0; i<treeWidget->topLevelItemCount(); i++){
-      if(i<0 && !treeWidget->topLevelItem(i)->text(1).isEmpty()){ //FILES
-        paths << treeWidget->topLevelItem(i)->whatsThis(0);
-      }else if(i>0 && treeWidget->topLevelItem(i)->text(1).isEmpty()){ //DIRS
-        paths << treeWidget->topLevelItem(i)->whatsThis(0);
-      }else if(i==0){ //ALL
-        paths << treeWidget->topLevelItem(i)->whatsThis(0);
-      }
-    }
+  for(int i=0; i<MODEL->rowCount(); i++){
+    if(type<0 && MODEL->isDir(i)){ continue; } //FILES
+    else if(type>0 && !MODEL->isDir(i)){ continue; } //DIRS
+    paths << MODEL->itemPath(i);
   }
   return paths;
 }
@@ -202,40 +190,42 @@ QStringList BrowserWidget::currentItems(int type){
 //     PUBLIC SLOTS
 // =================
 void BrowserWidget::retranslate(){
-  if(listWidget!=0){
-
-  }else if(treeWidget!=0){
-    QTreeWidgetItem *it = new QTreeWidgetItem();
-    it->setText(0,tr("Name"));
-    it->setText(1,tr("Size"));
-    it->setText(2, tr("Type"));
-    it->setText(3, tr("Date Modified") );
-    it->setText(4, tr("Date Created") );
-    treeWidget->setHeaderItem(it);
+  MODEL->setHeaderLabels( QStringList() << tr("Name") << tr("Size") << tr("Type") << tr("Date Modified") << tr("Date Created") );
+  if(treeWidget!=0){
     //Now reset the sorting (alphabetically, dirs first)
-    treeWidget->sortItems(0, Qt::AscendingOrder);  // sort by name
-    treeWidget->sortItems(1, Qt::AscendingOrder);  //sort by type
+    treeWidget->sortByColumn(0, Qt::AscendingOrder);  // sort by name
   }
 }
 
 // =================
 //          PRIVATE
 // =================
-QString BrowserWidget::DTtoString(QDateTime dt){
-  QStringList fmt = date_format;
-  if(fmt.isEmpty() || fmt.length()!=2 || (fmt[0].isEmpty() && fmt[1].isEmpty()) ){
-    //Default formatting
-    return dt.toString(Qt::DefaultLocaleShortDate);
-  }else if(fmt[0].isEmpty()){
-    //Time format only
-    return (dt.date().toString(Qt::DefaultLocaleShortDate)+" "+dt.time().toString(fmt[1]));
-  }else if(fmt[1].isEmpty()){
-    //Date format only
-    return (dt.date().toString(fmt[0])+" "+dt.time().toString(Qt::DefaultLocaleShortDate));
-  }else{
-    //both date/time formats set
-    return dt.toString(fmt.join(" "));
+void BrowserWidget::updateStatus(){
+  //Assemble any status message
+  QString stats = QString(tr("Capacity: %1")).arg(LOS::FileSystemCapacity(BROWSER->currentDirectory()));
+  int nF = MODEL->fileCount();
+  int nD = MODEL->dirCount();
+  double bytes = -1; //not supported for the list widget
+  if(treeWidget!=0 && MODEL->allSizesKnown()){ bytes = MODEL->knownBytes(); }
+
+  if( (nF+nD) >0){
+    stats.prepend("\t");
+    if(nF>0){
+      //Has Files
+      if(bytes>0){
+        stats.prepend( QString(tr("Files: %1 (%2)")).arg(QString::number(nF), LUtils::BytesToDisplaySize(bytes)) );
+      }else{
+        stats.prepend( QString(tr("Files: %1")).arg(QString::number(nF)) );
+      }
+    }
+    if(nD > 0){
+      //Has Dirs
+      if(nF>0){ stats.prepend(" / "); }//has files output already
+      stats.prepend( QString(tr("Dirs: %1")).arg(QString::number(nD)) );
+    }
   }
+  emit updateDirectoryStatus( stats.simplified() );
+  statustip = stats.simplified(); //save for later
 }
 
 // =================
@@ -243,115 +233,39 @@ QString BrowserWidget::DTtoString(QDateTime dt){
 // =================
 void BrowserWidget::clearItems(){
   //qDebug() << "Clear Items";
-  if(listWidget!=0){ listWidget->clear(); }
-  else if(treeWidget!=0){ treeWidget->clear(); }
+  MODEL->clearItems();
   freshload = true;
 }
 
 void BrowserWidget::itemRemoved(QString item){
   //qDebug() << "item removed" << item;
-  if(treeWidget!=0){
-    QList<QTreeWidgetItem*> found = treeWidget->findItems(item.section("/",-1), Qt::MatchExactly, 0); //look for exact name match
-    if(found.isEmpty()){ return; } //no match
-    delete found[0];
-  }else if(listWidget!=0){
-    QList<QListWidgetItem*> found = listWidget->findItems(item.section("/",-1), Qt::MatchExactly); //look for exact name match
-    if(found.isEmpty()){ return; }
-    delete found[0];
-  }
+  MODEL->removeItem(item);
+  if(!freshload){ updateStatus(); }
 }
 
 void BrowserWidget::itemDataAvailable(QIcon ico, LFileInfo info){
   //qDebug() << "Item Data Available:" << info.fileName();
-  int num = 0;
-  if(listWidget!=0){
-    //LIST WIDGET - name and icon only
-    if(!listWidget->findItems(info.fileName(), Qt::MatchExactly).isEmpty()){ 
-      //Update existing item
-      QListWidgetItem *it = listWidget->findItems(info.fileName(), Qt::MatchExactly).first();
-      it->setText(info.fileName());
-      it->setWhatsThis(info.absoluteFilePath());
-      it->setIcon(ico);
-    }else{
-      //New item
-      QListWidgetItem *it = new CQListWidgetItem(ico, info.fileName(), listWidget);
-        it->setWhatsThis(info.absoluteFilePath());
-        it->setData(Qt::UserRole, (info.isDir() ? "dir" : "file")); //used for sorting
-      listWidget->addItem(it);
-    }
-    num = listWidget->count();
-  }else if(treeWidget!=0){
-    QTreeWidgetItem *it = 0;
-    if( ! treeWidget->findItems(info.fileName(), Qt::MatchExactly, 0).isEmpty() ){ it =  treeWidget->findItems(info.fileName(), Qt::MatchExactly, 0).first(); }
-    else{ 
-      it = new CQTreeWidgetItem(treeWidget);  
-      it->setText(0, info.fileName() ); //name (0)
-      treeWidget->addTopLevelItem(it);
-    }
-    //Now set/update all the data
-    it->setIcon(0, ico);
-    it->setText(1, info.isDir() ? "" : LUtils::BytesToDisplaySize(info.size()) ); //size (1)
-    it->setText(2, info.mimetype() ); //type (2)
-    it->setText(3, DTtoString(info.lastModified() )); //modification date (3)
-    it->setText(4, DTtoString(info.created()) ); //creation date (4)
-    //Now all the hidden data
-    it->setWhatsThis(0, info.absoluteFilePath());
-    it->setWhatsThis(3, info.lastModified().toString("yyyyMMddhhmmsszzz") ); //sorts by this actually
-    it->setWhatsThis(4, info.created().toString("yyyyMMddhhmmsszzz") ); //sorts by this actually
-    num = treeWidget->topLevelItemCount();
-  }
-  if(num < numItems){
-    //Still loading items
-    //this->setEnabled(false);
-  }else{
-    if(freshload && treeWidget!=0){
-      //qDebug() << "Resize Tree Widget Contents";
-      for(int i=0; i<treeWidget->columnCount(); i++){ treeWidget->resizeColumnToContents(i); }
-    }
-    freshload = false; //any further changes are updates - not a fresh load of a dir
-    //Done loading items
-    //this->setEnabled(true);
-    //Assemble any status message
-    QString stats = QString(tr("Capacity: %1")).arg(LOS::FileSystemCapacity(BROWSER->currentDirectory()));
-    int nF, nD;
-    double bytes = 0;
-    nF = nD = 0;
-    if(listWidget!=0){
-      bytes = -1; //not supported for this widget
-      for(int i=0; i<listWidget->count(); i++){
-        if(listWidget->item(i)->data(Qt::UserRole).toString()=="dir"){ nD++; } //directory
-        else{ nF++; } //file
-      }
-    }else if(treeWidget!=0){
-      for(int i=0; i<treeWidget->topLevelItemCount(); i++){
-        if(treeWidget->topLevelItem(i)->text(1).isEmpty()){
-          nD++; //directory
-        }else{
-          nF++; //file
-          bytes+=LUtils::DisplaySizeToBytes(treeWidget->topLevelItem(i)->text(1));
-        }
-      }
-    }
+  MODEL->updateItem(ico, info);
+  //Only the total size changes once the listing is done
+  if(!freshload && treeWidget!=0 && MODEL->allSizesKnown()){ updateStatus(); }
+}
 
-    if( (nF+nD) >0){
-      stats.prepend("\t");
-      if(nF>0){
-        //Has Files
-        if(bytes>0){
-          stats.prepend( QString(tr("Files: %1 (%2)")).arg(QString::number(nF), LUtils::BytesToDisplaySize(bytes)) );
-        }else{
-          stats.prepend( QString(tr("Files: %1")).arg(QString::number(nF)) );
-        }
-      }
-      if(nD > 0){
-        //Has Dirs
-        if(nF>0){ stats.prepend(" / "); }//has files output already
-        stats.prepend( QString(tr("Dirs: %1")).arg(QString::number(nD)) );
-      }
-    }
-    emit updateDirectoryStatus( stats.simplified() );
-    statustip = stats.simplified(); //save for later
-  }//end check for finished loading items
+void BrowserWidget::itemsListed(QStringList paths, bool dirs){
+  MODEL->addItems(paths, dirs);
+}
+
+void BrowserWidget::listingFinished(){
+  //Items are listed in the default order - only need to re-sort for a different one (or new items on a reload)
+  if(!freshload || MODEL->sortColumn()!=0 || MODEL->sortOrder()!=Qt::AscendingOrder){
+    MODEL->sort(MODEL->sortColumn(), MODEL->sortOrder());
+  }
+  if(freshload && treeWidget!=0){
+    //qDebug() << "Resize Tree Widget Contents";
+    for(int i=0; i<MODEL->columnCount(); i++){ treeWidget->resizeColumnToContents(i); }
+  }
+  freshload = false; //any further changes are updates - not a fresh load of a dir
+  if(MODEL->rowCount()>0){ updateStatus(); }
+  else{ emit updateDirectoryStatus( tr("No Directory Contents") ); }
 }
 
 void BrowserWidget::itemsLoading(int total){
@@ -371,9 +285,5 @@ void BrowserWidget::selectionChanged(){
 
 void BrowserWidget::resizeEvent(QResizeEvent *ev){
   QWidget::resizeEvent(ev); //do the normal processing first
-  //The list widget needs to be poked to rearrange the items to fit the new size
-  //  tree widget does this fine at the moment.
-  if(listWidget!=0){
-    listWidget->sortItems(Qt::AscendingOrder);
-  }
+  //Note: the list view re-arranges the items to fit the new size itself (Adjust mode)
 }
@@ -13,12 +13,14 @@
 #include <QThread>
 
 #include "Browser.h"
+#include "BrowserModel.h"
 #include "widgets/DDListWidgets.h"
 
 class BrowserWidget : public QWidget{
 	Q_OBJECT
 private:
 	Browser *BROWSER;
+	BrowserModel *MODEL;
 	//QThread *bThread; //browserThread
 	int numItems; //used for checking if all the items have loaded yet
 	QString ID, statustip;
@@ -26,10 +28,10 @@ private:
 	bool freshload;
 
 	//The drag and drop brower widgets
-	DDListWidget *listWidget;
-	DDTreeWidget *treeWidget;
+	DDListView *listWidget;
+	DDTreeView *treeWidget;
 
-	QString DTtoString(QDateTime dt);  //QDateTime to string simplification routine
+	void updateStatus(); //assemble the status message for the directory
 
 public:
 	BrowserWidget(QString objID, QWidget *parent = 0);
@@ -71,6 +73,8 @@ private slots:
 	void clearItems();
 	void itemRemoved(QString);
 	void itemDataAvailable(QIcon, LFileInfo);
+	void itemsListed(QStringList, bool);
+	void listingFinished();
 	void itemsLoading(int total);
 	void selectionChanged();
 
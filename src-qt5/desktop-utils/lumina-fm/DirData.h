@@ -17,10 +17,12 @@
 
 #include <LuminaXDG.h>
 #include <LUtils.h>
+#include <LCommand.h>
 
 #define ZSNAPDIR QString("/.zfs/snapshot/")
 
 #define DIR_DEBUG 0
+#define ZFS_MOUNT_CACHE 60 //seconds the list of ZFS mountpoints is re-used
 
 //Class used for keeping track of directory information in the HASH
 class LDirInfoList{
@@ -35,16 +37,12 @@ public:
 	QStringList mntpoints;
 
 	//Access Functions
-	LDirInfoList(QString path = ""){
+	LDirInfoList(QString path = "", QStringList zfsmounts = QStringList()){
 	  dirpath = path;
 	  list.clear();
 	  fileNames.clear();
 	  hashidden = false;
-	  //Generate the list of all mountpoints if possible
-	  if(LUtils::isValidBinary("zfs")){
-	    mntpoints = LUtils::getCmdOutput("zfs list -H -o mountpoint").filter("/");
-	    mntpoints.removeDuplicates();
-	  }
+	  mntpoints = zfsmounts; //list of all the ZFS mountpoints (read by DirData)
 	}
 	~LDirInfoList(){}
 
@@ -71,8 +69,10 @@ public:
 	  if(showhidden){ dirlist = dir.entryInfoList(QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden , QDir::Name | QDir::DirsFirst); }
 	  else{ dirlist = dir.entryInfoList(QDir::AllEntries | QDir::NoDotAndDotDot , QDir::Name | QDir::DirsFirst); }
 	  //Simple add routine - can make it more dynamic/selective about updating individual items later
+	  QStringList mimes = LXDG::findAppMimeForFiles(dirlist); //one pass over the mime database for the whole dir
 	    for(int i=0; i<dirlist.length(); i++){
-	      list << LFileInfo(dirlist[i]); //generate the extra information for this file
+	      list << LFileInfo(dirlist[i]); //the rest of the extra information is only loaded when it is used
+	      list.last().setMimetype(mimes[i]);
 	      fileNames << dirlist[i].fileName(); //add the filename to the list
 	    }	
 	}
@@ -103,6 +103,9 @@ class DirData : public QObject{
 	Q_OBJECT
 private:
 	QHash<QString, LDirInfoList> HASH; //Where we cache any info for rapid access later
+	QStringList zfsmounts; //ZFS mountpoints
+	QDateTime zfsread; //when the mountpoints were read (re-read after ZFS_MOUNT_CACHE seconds)
+	QList<QStringList> pendingSnaps; //[ID, Dirpath] requests waiting on the list of mountpoints
 
 signals:
 	void DirDataAvailable(QString, QString, LFileInfoList); //[ID, Dirpath, DATA]
@@ -121,7 +124,29 @@ public:
 	  pauseData = false;
 	}
 	~DirData(){}
-	
+
+private slots:
+	void zfsMountsRead(int retcode, QStringList output){
+	  if(retcode==0){
+	    QStringList mounts = output.filter("/");
+	    mounts.removeDuplicates();
+	    if(mounts!=zfsmounts){
+	      //Datasets were mounted/unmounted: the snapshot dirs need to be found again
+	      zfsmounts = mounts;
+	      QHash<QString, LDirInfoList>::iterator it = HASH.begin();
+	      for( ; it!=HASH.end(); ++it){
+	        it.value().mntpoints = zfsmounts;
+	        it.value().snapdir.clear();
+	      }
+	    }
+	  }
+	  zfsread = QDateTime::currentDateTime();
+	  //Now answer the requests which came in while waiting
+	  QList<QStringList> pending = pendingSnaps;
+	  pendingSnaps.clear();
+	  for(int i=0; i<pending.length(); i++){ GetSnapshotData(pending[i][0], pending[i][1]); }
+	}
+
 public slots:
 	void GetDirData(QString ID, QString dirpath){ 
           return;
@@ -132,7 +157,7 @@ public slots:
 	  QString canon = QFileInfo(dirpath).canonicalFilePath();
 	  if(!HASH.contains(canon)){
 	    //New directory (not previously loaded)
-	    LDirInfoList info(canon);
+	    LDirInfoList info(canon, zfsmounts);
 	      info.update(showHidden);
 	    HASH.insert(canon, info);
 	  }else{
@@ -151,9 +176,18 @@ public slots:
 	  QString base; QStringList snaps;
 	  //Only check if ZFS is flagged as available
 	  if(zfsavailable){
+	    if(!zfsread.isValid() || zfsread.secsTo(QDateTime::currentDateTime()) >= ZFS_MOUNT_CACHE){
+	      //Read the list of ZFS mountpoints in the background first (can take a while on large pools)
+	      if(pendingSnaps.isEmpty()){
+	        LCommand *cmd = LCommand::run("zfs list -H -o mountpoint", QStringList(), LCOMMAND_TIMEOUT, ZFS_MOUNT_CACHE);
+	        connect(cmd, SIGNAL(finished(int, QStringList)), this, SLOT(zfsMountsRead(int, QStringList)) );
+	      }
+	      pendingSnaps << (QStringList() << ID << dirpath);
+	      return;
+	    }
 	    //First find if the hash already has an entry for this directory
 	    if(!HASH.contains(dirpath)){
-	      LDirInfoList info(dirpath);
+	      LDirInfoList info(dirpath, zfsmounts);
 	      HASH.insert(dirpath,info);
 	    }
 	    //Now see if a snapshot directory has already been located
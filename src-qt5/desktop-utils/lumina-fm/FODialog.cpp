@@ -9,6 +9,20 @@
 
 #include <QApplication>
 #include <QFontMetrics>
+#include <QDirIterator>
+#include <QtConcurrent>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <sys/ioctl.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <sys/sendfile.h>
+#include <linux/fs.h>
+#endif
 
 #include <ScrollDialog.h>
 
@@ -35,7 +49,7 @@ FODialog::FODialog(QWidget *parent) : QDialog(parent), ui(new Ui::FODialog){
 }
 
 FODialog::~FODialog(){
-  Worker->stopped = true; //just in case it might still be running when closed
+  Worker->stopped.storeRelease(1); //just in case it might still be running when closed
   WorkThread->quit();
   WorkThread->wait();
   delete Worker;
@@ -175,35 +189,28 @@ void FODialog::WorkDone(QStringList errlist){
 }
 
 void FODialog::on_push_stop_clicked(){
-  Worker->stopped = true;
+  Worker->stopped.storeRelease(1);
 }
 
 // ===================
 // ==== FOWorker Class ====
 // ===================
-QStringList FOWorker::subfiles(QString dirpath, bool dirsfirst){
-  //NOTE: dirpath (input) is always the first/last item in the output as well!
-  QStringList out;
-  if(dirsfirst){ out << dirpath; }
-  if( QFileInfo(dirpath).isDir() ){
-    QDir dir(dirpath);
-    if(dirsfirst){
-      //Now recursively add any subdirectories and their contents
-      QStringList subdirs = dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot | QDir::Hidden, QDir::NoSort);
-      for(int i=0; i<subdirs.length(); i++){ out << subfiles(dir.absoluteFilePath(subdirs[i]), dirsfirst); }
-    }
-    //List the files
-    QStringList files = dir.entryList(QDir::Files | QDir::NoDotAndDotDot | QDir::Hidden | QDir::System, QDir::NoSort);
-    for(int i=0; i<files.length(); i++){ out << dir.absoluteFilePath(files[i]); }
-    
-    if(!dirsfirst){
-      //Now recursively add any subdirectories and their contents
-      QStringList subdirs = dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot | QDir::Hidden, QDir::NoSort);
-      for(int i=0; i<subdirs.length(); i++){ out << subfiles(dir.absoluteFilePath(subdirs[i]), dirsfirst); }
+void FOWorker::countItems(QString path, bool bytes){
+  QFileInfo info(path);
+  int items = 1;
+  qint64 size = info.isDir() ? 0 : info.size();
+  if(info.isDir() && !info.isSymLink()){
+    QDirIterator it(path, QDir::Dirs | QDir::Files | QDir::NoDotAndDotDot | QDir::Hidden | QDir::System, QDirIterator::Subdirectories | QDirIterator::FollowSymlinks);
+    while(it.hasNext() && !stopped.loadAcquire()){
+      it.next();
+      items++;
+      if(bytes && !it.fileInfo().isDir()){ size+= it.fileInfo().size(); }
     }
   }
-  if(!dirsfirst){ out << dirpath; }
-  return out;
+  statMutex.lock();
+  totalItems+= items;
+  if(bytes){ totalBytes+= size; }
+  statMutex.unlock();
 }
 
 QString FOWorker::newFileName(QString path){
@@ -218,163 +225,275 @@ QString FOWorker::newFileName(QString path){
   return QString(path+"-"+QString::number(num)+extension);
 }
 
-QStringList FOWorker::removeItem(QString path, bool recursive){
+void FOWorker::removeItem(QString path, bool recursive){
   //qDebug() << "Remove Path:" << path;
-  QStringList items;
-  if(recursive){ items = subfiles(path,false); }
-  else{ items << path; } //only the given path
-  //qDebug() << " - Subfiles:" << items;
-  QStringList err;	
-  for(int i=0; i<items.length(); i++){
-    if(QFileInfo(items[i]).isDir()){
-      if(items[i]==path){
-        //Current Directory Removal
-        QDir dir;
-        if( !dir.rmdir(items[i]) ){ err << items[i]; }		      
-      }else{
-        //Recursive Directory Removal
-        err << removeItem(items[i], recursive);	      
-      }
-    }else{
-      //Simple File Removal
-      if( !QFile::remove(items[i]) ){ err << items[i]; }	    
+  QFileInfo info(path);
+  if(info.isDir() && !info.isSymLink()){
+    //Contents first (walked as we go - never listed all at once)
+    if(recursive){
+      QDirIterator it(path, QDir::Dirs | QDir::Files | QDir::NoDotAndDotDot | QDir::Hidden | QDir::System);
+      while(it.hasNext() && !stopped.loadAcquire()){ removeItem(it.next(), recursive); }
     }
+    QDir dir;
+    if( !dir.rmdir(path) ){ addError(path); }
+  }else{
+    //Simple File Removal (or the link itself - not the contents of a linked dir)
+    if( !QFile::remove(path) ){ addError(path); }
+  }
+  if(isRM){
+    setCurrent(path, "");
+    addProgress(0,1);
+    reportProgress();
   }
-  return err;
 }
 
-QStringList FOWorker::copyItem(QString oldpath, QString newpath){
-  QStringList err;
-  if(oldpath == newpath){ return err; } //copy something onto itself - just skip it 
-  if(QFileInfo(oldpath).isDir()){
-    //Create a new directory with the same name (no way to copy dir+contents)
+void FOWorker::copyTree(QString oldpath, QString newpath){
+  if(stopped.loadAcquire()){ return; }
+  QFileInfo info(oldpath);
+  if(info.isDir()){
+    //Create a new directory with the same name before anything goes in it
     QDir dir;
-    if( !dir.mkpath(newpath) ){ err << oldpath; }
+    if( !dir.mkpath(newpath) ){ addError(oldpath); return; } //skip all the children as well (they will also fail)
+    //Keep it writable until the contents are copied (read-only source dirs)
+    dirPerms << qMakePair(newpath, info.permissions());
+    setCurrent(oldpath, newpath);
+    addProgress(0,1);
+    QDirIterator it(oldpath, QDir::Dirs | QDir::Files | QDir::NoDotAndDotDot | QDir::Hidden | QDir::System);
+    while(it.hasNext() && !stopped.loadAcquire()){
+      QString path = it.next();
+      if(path==curDest){ continue; } //copy of a dir into itself - do not copy the copy
+      copyTree(path, newpath+"/"+it.fileName());
+    }
+  }else if(info.size() < 1048576){
+    //Small file: overlap it with the other small files (most of the time is spent opening/closing files)
+    setCurrent(oldpath, newpath);
+    waitForJobs(maxRunning-1);
+    statMutex.lock();
+    running++;
+    statMutex.unlock();
+    QtConcurrent::run(this, &FOWorker::copyJob, oldpath, newpath);
   }else{
-    //Copy the file and reset permissions as necessary
-    if( !QFile::copy(oldpath, newpath) ){ err << oldpath; }
-    else{
-      if(isCP){
-	QFile::setPermissions(newpath, QFile::permissions(oldpath));
-	//Nothing special for copies at the moment (might be something we run into later)
-      }else if(isRESTORE){
-	QFile::setPermissions(newpath, QFile::permissions(oldpath));
-	//Nothing special for restores at the moment (might be something we run into later)
+    //Large file: copy it right here with progress updates
+    setCurrent(oldpath, newpath);
+    if( !copyData(oldpath, newpath, true) ){ addError(oldpath); }
+    addProgress(0,1);
+  }
+  reportProgress();
+}
+
+void FOWorker::copyJob(QString oldpath, QString newpath){
+  bool ok = stopped.loadAcquire() || copyData(oldpath, newpath, false);
+  statMutex.lock();
+  if(!ok){ errors << oldpath; }
+  running--;
+  doneItems++;
+  jobDone.wakeAll();
+  statMutex.unlock();
+}
+
+bool FOWorker::copyData(QString oldpath, QString newpath, bool report){
+  int in = ::open(QFile::encodeName(oldpath).constData(), O_RDONLY);
+  if(in<0){ return false; }
+  struct stat st;
+  if(::fstat(in, &st)!=0){ ::close(in); return false; }
+  int out = ::open(QFile::encodeName(newpath).constData(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+  if(out<0){ ::close(in); return false; }
+  bool ok = true;
+  qint64 left = st.st_size;
+  int method = 0; //[0 = in-kernel copy, 1 = sendfile, 2 = read/write]
+#ifdef FICLONE
+  //Share the data blocks if the filesystem can do it (btrfs/xfs reflinks)
+  if(left>0 && ::ioctl(out, FICLONE, in)==0){ addProgress(left,0); left = 0; }
+#endif
+#if !defined(__linux__)
+  method = 2;
+#elif !defined(SYS_copy_file_range)
+  method = 1;
+#endif
+  QByteArray buffer;
+  while(left>0 && ok && !stopped.loadAcquire()){
+    size_t len = qMin(left, (qint64) 4194304); //4MB at a time (progress/stop checks)
+    ssize_t done = -1;
+#ifdef __linux__
+  #ifdef SYS_copy_file_range
+    if(method==0){
+      done = ::syscall(SYS_copy_file_range, in, (loff_t*) 0, out, (loff_t*) 0, len, 0);
+      if(done<0 && errno!=EINTR){ method = 1; continue; } //not supported here - fall back (file offsets are unchanged)
+    }
+  #endif
+    if(method==1){
+      done = ::sendfile(out, in, (off_t*) 0, len);
+      if(done<0 && errno!=EINTR){ method = 2; continue; }
+    }
+#endif
+    if(method==2){
+      if(buffer.isEmpty()){ buffer.resize(262144); }
+      done = ::read(in, buffer.data(), qMin(len, (size_t) buffer.size()) );
+      for(ssize_t written = 0; done>0 && written<done; ){
+        ssize_t w = ::write(out, buffer.data()+written, done-written);
+        if(w<0 && errno==EINTR){ continue; }
+        if(w<=0){ ok = false; break; }
+        written+= w;
       }
     }
+    if(done<0 && errno==EINTR){ continue; }
+    if(done<0){ ok = false; }
+    else if(done==0){ break; } //source shrank while copying
+    else{
+      left-= done;
+      addProgress(done,0);
+      if(report){ reportProgress(); }
+    }
+  }
+  //Same permissions as the original file
+  ::fchmod(out, st.st_mode & 07777);
+  if(::close(out)!=0){ ok = false; }
+  ::close(in);
+  if(stopped.loadAcquire()){
+    ok = true; //not an error - but do not leave a partial file around
+    if(left>0){ QFile::remove(newpath); }
+  }
+  return ok;
+}
+
+void FOWorker::waitForJobs(int max){
+  statMutex.lock();
+  while(running>max){
+    jobDone.wait(&statMutex, 200);
+    statMutex.unlock();
+    reportProgress();
+    statMutex.lock();
   }
-  return err;
+  statMutex.unlock();
+}
+
+void FOWorker::applyDirPermissions(){
+  //Deepest dirs first (created after their parents)
+  for(int i=dirPerms.length()-1; i>=0; i--){
+    QFile::setPermissions(dirPerms[i].first, dirPerms[i].second);
+  }
+  dirPerms.clear();
+}
+
+int FOWorker::errorCount(){
+  statMutex.lock();
+  int num = errors.length();
+  statMutex.unlock();
+  return num;
+}
+
+void FOWorker::setCurrent(QString oldpath, QString newpath){
+  statMutex.lock();
+  curOld = oldpath;
+  curNew = newpath;
+  statMutex.unlock();
+}
+
+void FOWorker::addProgress(qint64 bytes, int items){
+  statMutex.lock();
+  doneBytes+= bytes;
+  doneItems+= items;
+  statMutex.unlock();
+}
+
+void FOWorker::addError(QString path){
+  statMutex.lock();
+  errors << path;
+  statMutex.unlock();
+}
+
+void FOWorker::reportProgress(bool force){
+  //Only send updates a few times a second - not for every file
+  if(!force && lastReport.isValid() && lastReport.elapsed()<200){ return; }
+  lastReport.start();
+  statMutex.lock();
+  int item = doneItems, items = totalItems;
+  qint64 bytes = doneBytes, total = totalBytes;
+  QString ofile = curOld, nfile = curNew;
+  statMutex.unlock();
+  double rate = 0;
+  if(timer.elapsed()>0){ rate = (bytes*1000.0)/timer.elapsed(); }
+  emit startingItem(qMin(item+1, items), items, ofile, nfile);
+  if(total>0){ emit progress(bytes, total, rate); }
 }
 
 // ==== PRIVATE SLOTS ====
 void FOWorker::slotStartOperations(){
   if(DEBUG){ qDebug() << "Start File operations" << isRM << isCP << isMV << ofiles << nfiles << overwrite; }
-  //Now setup the UI
-  /*ui->progressBar->setRange(0,ofiles.length());
-  ui->progressBar->setValue(0);
-  ui->progressBar->setVisible(true);
-  QApplication::processEvents();*/
-  /*if(!isRM && overwrite==-1){
-    //Check if the new files already exist, and prompt for action
-    QStringList existing;
-    for(int i=0; i<nfiles.length(); i++){
-      if(QFile::exists(nfiles[i])){ existing << nfiles[i].section("/",-1); }
+  statMutex.lock();
+  errors.clear();
+  statMutex.unlock();
+  dirPerms.clear();
+  running = totalItems = doneItems = 0;
+  totalBytes = doneBytes = 0;
+  timer.start();
+  lastReport.invalidate();
+  //Check the new file names up front and get the size of the operation (better tracking)
+  QStringList olist, nlist; //old/new list to actually be used (not inputs - modified as necessary)
+  for(int i=0; i<ofiles.length() && !stopped.loadAcquire(); i++){
+    if(isRM){ //only old files
+      olist << ofiles[i];
+      countItems(ofiles[i], false);
+      continue;
     }
-    if(!existing.isEmpty()){
-      //Prompt for whether to overwrite, not overwrite, or cancel
-      QMessageBox::StandardButton ans = QMessageBox::question(this, tr("Overwrite Files?"), tr("Do you want to overwrite the existing files?")+"\n"+tr("Note: It will just add a number to the filename otherwise.")+"\n\n"+existing.join(", "), QMessageBox::YesToAll | QMessageBox::NoToAll | QMessageBox::Cancel, QMessageBox::NoToAll);
-      if(ans==QMessageBox::NoToAll){ overwrite = 0; } //don't overwrite
-      else if(ans==QMessageBox::YesToAll){ overwrite = 1; } //overwrite
-      else{ emit finished(QStringList()); return; } //cancel operations
+    if(isMV && nfiles[i].startsWith(ofiles[i]+"/") ){
+      //This is trying to move a directory into itself  (not possible)
+      // Example: move "~/mydir" -> "~/mydir/mydir2"
+      QStringList err; err << tr("Invalid Move") << QString(tr("It is not possible to move a directory into itself. Please make a copy of the directory instead.\n\nOld Location: %1\nNew Location: %2")).arg(ofiles[i], nfiles[i]);
+      emit finished(err); return;
     }
-  }*/
-	
-  //Get the complete number of items to be operated on (better tracking)
-  QStringList olist, nlist; //old/new list to actually be used (not inputs - modified/added as necessary)
-  for(int i=0; i<ofiles.length() && !stopped; i++){
-    if(isRM){ //only old files
-      olist << subfiles(ofiles[i], false); //dirs need to be last for removals
-    }else if(isCP || isRESTORE){
-      if(QFile::exists(nfiles[i])){
-	if(overwrite!=1){
-	  qDebug() << " - Get New Filename:" << nfiles[i];
-	  nfiles[i] = newFileName(nfiles[i]); //prompt for new file name up front before anything starts
-	  qDebug() << " -- " << nfiles[i];
-	}
-      }
-      if(nfiles[i] == ofiles[i] && overwrite==1){
-	//Trying to copy a file/dir to itself - skip it
-	continue;
-      }
-      QStringList subs = subfiles(ofiles[i], true); //dirs need to be first for additions
-      for(int s=0; s<subs.length(); s++){
-        olist << subs[s];
-	QString newsub = subs[s].section(ofiles[i],0,100, QString::SectionSkipEmpty); 
-	    newsub.prepend(nfiles[i]);
-	nlist << newsub;
-      }
-    }else{ //Move/rename
-      if( nfiles[i].startsWith(ofiles[i]+"/") ){
-	//This is trying to move a directory into itself  (not possible)
-	// Example: move "~/mydir" -> "~/mydir/mydir2"
-	QStringList err; err << tr("Invalid Move") << QString(tr("It is not possible to move a directory into itself. Please make a copy of the directory instead.\n\nOld Location: %1\nNew Location: %2")).arg(ofiles[i], nfiles[i]);
-	emit finished(err); return;
-      }else{
-	//Check for existance of the new name
-	if(QFile::exists(nfiles[i])){
-	  if(overwrite!=1){
-	    nfiles[i] = newFileName(nfiles[i]); //prompt for new file name up front before anything starts
-	  }
-        }
-	//no changes necessary
-        olist << ofiles[i];
-        nlist << nfiles[i];
-      }
+    if(QFile::exists(nfiles[i]) && overwrite!=1){
+      if(DEBUG){ qDebug() << " - Get New Filename:" << nfiles[i]; }
+      nfiles[i] = newFileName(nfiles[i]); //prompt for new file name up front before anything starts
     }
+    if(nfiles[i] == ofiles[i]){ continue; } //Trying to copy/move a file/dir to itself - skip it
+    olist << ofiles[i];
+    nlist << nfiles[i];
+    if(isMV){ statMutex.lock(); totalItems++; statMutex.unlock(); } //just a rename most of the time
+    else{ countItems(ofiles[i], true); }
   }
+  reportProgress(true);
   //Now start iterating over the operations
-  QStringList errlist;
-  for(int i=0; i<olist.length() && !stopped; i++){
+  for(int i=0; i<olist.length() && !stopped.loadAcquire(); i++){
     if(isRM){
-      /*ui->label->setText( QString(tr("Removing: %1")).arg(olist[i].section("/",-1)) );
-      QApplication::processEvents();*/
-      emit startingItem(i+1,olist.length(), olist[i], "");
-      errlist << removeItem(olist[i]);
-    }else if(isCP || isRESTORE){
-      /*ui->label->setText( QString(tr("Copying: %1 to %2")).arg(olist[i].section("/",-1), nlist[i].section("/",-1)) );
-      QApplication::processEvents();*/
-      emit startingItem(i+1,olist.length(), olist[i],nlist[i]);
-      if(QFile::exists(nlist[i])){
-	if(overwrite==1){
-	  errlist << removeItem(nlist[i], true); //recursively remove the file/dir since we are supposed to overwrite it
-	}
-      }
-      //If a parent directory fails to copy, skip all the children as well (they will also fail)
-      //QApplication::processEvents();
-      if( !errlist.contains(olist[i].section("/",0,-1)) ){ 
-        errlist << copyItem(olist[i], nlist[i]);
-      }
-    }else if(isMV){
-      /*ui->label->setText( QString(tr("Moving: %1 to %2")).arg(ofiles[i].section("/",-1), nfiles[i].section("/",-1)) );
-      QApplication::processEvents();*/
-      emit startingItem(i+1,olist.length(), olist[i], nlist[i]);
-      //Clean up any overwritten files/dirs
-      if(QFile::exists(nlist[i])){
-	if(overwrite==1){
-	  errlist << removeItem(nlist[i], true); //recursively remove the file/dir since we are supposed to overwrite it
-	}
+      removeItem(olist[i], true);
+      continue;
+    }
+    //Clean up any overwritten files/dirs
+    if(overwrite==1 && (QFileInfo::exists(nlist[i]) || QFileInfo(nlist[i]).isSymLink()) ){
+      removeItem(nlist[i], true); //recursively remove the file/dir since we are supposed to overwrite it
+    }
+    if(isMV){
+      setCurrent(olist[i], nlist[i]);
+      //Same filesystem: just a single rename of the top-level item
+      if( ::rename(QFile::encodeName(olist[i]).constData(), QFile::encodeName(nlist[i]).constData())==0 ){
+        addProgress(0,1);
+      }else if(errno==EXDEV){
+        //Different filesystem: copy everything over, then remove the originals
+        countItems(olist[i], true);
+        int errs = errorCount();
+        curDest = nlist[i];
+        copyTree(olist[i], nlist[i]);
+        waitForJobs(0);
+        applyDirPermissions();
+        if(errorCount()==errs && !stopped.loadAcquire()){ removeItem(olist[i], true); }
+        addProgress(0,1);
+      }else{
+        addError(olist[i]);
       }
-      //Perform the move if no error yet (including skipping all children)
-      if( !errlist.contains(olist[i].section("/",0,-1)) ){ 
-        if( !QFile::rename(ofiles[i], nfiles[i]) ){
-          errlist << ofiles[i];
-        }
-      }	
+    }else{
+      curDest = nlist[i];
+      copyTree(olist[i], nlist[i]);
     }
-    //ui->progressBar->setValue(i+1);
-    //QApplication::processEvents();
+    reportProgress();
   }
+  waitForJobs(0); //make sure the last copies are done
+  applyDirPermissions();
+  reportProgress(true);
   //All finished, emit the signal
+  statMutex.lock();
+  QStringList errlist = errors;
+  statMutex.unlock();
   errlist.removeAll(""); //make sure to clear any empty items
   emit finished(errlist);
   qDebug() << "Done with File Operations";
@@ -18,6 +18,11 @@
 #include <QDir>
 #include <QFile>
 #include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QElapsedTimer>
+#include <QAtomicInt>
+#include <QPair>
 
 // libLumina includes
 #include <LuminaXDG.h>
@@ -29,27 +34,59 @@ public:
 	//variables that need to be set before starting the operations
 	QStringList ofiles, nfiles; //original/new files
 	bool isRM, isCP, isRESTORE, isMV;
-	bool stopped;
+	QAtomicInt stopped; //set from the GUI thread, read by the copy jobs
 	int overwrite; // [-1= auto, 0= no overwrite, 1= overwrite]
 
 
 	FOWorker() : QObject(){
-	  isRM = isCP = isRESTORE = isMV = stopped = false;
+	  isRM = isCP = isRESTORE = isMV = false;
+	  stopped.storeRelease(0);
 	  overwrite = -1; //auto
+	  running = 0;
+	  maxRunning = qMax(2, QThread::idealThreadCount());
+	}
+	~FOWorker(){
+	  //make sure none of the copy jobs are still using this object
+	  stopped.storeRelease(1);
+	  statMutex.lock();
+	  while(running>0){ jobDone.wait(&statMutex); }
+	  statMutex.unlock();
 	}
-	~FOWorker(){}
 		
 public slots:
 	void slotStartOperations();
 
 private:
-	QStringList subfiles(QString dirpath, bool dirsfirst = false); //recursive function for fetching all "child" files/dirs (dirs last by default)
+	//Shared with the small-file copies running in the thread pool (use statMutex)
+	QMutex statMutex;
+	QWaitCondition jobDone;
+	QStringList errors;
+	int running, maxRunning; //number of copy jobs in the pool
+	int totalItems, doneItems;
+	qint64 totalBytes, doneBytes;
+	QString curOld, curNew; //item currently being worked on
+	//Only used on the worker thread
+	QElapsedTimer timer, lastReport;
+	QString curDest; //top-level destination of the current copy (never walked into)
+	QList< QPair<QString, QFile::Permissions> > dirPerms; //copied dirs (permissions set once the contents are done)
+
+	void countItems(QString path, bool bytes); //add everything under the given path to the totals
 	QString newFileName(QString path);
-	QStringList removeItem(QString path, bool recursive = false);
-	QStringList copyItem(QString oldpath, QString newpath);
+	void removeItem(QString path, bool recursive = false);
+	void copyTree(QString oldpath, QString newpath); //dirs are created right away, files copied/queued
+	void copyJob(QString oldpath, QString newpath); //runs in the thread pool
+	bool copyData(QString oldpath, QString newpath, bool report);
+	void waitForJobs(int max); //wait until no more than "max" copy jobs are running
+	void applyDirPermissions(); //after all the copy jobs are finished
+	int errorCount();
+	void setCurrent(QString oldpath, QString newpath);
+	void addProgress(qint64 bytes, int items);
+	void addError(QString path);
+	void reportProgress(bool force = false);
 
 signals:
 	void startingItem(int, int, QString, QString); //current number, total number, Old File, New File (if appropriate)
+	void progress(qint64, qint64, double); //bytes finished, bytes total, bytes per second
 	void finished(QStringList); //errors returned
 };
 
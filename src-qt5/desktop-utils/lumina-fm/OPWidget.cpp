@@ -11,6 +11,7 @@
 
 OPWidget::OPWidget(QWidget *parent) : QWidget(parent), ui(new Ui::OPWidget()){
   starttime = endtime = -1;
+  bytemode = false;
   WA = new QWidgetAction(0);
   WA->setDefaultWidget(this);
   worker = 0;
@@ -26,7 +27,7 @@ OPWidget::OPWidget(QWidget *parent) : QWidget(parent), ui(new Ui::OPWidget()){
 }
 
 OPWidget::~OPWidget(){
-  if(worker!=0){ worker->stopped = true; worker->deleteLater(); }
+  if(worker!=0){ worker->stopped.storeRelease(1); worker->deleteLater(); }
   if(workthread!=0){ workthread->quit(); workthread->wait(); delete workthread; }
   WA->deleteLater();
   if(dlg!=0){ dlg->deleteLater(); }
@@ -41,6 +42,7 @@ void OPWidget::setupOperation(QString optype, QStringList oldF, QStringList newF
   if(worker==0){
     worker = new FOWorker();
     connect(worker, SIGNAL(startingItem(int,int,QString,QString)), this, SLOT(opUpdate(int,int,QString,QString)) );
+    connect(worker, SIGNAL(progress(qint64,qint64,double)), this, SLOT(opProgress(qint64,qint64,double)) );
     connect(worker, SIGNAL(finished(QStringList)), this, SLOT(opFinished(QStringList)) );
     worker->moveToThread(workthread);
   }
@@ -85,7 +87,7 @@ void OPWidget::startOperation(){
 
 // PRIVATE SLOTS
 void OPWidget::closeWidget(){
-  if(!isDone()){ worker->stopped = true; }
+  if(!isDone()){ worker->stopped.storeRelease(1); }
   else{ emit closed(this->whatsThis()); }
 }
 
@@ -104,14 +106,29 @@ void OPWidget::opFinished(QStringList errors){
   endtime = QDateTime::currentMSecsSinceEpoch();
   emit finished(this->whatsThis());
   ui->progressBar->setValue(ui->progressBar->maximum()); //last item finished
+  ui->progressBar->resetFormat();
   ui->tool_showerrors->setVisible(!Errors.isEmpty());
   ui->label->setText( QString(tr("%1 Finished")).arg(tract) + (errors.isEmpty() ? "" : (" ("+tr("Errors Occured")+")") ) );
 }
 
 void OPWidget::opUpdate(int cur, int tot, QString ofile, QString nfile){ //current, total, old file, new file
-  ui->progressBar->setRange(0,tot);
-  ui->progressBar->setValue(cur);
+  if(!bytemode){
+    ui->progressBar->setRange(0,tot);
+    ui->progressBar->setValue(cur);
+  }
   QString txt = tract +": "+ofile.section("/",-1);
   if(!nfile.isEmpty()){txt.append(" -> "+nfile.section("/",-1) ); }
   ui->label->setText( txt);
 }
+
+void OPWidget::opProgress(qint64 done, qint64 total, double rate){ //bytes finished, bytes total, bytes per second
+  bytemode = true;
+  ui->progressBar->setRange(0,1000); //byte counts are too large for the progress bar
+  ui->progressBar->setValue( qRound( (done*1000.0)/total ) );
+  QString txt = "%p%";
+  if(rate>0){
+    txt.append(" - "+LUtils::BytesToDisplaySize(qRound64(rate))+"/s");
+    if(done<total){ txt.append(" - "+LUtils::SecondsToDisplay( qRound((total-done)/rate) ) ); }
+  }
+  ui->progressBar->setFormat(txt);
+}
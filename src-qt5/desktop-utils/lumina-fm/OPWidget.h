@@ -49,12 +49,14 @@ private:
 	qint64 starttime, endtime;  //in ms
 	QStringList Errors;
 	QString tract; //translated action
+	bool bytemode; //progress is shown in bytes (instead of items)
 
 private slots:
 	void closeWidget();
 	void showErrors();
 	void opFinished(QStringList); //errors
 	void opUpdate(int, int, QString, QString); //current, total, old file, new file
+	void opProgress(qint64, qint64, double); //bytes finished, bytes total, bytes per second
 
 signals:
 	void starting(QString);
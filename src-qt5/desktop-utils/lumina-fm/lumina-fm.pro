@@ -25,6 +25,7 @@ SOURCES += main.cpp \
 		gitCompat.cpp \
 		gitWizard.cpp \
 		Browser.cpp \
+		BrowserModel.cpp \
 		BrowserWidget.cpp \
 		TrayUI.cpp \
 		OPWidget.cpp
@@ -41,6 +42,7 @@ HEADERS  += MainUI.h \
 		gitCompat.h \
 		gitWizard.h \
 		Browser.h \
+		BrowserModel.h \
 		BrowserWidget.h \
 		TrayUI.h \
 		OPWidget.h
@@ -4,8 +4,8 @@
 //  Available under the 3-clause BSD license
 //  See the LICENSE file for full details
 //===========================================
-// This is a couple simple widget subclasses to enable drag and drop functionality
-// NOTE: The "whatsThis()" item information needs to correspond to the "[cut/copy]::::<file path>" syntax
+// This is a couple simple view subclasses to enable drag and drop functionality
+// NOTE: The "whatsThis" item data (Qt::WhatsThisRole) needs to be the file path of the item
 //NOTE2: The "whatsThis()" information on the widget itself should be the current dir path *if* it can accept drops
 //===========================================
 #ifndef _LUMINA_FM_DRAG_DROP_WIDGETS_H
@@ -13,8 +13,8 @@
 
 #define MIME QString("x-special/lumina-copied-files")
 
-#include <QListWidget>
-#include <QTreeWidget>
+#include <QListView>
+#include <QTreeView>
 #include <QDropEvent>
 #include <QMimeData>
 #include <QDrag>
@@ -24,15 +24,13 @@
 #include <QUrl>
 #include <QDir>
 
-#include <LUtils.h>
-
 //==============
-//  LIST WIDGET
+//  LIST VIEW
 //==============
-class DDListWidget : public QListWidget{
+class DDListView : public QListView{
 	Q_OBJECT
 public:
-	DDListWidget(QWidget *parent=0) : QListWidget(parent){
+	DDListView(QWidget *parent=0) : QListView(parent){
 	  //Drag and Drop Properties
 	  this->setDragDropMode(QAbstractItemView::DragDrop);
 	  this->setDefaultDropAction(Qt::MoveAction); //prevent any built-in Qt actions - the class handles it
@@ -43,11 +41,21 @@ public:
 	  this->setSelectionBehavior(QAbstractItemView::SelectRows);
 	  this->setFlow(QListView::TopToBottom);
 	  this->setWrapping(true);
+	  this->setResizeMode(QListView::Adjust);
 	  this->setMouseTracking(true);
-	  this->setSortingEnabled(true); //This sorts *only* by name - type is not preserved
+	  //Large directories: lay out the items in batches and only look at the size of one item
+	  this->setUniformItemSizes(true);
+	  this->setLayoutMode(QListView::Batched);
 	  //this->setStyleSheet("QListWidget::item{ border: 1px solid transparent; border-radius: 5px; background-color: transparent;} QListWidget::item:hover{ border-color: black; } QListWidget::item:focus{ border-color: lightblue; }");
 	}
-	~DDListWidget(){}
+	~DDListView(){}
+
+	QStringList selectedPaths(){
+	  QStringList paths;
+	  QModelIndexList sel = this->selectionModel()->selectedRows();
+	  for(int i=0; i<sel.length(); i++){ paths << sel[i].data(Qt::WhatsThisRole).toString(); }
+	  return paths;
+	}
 
 signals:
 	void DataDropped(QString, QStringList); //Dir path, List of commands
@@ -55,16 +63,16 @@ signals:
 
 protected:
 	void focusInEvent(QFocusEvent *ev){
-	  QListWidget::focusInEvent(ev);
+	  QListView::focusInEvent(ev);
 	  emit GotFocus();
 	}
 
 	void startDrag(Qt::DropActions act){
-	  QList<QListWidgetItem*> items = this->selectedItems();
+	  QStringList items = selectedPaths();
 	  if(items.length()<1){ return; }
 	  QList<QUrl> urilist;
 	  for(int i=0; i<items.length(); i++){ 
-	    urilist << QUrl::fromLocalFile(items[i]->whatsThis());	  
+	    urilist << QUrl::fromLocalFile(items[i]);	  
 	  }
 	  //Create the mime data
 	  //qDebug() << "Start Drag:" << urilist;
@@ -111,10 +119,10 @@ protected:
 	  ev->accept(); //handled here
 	  QString dirpath = this->whatsThis();
 	  //See if the item under the drop point is a directory or not
-	  QListWidgetItem *it = this->itemAt( ev->pos());
-	  if(it!=0){
-	    //qDebug() << "Drop Item:" << it->whatsThis();
-	    QFileInfo info(it->whatsThis());
+	  QModelIndex it = this->indexAt( ev->pos());
+	  if(it.isValid()){
+	    //qDebug() << "Drop Item:" << it.data(Qt::WhatsThisRole);
+	    QFileInfo info(it.data(Qt::WhatsThisRole).toString());
 	    if(info.isDir() && info.isWritable()){
 	      dirpath = info.absoluteFilePath();
 	    }
@@ -136,25 +144,25 @@ protected:
 	
 	void mouseReleaseEvent(QMouseEvent *ev){
 	  if(ev->button() != Qt::RightButton && ev->button() != Qt::LeftButton){ ev->ignore(); }
-	  else{ QListWidget::mouseReleaseEvent(ev); } //pass it along to the widget
+	  else{ QListView::mouseReleaseEvent(ev); } //pass it along to the widget
 	}
 	void mousePressEvent(QMouseEvent *ev){
 	  if(ev->button() != Qt::RightButton && ev->button() != Qt::LeftButton){ ev->ignore(); }
-	  else{ QListWidget::mousePressEvent(ev); } //pass it along to the widget	  
+	  else{ QListView::mousePressEvent(ev); } //pass it along to the widget	  
 	}
 	/*void mouseMoveEvent(QMouseEvent *ev){
 	  if(ev->button() != Qt::RightButton && ev->button() != Qt::LeftButton){ ev->ignore(); }
-	  else{ QListWidget::mouseMoveEvent(ev); } //pass it along to the widget		
+	  else{ QListView::mouseMoveEvent(ev); } //pass it along to the widget		
 	}*/
 };
 
 //================
-//     TreeWidget
+//     TreeView
 //================
-class DDTreeWidget : public QTreeWidget{
+class DDTreeView : public QTreeView{
 	Q_OBJECT
 public:
-	DDTreeWidget(QWidget *parent=0) : QTreeWidget(parent){
+	DDTreeView(QWidget *parent=0) : QTreeView(parent){
 	  //Drag and Drop Properties
 	  this->setDragDropMode(QAbstractItemView::DragDrop);
 	  this->setDefaultDropAction(Qt::MoveAction); //prevent any built-in Qt actions - the class handles it
@@ -167,8 +175,17 @@ public:
 	  this->setSortingEnabled(true);
 	  this->setIndentation(0);
 	  this->setItemsExpandable(false);
+	  this->setRootIsDecorated(false);
+	  this->setUniformRowHeights(true); //large directories: no need to check every row
+	}
+	~DDTreeView(){}
+
+	QStringList selectedPaths(){
+	  QStringList paths;
+	  QModelIndexList sel = this->selectionModel()->selectedRows();
+	  for(int i=0; i<sel.length(); i++){ paths << sel[i].data(Qt::WhatsThisRole).toString(); }
+	  return paths;
 	}
-	~DDTreeWidget(){}
 
 signals:
 	void DataDropped(QString, QStringList); //Dir path, List of commands
@@ -176,15 +193,15 @@ signals:
 
 protected:
 	void focusInEvent(QFocusEvent *ev){
-	  QTreeWidget::focusInEvent(ev);
+	  QTreeView::focusInEvent(ev);
 	  emit GotFocus();
 	}
 	void startDrag(Qt::DropActions act){
-	  QList<QTreeWidgetItem*> items = this->selectedItems();
+	  QStringList items = selectedPaths();
 	  if(items.length()<1){ return; }
 	  QList<QUrl> urilist;
 	  for(int i=0; i<items.length(); i++){ 
-	    urilist << QUrl::fromLocalFile(items[i]->whatsThis(0));	  
+	    urilist << QUrl::fromLocalFile(items[i]);	  
 	  }
 	  //Create the mime data
 	  QMimeData *mime = new QMimeData;
@@ -225,9 +242,9 @@ protected:
 	  ev->accept(); //handled here
 	  QString dirpath = this->whatsThis();
 	  //See if the item under the drop point is a directory or not
-	  QTreeWidgetItem *it = this->itemAt( ev->pos());
-	  if(it!=0){
-	    QFileInfo info(it->whatsThis(0));
+	  QModelIndex it = this->indexAt( ev->pos());
+	  if(it.isValid()){
+	    QFileInfo info(it.data(Qt::WhatsThisRole).toString());
 	    if(info.isDir() && info.isWritable()){
 	      dirpath = info.absoluteFilePath();
 	    }
@@ -249,81 +266,16 @@ protected:
 	
 	void mouseReleaseEvent(QMouseEvent *ev){
 	  if(ev->button() != Qt::RightButton && ev->button() != Qt::LeftButton){ ev->ignore(); }
-	  else{ QTreeWidget::mouseReleaseEvent(ev); } //pass it along to the widget
+	  else{ QTreeView::mouseReleaseEvent(ev); } //pass it along to the widget
 	}
 	void mousePressEvent(QMouseEvent *ev){
 	  if(ev->button() != Qt::RightButton && ev->button() != Qt::LeftButton){ ev->ignore(); }
-	  else{ QTreeWidget::mousePressEvent(ev); } //pass it along to the widget	  
+	  else{ QTreeView::mousePressEvent(ev); } //pass it along to the widget	  
 	}
 	/*void mouseMoveEvent(QMouseEvent *ev){
 	  if(ev->button() != Qt::RightButton && ev->button() != Qt::LeftButton){ ev->ignore(); }
-	  else{ QTreeWidget::mouseMoveEvent(ev); } //pass it along to the widget		
+	  else{ QTreeView::mouseMoveEvent(ev); } //pass it along to the widget		
 	}*/
 };
 
-/*
- * Virtual class for managing the sort of folders/files items. The problem with base class is that it only manages texts fields and
- * we have dates and sizes.
- *
- * On this class, we overwrite the function operator<.
- */
-
-class CQTreeWidgetItem : public QTreeWidgetItem {
-public:
-    CQTreeWidgetItem(int type = Type) : QTreeWidgetItem(type) {}
-    CQTreeWidgetItem(const QStringList & strings, int type = Type) : QTreeWidgetItem(strings, type) {}
-    CQTreeWidgetItem(QTreeWidget * parent, int type = Type) : QTreeWidgetItem(parent, type) {}
-    CQTreeWidgetItem(QTreeWidget * parent, const QStringList & strings, int type = Type) : QTreeWidgetItem(parent, strings, type) {}
-    CQTreeWidgetItem(QTreeWidget * parent, QTreeWidgetItem * preceding, int type = Type) : QTreeWidgetItem(parent, preceding, type) {}
-    CQTreeWidgetItem(QTreeWidgetItem * parent, int type = Type) : QTreeWidgetItem(parent, type) {}
-    CQTreeWidgetItem(QTreeWidgetItem * parent, const QStringList & strings, int type = Type) : QTreeWidgetItem(parent, strings, type) {}
-    CQTreeWidgetItem(QTreeWidgetItem * parent, QTreeWidgetItem * preceding, int type = Type) : QTreeWidgetItem(parent, preceding, type) {}
-    virtual ~CQTreeWidgetItem() {}
-    inline virtual bool operator<(const QTreeWidgetItem &tmp) const {
-      int column = this->treeWidget()->sortColumn();
-      // We are in date text
-      if(column == 3 || column == 4){
-        return this->whatsThis(column) < tmp.whatsThis(column);
-      // We are in size text
-      }else if(column == 1) {
-        QString text = this->text(column);
-        QString text_tmp = tmp.text(column);
-        double filesize, filesize_tmp;
-        // On folders, text is empty so we check for that
-        // In case we are in folders, we put -1 for differentiate of regular files with 0 bytes.
-        // Doing so, all folders we'll be together instead of mixing with files with 0 bytes.
-        if(text.isEmpty())
-          filesize = -1;
-        else
-          filesize = LUtils::DisplaySizeToBytes(text);
-        if(text_tmp.isEmpty())
-          filesize_tmp = -1;
-        else
-          filesize_tmp = LUtils::DisplaySizeToBytes(text_tmp);
-        return filesize < filesize_tmp;
-
-      //Name column - still sort by type too (folders first)
-      }else if(column == 0 && (this->text(2).isEmpty() || tmp.text(2).isEmpty()) ){
-        if(this->text(2) != tmp.text(2)){ return this->text(2).isEmpty(); }
-      }
-      // In other cases, we trust base class implementation
-      return QTreeWidgetItem::operator<(tmp);
-    }
-};
-
-//Item override for sorting purposes of list widget items
-class CQListWidgetItem : public QListWidgetItem {
-public:
-    CQListWidgetItem(const QIcon &icon, const QString &text, QListWidget *parent = Q_NULLPTR) : QListWidgetItem(icon,text,parent) {}
-    virtual ~CQListWidgetItem() {}
-    inline virtual bool operator<(const QListWidgetItem &tmp) const {
-	QString type = this->data(Qt::UserRole).toString();
-	QString tmptype = tmp.data(Qt::UserRole).toString();
-      //Sort by type first
-	if(type!=tmptype){ return (QString::compare(type,tmptype)<0); }
-      //Then sort by name using the normal rules
-      return QListWidgetItem::operator<(tmp);
-    }
-};
-
 #endif
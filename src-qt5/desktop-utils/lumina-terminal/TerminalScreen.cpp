@@ -0,0 +1,732 @@
+//===========================================
+//  Lumina-DE source code
+//  Copyright (c) 2016, Ken Moore
+//  Available under the 3-clause BSD license
+//  See the LICENSE file for full details
+//===========================================
+#include "TerminalScreen.h"
+
+#include <QTextCodec>
+#include <QDebug>
+
+#define DEBUG 0
+
+//Parser states
+#define ST_GROUND 0
+#define ST_ESCAPE 1
+#define ST_ESCAPE_INTER 2
+#define ST_CSI 3
+#define ST_STRING 4 //OSC/DCS/PM/APC - skipped until the terminator
+#define MAX_PARAMS 32
+#define TAB_WIDTH 8
+
+//DEC special graphics (line drawing) characters for 0x5F -> 0x7E
+static const ushort GFX_CHARS[32] = {
+  0x0020, 0x25C6, 0x2592, 0x2409, 0x240C, 0x240D, 0x240A, 0x00B0,
+  0x00B1, 0x2424, 0x240B, 0x2518, 0x2510, 0x250C, 0x2514, 0x253C,
+  0x23BA, 0x23BB, 0x2500, 0x23BC, 0x23BD, 0x251C, 0x2524, 0x2534,
+  0x252C, 0x2502, 0x2264, 0x2265, 0x03C0, 0x2260, 0x00A3, 0x00B7
+};
+
+//East Asian Wide/Fullwidth characters and emoji (two cells each)
+static const uint WIDE_CHARS[][2] = {
+  {0x1100, 0x115F}, {0x2329, 0x232A}, {0x2E80, 0x303E}, {0x3041, 0x33FF},
+  {0x3400, 0x4DBF}, {0x4E00, 0x9FFF}, {0xA000, 0xA4CF}, {0xA960, 0xA97F},
+  {0xAC00, 0xD7A3}, {0xF900, 0xFAFF}, {0xFE10, 0xFE19}, {0xFE30, 0xFE6F},
+  {0xFF00, 0xFF60}, {0xFFE0, 0xFFE6}, {0x1F300, 0x1F64F}, {0x1F900, 0x1F9FF},
+  {0x20000, 0x2FFFD}, {0x30000, 0x3FFFD}
+};
+
+//Number of cells used by a character (0: combines with the previous one)
+static int charWidth(uint ch){
+  if(ch<0x300){ return 1; } //latin - nothing special
+  QChar::Category cat = QChar::category(ch);
+  if(cat==QChar::Mark_NonSpacing || cat==QChar::Mark_Enclosing || (cat==QChar::Other_Format && ch!=0x00AD) ){ return 0; }
+  if(ch<0x1100){ return 1; }
+  for(uint i=0; i<sizeof(WIDE_CHARS)/sizeof(WIDE_CHARS[0]); i++){
+    if(ch<WIDE_CHARS[i][0]){ break; } //sorted list
+    if(ch<=WIDE_CHARS[i][1]){ return 2; }
+  }
+  return 1;
+}
+
+TerminalScreen::TerminalScreen(int cols, int rows, int maxhistory){
+  decoder = QTextCodec::codecForName("UTF-8")->makeDecoder();
+  histmax = (maxhistory<0) ? 0 : maxhistory;
+  histstart = histcount = 0;
+  ncols = (cols<1) ? 1 : cols;
+  nrows = (rows<1) ? 1 : rows;
+  reset();
+}
+
+TerminalScreen::~TerminalScreen(){
+  delete decoder;
+}
+
+void TerminalScreen::resize(int cols, int rows){
+  if(cols<1){ cols = 1; }
+  if(rows<1){ rows = 1; }
+  if(cols==ncols && rows==nrows){ return; }
+  resizeLines(screen, cols, rows, cy, !altscreen);
+  if(altscreen){ resizeLines(mainscreen, cols, rows, saved.y, true); }
+  ncols = cols;
+  nrows = rows;
+  top = 0; bottom = nrows-1;
+  if(cx>=ncols){ cx = ncols-1; }
+  if(saved.x>=ncols){ saved.x = ncols-1; }
+  wrapnext = false;
+  dirty.resize(nrows);
+  dirty.fill(true);
+}
+
+void TerminalScreen::parse(const QByteArray &data){
+  //The decoder keeps any partial UTF-8 sequence for the next chunk
+  //Note: Work on code points (characters outside the BMP are two QChars)
+  QVector<uint> text = decoder->toUnicode(data).toUcs4();
+  const uint *str = text.constData();
+  int len = text.size();
+  for(int i=0; i<len; i++){
+    uint ch = str[i];
+    switch(state){
+      case ST_GROUND:
+	if(ch>=0x20 && ch!=0x7F){ print(ch); }
+	else{ control(ch); }
+	break;
+      case ST_ESCAPE:
+	if(ch<0x20 && ch!=0x1B){ control(ch); }
+	else{ escape(ch); }
+	break;
+      case ST_ESCAPE_INTER:
+	if(ch<0x20){ control(ch); }
+	else if(ch>=0x30){
+	  //Character set selection (only the line drawing set is special)
+	  if(inter=='('){ gfxset[0] = (ch=='0'); }
+	  else if(inter==')'){ gfxset[1] = (ch=='0'); }
+	  state = ST_GROUND;
+	}
+	break;
+      case ST_CSI:
+	if(ch<0x20 && ch!=0x1B){ control(ch); }
+	else{ csi(ch); }
+	break;
+      case ST_STRING:
+	if(ch==0x07 || ch==0x9C || (stresc && ch=='\\') ){ state = ST_GROUND; }
+	else if(stresc){ state = ST_ESCAPE; escape(ch); } //not a terminator - new escape code
+	stresc = (state==ST_STRING && ch==0x1B);
+	break;
+    }
+  }
+}
+
+void TerminalScreen::reset(){
+  pen.ch = ' '; pen.attr = 0; pen.fg = TERM_DEFAULT_FG; pen.bg = TERM_DEFAULT_BG;
+  cx = cy = 0;
+  top = 0; bottom = nrows-1;
+  wrapnext = insertmode = newlinemode = originmode = appcursor = appkeypad = altscreen = false;
+  autowrap = showcursor = true;
+  gfxset[0] = gfxset[1] = false;
+  charset = 0;
+  state = ST_GROUND;
+  params.clear();
+  curparam = -1;
+  priv = inter = 0;
+  stresc = false;
+  mainscreen.clear();
+  screen = QVector<TermLine>(nrows, blankLine());
+  saveCursor();
+  dirty.resize(nrows);
+  dirty.fill(true);
+}
+
+const TermLine& TerminalScreen::line(int num){
+  static TermLine empty;
+  if(num<0 || num>=histcount+nrows){ return empty; }
+  if(num<histcount){ return history.at( (histstart+num) % histmax ); }
+  return screen.at(num-histcount);
+}
+
+QBitArray TerminalScreen::takeDirty(){
+  QBitArray out = dirty;
+  dirty.fill(false);
+  return out;
+}
+
+QByteArray TerminalScreen::takeReplies(){
+  QByteArray out = replies;
+  replies.clear();
+  return out;
+}
+
+// === PRIVATE ===
+void TerminalScreen::control(uint ch){
+  switch(ch){
+    case 0x08: //Backspace
+      if(cx>0){ cx--; }
+      wrapnext = false;
+      break;
+    case 0x09: //Tab
+      cx = qMin(ncols-1, (cx/TAB_WIDTH+1)*TAB_WIDTH);
+      wrapnext = false;
+      break;
+    case 0x0A: //Line Feed (also Vertical Tab / Form Feed)
+    case 0x0B:
+    case 0x0C:
+      lineFeed();
+      if(newlinemode){ cx = 0; }
+      break;
+    case 0x0D: //Carriage Return
+      cx = 0;
+      wrapnext = false;
+      break;
+    case 0x0E: //Shift Out (G1)
+      charset = 1;
+      break;
+    case 0x0F: //Shift In (G0)
+      charset = 0;
+      break;
+    case 0x18: //Cancel current code
+    case 0x1A:
+      state = ST_GROUND;
+      break;
+    case 0x1B:
+      state = ST_ESCAPE;
+      inter = 0;
+      break;
+    //BEL and anything else is ignored
+  }
+}
+
+void TerminalScreen::escape(uint ch){
+  state = ST_GROUND;
+  switch(ch){
+    case 0x1B:
+      state = ST_ESCAPE; //restart
+      break;
+    case '[':
+      state = ST_CSI;
+      params.clear();
+      curparam = -1;
+      priv = inter = 0;
+      break;
+    case ']': //OSC (window title, etc)
+    case 'P': //DCS
+    case 'X':
+    case '^':
+    case '_':
+      state = ST_STRING;
+      stresc = false;
+      break;
+    case '(':
+    case ')':
+    case '*':
+    case '+':
+    case '#':
+    case '%':
+    case ' ':
+      inter = ch;
+      state = ST_ESCAPE_INTER;
+      break;
+    case '7':
+      saveCursor();
+      break;
+    case '8':
+      restoreCursor();
+      break;
+    case 'D': //Index
+      lineFeed();
+      break;
+    case 'E': //Next Line
+      cx = 0;
+      lineFeed();
+      break;
+    case 'M': //Reverse Index
+      reverseIndex();
+      break;
+    case 'c': //Full Reset
+      reset();
+      break;
+    case '=':
+      appkeypad = true;
+      break;
+    case '>':
+      appkeypad = false;
+      break;
+    default:
+      if(DEBUG){ qDebug() << "Unhandled Escape Code:" << QChar(ch); }
+  }
+}
+
+void TerminalScreen::csi(uint ch){
+  if(ch>='0' && ch<='9'){
+    if(curparam<0){ curparam = 0; }
+    if(curparam<100000){ curparam = curparam*10 + (ch-'0'); }
+  }else if(ch==';' || ch==':'){
+    if(params.size()<MAX_PARAMS){ params << qMax(curparam,0); }
+    curparam = -1;
+  }else if(ch>=0x3C && ch<=0x3F){
+    priv = ch; //private mode prefix ("?", ">", etc)
+  }else if(ch>=0x20 && ch<=0x2F){
+    inter = ch;
+  }else if(ch>=0x40 && ch<=0x7E){
+    if(curparam>=0 || !params.isEmpty()){ params << qMax(curparam,0); }
+    state = ST_GROUND;
+    csiDispatch(ch);
+  }else if(ch==0x1B){
+    state = ST_ESCAPE;
+  }
+}
+
+void TerminalScreen::csiDispatch(ushort final){
+  if(inter!=0){ return; } //no supported codes use intermediate characters
+  int num = param(0,1);
+  if(priv=='?'){
+    if(final=='h' || final=='l'){
+      for(int i=0; i<params.size(); i++){ setMode(1000000+params[i], final=='h'); }
+    }
+    return;
+  }else if(priv=='>'){
+    if(final=='c'){ replies.append("\x1b[>1;10;0c"); } //secondary device attributes
+    return;
+  }else if(priv!=0){
+    return;
+  }
+  switch(final){
+    case '@': //ICH - Insert Characters
+      insertChars(num);
+      break;
+    case 'A': //CUU - Cursor Up
+      moveCursor(cx, qMax(cy<top ? 0 : top, cy-num));
+      break;
+    case 'B': //CUD - Cursor Down
+    case 'e':
+      moveCursor(cx, qMin(cy>bottom ? nrows-1 : bottom, cy+num));
+      break;
+    case 'C': //CUF - Cursor Forward
+    case 'a':
+      moveCursor(cx+num, cy);
+      break;
+    case 'D': //CUB - Cursor Back
+      moveCursor(cx-num, cy);
+      break;
+    case 'E': //CNL - Next Line
+      moveCursor(0, qMin(cy>bottom ? nrows-1 : bottom, cy+num));
+      break;
+    case 'F': //CPL - Previous Line
+      moveCursor(0, qMax(cy<top ? 0 : top, cy-num));
+      break;
+    case 'G': //CHA - Column
+    case '`':
+      moveCursor(num-1, cy);
+      break;
+    case 'H': //CUP - Position (row;column)
+    case 'f':
+      moveCursor(param(1,1)-1, param(0,1)-1 + (originmode ? top : 0));
+      break;
+    case 'd': //VPA - Row
+      moveCursor(cx, num-1 + (originmode ? top : 0));
+      break;
+    case 'J': //ED - Erase Display
+      eraseDisplay(param(0,0));
+      break;
+    case 'K': //EL - Erase Line
+      eraseLine(param(0,0));
+      break;
+    case 'L': //IL - Insert Lines
+      insertLines(num);
+      break;
+    case 'M': //DL - Delete Lines
+      deleteLines(num);
+      break;
+    case 'P': //DCH - Delete Characters
+      deleteChars(num);
+      break;
+    case 'S': //SU - Scroll Up
+      scrollUp(num);
+      break;
+    case 'T': //SD - Scroll Down
+      scrollDown(num);
+      break;
+    case 'X': //ECH - Erase Characters
+      fillCells(cy, cx, qMin(ncols, cx+num));
+      wrapnext = false;
+      break;
+    case 'Z': //CBT - Back Tab
+      for(int i=0; i<num && cx>0; i++){ cx = ((cx-1)/TAB_WIDTH)*TAB_WIDTH; }
+      wrapnext = false;
+      break;
+    case 'c': //DA - Device Attributes
+      if(param(0,0)==0){ replies.append("\x1b[?62;22c"); } //VT220 with color
+      break;
+    case 'n': //DSR - Device Status Report
+      if(num==5){ replies.append("\x1b[0n"); } //terminal ok
+      else if(num==6){ replies.append( QString("\x1b[%1;%2R").arg(QString::number(cy+1 - (originmode ? top : 0)), QString::number(cx+1)).toLatin1() ); }
+      break;
+    case 'm': //SGR - Graphics Rendition
+      sgr();
+      break;
+    case 'r': //DECSTBM - Scrolling Region
+      {
+      int t = param(0,1)-1;
+      int b = param(1,nrows)-1;
+      if(b>=nrows){ b = nrows-1; }
+      if(t<b){ top = t; bottom = b; }
+      else{ top = 0; bottom = nrows-1; }
+      moveCursor(0, originmode ? top : 0);
+      }
+      break;
+    case 's':
+      saveCursor();
+      break;
+    case 'u':
+      restoreCursor();
+      break;
+    case 'h':
+    case 'l':
+      for(int i=0; i<params.size(); i++){ setMode(params[i], final=='h'); }
+      break;
+    default:
+      if(DEBUG){ qDebug() << "Unhandled Control Code:" << QChar(final) << params; }
+  }
+}
+
+void TerminalScreen::setMode(int mode, bool on){
+  //Note: private ("?") modes are offset by 1000000
+  switch(mode){
+    case 4: //IRM - Insert Mode
+      insertmode = on;
+      break;
+    case 20: //LNM - New Line Mode
+      newlinemode = on;
+      break;
+    case 1000001: //DECCKM - Application Cursor Keys
+      appcursor = on;
+      break;
+    case 1000006: //DECOM - Origin Mode
+      originmode = on;
+      moveCursor(0, originmode ? top : 0);
+      break;
+    case 1000007: //DECAWM - Auto Wrap
+      autowrap = on;
+      wrapnext = false;
+      break;
+    case 1000025: //DECTCEM - Show Cursor
+      showcursor = on;
+      setDirty(cy, cy);
+      break;
+    case 1000047: //Alternate Screen
+    case 1001047:
+      setAltScreen(on);
+      break;
+    case 1001048: //Save/Restore Cursor
+      if(on){ saveCursor(); }
+      else{ restoreCursor(); }
+      break;
+    case 1001049: //Alternate Screen (with save/restore of the cursor)
+      if(on){ saveCursor(); setAltScreen(true); }
+      else{ setAltScreen(false); restoreCursor(); }
+      break;
+    default:
+      if(DEBUG){ qDebug() << "Unhandled Mode:" << mode << on; }
+  }
+}
+
+void TerminalScreen::sgr(){
+  if(params.isEmpty()){ params << 0; }
+  for(int i=0; i<params.size(); i++){
+    int code = params[i];
+    if(code==0){ pen.attr = 0; pen.fg = TERM_DEFAULT_FG; pen.bg = TERM_DEFAULT_BG; }
+    else if(code==1){ pen.attr |= TERM_BOLD; }
+    else if(code==2){ pen.attr |= TERM_FAINT; }
+    else if(code==3){ pen.attr |= TERM_ITALIC; }
+    else if(code==4 || code==21){ pen.attr |= TERM_UNDERLINE; }
+    //5-6: Blink text (unsupported)
+    else if(code==7){ pen.attr |= TERM_REVERSE; }
+    else if(code==8){ pen.attr |= TERM_CONCEAL; }
+    else if(code==9){ pen.attr |= TERM_STRIKE; }
+    else if(code==22){ pen.attr &= ~(TERM_BOLD | TERM_FAINT); }
+    else if(code==23){ pen.attr &= ~TERM_ITALIC; }
+    else if(code==24){ pen.attr &= ~TERM_UNDERLINE; }
+    else if(code==27){ pen.attr &= ~TERM_REVERSE; }
+    else if(code==28){ pen.attr &= ~TERM_CONCEAL; }
+    else if(code==29){ pen.attr &= ~TERM_STRIKE; }
+    else if(code>=30 && code<=37){ pen.fg = code-30; }
+    else if(code==39){ pen.fg = TERM_DEFAULT_FG; }
+    else if(code>=40 && code<=47){ pen.bg = code-40; }
+    else if(code==49){ pen.bg = TERM_DEFAULT_BG; }
+    else if(code==53){ pen.attr |= TERM_OVERLINE; }
+    else if(code==55){ pen.attr &= ~TERM_OVERLINE; }
+    else if(code>=90 && code<=97){ pen.fg = code-90+8; } //bright colors
+    else if(code>=100 && code<=107){ pen.bg = code-100+8; }
+    else if(code==38 || code==48){
+      //Extended colors: "5;<index>" or "2;<r>;<g>;<b>"
+      quint32 color = 0;
+      bool ok = false;
+      if(i+2<params.size() && params[i+1]==5){
+        color = qMin(params[i+2],255);
+        ok = true;
+        i+=2;
+      }else if(i+4<params.size() && params[i+1]==2){
+        color = TERM_RGB | (qMin(params[i+2],255)<<16) | (qMin(params[i+3],255)<<8) | qMin(params[i+4],255);
+        ok = true;
+        i+=4;
+      }else{
+        i = params.size(); //invalid - skip the rest
+      }
+      if(ok && code==38){ pen.fg = color; }
+      else if(ok){ pen.bg = color; }
+    }
+    else if(DEBUG){ qDebug() << "Unknown Color Code:" << code; }
+  }
+}
+
+int TerminalScreen::param(int num, int def){
+  if(num>=params.size() || params[num]<=0){ return def; }
+  return params[num];
+}
+
+// === Screen changes ===
+void TerminalScreen::print(uint ch){
+  if(gfxset[charset] && ch>=0x5F && ch<=0x7E){ ch = GFX_CHARS[ch-0x5F]; }
+  int width = charWidth(ch);
+  if(width==0){ combine(ch); return; }
+  if(width>ncols){ width = 1; } //no room for both halves
+  if(wrapnext){
+    cx = 0;
+    lineFeed();
+  }
+  if(width==2 && cx==ncols-1){
+    //Both halves need to be on the same line
+    if(autowrap){
+      fillCells(cy, cx, ncols);
+      cx = 0;
+      lineFeed();
+    }else{
+      cx--;
+    }
+  }
+  if(insertmode){ insertChars(width); }
+  TermLine &line = screen[cy];
+  //Do not leave half of an overwritten wide character behind
+  if(line[cx].ch==0 && cx>0){ line[cx-1].ch = ' '; }
+  if(cx+width<ncols && line[cx+width].ch==0){ line[cx+width].ch = ' '; }
+  line[cx] = pen;
+  line[cx].ch = ch;
+  if(width==2){
+    line[cx+1] = pen;
+    line[cx+1].ch = 0;
+  }
+  dirty.setBit(cy);
+  if(cx+width < ncols){ cx += width; }
+  else{
+    cx = ncols-1;
+    if(autowrap){ wrapnext = true; } //wrap when the next character comes in
+  }
+}
+
+void TerminalScreen::combine(uint ch){
+  //Find the last character printed (left of the cursor, or under it when waiting to wrap)
+  int col = wrapnext ? cx : cx-1;
+  if(col>=0 && screen[cy][col].ch==0){ col--; }
+  if(col<0){ return; }
+  TermCell &cell = screen[cy][col];
+  //Use the composed form if there is one (the cells only hold one code point)
+  uint chars[2] = {cell.ch, ch};
+  QVector<uint> comp = QString::fromUcs4(chars, 2).normalized(QString::NormalizationForm_C).toUcs4();
+  if(comp.size()==1){
+    cell.ch = comp[0];
+    dirty.setBit(cy);
+  }
+}
+
+void TerminalScreen::lineFeed(){
+  wrapnext = false;
+  if(cy==bottom){ scrollUp(1); }
+  else if(cy<nrows-1){ cy++; }
+}
+
+void TerminalScreen::reverseIndex(){
+  wrapnext = false;
+  if(cy==top){ scrollDown(1); }
+  else if(cy>0){ cy--; }
+}
+
+void TerminalScreen::scrollUp(int num){
+  num = qMin(num, bottom-top+1);
+  if(num<1){ return; }
+  //Lines going off the top of the main screen are kept in the history
+  if(top==0 && !altscreen){
+    for(int i=0; i<num; i++){ pushHistory(screen[i]); }
+  }
+  screen.remove(top, num);
+  screen.insert(bottom-num+1, num, blankLine());
+  setDirty(top, bottom);
+}
+
+void TerminalScreen::scrollDown(int num){
+  num = qMin(num, bottom-top+1);
+  if(num<1){ return; }
+  screen.remove(bottom-num+1, num);
+  screen.insert(top, num, blankLine());
+  setDirty(top, bottom);
+}
+
+void TerminalScreen::insertLines(int num){
+  if(cy<top || cy>bottom){ return; }
+  num = qMin(num, bottom-cy+1);
+  screen.remove(bottom-num+1, num);
+  screen.insert(cy, num, blankLine());
+  setDirty(cy, bottom);
+  cx = 0;
+  wrapnext = false;
+}
+
+void TerminalScreen::deleteLines(int num){
+  if(cy<top || cy>bottom){ return; }
+  num = qMin(num, bottom-cy+1);
+  screen.remove(cy, num);
+  screen.insert(bottom-num+1, num, blankLine());
+  setDirty(cy, bottom);
+  cx = 0;
+  wrapnext = false;
+}
+
+void TerminalScreen::insertChars(int num){
+  num = qMin(num, ncols-cx);
+  TermLine &row = screen[cy];
+  for(int i=ncols-1; i>=cx+num; i--){ row[i] = row[i-num]; }
+  fillCells(cy, cx, cx+num);
+  wrapnext = false;
+}
+
+void TerminalScreen::deleteChars(int num){
+  num = qMin(num, ncols-cx);
+  TermLine &row = screen[cy];
+  for(int i=cx; i<ncols-num; i++){ row[i] = row[i+num]; }
+  fillCells(cy, ncols-num, ncols);
+  wrapnext = false;
+}
+
+void TerminalScreen::eraseDisplay(int mode){
+  if(mode==0){
+    //Cursor to the end of the screen
+    fillCells(cy, cx, ncols);
+    for(int i=cy+1; i<nrows; i++){ fillCells(i, 0, ncols); }
+  }else if(mode==1){
+    //Start of the screen to the cursor
+    for(int i=0; i<cy; i++){ fillCells(i, 0, ncols); }
+    fillCells(cy, 0, cx+1);
+  }else if(mode==2){
+    for(int i=0; i<nrows; i++){ fillCells(i, 0, ncols); }
+  }else if(mode==3){
+    //Clear the history (xterm)
+    history.clear();
+    histstart = histcount = 0;
+    setDirty(0, nrows-1);
+  }
+  wrapnext = false;
+}
+
+void TerminalScreen::eraseLine(int mode){
+  if(mode==0){ fillCells(cy, cx, ncols); }
+  else if(mode==1){ fillCells(cy, 0, cx+1); }
+  else if(mode==2){ fillCells(cy, 0, ncols); }
+  wrapnext = false;
+}
+
+void TerminalScreen::fillCells(int row, int from, int to){
+  if(from>=to){ return; }
+  TermCell cell = blankCell();
+  TermLine &line = screen[row];
+  for(int i=from; i<to; i++){ line[i] = cell; }
+  dirty.setBit(row);
+}
+
+void TerminalScreen::moveCursor(int x, int y){
+  cx = qBound(0, x, ncols-1);
+  cy = qBound(0, y, nrows-1);
+  wrapnext = false;
+}
+
+void TerminalScreen::saveCursor(){
+  saved.x = cx;
+  saved.y = cy;
+  saved.pen = pen;
+  saved.origin = originmode;
+  saved.gfx0 = gfxset[0];
+  saved.gfx1 = gfxset[1];
+  saved.charset = charset;
+}
+
+void TerminalScreen::restoreCursor(){
+  pen = saved.pen;
+  originmode = saved.origin;
+  gfxset[0] = saved.gfx0;
+  gfxset[1] = saved.gfx1;
+  charset = saved.charset;
+  moveCursor(saved.x, saved.y);
+}
+
+void TerminalScreen::setAltScreen(bool on){
+  if(on==altscreen){ return; }
+  if(on){
+    mainscreen = screen;
+    screen = QVector<TermLine>(nrows, blankLine());
+  }else{
+    screen = mainscreen;
+    mainscreen.clear();
+  }
+  altscreen = on;
+  setDirty(0, nrows-1);
+}
+
+void TerminalScreen::pushHistory(const TermLine &line){
+  if(histmax<1){ return; }
+  if(history.size()<histmax){
+    //Still filling up the buffer
+    history << line;
+    histcount++;
+  }else{
+    //Full - overwrite the oldest line
+    history[histstart] = line;
+    histstart = (histstart+1) % histmax;
+  }
+}
+
+void TerminalScreen::resizeLines(QVector<TermLine> &lines, int cols, int rows, int &crow, bool keep){
+  //Make sure the cursor row stays on the screen (move the top lines into the history)
+  int extra = crow - (rows-1);
+  if(extra>0){
+    for(int i=0; i<extra && keep; i++){ pushHistory(lines[i]); }
+    lines.remove(0, extra);
+    crow -= extra;
+  }
+  if(lines.size()>rows){ lines.resize(rows); }
+  TermCell cell; cell.ch = ' '; cell.attr = 0; cell.fg = TERM_DEFAULT_FG; cell.bg = TERM_DEFAULT_BG;
+  for(int i=0; i<lines.size(); i++){
+    int oldcols = lines[i].size();
+    if(oldcols!=cols){
+      lines[i].resize(cols);
+      for(int c=oldcols; c<cols; c++){ lines[i][c] = cell; }
+    }
+  }
+  if(lines.size()<rows){ lines.insert(lines.size(), rows-lines.size(), TermLine(cols, cell)); }
+  if(crow<0){ crow = 0; }
+}
+
+void TerminalScreen::setDirty(int from, int to){
+  for(int i=from; i<=to && i<dirty.size(); i++){ dirty.setBit(i); }
+}
+
+TermCell TerminalScreen::blankCell(){
+  //Erased cells use the current background color
+  TermCell cell;
+  cell.ch = ' ';
+  cell.attr = 0;
+  cell.fg = TERM_DEFAULT_FG;
+  cell.bg = pen.bg;
+  return cell;
+}
+
+TermLine TerminalScreen::blankLine(){
+  return TermLine(ncols, blankCell());
+}
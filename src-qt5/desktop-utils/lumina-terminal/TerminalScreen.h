@@ -0,0 +1,126 @@
+//===========================================
+//  Lumina-DE source code
+//  Copyright (c) 2016, Ken Moore
+//  Available under the 3-clause BSD license
+//  See the LICENSE file for full details
+//===========================================
+//  This is the screen model for the terminal: a grid of character cells plus a
+//    ring buffer of the lines which were scrolled off the top (history)
+//  The TTY output is run through a VT100/VT220 state machine, so the data can be
+//    given to it in chunks of any size (codes may be split between chunks)
+//  NOTE: Only the rows which were changed get flagged for a repaint
+//===========================================
+#ifndef _LUMINA_DESKTOP_UTILITIES_TERMINAL_SCREEN_H
+#define _LUMINA_DESKTOP_UTILITIES_TERMINAL_SCREEN_H
+
+#include <QString>
+#include <QByteArray>
+#include <QVector>
+#include <QBitArray>
+#include <QPoint>
+#include <QTextDecoder>
+
+//Colors: anything below 256 is an index in the xterm color table
+#define TERM_DEFAULT_FG 0x100
+#define TERM_DEFAULT_BG 0x101
+#define TERM_RGB 0x1000000 //flag for a direct color (0xRRGGBB in the lower bits)
+
+//Cell attributes
+#define TERM_BOLD 0x01
+#define TERM_FAINT 0x02
+#define TERM_ITALIC 0x04
+#define TERM_UNDERLINE 0x08
+#define TERM_REVERSE 0x10
+#define TERM_CONCEAL 0x20
+#define TERM_STRIKE 0x40
+#define TERM_OVERLINE 0x80
+
+//Note: A wide (CJK) character uses two cells - the second one has a "ch" of 0
+struct TermCell{
+	uint ch; //unicode code point
+	quint8 attr;
+	quint32 fg, bg;
+};
+typedef QVector<TermCell> TermLine;
+
+class TerminalScreen{
+public:
+	TerminalScreen(int cols = 80, int rows = 24, int maxhistory = 10000);
+	~TerminalScreen();
+
+	void resize(int cols, int rows);
+	void parse(const QByteArray &data); //output from the TTY
+	void reset();
+
+	//Screen information
+	int columns(){ return ncols; }
+	int rows(){ return nrows; }
+	int historyCount(){ return histcount; }
+	const TermLine& line(int num); //history lines first, then the rows of the screen
+	QPoint cursor(){ return QPoint(cx, cy); } //position on the screen (not including history)
+	bool cursorVisible(){ return showcursor; }
+	bool appCursorKeys(){ return appcursor; }
+	bool appKeypad(){ return appkeypad; }
+
+	QBitArray takeDirty(); //rows which changed since the last call
+	QByteArray takeReplies(); //answers to terminal queries (need to be written back to the TTY)
+
+private:
+	QVector<TermLine> screen, mainscreen; //mainscreen: saved while the alternate screen is used
+	QVector<TermLine> history;
+	int histstart, histcount, histmax;
+	QBitArray dirty;
+	QByteArray replies;
+	QTextDecoder *decoder;
+	int ncols, nrows;
+
+	//Cursor and modes
+	int cx, cy, top, bottom; //cursor position, scrolling region
+	TermCell pen; //attributes for new characters
+	bool wrapnext, autowrap, insertmode, newlinemode, originmode, showcursor, appcursor, appkeypad, altscreen;
+	bool gfxset[2]; //G0/G1 set to the DEC line drawing characters
+	int charset; //active set (G0/G1)
+	struct SavedCursor{ int x, y; TermCell pen; bool origin, gfx0, gfx1; int charset; } saved;
+
+	//Parser state
+	int state;
+	QVector<int> params;
+	int curparam;
+	ushort priv, inter;
+	bool stresc; //ESC inside an OSC/string (start of the terminator)
+
+	void control(uint ch);
+	void escape(uint ch);
+	void csi(uint ch);
+	void csiDispatch(ushort final);
+	void setMode(int mode, bool on);
+	void sgr();
+	int param(int num, int def);
+
+	//Screen changes
+	void print(uint ch);
+	void combine(uint ch); //zero-width character: merge it into the last one printed
+	void lineFeed();
+	void reverseIndex();
+	void scrollUp(int num);
+	void scrollDown(int num);
+	void insertLines(int num);
+	void deleteLines(int num);
+	void insertChars(int num);
+	void deleteChars(int num);
+	void eraseDisplay(int mode);
+	void eraseLine(int mode);
+	void fillCells(int row, int from, int to);
+	void moveCursor(int x, int y);
+	void saveCursor();
+	void restoreCursor();
+	void setAltScreen(bool on);
+	void pushHistory(const TermLine &line);
+	void resizeLines(QVector<TermLine> &lines, int cols, int rows, int &crow, bool keep);
+	void setDirty(int from, int to);
+
+	TermCell blankCell();
+	TermLine blankLine();
+};
+
+#endif
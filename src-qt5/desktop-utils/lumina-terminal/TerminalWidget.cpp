@@ -9,52 +9,69 @@
 #include <QProcessEnvironment>
 #include <QDebug>
 #include <QApplication>
-#include <QScrollBar>
-#include <QTextBlock>
+#include <QFontDatabase>
+#include <QBitArray>
+#include <QRegion>
 
 #include <LuminaXDG.h>
 
 #define DEBUG 0
+#define FRAME_MS 16 //~60 repaints per second at most
 
-//Special control code ending symbols (aside from letters)
+//Add the character of a cell to a string (the second half of a wide character has none)
+static void appendCell(QString &text, uint ch){
+  if(ch==0){ return; }
+  if(QChar::requiresSurrogates(ch)){ text.append(QChar(QChar::highSurrogate(ch))); text.append(QChar(QChar::lowSurrogate(ch))); }
+  else{ text.append(QChar(ch)); }
+}
+
+//Start of a wide character (the next cell holds the second half)
+static bool isWide(const TermLine &line, int col){
+  return (line.at(col).ch!=0 && col+1<line.size() && line.at(col+1).ch==0);
+}
 
-TerminalWidget::TerminalWidget(QWidget *parent, QString dir) : QTextEdit(parent){
-  //Setup the text widget
+TerminalWidget::TerminalWidget(QWidget *parent, QString dir) : QWidget(parent){
+  //Setup the widget
   closing = false;
-  QPalette P = this->palette();
-    P.setColor(QPalette::Base, Qt::black);
-    P.setColor(QPalette::Text, Qt::white);
-  this->setPalette(P);
-  this->setLineWrapMode(QTextEdit::WidgetWidth);
-  this->setAcceptRichText(false);
-  this->setOverwriteMode(true);
+  this->setAttribute(Qt::WA_OpaquePaintEvent); //every pixel gets painted
   this->setFocusPolicy(Qt::StrongFocus);
-  this->setTabStopWidth( 8 * this->fontMetrics().width(" ") ); //8 character spaces per tab (UNIX standard)
-  //this->setWordWrapMode(QTextOption::NoWrap);
+  this->setCursor(Qt::IBeamCursor);
   this->setContextMenuPolicy(Qt::CustomContextMenu);
+  selStart = selEnd = QPoint(-1,-1);
+  //xterm color table: 16 standard colors, 6x6x6 color cube, 24 grays
+  static const QRgb basic[16] = { 0x000000, 0xcd0000, 0x00cd00, 0xcdcd00, 0x0000ee, 0xcd00cd, 0x00cdcd, 0xe5e5e5,
+				0x7f7f7f, 0xff0000, 0x00ff00, 0xffff00, 0x5c5cff, 0xff00ff, 0x00ffff, 0xffffff };
+  static const int levels[6] = { 0, 95, 135, 175, 215, 255 };
+  for(int i=0; i<16; i++){ colors << QColor(basic[i]); }
+  for(int i=0; i<216; i++){ colors << QColor(levels[i/36], levels[(i/6)%6], levels[i%6]); }
+  for(int i=0; i<24; i++){ colors << QColor(8+i*10, 8+i*10, 8+i*10); }
+  SCREEN = new TerminalScreen(80, 24);
+  scrollbar = new QScrollBar(Qt::Vertical, this);
+    scrollbar->setRange(0,0);
+    scrollbar->setCursor(Qt::ArrowCursor);
+    connect(scrollbar, SIGNAL(valueChanged(int)), this, SLOT(update()) );
   resizeTimer = new QTimer(this);
     resizeTimer->setInterval(20);
     resizeTimer->setSingleShot(true);
     connect(resizeTimer, SIGNAL(timeout()), this, SLOT(updateTermSize()) );
-  DEFFMT = this->textCursor().charFormat(); //save the default structure for later
-  DEFFMT.setForeground(Qt::white);
-  CFMT = DEFFMT; //current format
-  selCursor = this->textCursor(); //used for keeping track of selections
-  lastCursor = this->textCursor();
-  startrow = endrow = -1;
-  altkeypad = false;
+  paintTimer = new QTimer(this);
+    paintTimer->setInterval(FRAME_MS);
+    paintTimer->setSingleShot(true);
+    connect(paintTimer, SIGNAL(timeout()), this, SLOT(updateView()) );
   QFontDatabase FDB;
   QStringList fonts = FDB.families(QFontDatabase::Latin);
   for(int i=0; i<fonts.length(); i++){
     if(FDB.isFixedPitch(fonts[i]) && FDB.isSmoothlyScalable(fonts[i]) ){ this->setFont(QFont(fonts[i])); qDebug() << "Using Font:" << fonts[i]; break; }
     //if(FDB.isSmoothlyScalable(fonts[i]) ){ this->setFont(QFont(fonts[i])); qDebug() << "Using Font:" << fonts[i]; break; }
   }
+  setupCellSize();
   //Create/open the TTY port
   PROC = new TTYProcess(this);
   //qDebug() << "Open new TTY";
   //int fd;
   bool ok = PROC->startTTY( QProcessEnvironment::systemEnvironment().value("SHELL","/bin/sh"), QStringList(), dir);
   //qDebug() << " - opened:" << ok;
+  if(!ok){ qDebug() << "Could not start TTY"; }
   this->setEnabled(false);
   contextMenu = new QMenu(this);
     copyA = contextMenu->addAction(LXDG::findIcon("edit-copy"), tr("Copy Selection"), this, SLOT(copySelection()) );
@@ -62,404 +79,212 @@ TerminalWidget::TerminalWidget(QWidget *parent, QString dir) : QTextEdit(parent)
   //Connect the signals/slots
   connect(PROC, SIGNAL(readyRead()), this, SLOT(UpdateText()) );
   connect(PROC, SIGNAL(processClosed()), this, SLOT(ShellClosed()) );
-  
+
 }
 
 TerminalWidget::~TerminalWidget(){
   aboutToClose();
+  delete SCREEN;
 }
 
 void TerminalWidget::setTerminalFont(QFont font){
-  
   this->setFont(font);
+  setupCellSize();
+  updateTermSize();
 }
 
 void TerminalWidget::aboutToClose(){
   closing = true;
   if(PROC->isOpen()){ PROC->closeTTY(); } //TTY PORT
-  
+
 }
 
 // ==================
 //          PRIVATE
 // ==================
-void TerminalWidget::InsertText(QString txt){
-  if(txt.isEmpty()){ return; }
-  //qDebug() << "Insert Text:" << txt << "Cursor Pos:" << this->textCursor().position() << "Column:" << this->textCursor().columnNumber();
- QTextCursor cur = this->textCursor();
-    cur.setCharFormat(CFMT);
-  this->setTextCursor(cur); //ensure the current cursor has the proper format
-  this->insertPlainText(txt);
-  /*cur.setPosition( this->textCursor().position(), QTextCursor::KeepAnchor);
-  //cur.setCharFormat(CFMT);
-  //Now make sure the new characters are the right color
-  QList<QTextEdit::ExtraSelection> sels = this->extraSelections();	
-  QTextEdit::ExtraSelection sel;
-  sel.format = CFMT;
-  sel.cursor = cur;
-  sels << sel;
-  this->setExtraSelections(sels);*/
-  if(DEBUG){
-    qDebug() << "Insert Text:"<< txt << "Font Color:" << CFMT.foreground() << "Background Color:" << CFMT.background() << "Font Weight:" << CFMT.fontWeight();
+void TerminalWidget::paintRow(QPainter *P, int row){
+  int lnum = scrollbar->value() + row;
+  const TermLine &line = SCREEN->line(lnum);
+  int cols = qMin(SCREEN->columns(), line.size()); //history lines can be shorter than the screen
+  int y = row*cellH;
+  QPoint cur = SCREEN->cursor();
+  int curcol = -1;
+  if(SCREEN->cursorVisible() && lnum==SCREEN->historyCount()+cur.y()){ curcol = cur.x(); }
+  int col = 0;
+  while(col<cols){
+    //Find the run of cells which are drawn the same way
+    const TermCell &cell = line.at(col);
+    bool sel = isSelected(col, lnum);
+    int end = col+1;
+    if(isWide(line, col)){
+      end = qMin(cols, col+2); //drawn by itself (the font width might not match two cells)
+    }else if(col!=curcol){
+      while(end<cols && end!=curcol && line.at(end).attr==cell.attr && line.at(end).fg==cell.fg
+		&& line.at(end).bg==cell.bg && isSelected(end, lnum)==sel && line.at(end).ch!=0 && !isWide(line, end) ){ end++; }
+    }
+    //Colors
+    quint32 fgval = cell.fg;
+    if( (cell.attr & TERM_BOLD) && fgval<8 ){ fgval += 8; } //bold text uses the bright colors
+    QColor fg = cellColor(fgval);
+    QColor bg = cellColor(cell.bg);
+    bool invert = ( (cell.attr & TERM_REVERSE)!=0 );
+    if(sel){ invert = !invert; }
+    if(curcol>=col && curcol<end){ invert = !invert; } //the cursor might be on the second half of a wide character
+    if(invert){ QColor tmp = fg; fg = bg; bg = tmp; }
+    if(cell.attr & TERM_FAINT){ fg = fg.darker(150); }
+    if(cell.attr & TERM_CONCEAL){ fg = bg; }
+    QRect rect(col*cellW, y, (end-col)*cellW, cellH);
+    if(bg!=cellColor(TERM_DEFAULT_BG) || invert){ P->fillRect(rect, bg); } //default background is already painted
+    //Text
+    QString text;
+      text.reserve(end-col);
+    bool blank = true;
+    for(int i=col; i<end; i++){
+      appendCell(text, line.at(i).ch);
+      if(blank && line.at(i).ch!=' ' && line.at(i).ch!=0){ blank = false; }
+    }
+    if(!blank || (cell.attr & (TERM_UNDERLINE | TERM_STRIKE | TERM_OVERLINE)) ){
+      QFont font = this->font();
+	font.setBold( cell.attr & TERM_BOLD );
+	font.setItalic( cell.attr & TERM_ITALIC );
+	font.setUnderline( cell.attr & TERM_UNDERLINE );
+	font.setStrikeOut( cell.attr & TERM_STRIKE );
+	font.setOverline( cell.attr & TERM_OVERLINE );
+      P->setFont(font);
+      P->setPen(fg);
+      P->drawText(rect.x(), y+cellAscent, text);
+    }
+    col = end;
   }
 }
 
-void TerminalWidget::applyData(QByteArray data){
-  this->setEnabled(true);
-  if(DEBUG){ qDebug() << "Got Data: " << data; }
-  //Make sure the current cursor is the right cursor
-  if(this->textCursor()==selCursor){ this->setTextCursor(lastCursor); }
-  //Iterate through the data and apply it when possible
-  QByteArray chars;
-  //qDebug() << "Data:" << data;
-  for(int i=0; i<data.size(); i++){
-    if( data.at(i)=='\b' ){
-      //Backspace
-      if(!chars.isEmpty()){ chars.chop(1); }
-      else{ 
-        QTextCursor cur = this->textCursor();
-	  cur.movePosition(QTextCursor::Left, QTextCursor::KeepAnchor, 1);
-	  cur.removeSelectedText();
-        this->setTextCursor(cur);
-      }
-
-    //}else if( data.at(i)=='\t' ){
-       //chars.append("  ");
-    }else if( data.at(i)=='\x1B' ){
-      //Flush current text buffer to widget
-      if(!chars.isEmpty()){ InsertText(chars); chars.clear(); }
-      //ANSI Control Code start
-      //Look for the end of the code
-      int end = -1;
-      for(int j=1; j<(data.size()-i) && end<0; j++){
-        if(QChar(data.at(i+j)).isLetter() || (QChar(data.at(i+j)).isSymbol() && data.at(i+j)!=';') ){ end = j; }
-	else if(data.at(i+j)=='\x1B'){ end = j-1; } //start of the next control code
-      }
-      if(end<0){ return; } //skip everything else - no end to code found
-      applyANSI(data.mid(i+1, end));
-      //qDebug() << "Code:" << data.mid(i+1, end) << "Next Char:" << data[i+end+2];
-      i+=end; //move the final loop along - already handled these bytes
-      
-    }else if( data.at(i) == '\r' ){
-	//Move cursor to end of line
-      //qDebug() << "Got a return char";
-      QTextCursor cur = this->textCursor();
-	cur.movePosition(QTextCursor::EndOfLine, QTextCursor::MoveAnchor, 1);
-	cur.removeSelectedText();
-      this->setTextCursor(cur);
-    }else{
-      chars.append(data.at(i)); //Add the character to the buffer
-    }
-  } //end loop over data
-  if(!chars.isEmpty()){ InsertText(chars); }
+QColor TerminalWidget::cellColor(quint32 val){
+  if(val==TERM_DEFAULT_FG){ return QColor(Qt::white); }
+  else if(val==TERM_DEFAULT_BG){ return QColor(Qt::black); }
+  else if(val & TERM_RGB){ return QColor( QRgb(val & 0xFFFFFF) ); }
+  return colors[val & 0xFF];
 }
 
-void TerminalWidget::applyANSI(QByteArray code){
-  //Note: the first byte is often the "[" character
-  //qDebug() << "Handle ANSI:" << code;
-  if(code.length()==1){
-    //KEYPAD MODES
-    if(code.at(0)=='='){ altkeypad = true; }
-    else if(code.at(0)=='>'){ altkeypad = false; }
-    else{
-      qDebug() << "Unhandled ANSI Code:" << code;
-    }
+void TerminalWidget::setupCellSize(){
+  QFontMetrics metrics(this->font());
+  cellW = qMax(1, metrics.width("W"));
+  cellH = qMax(1, metrics.lineSpacing());
+  cellAscent = metrics.ascent();
+}
 
-  }else if(code.startsWith("[") && code.contains("@")){
-    code = code.remove(0, code.indexOf("@")+1);
-    InsertText(code); //insert character (cursor position already accounted for with other systems)
-  }else if(code.startsWith("[")){
-    // VT100 ESCAPE CODES
-  //CURSOR MOVEMENT
-  if( code.endsWith("A") ){ //Move Up
-    int num = 1;
-    if(code.size()>2){ num = code.mid(1, code.size()-2).toInt(); } //everything in the middle
-    QTextCursor cur = this->textCursor();
-    cur.movePosition(QTextCursor::Up, QTextCursor::MoveAnchor, num);
-    this->setTextCursor(cur);
-  }else if(code.endsWith("B")){ //Move Down
-    int num = 1;
-    if(code.size()>2){ num = code.mid(1, code.size()-2).toInt(); } //everything in the middle
-        QTextCursor cur = this->textCursor();
-    cur.movePosition(QTextCursor::Down, QTextCursor::MoveAnchor, num);
-    this->setTextCursor(cur);
-  }else if(code.endsWith("C")){ //Move Forward
-    int num = 1;
-    if(code.size()>2){ num = code.mid(1, code.size()-2).toInt(); } //everything in the middle
-    QTextCursor cur = this->textCursor();
-    cur.movePosition(QTextCursor::Right, QTextCursor::MoveAnchor, num);
-    this->setTextCursor(cur);
-  }else if(code.endsWith("D")){ //Move Back
-    int num = 1;
-    if(code.size()>2){ num = code.mid(1, code.size()-2).toInt(); } //everything in the middle
-    QTextCursor cur = this->textCursor();
-    cur.movePosition(QTextCursor::Left, QTextCursor::MoveAnchor, num);
-    this->setTextCursor(cur);
-  }else if(code.endsWith("E")){ //Move Next/down Lines (go toward end)
-    int num = 1;
-    if(code.size()>2){ num = code.mid(1, code.size()-2).toInt(); } //everything in the middle
-    QTextCursor cur = this->textCursor();
-    cur.movePosition(QTextCursor::NextRow, QTextCursor::MoveAnchor, num);
-    this->setTextCursor(cur);
-  }else if(code.endsWith("F")){ //Move Previous/up Lines (go to beginning)
-    int num = 1;
-    if(code.size()>2){ num = code.mid(1, code.size()-2).toInt(); } //everything in the middle
-    QTextCursor cur = this->textCursor();
-    cur.movePosition(QTextCursor::PreviousRow, QTextCursor::MoveAnchor, num);
-    this->setTextCursor(cur);
-  }else if(code.endsWith("G")){ //Move to specific column
-    int num = 1;
-    if(code.size()>2){ num = code.mid(1, code.size()-2).toInt(); } //everything in the middle
-    QTextCursor cur = this->textCursor();
-    cur.setPosition(num);
-    this->setTextCursor(cur);
-  }else if(code.endsWith("H") || code.endsWith("f") ){ //Move to specific position (row/column)
-    int mid = code.indexOf(";");
-    if(mid>1){
-      int numR, numC; numR = numC = 1;
-      if(mid >=2){ numR = code.mid(1,mid-1).toInt(); }
-      if(mid < code.size()-1){ numC = code.mid(mid+1,code.size()-mid-2).toInt(); }
-      
-      if(startrow>=0 && endrow>=0){
-	if(numR == startrow){ numR = 0;}
-	else if(numR==endrow){ numR = this->document()->lineCount()-1; }
-      }
-      qDebug() << "Set Text Position (absolute):" << "Code:" << code << "Row:" << numR << "Col:" << numC;
-      //qDebug() << " - Current Pos:" << this->textCursor().position() << "Line Count:" << this->document()->lineCount();
-      //if(!this->textCursor().movePosition(QTextCursor::Start, QTextCursor::MoveAnchor,1) ){ qDebug() << "Could not go to start"; }
-      QTextCursor cur(this->textCursor());
-      cur.setPosition(QTextCursor::Start, QTextCursor::MoveAnchor); //go to start of document
-       //qDebug() << " - Pos After Start Move:" << cur.position();
-      if( !cur.movePosition(QTextCursor::Down, QTextCursor::MoveAnchor, numR) ){ qDebug() << "Could not go to row:" << numR; }
-       //qDebug() << " - Pos After Down Move:" << cur.position();
-      if( !cur.movePosition(QTextCursor::Right, QTextCursor::MoveAnchor, numC) ){ qDebug() << "Could not go to col:" << numC; }
-      /*this->textCursor().setPosition( this->document()->findBlockByLineNumber(numR).position() );
-      qDebug() << " - Pos After Row Move:" << this->textCursor().position();
-      if( !this->textCursor().movePosition(QTextCursor::Right, QTextCursor::MoveAnchor, numC) ){ qDebug() << "Could not go to col:" << numC; }*/
-      //qDebug() << " - Ending Pos:" << cur.position();
-      this->setTextCursor(cur);
-    }else{
-      //Go to home position
-      this->moveCursor(QTextCursor::Start);
-    }
+// === Selection ===
+QPoint TerminalWidget::cellAt(QPoint pos){
+  int col = qBound(0, pos.x()/cellW, SCREEN->columns()-1);
+  int row = qBound(0, pos.y()/cellH, SCREEN->rows()-1);
+  return QPoint(col, scrollbar->value()+row);
+}
 
-   // CURSOR MANAGEMENT
-  }else if(code.endsWith("r")){ //Tag top/bottom lines as perticular numbers
-    int mid = code.indexOf(";");
-    qDebug() << "New Row Codes:" << code << "midpoint:" << mid;
-    if(mid>1){
-      if(mid >=2){ startrow = code.mid(1,mid-1).toInt(); }
-      if(mid < code.size()-1){ endrow = code.mid(mid+1,code.size()-mid-2).toInt(); }
-    }
-    qDebug() << "New Row Codes:" << startrow << endrow;
-   // DISPLAY CLEAR CODES
-  }else if(code.endsWith("J")){ //ED - Erase Display
-    int num = 0;
-    if(code.size()>2){ num = code.mid(1, code.size()-2).toInt(); } //everything in the middle
-    //qDebug() << "Erase Display:" << num;
-    if(num==1){
-      //Clear from cursor to beginning of screen
-      QTextCursor cur = this->textCursor();
-	cur.movePosition(QTextCursor::Start, QTextCursor::KeepAnchor, 1);
-	cur.removeSelectedText();
-      this->setTextCursor(cur);
-    }else if(num==2){
-      //Clear the whole screen
-      qDebug() << "Clear Screen:" << this->document()->lineCount();
-      this->clear();
-    }else{
-      //Clear from cursor to end of screen
-      QTextCursor cur = this->textCursor();
-	cur.movePosition(QTextCursor::End, QTextCursor::KeepAnchor, 1);
-	cur.removeSelectedText();
-      this->setTextCursor(cur);
-    }	    
-  }else if(code.endsWith("K")){ //EL - Erase in Line
-    int num = 0;
-    if(code.size()>2){ num = code.mid(1, code.size()-2).toInt(); } //everything in the middle
-    //qDebug() << "Erase Number" << num;
-    //Now determine what should be cleared based on code
-    if(num==1){
-      //Clear from current cursor to beginning of line
-      QTextCursor cur = this->textCursor();
-	cur.movePosition(QTextCursor::StartOfLine, QTextCursor::KeepAnchor, 1);
-	cur.removeSelectedText();
-      this->setTextCursor(cur);
-    }else if(num==2){
-      //Clear the entire line
-      QTextCursor cur = this->textCursor();
-	cur.movePosition(QTextCursor::StartOfLine, QTextCursor::MoveAnchor, 1);
-	cur.movePosition(QTextCursor::EndOfLine, QTextCursor::KeepAnchor, 1);
-      cur.removeSelectedText();
-      this->setTextCursor(cur);
-    }else{
-      //Clear from current cursor to end of line
-      QTextCursor cur = this->textCursor();
-	cur.movePosition(QTextCursor::EndOfLine, QTextCursor::KeepAnchor, 1);
-	cur.removeSelectedText();
-      this->setTextCursor(cur);
-    }
-  }else if(code.endsWith("g")){
-    //Tab Clear codes (0 or 3 only)
-    int num = 0;
-    if(code.size()>2){ num = code.mid(1, code.size()-2).toInt(); } //everything in the middle
-    if(num==0){ //clear current column (delete key analogue)
-      QTextCursor cur = this->textCursor();
-	cur.movePosition(QTextCursor::Right, QTextCursor::KeepAnchor, 1);
-	cur.removeSelectedText();
-      this->setTextCursor(cur);
-    }else if(num==3){ //clear all
-      this->clear();
-    }
-   //SCROLL MOVEMENT CODES 
-  //}else if(code.endsWith("S")){ // SU - Scroll Up
-    //qDebug() << "Scroll Up:" << code;
-  //}else if(code.endsWith("T")){ // SD - Scroll Down
-    //qDebug() << "Scroll Down:" << code;
-	  
-  // GRAPHICS RENDERING
-  }else if(code.endsWith("m")){
-    //Format: "[<number>;<number>m" (no limit to sections separated by ";")
-    //qDebug() << "Got Graphics Code:" << code;
-    code.chop(1); //chop the "m" off the end
-    int start = 1;
-    int end = code.indexOf(";");
-    while(end>start){
-      //qDebug() << "Color Code:" << code << start << end << code.mid(start, end-start);
-      applyANSIColor(code.mid(start, end-start).toInt());
-      //Now update the iterators and try again
-      start = end;
-      end = code.indexOf(";",start); //go to the next one
-      //qDebug() << "Next end:" << end;
-    }
-    //Need the last section as well
-    end = code.size();
-    if(start>1){ start ++; }
-    //qDebug() << "Color Code:" << code << start << end << code.mid(start, end-start);
-    if(end>start){ applyANSIColor(code.mid(start, end-start).toInt());}
-    else{ applyANSIColor(0); }
-    
-    
-  // GRAPHICS MODES
-  //}else if(code.endsWith("h")){
-	  
-  //}else if(code.endsWith("l")){
-	  
-  }else{
-    qDebug() << "Unhandled Control Code:" << code;
-  }
-  
-  } //End VT100 control codes
-  else{
-    qDebug() << "Unhandled Control Code:" << code;
-  }
+bool TerminalWidget::hasSelection(){
+  return (selStart.x()>=0 && selStart!=selEnd);
 }
 
-void TerminalWidget::applyANSIColor(int code){
-  //qDebug() << "Apply Color code:" << code;
-  if(code <=0){ CFMT = DEFFMT; } //Reset back to default
-  else if(code==1){  CFMT.setFontWeight(75); } //BOLD font
-  else if(code==2){ CFMT.setFontWeight(25); } //Faint font (smaller than normal by a bit)
-  else if(code==3){ CFMT.setFontWeight(75); } //Italic font
-  else if(code==4){ CFMT.setFontUnderline(true); } //Underline
-  //5-6: Blink text (unsupported)
-  //7: Reverse foreground/background (unsupported)
-  //8: Conceal (unsupported)
-  else if(code==9){ CFMT.setFontStrikeOut(true); } //Crossed out
-  //10-19: Change font family (unsupported)
-  //20: Fraktur Font (unsupported)
-  //21: Bold:off or Underline:Double (unsupported)
-  else if(code==22){ CFMT.setFontWeight(50); } //Normal weight
-  //23: Reset font (unsupported)
-  else if(code==24){ CFMT.setFontUnderline(false); } //disable underline
-  //25: Disable blinking (unsupported)
-  //26: Reserved
-  //27: Reset reversal (7) (unsupported)
-  //28: Reveal (cancel 8) (unsupported)
-  else if(code==29){ CFMT.setFontStrikeOut(false); } //Not Crossed out
-  else if(code>=30 && code<=39){
-    //Set the font color
-   QColor color;
-    if(code==30){color=QColor(Qt::black); }
-    else if(code==31){ color=QColor(Qt::red); }
-    else if(code==32){ color=QColor(Qt::green); }
-    else if(code==33){ color=QColor(Qt::yellow); }
-    else if(code==34){ color=QColor(Qt::blue); }
-    else if(code==35){ color=QColor(Qt::magenta); }
-    else if(code==36){ color=QColor(Qt::cyan); }
-    else if(code==37){ color=QColor(Qt::white); }
-    //48: Special extended color setting (unsupported)
-    else if(code==39){ color= DEFFMT.foreground().color(); } //reset to default color
-    QBrush brush = CFMT.foreground();
-    color.setAlpha(255); //fully opaque
-    brush.setColor(color);
-    CFMT.setForeground( brush );
-    //this->setTextColor(color); //just in case the format is not used
-  }
-  else if(code>=40 && code<=49){
-    //Set the font color
-   QColor color;
-    if(code==40){color=QColor(Qt::black); }
-    else if(code==41){ color=QColor(Qt::red); }
-    else if(code==42){ color=QColor(Qt::green); }
-    else if(code==43){ color=QColor(Qt::yellow); }
-    else if(code==44){ color=QColor(Qt::blue); }
-    else if(code==45){ color=QColor(Qt::magenta); }
-    else if(code==46){ color=QColor(Qt::cyan); }
-    else if(code==47){ color=QColor(Qt::white); }
-    //48: Special extended color setting (unsupported)
-    else if(code==49){ color= DEFFMT.background().color(); } //reset to default color
-    QBrush brush = CFMT.background();
-    color.setAlpha(255); //fully opaque
-    brush.setColor(color);
-    CFMT.setBackground( brush );
+bool TerminalWidget::isSelected(int col, int line){
+  if(!hasSelection()){ return false; }
+  QPoint first = selStart, last = selEnd;
+  if(last.y()<first.y() || (last.y()==first.y() && last.x()<first.x()) ){ first = selEnd; last = selStart; }
+  if(line<first.y() || line>last.y()){ return false; }
+  if(line==first.y() && col<first.x()){ return false; }
+  if(line==last.y() && col>last.x()){ return false; }
+  return true;
+}
+
+QString TerminalWidget::selectedText(){
+  if(!hasSelection()){ return ""; }
+  QPoint first = selStart, last = selEnd;
+  if(last.y()<first.y() || (last.y()==first.y() && last.x()<first.x()) ){ first = selEnd; last = selStart; }
+  QStringList lines;
+  for(int l=first.y(); l<=last.y(); l++){
+    const TermLine &line = SCREEN->line(l);
+    int from = (l==first.y()) ? first.x() : 0;
+    int to = (l==last.y()) ? qMin(last.x()+1, line.size()) : line.size();
+    QString text;
+    for(int c=from; c<to; c++){ appendCell(text, line.at(c).ch); }
+    while(text.endsWith(" ")){ text.chop(1); } //empty cells at the end of the line
+    lines << text;
   }
-  //50: Reserved
-  //51: Framed
-  //52: Encircled
-  else if(code==53){ CFMT.setFontOverline(true); } //enable overline
-  //54: Not framed/circled (51/52)
-  else if(code==55){ CFMT.setFontOverline(false); } //disable overline
-  //56-59: Reserved
-  //60+: Not generally supported (special code for particular terminals such as aixterm)
-  else{ qDebug() << "Unknown Color Code:" << code; }
+  return lines.join("\n");
 }
 
 //Outgoing Data parsing
 void TerminalWidget::sendKeyPress(int key){
   QByteArray ba;
-  //if(this->textCursor()==selCursor){ this->setTextCursor(lastCursor); }
-  //int fromEnd = this->document()->characterCount() - this->textCursor().position();
+  bool app = SCREEN->appCursorKeys(); //application cursor key codes
   //Check for special keys
   switch(key){
     case Qt::Key_Delete:
 	ba.append("\e[3~");
         break;
     case Qt::Key_Backspace:
-	ba.append("\x08");    
+	ba.append("\x08");
         break;
     case Qt::Key_Left:
-	if(altkeypad){ ba.append("^[D"); }
-	else{ ba.append("\x1b[D"); }
+	ba.append(app ? "\x1bOD" : "\x1b[D");
         break;
     case Qt::Key_Right:
-	if(altkeypad){ ba.append("^[C"); }
-	else{ ba.append("\x1b[C"); }
+	ba.append(app ? "\x1bOC" : "\x1b[C");
         break;
     case Qt::Key_Up:
-        if(altkeypad){ ba.append("^[A"); }
-	else{ ba.append("\x1b[A"); }
+	ba.append(app ? "\x1bOA" : "\x1b[A");
         break;
     case Qt::Key_Down:
-        if(altkeypad){ ba.append("^[B"); }
-	else{ ba.append("\x1b[B"); }
+	ba.append(app ? "\x1bOB" : "\x1b[B");
         break;
     case Qt::Key_Home:
-        ba.append("\x1b[H");
-        break;	    
+	ba.append(app ? "\x1bOH" : "\x1b[H");
+        break;
     case Qt::Key_End:
-	ba.append("\x1b[F");
-        break;	    
+	ba.append(app ? "\x1bOF" : "\x1b[F");
+        break;
+    case Qt::Key_Insert:
+	ba.append("\x1b[2~");
+        break;
+    case Qt::Key_PageUp:
+	ba.append("\x1b[5~");
+        break;
+    case Qt::Key_PageDown:
+	ba.append("\x1b[6~");
+        break;
+    case Qt::Key_F1:
+	ba.append("\x1bOP");
+        break;
+    case Qt::Key_F2:
+	ba.append("\x1bOQ");
+        break;
+    case Qt::Key_F3:
+	ba.append("\x1bOR");
+        break;
+    case Qt::Key_F4:
+	ba.append("\x1bOS");
+        break;
+    case Qt::Key_F5:
+	ba.append("\x1b[15~");
+        break;
+    case Qt::Key_F6:
+	ba.append("\x1b[17~");
+        break;
+    case Qt::Key_F7:
+	ba.append("\x1b[18~");
+        break;
+    case Qt::Key_F8:
+	ba.append("\x1b[19~");
+        break;
+    case Qt::Key_F9:
+	ba.append("\x1b[20~");
+        break;
+    case Qt::Key_F10:
+	ba.append("\x1b[21~");
+        break;
+    case Qt::Key_F11:
+	ba.append("\x1b[23~");
+        break;
+    case Qt::Key_F12:
+	ba.append("\x1b[24~");
+        break;
   }
    //qDebug() << "Forward Input:" << ba;
   if(!ba.isEmpty()){ PROC->writeTTY(ba); }
@@ -472,9 +297,16 @@ void TerminalWidget::UpdateText(){
   //read the data from the process
   //qDebug() << "UpdateText";
   if(!PROC->isOpen()){ return; }
-  applyData(PROC->readTTY());
-  //adjust the scrollbar as needed
-  this->ensureCursorVisible();
+  QByteArray data = PROC->readTTY();
+  if(data.isEmpty()){ return; }
+  if(!this->isEnabled()){ this->setEnabled(true); }
+  if(DEBUG){ qDebug() << "Got Data: " << data; }
+  SCREEN->parse(data);
+  //Answer any terminal queries (cursor position, device attributes, etc)
+  QByteArray reply = SCREEN->takeReplies();
+  if(!reply.isEmpty()){ PROC->writeTTY(reply); }
+  //Only repaint once per frame, no matter how much data comes in
+  if(!paintTimer->isActive()){ paintTimer->start(); }
 }
 
 void TerminalWidget::ShellClosed(){
@@ -483,87 +315,143 @@ void TerminalWidget::ShellClosed(){
   }
 }
 
+void TerminalWidget::updateView(){
+  //Keep following the output unless the user scrolled back into the history
+  bool follow = (scrollbar->value()==scrollbar->maximum());
+  scrollbar->setPageStep(SCREEN->rows());
+  scrollbar->setMaximum(SCREEN->historyCount());
+  if(follow && scrollbar->value()!=scrollbar->maximum()){
+    scrollbar->setValue(scrollbar->maximum()); //full repaint
+  }
+  QBitArray dirty = SCREEN->takeDirty();
+  QPoint cur = SCREEN->cursor();
+  if(scrollbar->value()!=scrollbar->maximum()){
+    //Looking at the history - the screen rows are not where they would normally be
+    if(dirty.count(true)>0){ this->update(); }
+  }else{
+    //Only repaint the rows which changed
+    QRegion region;
+    for(int i=0; i<dirty.size(); i++){
+      if(dirty.testBit(i)){ region += QRect(0, i*cellH, this->width(), cellH); }
+    }
+    if(cur!=lastCursor){
+      region += QRect(0, lastCursor.y()*cellH, this->width(), cellH);
+      region += QRect(0, cur.y()*cellH, this->width(), cellH);
+    }
+    if(!region.isEmpty()){ this->update(region); }
+  }
+  lastCursor = cur;
+}
+
 void TerminalWidget::copySelection(){
-  QApplication::clipboard()->setText( selCursor.selectedText() );
+  QApplication::clipboard()->setText( selectedText() );
 }
 
 void TerminalWidget::pasteSelection(){
   QString text = QApplication::clipboard()->text();
-  if(!text.isEmpty()){ 
-    QByteArray ba; ba.append(text); //avoid any byte conversions
-    PROC->writeTTY(ba); 
+  if(!text.isEmpty()){
+    PROC->writeTTY( text.toUtf8() );
   }
 }
 
 void TerminalWidget::updateTermSize(){
- if(!PROC->isOpen()){ return; }
-  QSize pix = this->size(); //pixels
-  QSize chars; 
-    chars.setWidth( pix.width()/this->fontMetrics().width("W") );
-    chars.setHeight( pix.height()/this->fontMetrics().lineSpacing() );
-  
-  PROC->setTerminalSize(chars,pix);
+  QSize pix( this->width()-scrollbar->width(), this->height() ); //pixels
+  QSize chars( qMax(1, pix.width()/cellW), qMax(1, pix.height()/cellH) );
+  SCREEN->resize(chars.width(), chars.height());
+  if(PROC->isOpen()){ PROC->setTerminalSize(chars,pix); }
+  updateView();
+  this->update();
 }
 
 // ==================
 //       PROTECTED
 // ==================
 void TerminalWidget::keyPressEvent(QKeyEvent *ev){
-	
+  //Shift+PageUp/PageDown scroll through the history
+  if(ev->modifiers().testFlag(Qt::ShiftModifier) && (ev->key()==Qt::Key_PageUp || ev->key()==Qt::Key_PageDown) ){
+    scrollbar->triggerAction( (ev->key()==Qt::Key_PageUp) ? QAbstractSlider::SliderPageStepSub : QAbstractSlider::SliderPageStepAdd);
+    return;
+  }
   if(ev->text().isEmpty() || ev->text()=="\b" ){
     sendKeyPress(ev->key());
   }else{
-    QByteArray ba; ba.append(ev->text()); //avoid any byte conversions
+    QByteArray ba = ev->text().toUtf8();
+    if(ev->modifiers().testFlag(Qt::AltModifier)){ ba.prepend("\x1b"); } //Meta key
     //qDebug() << "Forward Input:" << ba;
     PROC->writeTTY(ba);
   }
-  
+  scrollbar->setValue(scrollbar->maximum()); //go back to the current output
   ev->ignore();
 }
 
 void TerminalWidget::mousePressEvent(QMouseEvent *ev){
   this->setFocus();
   this->activateWindow();
-  if(ev->button()==Qt::RightButton){
-    QTextEdit::mousePressEvent(ev);	  
-  }else if(ev->button()==Qt::MiddleButton){
+  if(ev->button()==Qt::MiddleButton){
     pasteSelection();
   }else if(ev->button()==Qt::LeftButton){
-    if(this->textCursor()!=selCursor){ lastCursor = this->textCursor(); }
-    selCursor = this->cursorForPosition(ev->pos());
+    selStart = selEnd = cellAt(ev->pos());
+    this->update();
   }
-  Q_UNUSED(ev);
 }
 
 void TerminalWidget::mouseMoveEvent(QMouseEvent *ev){
   //qDebug() << "MouseMove Event" << ev->button() << ev->buttons() << Qt::LeftButton;
-  if(ev->buttons().testFlag(Qt::LeftButton) ){
-    selCursor.setPosition(this->cursorForPosition(ev->pos()).position(), QTextCursor::KeepAnchor);
-    if(selCursor.hasSelection()){ this->setTextCursor(selCursor); }
-    //qDebug() << "Mouse Movement:" << selCursor.hasSelection();
-  }else{
-    QTextEdit::mouseMoveEvent(ev);
+  if(ev->buttons().testFlag(Qt::LeftButton) && selStart.x()>=0){
+    QPoint pt = cellAt(ev->pos());
+    if(pt!=selEnd){ selEnd = pt; this->update(); }
   }
 }
 
 void TerminalWidget::mouseReleaseEvent(QMouseEvent *ev){
   if(ev->button()==Qt::LeftButton){
-    selCursor.setPosition(this->cursorForPosition(ev->pos()).position(), QTextCursor::KeepAnchor);
-    if(selCursor.hasSelection()){ this->setTextCursor(selCursor); }
-    else{ this->setTextCursor(lastCursor); }
+    if(hasSelection() && QApplication::clipboard()->supportsSelection()){
+      QApplication::clipboard()->setText( selectedText(), QClipboard::Selection );
+    }
   }else if(ev->button()==Qt::RightButton){
-    copyA->setEnabled( selCursor.hasSelection() );
+    copyA->setEnabled( hasSelection() );
     pasteA->setEnabled( !QApplication::clipboard()->text().isEmpty() );
-    contextMenu->popup( this->mapToGlobal(ev->pos()) );	  
+    contextMenu->popup( this->mapToGlobal(ev->pos()) );
   }
-  Q_UNUSED(ev);
 }
 
 void TerminalWidget::mouseDoubleClickEvent(QMouseEvent *ev){
-  Q_UNUSED(ev);	
+  if(ev->button()!=Qt::LeftButton){ return; }
+  //Select the word under the mouse
+  QPoint pt = cellAt(ev->pos());
+  const TermLine &line = SCREEN->line(pt.y());
+  if(pt.x()>=line.size() || QChar::isSpace(line.at(pt.x()).ch)){ return; }
+  int start = pt.x(), end = pt.x();
+  while(start>0 && !QChar::isSpace(line.at(start-1).ch)){ start--; }
+  while(end<line.size()-1 && !QChar::isSpace(line.at(end+1).ch)){ end++; }
+  selStart = QPoint(start, pt.y());
+  selEnd = QPoint(end, pt.y());
+  if(QApplication::clipboard()->supportsSelection()){
+    QApplication::clipboard()->setText( selectedText(), QClipboard::Selection );
+  }
+  this->update();
+}
+
+void TerminalWidget::wheelEvent(QWheelEvent *ev){
+  QApplication::sendEvent(scrollbar, ev);
 }
 
 void TerminalWidget::resizeEvent(QResizeEvent *ev){
+  int sbw = scrollbar->sizeHint().width();
+  scrollbar->setGeometry(this->width()-sbw, 0, sbw, this->height());
   resizeTimer->start();
-  QTextEdit::resizeEvent(ev);
+  QWidget::resizeEvent(ev);
+}
+
+void TerminalWidget::paintEvent(QPaintEvent *ev){
+  QPainter P(this);
+  P.fillRect(ev->rect(), cellColor(TERM_DEFAULT_BG));
+  int first = qMax(0, ev->rect().top()/cellH);
+  int last = qMin(SCREEN->rows()-1, ev->rect().bottom()/cellH);
+  for(int r=first; r<=last; r++){ paintRow(&P, r); }
+}
+
+bool TerminalWidget::focusNextPrevChild(bool next){
+  Q_UNUSED(next);
+  return false;
 }
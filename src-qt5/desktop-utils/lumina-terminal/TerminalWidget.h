@@ -7,17 +7,23 @@
 #ifndef _LUMINA_DESKTOP_UTILITIES_TERMINAL_PROCESS_WIDGET_H
 #define _LUMINA_DESKTOP_UTILITIES_TERMINAL_PROCESS_WIDGET_H
 
-#include <QTextEdit>
+#include <QWidget>
+#include <QScrollBar>
 #include <QKeyEvent>
 #include <QResizeEvent>
-#include <QSocketNotifier>
+#include <QPaintEvent>
+#include <QWheelEvent>
+#include <QPainter>
 #include <QTimer>
 #include <QMenu>
 #include <QClipboard>
+#include <QVector>
+#include <QColor>
 
 #include "TtyProcess.h"
+#include "TerminalScreen.h"
 
-class TerminalWidget : public QTextEdit{
+class TerminalWidget : public QWidget{
 	Q_OBJECT
 public:
 	TerminalWidget(QWidget *parent =0, QString dir="");
@@ -28,29 +34,35 @@ public:
 
 private:
 	TTYProcess *PROC;
-	QTimer *resizeTimer;
-	QTextCharFormat DEFFMT, CFMT; //default/current text format
-	QTextCursor selCursor, lastCursor;
+	TerminalScreen *SCREEN;
+	QScrollBar *scrollbar; //history
+	QTimer *resizeTimer, *paintTimer;
 	QMenu *contextMenu;
 	QAction *copyA, *pasteA;
-	int selectionStart;
+	QVector<QColor> colors; //xterm color table
+	QPoint selStart, selEnd; //selection (column, line number including the history)
+	QPoint lastCursor; //cursor position at the last repaint
+	int cellW, cellH, cellAscent; //character cell size
 	bool closing;
 
-	//Incoming Data parsing
-	void InsertText(QString);
-	void applyData(QByteArray data); //overall data parsing
-	void applyANSI(QByteArray code); //individual code application
-	void applyANSIColor(int code); //Add the designated color code to the  CFMT structure
+	//Painting
+	void paintRow(QPainter *P, int row);
+	QColor cellColor(quint32 val);
+	void setupCellSize();
+
+	//Selection
+	QPoint cellAt(QPoint pos); //widget position -> (column, line number)
+	bool hasSelection();
+	bool isSelected(int col, int line);
+	QString selectedText();
 
 	//Outgoing Data parsing
 	void sendKeyPress(int key);
 
-	//Special incoming data flags
-	int startrow, endrow; //indexes for the first/last row ("\x1b[A;Br" CC)
-	bool altkeypad;
 private slots:
 	void UpdateText();
 	void ShellClosed();
+	void updateView(); //repaint the rows which changed (at most once per frame)
 
 	void copySelection();
 	void pasteSelection();
@@ -66,8 +78,10 @@ protected:
 	void mouseMoveEvent(QMouseEvent *ev);
 	void mouseReleaseEvent(QMouseEvent *ev);
 	void mouseDoubleClickEvent(QMouseEvent *ev);
-	//void contextMenuEvent(QContextMenuEvent *ev);
+	void wheelEvent(QWheelEvent *ev);
 	void resizeEvent(QResizeEvent *ev);
+	void paintEvent(QPaintEvent *ev);
+	bool focusNextPrevChild(bool next); //keep the tab key for the terminal
 };
 
 #endif
@@ -4,14 +4,13 @@
 #include <QProcessEnvironment>
 #include <QTimer>
 
-#define DEBUG 1
+#define DEBUG 0
+#define READ_MAX 1048576 //max bytes per read call (keep the event loop responsive during a flood of output)
 
 TTYProcess::TTYProcess(QObject *parent) : QObject(parent){
   childProc = 0;
-  sn = 0;
+  sn = wn = 0;
   ttyfd = 0;
-  starting = true;
-  fixReply = -1;
 }
 
 TTYProcess::~TTYProcess(){
@@ -80,13 +79,17 @@ bool TTYProcess::startTTY(QString prog, QStringList args, QString workdir){
     childProc = tmp;
     //Load the file for close notifications
       //TO-DO
+    //Never block on the PTY - read everything which is available at once
+    fcntl(FD, F_SETFL, fcntl(FD, F_GETFL) | O_NONBLOCK);
     //Watch the socket for activity
-    sn= new QSocketNotifier(FD, QSocketNotifier::Read);
+    sn= new QSocketNotifier(FD, QSocketNotifier::Read, this);
 	sn->setEnabled(true);
 	connect(sn, SIGNAL(activated(int)), this, SLOT(checkStatus(int)) );
+    wn = new QSocketNotifier(FD, QSocketNotifier::Write, this);
+	wn->setEnabled(false); //only needed when the PTY is full
+	connect(wn, SIGNAL(activated(int)), this, SLOT(flushTTY()) );
     ttyfd = FD;
    if(DEBUG){ qDebug() << " - PTY:" << ptsname(FD); }
-    starting = true;
     return true;
   }
 }
@@ -98,6 +101,8 @@ void TTYProcess::closeTTY(){
   }
   if(ttyfd!=0 && sn!=0){
     sn->setEnabled(false);
+    wn->setEnabled(false);
+    writeBA.clear();
     ::close(ttyfd);
     ttyfd = 0;
     emit processClosed();
@@ -106,84 +111,24 @@ void TTYProcess::closeTTY(){
 
 void TTYProcess::writeTTY(QByteArray output){
   //qDebug() << "Write:" << output;
-  static QList<QByteArray> knownFixes;
-  if(knownFixes.isEmpty()){ knownFixes << "\x1b[C" << "\x1b[D" << "\b" << "\x7F" << "\x08"; }//<<"\x1b[H"<<"\x1b[F"; }
-  fixReply = knownFixes.indexOf(output);
-  ::write(ttyfd, output.data(), output.size());
+  if(ttyfd==0){ return; }
+  writeBA.append(output);
+  flushTTY();
 }
 
 QByteArray TTYProcess::readTTY(){
   QByteArray BA;
   //qDebug() << "Read TTY";
   if(sn==0){ return BA; } //not setup yet
-  char buffer[64];
-  ssize_t rtot = read(sn->socket(),&buffer,64);
-  //buffer[rtot]='\0';
-  BA = QByteArray(buffer, rtot);
-  //qDebug() << " - Got Data:" << BA;
-  if(!fragBA.isEmpty()){
-    //Have a leftover fragment, include this too
-    BA = BA.prepend(fragBA);
-    fragBA.clear();
-  }
-  bool bad = true;
-  BA = CleanANSI(BA, bad);
-  if(bad){
-    //incomplete fragent - read some more first
-    fragBA = BA; 
-    return readTTY();
-  }else{
-    if(DEBUG){ qDebug() << "Read Data:" << BA; }
-    //BUG BYPASS - 12/7/16
-    //If the PTY gets input fairly soon after starting, the PTY will re-print the initial line(s)
-    if(starting && !BA.contains("\n") ){
-      //qDebug() << "Starting phase 1:" << BA;
-       writeTTY("tset\n"); //Terminal Setup utility (uses the TERM env variable)
-      BA.clear();
-    }else if(starting){
-      //qDebug() << "Starting phase 2:" << BA;
-      BA.remove(0, BA.indexOf("\n")+1);
-      starting = false;
-    }
-    //Apply known fixes for replies to particular inputs (mostly related to cursor position *within* the current line)
-    // This appears to be primarily from the concept that the cursor position is always at the end of the line (old VT limitation?)
-    //  so almost all these fixes are for cursor positioning within the current line
-    if(fixReply >= 0){
-      if(DEBUG){ qDebug() << "Fix Reply:" <<fixReply <<  BA; }
-      switch(fixReply){
-	case 0: //Right arrow ("\x1b[C") - PTY reply re-prints the next character rather than moving the cursor
-          if(BA.length()>0){
-            BA.remove(0,1);
-            BA.prepend("\x1b[C"); //just move the cursor - don't re-print that 1 character
-          }
-	  break;
-	case 1: //Left arrow ("\x1b[D") - PTY erases the previous character instead of moving the cursor
-          if(BA.startsWith("\b")){
-            BA.remove(0,1);
-            BA.prepend("\x1b[D"); //just move the cursor - don't send the "back" character (\b)
-          }
-	  break;
-	case 2: //Backspace or delete - PTY works fine if on the end of the line, but when in the middle of a line it will backpace a number of times after clearing (same as left arrow issue)
-        case 3:
-	case 4:
-          if(BA.contains("\x1b[K")){
-	    while(BA.indexOf("\x1b[K") < BA.lastIndexOf("\b") ){
-              BA.replace( BA.lastIndexOf("\b"), 1, "\x1b[D"); //just move the cursor left - don't send the "back" character (\b)
-            }
-          }
-	  break;
-	case 5: //Home Key
-          BA = "\x1b[H";
-          break;
-	case 6: //End Key
-          BA = "\x1b[F";
-          break;
-      }
-      fixReply = -1; //done with the fix - resume normal operations
-      if(DEBUG){ qDebug() << " - Fixed:" << BA; }
-    }
-    return BA;
-  }
+  //Read large chunks until nothing else is available (the terminal parser handles partial codes)
+  char buffer[65536];
+  while(BA.size() < READ_MAX){
+    ssize_t rtot = ::read(ttyfd, buffer, sizeof(buffer));
+    if(rtot<=0){ break; } //no more data (EAGAIN), or the TTY was closed
+    BA.append(buffer, rtot);
+  }
+  if(DEBUG){ qDebug() << "Read Data:" << BA.size(); }
+  return BA;
 }
 
 void TTYProcess::setTerminalSize(QSize chars, QSize pixels){
@@ -193,7 +138,7 @@ void TTYProcess::setTerminalSize(QSize chars, QSize pixels){
     c_sz.ws_col = chars.width();
     c_sz.ws_xpixel = pixels.width();
     c_sz.ws_ypixel = pixels.height();
-  if( ioctl(ttyfd, TIOCSWINSZ, &ws) ){
+  if( ioctl(ttyfd, TIOCSWINSZ, &c_sz) ){
     qDebug() << "Error settings terminal size";
   }else{
     //qDebug() <<"Set Terminal Size:" << pixels << chars;
@@ -204,89 +149,6 @@ bool TTYProcess::isOpen(){
   return (ttyfd!=0);
 }
 
-QByteArray TTYProcess::CleanANSI(QByteArray raw, bool &incomplete){
-  incomplete = true;
-  //qDebug() << "Clean ANSI Data:" << raw;
-  //IN_LINE TERMINAL COLOR CODES (ANSI Escape Codes) "\x1B[<colorcode>m"
-  //  - Just remove them for now
-	
-  //Special XTERM encoding (legacy support)
-  int index = raw.indexOf("\x1B]");
-  while(index>=0){
-    //The end character of this sequence is the Bell command ("\x07")
-    int end = raw.indexOf("\x07");
-    if(end<0){ return raw; } //incomplete raw array
-    raw = raw.remove(index, end-index+1);
-    index = raw.indexOf("\x1B]");
-  }
-
-  // GENERIC ANSI CODES ((Make sure the output is not cut off in the middle of a code)
-  index = raw.indexOf("\x1B");
-  while(index>=0){
-    //CURSOR MOVEMENT
-    int end = 0;
-    for(int i=1; i<raw.size() && end==0; i++){
-      if(raw.size() < index+i){ return raw; }//cut off - go back for more data
-      //qDebug() << "Check Char:" << raw.at(index+i);
-      if( QChar(raw.at(index+i)).isLetter() ){
-        end = i; //found the end of the control code
-      }
-    }
-    index = raw.indexOf("\x1B",index+1); //now find the next one
-  }
-  
-  // SYSTEM BELL
-  index = raw.indexOf("\x07");
-  while(index>=0){ 
-    //qDebug() << "Remove Bell:" << index;
-    raw = raw.remove(index,1); 
-    index = raw.indexOf("\x07");
-  }
-  //VT220(?) print character code (cut out the code, leave the character)
-  index=raw.indexOf("\x1b[@");
-  while(index>=0){ 
-    raw = raw.remove(index,3); 
-    index = raw.indexOf("\x1b[@");
-  }
-
-  //VT102 Identify request
-  index = raw.indexOf("\x1b[Z");
-  while(index>=0){ 
-    raw = raw.remove(index,3); 
-    index = raw.indexOf("\x1b[Z");
-    //Also send the proper reply to this identify request right away
-    writeTTY("\x1b[/Z");
-  }
- //Terminal Status request
-  index = raw.indexOf("\x1b[5n");
-  while(index>=0){ 
-    raw = raw.remove(index,4); 
-    index = raw.indexOf("\x1b[5n");
-    //Also send the proper reply to this identify request right away
-    writeTTY("\x1b[c"); //everything ok
-   }
-  //Terminal Identify request
-  index = raw.indexOf("\x1b[c");
-  while(index>=0){ 
-    raw = raw.remove(index,3); 
-    index = raw.indexOf("\x1b[c");
-    //Also send the proper reply to this identify request right away
-    writeTTY("\x1b[1c"); //VT220 reply code
-  }
-  //Terminal Identify request (xterm/termcap?)
-  /*index = raw.indexOf("\x1b[P");
-  while(index>=0){ 
-    raw = raw.remove(index,3); 
-    index = raw.indexOf("\x1b[P");
-    //Also send the proper reply to this identify request right away
-    qDebug() << " - Got XTERM/TERMCAP identify request ([P)";
-    writeTTY("\x1b[/Z");
-  }*/
-
-  incomplete = false;
-  return raw;
-}
-
 // === PRIVATE ===
 pid_t TTYProcess::LaunchProcess(int& fd, char *prog, char **child_args){
   //Returns: -1 for errors, positive value (file descriptor) for the master side of the TTY to watch	
@@ -379,3 +241,13 @@ void TTYProcess::checkStatus(int sock){
     emit readyRead();
   }
 }
+
+void TTYProcess::flushTTY(){
+  //Write as much of the pending data as the PTY will take right now
+  while(!writeBA.isEmpty()){
+    ssize_t num = ::write(ttyfd, writeBA.constData(), writeBA.size());
+    if(num<=0){ break; } //PTY is full (EAGAIN) - wait for the write notifier
+    writeBA.remove(0, num);
+  }
+  if(wn!=0){ wn->setEnabled(!writeBA.isEmpty()); }
+}
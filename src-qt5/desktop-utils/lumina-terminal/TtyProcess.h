@@ -52,17 +52,12 @@ public:
 
 	//Status update checks
 	bool isOpen();
-	
-	//Functions for handling ANSI escape codes (typically not used by hand)
-	QByteArray CleanANSI(QByteArray, bool &incomplete);
 
 private:
 	pid_t childProc;
 	int ttyfd;
-	QSocketNotifier *sn;
-	QByteArray fragBA; //fragment ByteArray
-	bool starting;
-	int fixReply; //flag for detecting particular inputs and "fixing" the reply to it as needed
+	QSocketNotifier *sn, *wn; //read/write notifiers
+	QByteArray writeBA; //data which could not be written yet (TTY is non-blocking)
 	
 	//====================================
 	// C Library function for setting up the PTY
@@ -78,6 +73,7 @@ private:
 
 private slots:
 	void checkStatus(int);
+	void flushTTY();
 
 signals:
 	void readyRead();
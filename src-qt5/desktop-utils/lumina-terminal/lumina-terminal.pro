@@ -14,12 +14,14 @@ include(../../core/libLumina/LuminaThemes.pri)
 HEADERS	+= TrayIcon.h \
 		TermWindow.h \
 		TerminalWidget.h \
+		TerminalScreen.h \
 		TtyProcess.h
 		
 SOURCES	+= main.cpp \
 		TrayIcon.cpp \
 		TermWindow.cpp \
 		TerminalWidget.cpp \
+		TerminalScreen.cpp \
 		TtyProcess.cpp
 
 
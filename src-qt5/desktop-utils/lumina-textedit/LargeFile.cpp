@@ -0,0 +1,181 @@
+//===========================================
+//  Lumina-DE source code
+//  Copyright (c) 2016, Ken Moore
+//  Available under the 3-clause BSD license
+//  See the LICENSE file for full details
+//===========================================
+#include "LargeFile.h"
+
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <string.h>
+
+#define INITIAL_LINES 10000 //lines indexed right away (so the start of the file can be shown immediately)
+#define SEARCH_CHUNK 16777216 //16MB - bytes searched at a time
+
+LargeFile::LargeFile(QObject *parent) : QObject(parent){
+  data = 0;
+  fsize = 0;
+  indexed = false;
+  watcher = new QFutureWatcher< QVector<qint64> >(this);
+  connect(watcher, SIGNAL(finished()), this, SLOT(indexFinished()) );
+  searcher = new QFutureWatcher<qint64>(this);
+  connect(searcher, SIGNAL(finished()), this, SLOT(searchFinished()) );
+}
+
+LargeFile::~LargeFile(){
+  close();
+}
+
+bool LargeFile::open(QString path){
+  close();
+  file.setFileName(path);
+  if(!file.open(QIODevice::ReadOnly)){ return false; }
+  fsize = file.size();
+  data = (const char*) file.map(0, fsize);
+  if(data==0){ close(); return false; }
+  //Index the first few lines now, and the rest of the file in the background
+  stop.store(0);
+  lines = indexLines(data, fsize, INITIAL_LINES, &stop);
+  indexed = (lines.count()<INITIAL_LINES);
+  if(!indexed){
+    watcher->setFuture( QtConcurrent::run(&LargeFile::indexLines, data, fsize, -1, &stop) );
+  }
+  return true;
+}
+
+void LargeFile::close(){
+  //Make sure the index/search threads are not still using the data
+  stop.store(1);
+  watcher->waitForFinished();
+  cancelFind();
+  if(data!=0){ file.unmap( (uchar*) data); }
+  if(file.isOpen()){ file.close(); }
+  data = 0;
+  fsize = 0;
+  lines.clear();
+  indexed = false;
+}
+
+QString LargeFile::text(int first, int count){
+  if(data==0 || first<0 || first>=lines.count() || count<1){ return ""; }
+  int last = qMin(first+count, lines.count())-1;
+  qint64 start = lines[first];
+  qint64 end = lineEnd(last);
+  QString out = QString::fromUtf8(data+start, end-start);
+  if(out.endsWith("\n")){ out.chop(1); } //no extra empty line at the end
+  return out;
+}
+
+qint64 LargeFile::lineOffset(int line){
+  if(line<0 || line>=lines.count()){ return fsize; }
+  return lines[line];
+}
+
+int LargeFile::lineForOffset(qint64 offset){
+  if(lines.isEmpty()){ return 0; }
+  return (std::upper_bound(lines.constBegin(), lines.constEnd(), offset) - lines.constBegin()) - 1;
+}
+
+int LargeFile::columnForOffset(int line, qint64 offset){
+  qint64 start = lineOffset(line);
+  if(data==0 || offset<=start){ return 0; }
+  return QString::fromUtf8(data+start, qMin(offset,fsize)-start).length();
+}
+
+void LargeFile::startFind(QByteArray text, qint64 from, bool forward, bool casesensitive){
+  cancelFind(); //only one search at a time
+  if(data==0 || text.isEmpty()){ emit findFinished(-1); return; }
+  stopFind.store(0);
+  LargeFind job;
+    job.data = data;
+    job.size = fsize;
+    job.from = from;
+    job.text = text;
+    job.forward = forward;
+    job.casesensitive = casesensitive;
+    job.stop = &stopFind;
+  searcher->setFuture( QtConcurrent::run(&LargeFile::findAll, job) );
+}
+
+void LargeFile::cancelFind(){
+  //Note: The search thread stops within one chunk
+  stopFind.store(1);
+  searcher->waitForFinished();
+}
+
+// === PRIVATE ===
+qint64 LargeFile::findAll(LargeFind job){
+  //Note: This is run in a separate thread
+  qint64 found = find(job, job.from);
+  if(found<0 && job.stop->load()==0){ found = find(job, job.forward ? 0 : job.size); } //start over at the other end
+  return found;
+}
+
+qint64 LargeFile::find(LargeFind job, qint64 from){
+  //Note: searched in chunks (QByteArray sizes are limited to an int)
+  QByteArray needle = job.casesensitive ? job.text : job.text.toLower();
+  qint64 overlap = needle.size()-1; //so a match between two chunks is not missed
+  if(job.forward){
+    for(qint64 start=qMax(from, (qint64) 0); start<job.size; start+=SEARCH_CHUNK){
+      if(job.stop->load()!=0){ return -1; } //cancelled
+      qint64 len = qMin((qint64) SEARCH_CHUNK+overlap, job.size-start);
+      QByteArray chunk = QByteArray::fromRawData(job.data+start, len);
+      if(!job.casesensitive){ chunk = chunk.toLower(); }
+      int index = chunk.indexOf(needle);
+      if(index>=0){ return start+index; }
+    }
+  }else{
+    //Find the last match which starts before the given offset
+    qint64 end = qMin(from, job.size);
+    while(end>0){
+      if(job.stop->load()!=0){ return -1; } //cancelled
+      qint64 start = qMax((qint64) 0, end-SEARCH_CHUNK);
+      qint64 len = qMin(job.size, end+overlap) - start;
+      QByteArray chunk = QByteArray::fromRawData(job.data+start, len);
+      if(!job.casesensitive){ chunk = chunk.toLower(); }
+      int index = chunk.lastIndexOf(needle, end-start-1);
+      if(index>=0){ return start+index; }
+      end = start;
+    }
+  }
+  return -1;
+}
+
+qint64 LargeFile::lineEnd(int line){
+  if(line+1<lines.count()){ return lines[line+1]; }
+  //Last known line - look for the end of it
+  const char *nl = (const char*) memchr(data+lines[line], '\n', fsize-lines[line]);
+  return (nl==0) ? fsize : (nl-data)+1;
+}
+
+QVector<qint64> LargeFile::indexLines(const char *data, qint64 size, int max, QAtomicInt *stop){
+  //Note: This is run in a separate thread for the full index
+  QVector<qint64> out;
+  out << 0;
+  qint64 pos = 0;
+  while(pos<size && (max<0 || out.count()<max) ){
+    const char *nl = (const char*) memchr(data+pos, '\n', size-pos);
+    if(nl==0){ break; }
+    pos = (nl-data)+1;
+    if(pos<size){ out << pos; }
+    if( (out.count() & 0xFFFF)==0 && stop->load()!=0){ return QVector<qint64>(); } //cancelled
+  }
+  return out;
+}
+
+// === PRIVATE SLOTS ===
+void LargeFile::indexFinished(){
+  if(indexed || data==0 || stop.load()!=0){ return; }
+  QVector<qint64> all = watcher->result();
+  if(all.isEmpty()){ return; }
+  lines = all;
+  indexed = true;
+  emit indexReady();
+}
+
+void LargeFile::searchFinished(){
+  if(stopFind.load()!=0){ return; } //cancelled
+  emit findFinished(searcher->result());
+}
@@ -0,0 +1,80 @@
+//===========================================
+//  Lumina-DE source code
+//  Copyright (c) 2016, Ken Moore
+//  Available under the 3-clause BSD license
+//  See the LICENSE file for full details
+//===========================================
+//  This is the backend for viewing files which are too big to load into the editor
+//  The file is mapped into memory and the start of every line is indexed in a background thread,
+//    so any range of lines can be pulled out (or searched) without reading the whole file
+//===========================================
+#ifndef _LUMINA_PLAIN_TEXT_EDITOR_LARGE_FILE_H
+#define _LUMINA_PLAIN_TEXT_EDITOR_LARGE_FILE_H
+
+#include <QObject>
+#include <QString>
+#include <QByteArray>
+#include <QVector>
+#include <QFile>
+#include <QFutureWatcher>
+#include <QAtomicInt>
+
+//One search of the file data (run in a worker thread)
+struct LargeFind{
+	const char *data;
+	qint64 size, from;
+	QByteArray text;
+	bool forward, casesensitive;
+	QAtomicInt *stop;
+};
+
+class LargeFile : public QObject{
+	Q_OBJECT
+public:
+	LargeFile(QObject *parent = 0);
+	~LargeFile();
+
+	bool open(QString path);
+	void close();
+
+	bool isIndexed(){ return indexed; }
+	qint64 size(){ return fsize; }
+	int lineCount(){ return lines.count(); } //only the lines which are indexed so far
+
+	QString text(int first, int count); //contents of a range of lines
+	qint64 lineOffset(int line);
+	int lineForOffset(qint64 offset);
+	int columnForOffset(int line, qint64 offset); //number of characters before the offset
+
+	//Search the raw file data in a background thread (starts back at the other end of the file if needed)
+	// findFinished() gets the offset of the match (-1 if not found)
+	void startFind(QByteArray text, qint64 from, bool forward, bool casesensitive);
+	void cancelFind();
+	bool isSearching(){ return searcher->isRunning(); }
+
+private:
+	QFile file;
+	const char *data;
+	qint64 fsize;
+	QVector<qint64> lines; //start offset of each line
+	bool indexed;
+	QFutureWatcher< QVector<qint64> > *watcher;
+	QAtomicInt stop;
+	QFutureWatcher<qint64> *searcher;
+	QAtomicInt stopFind;
+
+	qint64 lineEnd(int line);
+	static QVector<qint64> indexLines(const char *data, qint64 size, int max, QAtomicInt *stop);
+	static qint64 find(LargeFind job, qint64 from);
+	static qint64 findAll(LargeFind job);
+
+private slots:
+	void indexFinished();
+	void searchFinished();
+
+signals:
+	void indexReady();
+	void findFinished(qint64);
+};
+
+#endif
@@ -241,6 +241,7 @@ void MainUI::wrapLines(bool wrap){
   settings->setValue("wrapLines",wrap);
   for(int i=0; i<ui->tabWidget->count(); i++){
     PlainTextEditor *edit = static_cast<PlainTextEditor*>(ui->tabWidget->widget(i));
+    if(edit->isLargeFile()){ continue; } //always one line per row
     edit->setLineWrapMode( wrap ? QPlainTextEdit::WidgetWidth : QPlainTextEdit::NoWrap);
   }	
 }
@@ -320,28 +321,20 @@ void MainUI::openReplace(){
 void MainUI::findNext(){
   PlainTextEditor *cur = currentEditor();
   if(cur==0){ return; }
-  bool found = cur->find( ui->line_find->text(), ui->tool_find_casesensitive->isChecked() ? QTextDocument::FindCaseSensitively : QTextDocument::FindFlags() );
-  if(!found){
-    //Try starting back at the top of the file
-    cur->moveCursor(QTextCursor::Start);
-    cur->find( ui->line_find->text(), ui->tool_find_casesensitive->isChecked() ? QTextDocument::FindCaseSensitively : QTextDocument::FindFlags() );	  
-  }
+  //Note: the editor will start back at the top of the file as needed
+  cur->findText( ui->line_find->text(), ui->tool_find_casesensitive->isChecked() ? QTextDocument::FindCaseSensitively : QTextDocument::FindFlags() );
 }
 
 void MainUI::findPrev(){
   PlainTextEditor *cur = currentEditor();
   if(cur==0){ return; }
-  bool found = cur->find( ui->line_find->text(), ui->tool_find_casesensitive->isChecked() ? QTextDocument::FindCaseSensitively | QTextDocument::FindBackward : QTextDocument::FindBackward );
-  if(!found){
-    //Try starting back at the bottom of the file
-    cur->moveCursor(QTextCursor::End);
-    cur->find( ui->line_find->text(), ui->tool_find_casesensitive->isChecked() ? QTextDocument::FindCaseSensitively | QTextDocument::FindBackward : QTextDocument::FindBackward );	  
-  }
+  //Note: the editor will start back at the bottom of the file as needed
+  cur->findText( ui->line_find->text(), ui->tool_find_casesensitive->isChecked() ? QTextDocument::FindCaseSensitively | QTextDocument::FindBackward : QTextDocument::FindBackward );
 }
 
 void MainUI::replaceOne(){
   PlainTextEditor *cur = currentEditor();
-  if(cur==0){ return; }
+  if(cur==0 || cur->isReadOnly()){ return; }
   //See if the current selection matches the find field first
   if(cur->textCursor().selectedText()==ui->line_find->text()){
     cur->insertPlainText(ui->line_replace->text());
@@ -351,7 +344,7 @@ void MainUI::replaceOne(){
 
 void MainUI::replaceAll(){
 PlainTextEditor *cur = currentEditor();
-  if(cur==0){ return; }
+  if(cur==0 || cur->isReadOnly()){ return; }
   //See if the current selection matches the find field first
   bool done = false;
   if(cur->textCursor().selectedText()==ui->line_find->text()){
@@ -9,13 +9,19 @@
 #include <QColor>
 #include <QPainter>
 #include <QTextBlock>
+#include <QScrollBar>
 #include <QFileDialog>
 #include <QDebug>
 #include <QApplication>
 #include <QMessageBox>
+#include <QFileInfo>
 
 #include <LUtils.h>
 
+#define LARGE_FILE_SIZE 33554432 //32MB - bigger files are opened read-only in the large file mode
+#define LARGE_WINDOW 3000 //number of lines from a large file which are loaded into the editor at a time
+#define LARGE_MARGIN 500 //load a new window when the view gets this close to either end of the current one
+
 //==============
 //       PUBLIC
 //==============
@@ -27,6 +33,11 @@ PlainTextEditor::PlainTextEditor(QSettings *set, QWidget *parent) : QPlainTextEd
   hasChanges = false;
   lastSaveContents.clear();
   matchleft = matchright = -1;
+  LARGE = 0;
+  findMatch = -1;
+  findLength = 0;
+  largeScroll = 0;
+  winStart = 0;
   this->setTabStopWidth( 8 * this->fontMetrics().width(" ") ); //8 character spaces per tab (UNIX standard)
   //this->setObjectName("PlainTextEditor");
   //this->setStyleSheet("QPlainTextEdit#PlainTextEditor{ }");
@@ -37,6 +48,8 @@ PlainTextEditor::PlainTextEditor(QSettings *set, QWidget *parent) : QPlainTextEd
   connect(this, SIGNAL(cursorPositionChanged()), this, SLOT(checkMatchChar()) );
   connect(this, SIGNAL(cursorPositionChanged()), this, SLOT(cursorMoved()) );
   connect(this, SIGNAL(textChanged()), this, SLOT(textChanged()) );
+  connect(this->verticalScrollBar(), SIGNAL(valueChanged(int)), this, SLOT(updateSyntaxLimit()) );
+  connect(this->verticalScrollBar(), SIGNAL(valueChanged(int)), this, SLOT(windowScrolled()) );
   connect(watcher, SIGNAL(fileChanged(const QString&)), this, SLOT(fileChanged()) );
   LNW_updateWidth();
   LNW_highlightLine();
@@ -66,21 +79,31 @@ void PlainTextEditor::updateSyntaxColors(){
 void PlainTextEditor::LoadFile(QString filepath){
   if( !watcher->files().isEmpty() ){  watcher->removePaths(watcher->files()); }
   bool diffFile = (filepath != this->whatsThis());
+  int keepline = (LARGE!=0 && !diffFile) ? (winStart + this->verticalScrollBar()->value()) : 0;
   this->setWhatsThis(filepath);
   this->clear();
   SYNTAX->loadRules( Custom_Syntax::ruleForFile(filepath.section("/",-1)) );
-  lastSaveContents = LUtils::readFile(filepath).join("\n");
-  if(diffFile){
-    this->setPlainText( lastSaveContents );
+  if(QFileInfo(filepath).size() > LARGE_FILE_SIZE && openLargeFile(filepath)){
+    //Too big to load all at once - just show the lines around the current position
+    lastSaveContents.clear();
+    winStart = keepline;
+    loadWindow(keepline);
+    updateLargeScroll();
   }else{
-    //Try to keep the mouse cursor/scroll in the same position
-    int curpos = this->textCursor().position();;
-    this->setPlainText( lastSaveContents );
-    QApplication::processEvents();
-    QTextCursor cur = this->textCursor();
-      cur.setPosition(curpos);
-    this->setTextCursor( cur );
-    this->centerCursor(); //scroll until cursor is centered (if possible)
+    closeLargeFile();
+    lastSaveContents = LUtils::readFile(filepath).join("\n");
+    if(diffFile){
+      this->setPlainText( lastSaveContents );
+    }else{
+      //Try to keep the mouse cursor/scroll in the same position
+      int curpos = this->textCursor().position();;
+      this->setPlainText( lastSaveContents );
+      QApplication::processEvents();
+      QTextCursor cur = this->textCursor();
+        cur.setPosition(curpos);
+      this->setTextCursor( cur );
+      this->centerCursor(); //scroll until cursor is centered (if possible)
+    }
   }
   hasChanges = false;
   watcher->addPath(filepath);
@@ -89,6 +112,7 @@ void PlainTextEditor::LoadFile(QString filepath){
 
 void PlainTextEditor::SaveFile(bool newname){
   //qDebug() << "Save File:" << this->whatsThis();
+  if(LARGE!=0){ return; } //read-only view (the editor only contains part of the file)
   if( !this->whatsThis().startsWith("/") || newname ){
     //prompt for a filename/path
     QString file = QFileDialog::getSaveFileName(this, tr("Save File"), this->whatsThis(), tr("Text File (*)"));
@@ -113,10 +137,34 @@ bool PlainTextEditor::hasChange(){
   return hasChanges;	
 }
 
+bool PlainTextEditor::findText(QString text, QTextDocument::FindFlags flags){
+  if(text.isEmpty()){ return false; }
+  bool backward = flags.testFlag(QTextDocument::FindBackward);
+  if(LARGE==0){
+    bool found = this->find(text, flags);
+    if(!found){
+      //Try starting back at the other end of the document
+      this->moveCursor( backward ? QTextCursor::End : QTextCursor::Start );
+      found = this->find(text, flags);
+    }
+    return found;
+  }
+  //Large file: search the mapped file data in the background (the match is shown by largeFindFinished())
+  QTextCursor cur = this->textCursor();
+  QTextBlock block = this->document()->findBlock( backward ? cur.selectionStart() : cur.selectionEnd() );
+  int col = (backward ? cur.selectionStart() : cur.selectionEnd()) - block.position();
+  qint64 from = LARGE->lineOffset(winStart + block.blockNumber()) + block.text().left(col).toUtf8().length();
+  findMatch = -1;
+  findLength = text.length();
+  LARGE->startFind(text.toUtf8(), from, !backward, flags.testFlag(QTextDocument::FindCaseSensitively));
+  cursorMoved(); //show the search status
+  return true;
+}
+
 //Functions for managing the line number widget
 int PlainTextEditor::LNWWidth(){
   //Get the number of chars we need for line numbers
-  int lines = this->blockCount();
+  int lines = (LARGE!=0) ? LARGE->lineCount() : this->blockCount();
   if(lines<1){ lines = 1; }
   int chars = 1;
   while(lines>=10){ chars++; lines/=10; }
@@ -136,7 +184,7 @@ void PlainTextEditor::paintLNW(QPaintEvent *ev){
   while(block.isValid() && bTop<=ev->rect().bottom()){ //ensure block below top of viewport
     bBottom = bTop+blockBoundingRect(block).height();
     if(block.isVisible() && bBottom >= ev->rect().top()){ //ensure block above bottom of viewport
-      P.drawText(0,bTop, LNW->width(), this->fontMetrics().height(), Qt::AlignRight, QString::number(block.blockNumber()+1) );
+      P.drawText(0,bTop, LNW->width(), this->fontMetrics().height(), Qt::AlignRight, QString::number(winStart+block.blockNumber()+1) );
     }
     //Go to the next block
     block = block.next();
@@ -159,6 +207,56 @@ void PlainTextEditor::clearMatchData(){
   }
 }
 
+bool PlainTextEditor::openLargeFile(QString filepath){
+  if(LARGE==0){
+    LARGE = new LargeFile(this);
+    connect(LARGE, SIGNAL(indexReady()), this, SLOT(updateLargeScroll()) );
+    connect(LARGE, SIGNAL(indexReady()), this, SLOT(showLargeMatch()) );
+    connect(LARGE, SIGNAL(findFinished(qint64)), this, SLOT(largeFindFinished(qint64)) );
+    largeScroll = new QScrollBar(Qt::Vertical, this);
+    connect(largeScroll, SIGNAL(valueChanged(int)), this, SLOT(largeScrolled(int)) );
+  }
+  findMatch = -1;
+  if(!LARGE->open(filepath)){ closeLargeFile(); return false; }
+  this->setReadOnly(true);
+  this->setLineWrapMode(QPlainTextEdit::NoWrap); //one line per block - the scroll position is then a line number
+  this->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff); //replaced by the largeScroll
+  largeScroll->show();
+  return true;
+}
+
+void PlainTextEditor::closeLargeFile(){
+  if(LARGE==0){ return; }
+  delete LARGE; //unmaps the file
+  LARGE = 0;
+  delete largeScroll;
+  largeScroll = 0;
+  winStart = 0;
+  this->setReadOnly(false);
+  this->setVerticalScrollBarPolicy(Qt::ScrollBarAsNeeded);
+  this->setLineWrapMode( settings->value("wrapLines",true).toBool() ? QPlainTextEdit::WidgetWidth : QPlainTextEdit::NoWrap);
+  LNW_updateWidth();
+}
+
+void PlainTextEditor::loadWindow(int line){
+  //Remember where the cursor is within the file
+  QTextCursor cur = this->textCursor();
+  int curline = winStart + cur.blockNumber();
+  int curcol = cur.positionInBlock();
+  //Load the lines centered around the given line
+  winStart = qBound(0, line - LARGE_WINDOW/2, qMax(0, LARGE->lineCount()-LARGE_WINDOW) );
+  this->verticalScrollBar()->blockSignals(true);
+  this->setPlainText( LARGE->text(winStart, LARGE_WINDOW) );
+  QTextBlock block = this->document()->findBlockByNumber( qBound(0, curline-winStart, this->blockCount()-1) );
+  cur = QTextCursor(block);
+  if(curline>=winStart && curline<winStart+this->blockCount()){ cur.setPosition(block.position() + qMin(curcol, block.length()-1) ); }
+  this->setTextCursor(cur);
+  this->verticalScrollBar()->setValue(line-winStart);
+  this->verticalScrollBar()->blockSignals(false);
+  updateSyntaxLimit();
+  LNW->update();
+}
+
 void PlainTextEditor::highlightMatch(QChar ch, bool forward, int fromPos, QChar startch){
   if(forward){ matchleft = fromPos;  }
   else{ matchright = fromPos; }
@@ -220,10 +318,11 @@ void PlainTextEditor::highlightMatch(QChar ch, bool forward, int fromPos, QChar
 //===================
 //Functions for managing the line number widget
 void PlainTextEditor::LNW_updateWidth(){
+  int right = (largeScroll!=0) ? largeScroll->sizeHint().width() : 0; //the largeScroll is contained within the right margin
   if(showLNW){
-    this->setViewportMargins( LNWWidth(), 0, 0, 0); //the LNW is contained within the left margin
+    this->setViewportMargins( LNWWidth(), 0, right, 0); //the LNW is contained within the left margin
   }else{
-    this->setViewportMargins( 0, 0, 0, 0); //the LNW is contained within the left margin
+    this->setViewportMargins( 0, 0, right, 0); //the LNW is contained within the left margin
   }
 }
 
@@ -273,9 +372,84 @@ void PlainTextEditor::checkMatchChar(){
   } //end check for next/previous char
 }
 
+void PlainTextEditor::updateSyntaxLimit(){
+  //Highlight everything down to a bit past the bottom of the viewport (each block is at least one line)
+  int lines = this->viewport()->height() / this->fontMetrics().lineSpacing();
+  SYNTAX->setHighlightLimit( this->firstVisibleBlock().blockNumber() + 2*lines + 10 );
+}
+
+//Functions for moving the large file window around
+void PlainTextEditor::windowScrolled(){
+  if(LARGE==0){ return; }
+  QScrollBar *bar = this->verticalScrollBar();
+  int line = winStart + bar->value(); //first visible line in the file
+  bool nearTop = (winStart>0 && bar->value()<LARGE_MARGIN);
+  bool nearBottom = (winStart+this->blockCount() < LARGE->lineCount() && bar->value()+bar->pageStep() > this->blockCount()-LARGE_MARGIN);
+  if(nearTop || nearBottom){ loadWindow(line); }
+  largeScroll->blockSignals(true);
+  largeScroll->setValue(line);
+  largeScroll->blockSignals(false);
+}
+
+void PlainTextEditor::largeScrolled(int line){
+  if(LARGE==0){ return; }
+  QScrollBar *bar = this->verticalScrollBar();
+  if(line<winStart || line > winStart+this->blockCount()-bar->pageStep()){ loadWindow(line); }
+  else{ bar->setValue(line-winStart); }
+}
+
+void PlainTextEditor::largeFindFinished(qint64 found){
+  if(LARGE==0){ return; }
+  if(found<0){
+    cursorMoved();
+    this->setStatusTip(this->statusTip()+" "+tr("(text not found)"));
+    emit statusTipChanged();
+    return;
+  }
+  findMatch = found;
+  if(LARGE->isIndexed()){ showLargeMatch(); }
+  else{ cursorMoved(); } //need the full line index first (indexReady)
+}
+
+void PlainTextEditor::showLargeMatch(){
+  //Turn the offset of the match into a line number and select it
+  if(LARGE==0 || findMatch<0 || !LARGE->isIndexed()){ return; }
+  qint64 found = findMatch;
+  findMatch = -1;
+  int line = LARGE->lineForOffset(found);
+  if(line<winStart || line>=winStart+this->blockCount()){ loadWindow(line); }
+  QTextBlock block = this->document()->findBlockByNumber(line-winStart);
+  QTextCursor cur(block);
+    cur.setPosition(block.position() + LARGE->columnForOffset(line, found));
+    cur.setPosition(cur.position() + findLength, QTextCursor::KeepAnchor);
+  this->setTextCursor(cur);
+  this->centerCursor();
+  cursorMoved();
+}
+
+void PlainTextEditor::updateLargeScroll(){
+  if(LARGE==0){ return; }
+  //Place the scrollbar within the right margin
+  QRect cGeom = this->contentsRect();
+  int width = largeScroll->sizeHint().width();
+  int height = cGeom.height();
+  if(this->horizontalScrollBar()->isVisible()){ height -= this->horizontalScrollBar()->height(); }
+  largeScroll->setGeometry( QRect(cGeom.right()-width+1, cGeom.top(), width, height) );
+  //Now update the range (the line index might have just finished)
+  int page = qMax(1, this->viewport()->height() / this->fontMetrics().lineSpacing());
+  largeScroll->blockSignals(true);
+  largeScroll->setRange(0, qMax(0, LARGE->lineCount()-page) );
+  largeScroll->setPageStep(page);
+  largeScroll->setValue(winStart + this->verticalScrollBar()->value());
+  largeScroll->blockSignals(false);
+  LNW_updateWidth();
+  cursorMoved();
+}
+
 //Functions for notifying the parent widget of changes
 void PlainTextEditor::textChanged(){
   //qDebug() << " - Got Text Changed signal";
+  if(LARGE!=0){ return; } //read-only view (the window of lines is just being changed)
   bool changed = (lastSaveContents != this->toPlainText());
   if(changed == hasChanges){ return; } //no change
   hasChanges = changed; //save for reading later
@@ -287,7 +461,13 @@ void PlainTextEditor::cursorMoved(){
   //Update the status tip for the editor to show the row/column number for the cursor
   QTextCursor cur = this->textCursor();
   QString stat = tr("Row Number: %1, Column Number: %2");
-  this->setStatusTip(stat.arg(QString::number(cur.blockNumber()+1) , QString::number(cur.columnNumber()) ) );
+  stat = stat.arg(QString::number(winStart+cur.blockNumber()+1) , QString::number(cur.columnNumber()) );
+  if(LARGE!=0){
+    stat.append(" ("+tr("Read Only")+")");
+    if(LARGE->isSearching() || findMatch>=0){ stat.append(" "+tr("Searching...")); }
+    else if(!LARGE->isIndexed()){ stat.append(" "+tr("Indexing lines...")); }
+  }
+  this->setStatusTip(stat);
   emit statusTipChanged();
 }
 
@@ -317,4 +497,6 @@ void PlainTextEditor::resizeEvent(QResizeEvent *ev){
   //Now re-adjust the placement of the LNW (within the left margin area)
   QRect cGeom = this->contentsRect();
   LNW->setGeometry( QRect(cGeom.left(), cGeom.top(), LNWWidth(), cGeom.height()) );
+  updateLargeScroll();
+  updateSyntaxLimit();
 }
@@ -12,8 +12,11 @@
 #include <QResizeEvent>
 #include <QPaintEvent>
 #include <QFileSystemWatcher>
+#include <QScrollBar>
+#include <QTextDocument>
 
 #include "syntaxSupport.h"
+#include "LargeFile.h"
 
 //QPlainTextEdit subclass for providing the actual text editor functionality
 class PlainTextEditor : public QPlainTextEdit{
@@ -33,6 +36,11 @@ public:
 	QString currentFile();
 
 	bool hasChange();
+	bool isLargeFile(){ return (LARGE!=0); } //read-only view of a file too big to load
+
+	//Search (starting back at the other end of the file if nothing is found)
+	// Note: Large files are searched in the background - the match gets selected once it is found
+	bool findText(QString text, QTextDocument::FindFlags flags);
 
 	//Functions for managing the line number widget (internal - do not need to run directly)
 	int LNWWidth(); //replacing the LNW size hint detection
@@ -54,6 +62,17 @@ private:
 
 	//Flags to keep track of changes
 	bool hasChanges;
+
+	//Large file mode (only a window of lines from the file is loaded into the editor)
+	LargeFile *LARGE;
+	QScrollBar *largeScroll; //position within the whole file
+	int winStart; //file line number of the first line in the editor
+	qint64 findMatch; //offset of a match waiting for the line index (-1: none)
+	int findLength; //characters to select for the match
+	bool openLargeFile(QString filepath);
+	void closeLargeFile();
+	void loadWindow(int line); //load the lines around this line of the file
+
 private slots:
 	//Functions for managing the line number widget
 	void LNW_updateWidth();  	// Tied to the QPlainTextEdit::blockCountChanged() signal
@@ -61,6 +80,14 @@ private slots:
 	void LNW_update(const QRect&, int); 	// Tied to the QPlainTextEdit::updateRequest() signal
 	//Function for running the matching routine
 	void checkMatchChar();
+	//Function for keeping the syntax highlighting caught up with the visible area
+	void updateSyntaxLimit();
+	//Functions for moving the large file window around
+	void windowScrolled();
+	void largeScrolled(int);
+	void updateLargeScroll();
+	void largeFindFinished(qint64);
+	void showLargeMatch();
 	//Functions for notifying the parent widget of changes
 	void textChanged();
 	void cursorMoved();
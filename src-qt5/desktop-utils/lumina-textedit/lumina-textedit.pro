@@ -1,6 +1,6 @@
 include("$${PWD}/../../OS-detect.pri")
 
-QT += core gui widgets
+QT += core gui widgets concurrent
 
 TARGET  = lumina-textedit
 target.path = $${L_BINDIR}
@@ -14,12 +14,14 @@ include(../../core/libLumina/LuminaThemes.pri)
 HEADERS	+= MainUI.h \
 			PlainTextEditor.h \
 			syntaxSupport.h \
+			LargeFile.h \
 			ColorDialog.h
 		
 SOURCES	+= main.cpp \
 			MainUI.cpp \
 			PlainTextEditor.cpp \
 			syntaxSupport.cpp \
+			LargeFile.cpp \
 			ColorDialog.cpp
 
 FORMS		+= MainUI.ui \
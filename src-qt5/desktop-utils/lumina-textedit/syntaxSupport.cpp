@@ -6,6 +6,22 @@
 //===========================================
 #include "syntaxSupport.h"
 
+#include <QElapsedTimer>
+
+#define SLICE_MS 10 //max time spent on background highlighting before returning to the event loop
+#define DEFAULT_LIMIT 100
+
+Custom_Syntax::Custom_Syntax(QSettings *set, QTextDocument *parent) : QSyntaxHighlighter(parent){
+  settings = set;
+  limit = DEFAULT_LIMIT;
+  firstPending = 0;
+  pendingTimer = new QTimer(this);
+    pendingTimer->setInterval(0);
+    pendingTimer->setSingleShot(true);
+    connect(pendingTimer, SIGNAL(timeout()), this, SLOT(highlightPending()) );
+  if(parent!=0){ connect(parent, SIGNAL(contentsChange(int,int,int)), this, SLOT(documentChanged(int,int,int)) ); }
+}
+
 QStringList Custom_Syntax::availableRules(){
   QStringList avail;
     avail << "C++";
@@ -63,44 +79,40 @@ void Custom_Syntax::loadRules(QString type){
     SyntaxRule rule;
 	rule.format.setForeground( QColor(settings->value("colors/keyword").toString()) );
 	rule.format.setFontWeight(QFont::Bold);
-    for(int i=0; i<keywords.length(); i++){
-      rule.pattern = QRegExp("\\b"+keywords[i]+"\\b"); //turn each keyword into a QRegExp and insert the rule
-      rules << rule;
-    }
+    rule.pattern = QRegularExpression("\\b(?:"+keywords.join("|")+")\\b"); //all the keywords in a single pattern
+    rules << rule;
     //Alternate Keywords (built-in functions)
     keywords.clear();
     keywords << "for" << "while" << "switch" << "case" << "if" << "else" << "return" << "exit";
     rule.format.setForeground( QColor(settings->value("colors/altkeyword").toString()) );
-    for(int i=0; i<keywords.length(); i++){
-      rule.pattern = QRegExp("\\b"+keywords[i]+"\\b"); //turn each keyword into a QRegExp and insert the rule
-      rules << rule;
-    }
+    rule.pattern = QRegularExpression("\\b(?:"+keywords.join("|")+")\\b"); //all the keywords in a single pattern
+    rules << rule;
     //Class Names
     rule.format.setForeground( QColor(settings->value("colors/class").toString()) );
-    rule.pattern = QRegExp("\\b[A-Za-z0-9_-\\.]+(?=::)\\b");
+    rule.pattern = QRegularExpression("\\b[A-Za-z0-9_\\-\\.]+(?=::)\\b");
     rules << rule;
     //Quotes
     rule.format.setForeground( QColor(settings->value("colors/text").toString()) );
     rule.format.setFontWeight(QFont::Normal);
-    rule.pattern = QRegExp( "\"[^\"\\\\]*(\\\\(.|\\n)[^\"\\\\]*)*\"|'[^'\\\\]*(\\\\(.|\\n)[^'\\\\]*)*'");
+    rule.pattern = QRegularExpression( "\"[^\"\\\\]*(\\\\(.|\\n)[^\"\\\\]*)*\"|'[^'\\\\]*(\\\\(.|\\n)[^'\\\\]*)*'");
     rules << rule;
     //Functions
     rule.format.setForeground( QColor(settings->value("colors/function").toString()) );
-    rule.pattern = QRegExp("\\b[A-Za-z0-9_]+(?=\\()");
+    rule.pattern = QRegularExpression("\\b[A-Za-z0-9_]+(?=\\()");
     rules << rule;
     //Proprocessor commands
     rule.format.setForeground( QColor(settings->value("colors/preprocessor").toString()) );
-    rule.pattern = QRegExp("^[\\s]*#[^\n]*");
+    rule.pattern = QRegularExpression("^[\\s]*#[^\n]*");
     rules << rule;    
     //Comment (single line)
     rule.format.setForeground( QColor(settings->value("colors/comment").toString()) );
-    rule.pattern = QRegExp("//[^\n]*");
+    rule.pattern = QRegularExpression("//[^\n]*");
     rules << rule;
     //Comment (multi-line)
     SyntaxRuleSplit srule;
     srule.format = rule.format; //re-use the single-line comment format
-    srule.startPattern = QRegExp("/\\*");
-    srule.endPattern = QRegExp("\\*/");
+    srule.startPattern = QRegularExpression("/\\*");
+    srule.endPattern = QRegularExpression("\\*/");
     splitrules << srule;
     
   }else if(type=="Shell"){
@@ -121,46 +133,42 @@ void Custom_Syntax::loadRules(QString type){
     SyntaxRule rule;
 	rule.format.setForeground( QColor(settings->value("colors/keyword").toString()) );
 	rule.format.setFontWeight(QFont::Bold);
-    for(int i=0; i<keywords.length(); i++){
-      rule.pattern = QRegExp("\\b"+keywords[i]+"\\b"); //turn each keyword into a QRegExp and insert the rule
-      rules << rule;
-    }
+    rule.pattern = QRegularExpression("\\b(?:"+keywords.join("|")+")\\b"); //all the keywords in a single pattern
+    rules << rule;
     //Alternate Keywords (built-in functions)
     /*keywords.clear();
     keywords << "for" << "while" << "switch" << "case" << "if" << "else" << "return" << "exit";
     rule.format.setForeground( QColor(settings->value("colors/altkeyword").toString()) );
-    for(int i=0; i<keywords.length(); i++){
-      rule.pattern = QRegExp("\\b"+keywords[i]+"\\b"); //turn each keyword into a QRegExp and insert the rule
-      rules << rule;
-    }*/
+    rule.pattern = QRegularExpression("\\b(?:"+keywords.join("|")+")\\b"); //all the keywords in a single pattern
+    rules << rule;*/
     //Variable Names
     rule.format.setForeground( QColor(settings->value("colors/class").toString()) );
-    rule.pattern = QRegExp("\\$\\{[^\\n\\}]+\\}");
+    rule.pattern = QRegularExpression("\\$\\{[^\\n\\}]+\\}");
     rules << rule;
-    rule.pattern = QRegExp("\\$[^\\s$]+(?=\\s|$)");
+    rule.pattern = QRegularExpression("\\$[^\\s$]+(?=\\s|$)");
     rules << rule;
     //Quotes
     rule.format.setForeground( QColor(settings->value("colors/text").toString()) );
     rule.format.setFontWeight(QFont::Normal);
-    rule.pattern = QRegExp( "\"[^\"\\\\]*(\\\\(.|\\n)[^\"\\\\]*)*\"|'[^'\\\\]*(\\\\(.|\\n)[^'\\\\]*)*'");
+    rule.pattern = QRegularExpression( "\"[^\"\\\\]*(\\\\(.|\\n)[^\"\\\\]*)*\"|'[^'\\\\]*(\\\\(.|\\n)[^'\\\\]*)*'");
     rules << rule;
     //Functions
     rule.format.setForeground( QColor(settings->value("colors/function").toString()) );
-    rule.pattern = QRegExp("\\b[A-Za-z0-9_]+(?=\\()");
+    rule.pattern = QRegularExpression("\\b[A-Za-z0-9_]+(?=\\()");
     rules << rule;
     //Proprocessor commands
     rule.format.setForeground( QColor(settings->value("colors/preprocessor").toString()) );
-    rule.pattern = QRegExp("^#![^\n]*");
+    rule.pattern = QRegularExpression("^#![^\n]*");
     rules << rule;    
     //Comment (single line)
     rule.format.setForeground( QColor(settings->value("colors/comment").toString()) );
-    rule.pattern = QRegExp("#[^\n]*");
+    rule.pattern = QRegularExpression("#[^\n]*");
     rules << rule;
     //Comment (multi-line)
     //SyntaxRuleSplit srule;
     //srule.format = rule.format; //re-use the single-line comment format
-    //srule.startPattern = QRegExp("/\\*");
-    //srule.endPattern = QRegExp("\\*/");
+    //srule.startPattern = QRegularExpression("/\\*");
+    //srule.endPattern = QRegularExpression("\\*/");
     //splitrules << srule;
     
   }else if(type=="Python"){
@@ -174,32 +182,30 @@ void Custom_Syntax::loadRules(QString type){
     SyntaxRule rule;
 	rule.format.setForeground( QColor(settings->value("colors/keyword").toString()) );
 	rule.format.setFontWeight(QFont::Bold);
-    for(int i=0; i<keywords.length(); i++){
-      rule.pattern = QRegExp("\\b"+keywords[i]+"\\b"); //turn each keyword into a QRegExp and insert the rule
-      rules << rule;
-    }
+    rule.pattern = QRegularExpression("\\b(?:"+keywords.join("|")+")\\b"); //all the keywords in a single pattern
+    rules << rule;
     //Class Names
     //rule.format.setForeground(Qt::darkMagenta);
-    //rule.pattern = QRegExp("\\bQ[A-Za-z]+\\b");
+    //rule.pattern = QRegularExpression("\\bQ[A-Za-z]+\\b");
     //rules << rule;
     //Quotes
     rule.format.setForeground( QColor(settings->value("colors/text").toString()) );
     rule.format.setFontWeight(QFont::Normal);
-    rule.pattern = QRegExp( "\"[^\"\\\\]*(\\\\(.|\\n)[^\"\\\\]*)*\"|'[^'\\\\]*(\\\\(.|\\n)[^'\\\\]*)*'");
+    rule.pattern = QRegularExpression( "\"[^\"\\\\]*(\\\\(.|\\n)[^\"\\\\]*)*\"|'[^'\\\\]*(\\\\(.|\\n)[^'\\\\]*)*'");
     rules << rule;
     //Functions
     rule.format.setForeground( QColor(settings->value("colors/function").toString()) );
-    rule.pattern = QRegExp("\\b[A-Za-z0-9_]+(?=\\()");
+    rule.pattern = QRegularExpression("\\b[A-Za-z0-9_]+(?=\\()");
     rules << rule;
     //Comment (single line)
     rule.format.setForeground( QColor(settings->value("colors/comment").toString()) );
-    rule.pattern = QRegExp("#[^\n]*");
+    rule.pattern = QRegularExpression("#[^\n]*");
     rules << rule;
     //Comment (multi-line)
     //SyntaxRuleSplit srule;
     //srule.format = rule.format; //re-use the single-line comment format
-    //srule.startPattern = QRegExp("/\\*");
-    //srule.endPattern = QRegExp("\\*/");
+    //srule.startPattern = QRegularExpression("/\\*");
+    //srule.endPattern = QRegularExpression("\\*/");
     //splitrules << srule;
     
   }else if(type=="reST"){
@@ -207,62 +213,183 @@ void Custom_Syntax::loadRules(QString type){
     // directives
     rule.format.setForeground( QColor(settings->value("colors/class").toString()) );
     rule.format.setFontItalic(false);
-    rule.pattern = QRegExp("(\\s|^):[a-zA-Z0-9 ]*:`[^`]*`");
+    rule.pattern = QRegularExpression("(\\s|^):[a-zA-Z0-9 ]*:`[^`]*`");
     rules << rule;
     // hyperlinks
     rule.format.setFontItalic(true);
     rule.format.setFontWeight(QFont::Normal);
-    rule.pattern = QRegExp("`[^\\<]*\\<[^\\>]*\\>`_");
+    rule.pattern = QRegularExpression("`[^\\<]*\\<[^\\>]*\\>`_");
     rules << rule;
     // Code Sample
     rule.format.setFontItalic(false);
     rule.format.setFontWeight(QFont::Light);
     rule.format.setFontFixedPitch(true);
-    rule.pattern = QRegExp("\\b`{2}.*`{2}\\b");
+    rule.pattern = QRegularExpression("\\b`{2}.*`{2}\\b");
     rules << rule;
     //Quotes
     /*rule.format.setForeground( QColor(settings->value("colors/text").toString()) );
     rule.format.setFontWeight(QFont::Normal);
-    rule.pattern = QRegExp( "\"[^\"\\\\]*(\\\\(.|\\n)[^\"\\\\]*)*\"|'[^'\\\\]*(\\\\(.|\\n)[^'\\\\]*)*'");
+    rule.pattern = QRegularExpression( "\"[^\"\\\\]*(\\\\(.|\\n)[^\"\\\\]*)*\"|'[^'\\\\]*(\\\\(.|\\n)[^'\\\\]*)*'");
     rules << rule;*/
     //TODO
     rule = SyntaxRule(); //reset rule
     rule.format.setFontWeight( QFont::Bold );
-    rule.pattern = QRegExp("^\\.\\.\\sTODO\\b");
+    rule.pattern = QRegularExpression("^\\.\\.\\sTODO\\b");
     rules << rule;
     rule = SyntaxRule(); //reset rule
     rule.format.setFontWeight( QFont::Bold );
-    rule.pattern = QRegExp("^(\\s*)\\.\\.(\\s*)([a-zA-Z0-9]+)::");
+    rule.pattern = QRegularExpression("^(\\s*)\\.\\.(\\s*)([a-zA-Z0-9]+)::");
     rules << rule;
     //Functions
     rule = SyntaxRule(); //reset rule
     rule.format.setForeground( QColor(settings->value("colors/preprocessor").toString()) );
-    rule.pattern = QRegExp("^(\\s*)\\.\\.(\\s*)\\b_[a-zA-Z0-9 ]*:(\\s|$)");
+    rule.pattern = QRegularExpression("^(\\s*)\\.\\.(\\s*)\\b_[a-zA-Z0-9 ]*:(\\s|$)");
     rules << rule;
     //figures and other properties for them
     rule = SyntaxRule(); //reset rule
     rule.format.setForeground( QColor(settings->value("colors/keyword").toString()) );
-    rule.pattern = QRegExp("^(\\s*)\\.\\.\\sfigure::\\s");
+    rule.pattern = QRegularExpression("^(\\s*)\\.\\.\\sfigure::\\s");
     rules << rule;
     rule = SyntaxRule(); //reset rule
     rule.format.setForeground( QColor(settings->value("colors/altkeyword").toString()) );
-    rule.pattern = QRegExp("^( ){3}:(.)*: ");
+    rule.pattern = QRegularExpression("^( ){3}:(.)*: ");
     rules << rule;    
 
     //Code Blocks
     SyntaxRuleSplit srule;
     srule.format.setBackground( QColor("lightblue") );
-    srule.startPattern = QRegExp("\\:\\:$");
-    srule.endPattern = QRegExp("^(?=[^\\s])");
+    srule.startPattern = QRegularExpression("\\:\\:$");
+    srule.endPattern = QRegularExpression("^(?=[^\\s])");
     splitrules << srule;
-    srule.startPattern = QRegExp("^(\\s*)\\.\\.\\scode-block::\\s"); //alternate start string for the same rule
-    srule.endPattern = QRegExp("^(?=[^\\s])");
+    srule.startPattern = QRegularExpression("^(\\s*)\\.\\.\\scode-block::\\s"); //alternate start string for the same rule
+    srule.endPattern = QRegularExpression("^(?=[^\\s])");
     splitrules << srule;
     //Comment (multi-line)
     srule = SyntaxRuleSplit();
     srule.format.setForeground( QColor(settings->value("colors/comment").toString()) );
-    srule.startPattern = QRegExp("^(\\s*)\\.\\.\\s[^_](?![\\w-_\\.]+::(\\s|$))");
-    srule.endPattern = QRegExp("^(?=([^\\s]|$))");
+    srule.startPattern = QRegularExpression("^(\\s*)\\.\\.\\s[^_](?![\\w\\-\\.]+::(\\s|$))");
+    srule.endPattern = QRegularExpression("^(?=([^\\s]|$))");
     splitrules << srule;
   }
+  compileRules();
+}
+
+void Custom_Syntax::setHighlightLimit(int block){
+  limit = block;
+  if(firstPending<=limit && !pendingTimer->isActive()){ pendingTimer->start(); }
+}
+
+// === PROTECTED ===
+void Custom_Syntax::highlightBlock(const QString &text){
+  //qDebug() << "Highlight Block:" << text;
+  //Blocks past the limit (or after a block which is not done yet) get highlighted later
+  // Note: the block state is left alone so the change does not propagate any further right now
+  QTextBlock block = currentBlock();
+  if(block.blockNumber()>limit || isPending(block.previous()) ){ setPending(true); return; }
+  setPending(false);
+  QVector<bool> done(text.length(), false); //characters which are already highlighted
+  //Now look for any multi-line patterns (starting/continuing/ending)
+  int start = 0;
+  int splitactive = previousBlockState();
+  if(splitactive>splitrules.length()-1){ splitactive = -1; } //just in case
+  while(start>=0 && start<=text.length()-1){
+    //qDebug() << "split check:" << start << splitactive;
+    if(splitactive>=0){
+      //Find the end of the current rule
+      QRegularExpressionMatch match = splitrules[splitactive].endPattern.match(text, start);
+      int from = (start>0) ? start-1 : start; //need to include the first character as well
+      if(!match.hasMatch()){
+        //rule did not finish - apply to all
+        setFormat(from, text.length()-from, splitrules[splitactive].format);
+        for(int c=from; c<text.length(); c++){ done[c] = true; }
+        break; //stop looking for more multi-line patterns
+      }else{
+        //Found end point within the same line
+        int len = match.capturedEnd()-from;
+        setFormat(from, len, splitrules[splitactive].format);
+        for(int c=from; c<from+len && c<text.length(); c++){ done[c] = true; }
+        start = from+len; //move pointer to the end of handled range
+        splitactive = -1; //done with this rule
+      }
+    } //end check for end match
+    //Look for the start of any new split rule
+    for(int i=0; i<splitrules.length() && splitactive<0; i++){
+      QRegularExpressionMatch match = splitrules[i].startPattern.match(text, start);
+      if(match.hasMatch() && match.capturedStart()>=start){
+        splitactive = i;
+        start = match.capturedStart()+1;
+        if(start>=text.length()-1){
+          //Need to apply highlighting to this section too - start matches the end of the line
+          setFormat(start-1, text.length()-start+1, splitrules[splitactive].format);
+          for(int c=start-1; c<text.length(); c++){ done[c] = true; }
+        }
+      }
+    }
+    if(splitactive<0){ break; } //no other rules found - go ahead and exit the loop
+  }
+  setCurrentBlockState(splitactive);
+  //Do all the single-line patterns
+  for(int i=0; i<rules.length(); i++){
+    QRegularExpressionMatchIterator it = rules[i].pattern.globalMatch(text);
+    while(it.hasNext()){
+      QRegularExpressionMatch match = it.next();
+      int index = match.capturedStart();
+      int len = match.capturedLength();
+      if(len<1 || done[index]){ continue; } //only apply highlighting if not within a section already
+      setFormat(index, len, rules[i].format);
+      for(int c=index; c<index+len; c++){ done[c] = true; }
+    }
+  }//end loop over normal (single-line) patterns
+}
+
+// === PRIVATE ===
+bool Custom_Syntax::isPending(const QTextBlock &block){
+  SyntaxBlockData *data = static_cast<SyntaxBlockData*>(block.userData());
+  return (data!=0 && data->pending);
+}
+
+void Custom_Syntax::setPending(bool pending){
+  SyntaxBlockData *data = static_cast<SyntaxBlockData*>(currentBlockUserData());
+  if(data==0){
+    if(!pending){ return; }
+    data = new SyntaxBlockData();
+    setCurrentBlockUserData(data); //the block takes ownership
+  }
+  data->pending = pending;
+  if(pending){
+    int num = currentBlock().blockNumber();
+    if(num<firstPending){ firstPending = num; }
+    if(num<=limit && !pendingTimer->isActive()){ pendingTimer->start(); }
+  }
+}
+
+void Custom_Syntax::compileRules(){
+  //Compile all the patterns once (instead of for every block)
+  for(int i=0; i<rules.length(); i++){ rules[i].pattern.optimize(); }
+  for(int i=0; i<splitrules.length(); i++){
+    splitrules[i].startPattern.optimize();
+    splitrules[i].endPattern.optimize();
+  }
+}
+
+// === PRIVATE SLOTS ===
+void Custom_Syntax::highlightPending(){
+  if(document()==0){ return; }
+  //Work through the flagged blocks in order (each one needs the state of the one before it)
+  QElapsedTimer timer;
+  timer.start();
+  QTextBlock block = document()->findBlockByNumber(firstPending);
+  while(block.isValid() && block.blockNumber()<=limit && timer.elapsed()<SLICE_MS){
+    if(isPending(block)){ rehighlightBlock(block); }
+    block = block.next();
+  }
+  firstPending = block.isValid() ? block.blockNumber() : document()->blockCount();
+  if(block.isValid() && block.blockNumber()<=limit){ pendingTimer->start(); } //more to do - continue after any other events
+}
+
+void Custom_Syntax::documentChanged(int pos, int removed, int added){
+  Q_UNUSED(removed); Q_UNUSED(added);
+  //Block numbers after this point might have changed - check again from here
+  int num = document()->findBlock(pos).blockNumber();
+  if(num>=0 && num<firstPending){ firstPending = num; }
 }